@@ -54,7 +54,7 @@ enum   WindSpeedType  {WDMV, AWND};
 enum   TempUnitsType {DEG_C10, DEG_C, DEG_F};
 static char* ClimateVarWords[] = {"TMIN", "TMAX", "EVAP", "WDMV", "AWND",
                                   NULL};
-static char* TempUnitsWords[] = {"C10", "C", "F", NULL};
+static char* ClimTempUnitsWords[] = {"C10", "C", "F", NULL};
 
 //-----------------------------------------------------------------------------
 //  Data Structures
@@ -216,7 +216,7 @@ int  climate_readParams(char* tok[], int ntoks)
             FileTempUnits = DEG_C;
         if (ntoks > 3)
         {
-            i = findmatch(tok[3], TempUnitsWords);
+            i = findmatch(tok[3], ClimTempUnitsWords);
             if (i < 0)
                 return error_setInpError(ERR_KEYWORD, tok[3]);
             FileTempUnits = i;
@@ -58,6 +58,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "headers.h"
+#include "mempool.h"
 
 //-----------------------------------------------------------------------------
 //  Constants
@@ -642,7 +643,7 @@ int  addPremise(int r, int type, char* tok[], int nToks)
     if ( n < nToks && findmatch(tok[n], RuleKeyWords) >= 0 ) return ERR_RULE;
 
     // --- create the premise object
-    p = (struct TPremise *) malloc(sizeof(struct TPremise));
+    p = AllocArray(struct TPremise, 1);
     if ( !p ) return ERR_MEMORY;
     p->type      = type;
     p->exprIndex = exprIndex;
@@ -994,7 +995,7 @@ int  addAction(int r, char* tok[], int nToks)
     if ( n < nToks && findmatch(tok[n], RuleKeyWords) >= 0 ) return ERR_RULE;
 
     // --- create the action object
-    a = (struct TAction *) malloc(sizeof(struct TAction));
+    a = AllocArray(struct TAction, 1);
     if ( !a ) return ERR_MEMORY;
     a->rule      = r;
     a->link      = link;
@@ -1497,36 +1498,10 @@ void  deleteRules(void)
 //  Output:  none
 //  Purpose: frees the memory used for all of the control rules.
 //
+//  NOTE: each rule's premises and actions come from the project's memory
+//        pool and are freed along with it.
+//
 {
-   struct TPremise* p;
-   struct TPremise* pnext;
-   struct TAction*  a;
-   struct TAction*  anext;
-   int r;
-   for (r=0; r<RuleCount; r++)
-   {
-      p = Rules[r].firstPremise;
-      while ( p )
-      {
-         pnext = p->next;
-         free(p);
-         p = pnext;
-      }
-      a = Rules[r].thenActions;
-      while (a )
-      {
-         anext = a->next;
-         free(a);
-         a = anext;
-      }
-      a = Rules[r].elseActions;
-      while (a )
-      {
-         anext = a->next;
-         free(a);
-         a = anext;
-      }
-   }
    FREE(Rules);
    RuleCount = 0;
 }
@@ -36,18 +36,54 @@
 
 static const  double MAXVELOCITY =  50.;     // max. allowable velocity (ft/sec)
 
+// --- shape code that selects the general cross section functions
+#define ANY_SHAPE (-1)
+
+// --- the conduit solver and its geometry functions are inlined into one
+//     flow function per shape, where the shape is a constant and the
+//     compiler drops the geometry of all other shapes
+#if defined(_MSC_VER)
+  #define KERNEL_INLINE static __forceinline
+#elif defined(__GNUC__)
+  #define KERNEL_INLINE static inline __attribute__((always_inline))
+#else
+  #define KERNEL_INLINE static inline
+#endif
+
+// --- flow function of a conduit's cross section shape
+typedef void (*TConduitKernel)(int j, int steps, double omega, double dt,
+              double f);
+
 static int    getFlowClass(int link, double q, double h1, double h2,
               double y1, double y2, double* criticalDepth, double* normalDepth,
               double* fasnh);
-static void   findSurfArea(int link, double q, double length, double* h1,
-              double* h2, double* y1, double* y2);
+static TConduitKernel getKernel(TXsect* xsect);
+static void   findCircularFlow(int j, int steps, double omega, double dt,
+              double f);
+static void   findRectClosedFlow(int j, int steps, double omega, double dt,
+              double f);
+static void   findRectOpenFlow(int j, int steps, double omega, double dt,
+              double f);
+static void   findTrapezoidalFlow(int j, int steps, double omega, double dt,
+              double f);
+static void   findGeneralFlow(int j, int steps, double omega, double dt,
+              double f);
+KERNEL_INLINE void findConduitFlow(int j, int steps, double omega,
+              double dt, int shape, double f);
+static double getNodeDepth(int n, double f);
+KERNEL_INLINE void findSurfArea(int link, double q, double length,
+              double* h1, double* h2, double* y1, double* y2, int shape);
 static double findLocalLosses(int link, double a1, double a2, double aMid,
               double q);
 
 double getWidth(TXsect* xsect, double y);
-static double getSlotWidth(TXsect* xsect, double y);
-static double getArea(TXsect* xsect, double y, double wSlot);
 double getHydRad(TXsect* xsect, double y);
+KERNEL_INLINE int    isOpenShape(TXsect* xsect, int shape);
+KERNEL_INLINE double findSlotWidth(TXsect* xsect, int shape, double y);
+KERNEL_INLINE double findWidth(TXsect* xsect, int shape, double y);
+KERNEL_INLINE double findArea(TXsect* xsect, int shape, double y,
+              double wSlot);
+KERNEL_INLINE double findHydRad(TXsect* xsect, int shape, double y);
 
 static double checkNormalFlow(int j, double q, double y1, double y2,
               double a1, double r1);
@@ -60,10 +96,135 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
 //           steps    = number of iteration steps taken
 //           omega    = under-relaxation parameter
 //           dt       = time step (sec)
-//  Output:  returns new flow value (cfs)
+//  Output:  none
 //  Purpose: updates flow in conduit link by solving finite difference
 //           form of continuity and momentum equations.
 //
+{
+    getKernel(&Link[j].xsect)(j, steps, omega, dt, 1.0);
+}
+
+//=============================================================================
+
+void  dwflow_findConduitSubsteps(int j, int steps, double omega, double dt,
+                                 int n)
+//
+//  Input:   j        = link index
+//           steps    = number of iteration steps taken
+//           omega    = under-relaxation parameter
+//           dt       = time step (sec)
+//           n        = number of sub-steps
+//  Output:  none
+//  Purpose: updates flow in conduit link by taking n equal sub-steps over
+//           the time step, with end node depths interpolated between their
+//           values at the start and end of the time step.
+//
+//  This is link-only sub-stepping: the end nodes are not sub-stepped, so
+//  their depths still come from the network's node continuity balance
+//  made once per time step.
+//
+{
+    int    s;
+    int    k = Link[j].subIndex;
+    TConduitKernel findFlow = getKernel(&Link[j].xsect);
+    double qOld = Link[j].oldFlow;
+    double aOld = Conduit[k].a2;
+    double qLast = Conduit[k].q1;      // flow from previous iteration (cfs)
+    double q;
+
+    // --- each sub-step starts from the solution of the previous one
+    //     (under-relaxation is not applied between sub-steps)
+    for ( s = 1; s <= n; s++ )
+    {
+        findFlow(j, 0, omega, dt / n, (double)s / n);
+        Link[j].oldFlow = Link[j].newFlow;
+        Conduit[k].a2 = Conduit[k].a1;
+    }
+
+    // --- restore state at start of time step & make dqdh refer to
+    //     the full time step
+    Link[j].oldFlow = qOld;
+    Conduit[k].a2 = aOld;
+    Link[j].dqdh *= n;
+
+    // --- apply under-relaxation between the end-of-step flow & the flow
+    //     from the previous iteration (as done for a single step);
+    //     do not allow change in flow direction without first being zero
+    q = Conduit[k].q1;
+    if ( steps > 0 && q != 0.0 )
+    {
+        q = (1.0 - omega) * qLast + omega * q;
+        if ( q * qLast < 0.0 ) q = 0.001 * SGN(q);
+        Conduit[k].q1 = q;
+        Conduit[k].q2 = q;
+        Link[j].newFlow = q * Conduit[k].barrels;
+    }
+}
+
+//=============================================================================
+
+TConduitKernel getKernel(TXsect* xsect)
+//
+//  Input:   xsect = ptr. to conduit's cross section
+//  Output:  returns the flow function used for the conduit
+//  Purpose: selects the flow function specialized for a conduit's shape
+//           (shapes that use a geometry lookup table use the general one).
+//
+{
+    if ( xsect->geomTable < 0 ) switch ( xsect->type )
+    {
+      case CIRCULAR:    return findCircularFlow;
+      case RECT_CLOSED: return findRectClosedFlow;
+      case RECT_OPEN:   return findRectOpenFlow;
+      case TRAPEZOIDAL: return findTrapezoidalFlow;
+    }
+    return findGeneralFlow;
+}
+
+//=============================================================================
+
+void findCircularFlow(int j, int steps, double omega, double dt, double f)
+{
+    findConduitFlow(j, steps, omega, dt, CIRCULAR, f);
+}
+
+void findRectClosedFlow(int j, int steps, double omega, double dt, double f)
+{
+    findConduitFlow(j, steps, omega, dt, RECT_CLOSED, f);
+}
+
+void findRectOpenFlow(int j, int steps, double omega, double dt, double f)
+{
+    findConduitFlow(j, steps, omega, dt, RECT_OPEN, f);
+}
+
+void findTrapezoidalFlow(int j, int steps, double omega, double dt, double f)
+{
+    findConduitFlow(j, steps, omega, dt, TRAPEZOIDAL, f);
+}
+
+void findGeneralFlow(int j, int steps, double omega, double dt, double f)
+{
+    findConduitFlow(j, steps, omega, dt, ANY_SHAPE, f);
+}
+
+//=============================================================================
+
+void  findConduitFlow(int j, int steps, double omega, double dt, int shape,
+                      double f)
+//
+//  Input:   j        = link index
+//           steps    = number of iteration steps taken
+//           omega    = under-relaxation parameter
+//           dt       = time step (sec)
+//           shape    = conduit's cross section shape or ANY_SHAPE
+//                      (a constant in each shape's flow function)
+//           f        = fraction of the routing time step at which end
+//                      node depths are evaluated
+//  Output:  none
+//  Purpose: solves the continuity and momentum equations for a conduit
+//           using geometry functions specialized for a given shape.
+//
 {
     int    k;                          // index of conduit
     int    n1, n2;                     // indexes of end nodes
@@ -109,8 +270,8 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
     n2 = Link[j].node2;
     z1 = Node[n1].invertElev + Link[j].offset1;
     z2 = Node[n2].invertElev + Link[j].offset2;
-    h1 = Node[n1].newDepth + Node[n1].invertElev;
-    h2 = Node[n2].newDepth + Node[n2].invertElev;
+    h1 = getNodeDepth(n1, f) + Node[n1].invertElev;
+    h2 = getNodeDepth(n2, f) + Node[n2].invertElev;
     h1 = MAX(h1, z1);
     h2 = MAX(h2, z2);
 
@@ -137,20 +298,20 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
 
     // --- find surface area contributions to upstream and downstream nodes
     //     based on previous iteration's flow estimate
-    findSurfArea(j, qLast, length, &h1, &h2, &y1, &y2);
+    findSurfArea(j, qLast, length, &h1, &h2, &y1, &y2, shape);
 
     // --- compute area at each end of conduit & hyd. radius at upstream end
-    wSlot = getSlotWidth(xsect, y1);
-    a1 = getArea(xsect, y1, wSlot);
-    r1 = getHydRad(xsect, y1);
-    wSlot = getSlotWidth(xsect, y2);
-    a2 = getArea(xsect, y2, wSlot);
+    wSlot = findSlotWidth(xsect, shape, y1);
+    a1 = findArea(xsect, shape, y1, wSlot);
+    r1 = findHydRad(xsect, shape, y1);
+    wSlot = findSlotWidth(xsect, shape, y2);
+    a2 = findArea(xsect, shape, y2, wSlot);
 
     // --- compute area & hyd. radius at midpoint
     yMid = 0.5 * (y1 + y2);
-    wSlot = getSlotWidth(xsect, yMid);
-    aMid = getArea(xsect, yMid, wSlot);
-    rMid = getHydRad(xsect, yMid);
+    wSlot = findSlotWidth(xsect, shape, yMid);
+    aMid = findArea(xsect, shape, yMid, wSlot);
+    rMid = findHydRad(xsect, shape, yMid);
 
     // --- alternate approach not currently used, but might produce better
     //     Bernoulli energy balance for steady flows
@@ -205,7 +366,7 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
     else if ( InertDamping == FULL_DAMPING ) sigma = 0.0;
 
     // --- use full inertial damping if closed conduit is surcharged
-    if ( isFull && !xsect_isOpen(xsect->type) ) sigma = 0.0;
+    if ( isFull && !isOpenShape(xsect, shape) ) sigma = 0.0;
 
     // --- compute terms of momentum eqn.:
     // --- 1. friction slope term
@@ -277,8 +438,8 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
 
     // --- do not allow flow out of a dry node
     //     (as suggested by R. Dickinson)
-    if( q >  FUDGE && Node[n1].newDepth <= FUDGE ) q =  FUDGE;
-    if( q < -FUDGE && Node[n2].newDepth <= FUDGE ) q = -FUDGE;
+    if( q >  FUDGE && getNodeDepth(n1, f) <= FUDGE ) q =  FUDGE;
+    if( q < -FUDGE && getNodeDepth(n2, f) <= FUDGE ) q = -FUDGE;
 
     // --- save new values of area, flow, depth, & volume
     Conduit[k].a1 = aMid;
@@ -420,8 +581,23 @@ int getFlowClass(int j, double q, double h1, double h2, double y1, double y2,
 
 //=============================================================================
 
+double getNodeDepth(int n, double f)
+//
+//  Input:   n = node index
+//           f = fraction of the routing time step
+//  Output:  returns node depth (ft)
+//  Purpose: interpolates a node's depth between the start of the time step
+//           and its current estimate at the end of the time step.
+//
+{
+    if ( f >= 1.0 ) return Node[n].newDepth;
+    return Node[n].oldDepth + f * (Node[n].newDepth - Node[n].oldDepth);
+}
+
+//=============================================================================
+
 void findSurfArea(int j, double q, double length, double* h1, double* h2,
-                  double* y1, double* y2)
+                  double* y1, double* y2, int shape)
 //
 //  Input:   j  = conduit link index
 //           q  = current conduit flow (cfs)
@@ -430,6 +606,7 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
 //           h2 = head at downstream end of conduit (ft)
 //           y1 = upstream flow depth (ft)
 //           y2 = downstream flow depth (ft)
+//           shape = conduit's cross section shape or ANY_SHAPE
 //  Output:  updated values of h1, h2, y1, & y2;
 //  Purpose: assigns surface area of conduit to its up and downstream nodes.
 //
@@ -473,9 +650,9 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
       case SUBCRITICAL:
         flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
         if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width1 =   getWidth(xsect, flowDepth1);
-        width2 =   getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
+        width1 =   findWidth(xsect, shape, flowDepth1);
+        width2 =   findWidth(xsect, shape, flowDepth2);
+        widthMid = findWidth(xsect, shape, flowDepthMid);
         surfArea1 = (width1 + widthMid) * length / 4.;
         surfArea2 = (widthMid + width2) * length / 4. * fasnh;
 		
@@ -493,8 +670,8 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
         *h1 = Node[n1].invertElev + Link[j].offset1 + flowDepth1;
         flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
         if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width2   = getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
+        width2   = findWidth(xsect, shape, flowDepth2);
+        widthMid = findWidth(xsect, shape, flowDepthMid);
         surfArea2 = (widthMid + width2) * length * 0.5;
 		
 		/* START modification by Peter Schlagbauer | TUGraz; Revised by Alejandro Figueroa | EAWAG */
@@ -508,10 +685,10 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
         if ( normalDepth < criticalDepth ) flowDepth2 = normalDepth;
         flowDepth2 = MAX(flowDepth2, FUDGE);
         *h2 = Node[n2].invertElev + Link[j].offset2 + flowDepth2;
-        width1 = getWidth(xsect, flowDepth1);
+        width1 = findWidth(xsect, shape, flowDepth1);
         flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
         if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        widthMid = getWidth(xsect, flowDepthMid);
+        widthMid = findWidth(xsect, shape, flowDepthMid);
         surfArea1 = (width1 + widthMid) * length * 0.5;
 		
 		/* START modification by Peter Schlagbauer | TUGraz; Revised by Alejandro Figueroa | EAWAG */
@@ -524,9 +701,9 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
         flowDepth1 = FUDGE;
         flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
         if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width1 = getWidth(xsect, flowDepth1);
-        width2 = getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
+        width1 = findWidth(xsect, shape, flowDepth1);
+        width2 = findWidth(xsect, shape, flowDepth2);
+        widthMid = findWidth(xsect, shape, flowDepthMid);
 
         // --- assign avg. surface area of downstream half of conduit
         //     to the downstream node
@@ -549,9 +726,9 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
         flowDepth2 = FUDGE;
         flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
         if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width1 = getWidth(xsect, flowDepth1);
-        width2 = getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
+        width1 = findWidth(xsect, shape, flowDepth1);
+        width2 = findWidth(xsect, shape, flowDepth2);
+        widthMid = findWidth(xsect, shape, flowDepthMid);
 
         // --- assign avg. surface area of upstream half of conduit
         //     to the upstream node
@@ -609,12 +786,65 @@ double findLocalLosses(int j, double a1, double a2, double aMid, double q)
 
 //=============================================================================
 
-double getSlotWidth(TXsect* xsect, double y)
+double getWidth(TXsect* xsect, double y)
+//
+//  Input:   xsect = ptr. to conduit cross section
+//           y     = flow depth (ft)
+//  Output:  returns top width (ft)
+//  Purpose: computes top width of flow surface in conduit.
+//
+{
+    return findWidth(xsect, ANY_SHAPE, y);
+}
+
+//=============================================================================
+
+double getHydRad(TXsect* xsect, double y)
+//
+//  Input:   xsect = ptr. to conduit cross section
+//           y     = flow depth (ft)
+//  Output:  returns hydraulic radius (ft)
+//  Purpose: computes hydraulic radius of flow cross-section in a conduit.
+//
+{
+    return findHydRad(xsect, ANY_SHAPE, y);
+}
+
+//=============================================================================
+
+int isOpenShape(TXsect* xsect, int shape)
+//
+//  Input:   xsect = ptr. to conduit cross section
+//           shape = cross section shape or ANY_SHAPE
+//  Output:  returns TRUE if the cross section is open, FALSE if not
+//  Purpose: determines if a conduit's cross section is open or closed.
+//
+{
+    switch ( shape )
+    {
+      case CIRCULAR:
+      case RECT_CLOSED: return FALSE;
+      case RECT_OPEN:
+      case TRAPEZOIDAL: return TRUE;
+      default:          return xsect_isOpen(xsect->type);
+    }
+}
+
+//=============================================================================
+
+double findSlotWidth(TXsect* xsect, int shape, double y)
+//
+//  Input:   xsect = ptr. to conduit cross section
+//           shape = cross section shape or ANY_SHAPE
+//           y     = flow depth (ft)
+//  Output:  returns width of Preissmann slot (ft)
+//  Purpose: computes width of the Preissmann slot of a surcharged conduit.
+//
 {
     double yNorm = y / xsect->yFull;
 
     // --- return 0.0 if slot surcharge method not used
-    if (SurchargeMethod != SLOT || xsect_isOpen(xsect->type) ||
+    if (SurchargeMethod != SLOT || isOpenShape(xsect, shape) ||
     yNorm < CrownCutoff) return 0.0;
 
     // --- for depth > 1.78 * pipe depth, slot width = 1% of max. width
@@ -626,47 +856,95 @@ double getSlotWidth(TXsect* xsect, double y)
 
 //=============================================================================
 
-double getWidth(TXsect* xsect, double y)
+double findWidth(TXsect* xsect, int shape, double y)
 //
 //  Input:   xsect = ptr. to conduit cross section
+//           shape = cross section shape or ANY_SHAPE
 //           y     = flow depth (ft)
 //  Output:  returns top width (ft)
 //  Purpose: computes top width of flow surface in conduit.
 //
 {
-    double wSlot = getSlotWidth(xsect, y);
+    double wSlot = findSlotWidth(xsect, shape, y);
     if (wSlot > 0.0) return wSlot;
-    if (y / xsect->yFull >= CrownCutoff && !xsect_isOpen(xsect->type))
+    if (y / xsect->yFull >= CrownCutoff && !isOpenShape(xsect, shape))
         y = CrownCutoff * xsect->yFull;
-    return xsect_getWofY(xsect, y);
+    switch ( shape )
+    {
+      case CIRCULAR:
+        return xsect_getCircWofY(xsect, y);
+      case RECT_CLOSED:
+        if (y / xsect->yFull == 1.0) return 0.0;
+        return xsect->wMax;
+      case RECT_OPEN:
+        return xsect->wMax;
+      case TRAPEZOIDAL:
+        return xsect->yBot + 2.0 * y * xsect->sBot;
+      default:
+        return xsect_getWofY(xsect, y);
+    }
 }
 
 //=============================================================================
 
-double getArea(TXsect* xsect, double y, double wSlot)
+double findArea(TXsect* xsect, int shape, double y, double wSlot)
 //
 //  Input:   xsect = ptr. to conduit cross section
+//           shape = cross section shape or ANY_SHAPE
 //           y     = flow depth (ft)
+//           wSlot = width of Preissmann slot (ft)
 //  Output:  returns flow area (ft2)
 //  Purpose: computes area of flow cross-section in a conduit.
 //
 {
     if ( y >= xsect->yFull ) return xsect->aFull + (y - xsect->yFull) * wSlot;
-    return xsect_getAofY(xsect, y);
+    if ( y <= 0.0 ) return 0.0;
+    switch ( shape )
+    {
+      case CIRCULAR:
+        return xsect_getCircAofY(xsect, y);
+      case RECT_CLOSED:
+      case RECT_OPEN:
+        return y * xsect->wMax;
+      case TRAPEZOIDAL:
+        return ( xsect->yBot + xsect->sBot * y ) * y;
+      default:
+        return xsect_getAofY(xsect, y);
+    }
 }
 
 //=============================================================================
 
-double getHydRad(TXsect* xsect, double y)
+double findHydRad(TXsect* xsect, int shape, double y)
 //
 //  Input:   xsect = ptr. to conduit cross section
+//           shape = cross section shape or ANY_SHAPE
 //           y     = flow depth (ft)
 //  Output:  returns hydraulic radius (ft)
 //  Purpose: computes hydraulic radius of flow cross-section in a conduit.
 //
 {
+    double a;
+
     if (y >= xsect->yFull) return xsect->rFull;
-    return xsect_getRofY(xsect, y);
+    switch ( shape )
+    {
+      case CIRCULAR:
+        return xsect_getCircRofY(xsect, y);
+      case RECT_CLOSED:
+        if ( y <= 0.0 ) return 0.0;
+        return xsect_getRofA(xsect, y * xsect->wMax);
+      case RECT_OPEN:
+        a = y * xsect->wMax;
+        if ( a <= 0.0 ) return 0.0;
+        return a / (xsect->wMax + (2. - xsect->sBot) * a / xsect->wMax);
+      case TRAPEZOIDAL:
+        if ( y == 0.0 ) return 0.0;
+        a = ( xsect->yBot + xsect->sBot * y ) * y;
+        return a / (xsect->yBot + y * xsect->rBot);
+      default:
+        return xsect_getRofY(xsect, y);
+    }
 }
 
 //=============================================================================
@@ -64,6 +64,7 @@ static const double DEFAULT_HEADTOL     = 0.005;  // Default head tolerance (ft)
 static const double EXTRAN_CROWN_CUTOFF = 0.96;   // crown cutoff for EXTRAN
 static const double SLOT_CROWN_CUTOFF   = 0.985257; // crown cutoff for SLOT
 static const int    DEFAULT_MAXTRIALS   = 8;      // Max. trials per time step
+static const double NEWTON_TOL          = 1.0e-6; // Rel. tolerance of head solver
 
 
 //-----------------------------------------------------------------------------
@@ -76,6 +77,7 @@ typedef struct
     double  oldSurfArea;               // previous surface area (ft2)
     double  sumdqdh;                   // sum of dqdh from adjoining links
     double  dYdT;                      // change in depth w.r.t. time (ft/sec)
+    char    fixedHead;                 // TRUE if Newton solver holds head fixed
 } TXnode;
 
 //-----------------------------------------------------------------------------
@@ -86,6 +88,21 @@ static TXnode* Xnode;                  // extended nodal information
 
 static double  Omega;                  // actual under-relaxation parameter
 static int     Steps;                  // number of Picard iterations
+static int     NotConverged;           // TRUE if a node has not converged
+
+static int*    ConduitOrder;           // true conduits by shape & locality
+static int     ConduitCount;           // number of true conduits
+
+static double* Jdiag;                  // diagonal of head Jacobian
+static double* Jresid;                 // node continuity residuals
+static double* Dhead;                  // Newton head corrections (ft)
+static double* Work;                   // work arrays for the CG solver
+static int*    NodeLinkStart;          // start of each node's coupled links
+static int*    NodeLinks;              // links coupling heads of their nodes
+static double  CgRz, CgPq,             // sums shared by the threads
+               CgRnorm, CgBnorm;       //   of the CG solver
+
+static char*   RateLevel;              // sub-step level of each link
 
 //-----------------------------------------------------------------------------
 //  Function declarations
@@ -97,6 +114,8 @@ static void   findLimitedLinks();
 
 static void   findLinkFlows(double dt);
 static int    isTrueConduit(int link);
+static int    usesNodeInflow(int link);
+static int    sortConduits(void);
 static void   findNonConduitFlow(int link, double dt);
 static void   findNonConduitSurfArea(int link);
 static double getModPumpFlow(int link, double q, double dt);
@@ -105,11 +124,18 @@ static void   updateConvergenceStats();
 
 static int    findNodeDepths(double dt);
 static void   setNodeDepth(int node, double dt);
+static int    isSurchargedNode(int node, int isPonded);
+static int    findNodeLinks(void);
+static void   findNewtonSteps(double dt);
+static void   multJacobian(double* x, double* y);
+static void   solveJacobian(double* b, double* x);
 static double getFloodedDepth(int node, int canPond, double dV, double yNew,
               double yMax, double dt);
 
 static double getVariableStep(double maxStep);
 static double getLinkStep(double tMin, int *minLink);
+static double getConduitStep(int link);
+static void   setRateLevels(double tStep);
 static double getNodeStep(double tMin, int *minNode);
 
 //=============================================================================
@@ -132,6 +158,45 @@ void dynwave_init()
             " Not enough memory for dynamic wave routing.");
         return;
     }
+    if ( !sortConduits() )
+    {
+        report_writeErrorMsg(ERR_MEMORY,
+            " Not enough memory for dynamic wave routing.");
+        return;
+    }
+
+    // --- allocate arrays used by the Newton solver
+    if ( SolverMethod == NEWTON )
+    {
+        Jdiag = (double *) calloc(6 * (Nobjects[NODE] + 1), sizeof(double));
+        if ( Jdiag == NULL )
+        {
+            report_writeErrorMsg(ERR_MEMORY,
+                " Not enough memory for dynamic wave routing.");
+            return;
+        }
+        Jresid = Jdiag + (Nobjects[NODE] + 1);
+        Dhead = Jresid + (Nobjects[NODE] + 1);
+        Work = Dhead + (Nobjects[NODE] + 1);
+        if ( !findNodeLinks() )
+        {
+            report_writeErrorMsg(ERR_MEMORY,
+                " Not enough memory for dynamic wave routing.");
+            return;
+        }
+    }
+
+    // --- allocate sub-step levels used by multirate routing
+    if ( RateLevels > 0 )
+    {
+        RateLevel = (char *) calloc(Nobjects[LINK] + 1, sizeof(char));
+        if ( RateLevel == NULL )
+        {
+            report_writeErrorMsg(ERR_MEMORY,
+                " Not enough memory for dynamic wave routing.");
+            return;
+        }
+    }
     
     // --- initialize node surface areas & crown elev.
     for (i = 0; i < Nobjects[NODE]; i++ )
@@ -170,6 +235,15 @@ void  dynwave_close()
 //
 {
     FREE(Xnode);
+    FREE(ConduitOrder);
+    ConduitCount = 0;
+    FREE(Jdiag);
+    Jresid = NULL;
+    Dhead = NULL;
+    Work = NULL;
+    FREE(NodeLinkStart);
+    FREE(NodeLinks);
+    FREE(RateLevel);
 }
 
 //=============================================================================
@@ -236,7 +310,16 @@ int dynwave_execute(double tStep)
     Steps = 0;
     converged = FALSE;
     Omega = OMEGA;
+
+    // --- one team of threads carries out all iterations of the time step;
+    //     the functions called below share out their loops among it
+    //     and make any serial updates from a single thread
+#pragma omp parallel num_threads(NumThreads)
+{
+    int stepConverged = FALSE;
+
     initRoutingStep();
+    if ( RateLevels > 0 ) setRateLevels(tStep);
 
     // --- keep iterating until convergence 
     while ( Steps < MaxTrials )
@@ -244,16 +327,20 @@ int dynwave_execute(double tStep)
         // --- execute a routing step & check for nodal convergence
         initNodeStates();
         findLinkFlows(tStep);
-        converged = findNodeDepths(tStep);
+        stepConverged = findNodeDepths(tStep);
+        #pragma omp single
         Steps++;
         if ( Steps > 1 )
         {
-            if ( converged ) break;
+            if ( stepConverged ) break;
 
             // --- check if link calculations can be skipped in next step
             findBypassedLinks();
         }
     }
+    #pragma omp master
+    converged = stepConverged;
+}
     if ( !converged ) updateConvergenceStats();
 
     //  --- identify any capacity-limited conduits
@@ -276,11 +363,13 @@ void updateConvergenceStats()
 void   initRoutingStep()
 {
     int i;
+    #pragma omp for nowait
     for (i = 0; i < Nobjects[NODE]; i++)
     {
         Xnode[i].converged = FALSE;
         Xnode[i].dYdT = 0.0;
     }
+    #pragma omp for nowait
     for (i = 0; i < Nobjects[LINK]; i++)
     {
         Link[i].bypassed = FALSE;
@@ -289,6 +378,7 @@ void   initRoutingStep()
     }
 
     // --- a2 preserves conduit area from solution at last time step
+    #pragma omp for
     for ( i = 0; i < Nlinks[CONDUIT]; i++) Conduit[i].a2 = Conduit[i].a1;
 }
 
@@ -303,6 +393,7 @@ void initNodeStates()
 {
     int i;
 
+    #pragma omp for
     for (i = 0; i < Nobjects[NODE]; i++)
     {
         // --- initialize nodal surface area
@@ -335,6 +426,7 @@ void initNodeStates()
 void   findBypassedLinks()
 {
     int i;
+    #pragma omp for
     for (i = 0; i < Nobjects[LINK]; i++)
     {
         if ( Xnode[Link[i].node1].converged &&
@@ -381,32 +473,47 @@ void  findLimitedLinks()
 
 void findLinkFlows(double dt)
 {
-    int i;
+    int i, j;
 
     // --- find new flow in each non-dummy conduit
-#pragma omp parallel num_threads(NumThreads)
-{
-    #pragma omp for
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    //     (conduits are visited grouped by cross section shape so that
+    //     each thread's block of conduits runs the same flow kernel)
+    #pragma omp for nowait
+    for ( i = 0; i < ConduitCount; i++)
     {
-        if ( isTrueConduit(i) && !Link[i].bypassed )
-            dwflow_findConduitFlow(i, Steps, Omega, dt);
+        j = ConduitOrder[i];
+        if ( Link[j].bypassed ) continue;
+        if ( RateLevel && RateLevel[j] > 0 )
+            dwflow_findConduitSubsteps(j, Steps, Omega, dt, 1 << RateLevel[j]);
+        else dwflow_findConduitFlow(j, Steps, Omega, dt);
     }
-}
 
-    // --- update inflow/outflows for nodes attached to non-dummy conduits
+    // --- find new flows for regulators, which depend only on node heads
+    #pragma omp for
     for ( i = 0; i < Nobjects[LINK]; i++)
     {
-        if ( isTrueConduit(i) ) updateNodeFlows(i);
+        if ( !isTrueConduit(i) && !Link[i].bypassed && !usesNodeInflow(i) )
+            findNonConduitFlow(i, dt);
     }
 
-    // --- find new flows for all dummy conduits, pumps & regulators
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    #pragma omp single
     {
-        if ( !isTrueConduit(i) )
+        // --- update inflow/outflows for nodes attached to non-dummy conduits
+        for ( i = 0; i < Nobjects[LINK]; i++)
         {
-            if ( !Link[i].bypassed ) findNonConduitFlow(i, dt);
-            updateNodeFlows(i);
+            if ( isTrueConduit(i) ) updateNodeFlows(i);
+        }
+
+        // --- find new flows for dummy conduits & pumps, which depend on the
+        //     inflow accumulated at their inlet nodes, & update node flows
+        for ( i = 0; i < Nobjects[LINK]; i++)
+        {
+            if ( !isTrueConduit(i) )
+            {
+                if ( !Link[i].bypassed && usesNodeInflow(i) )
+                    findNonConduitFlow(i, dt);
+                updateNodeFlows(i);
+            }
         }
     }
 }
@@ -420,6 +527,82 @@ int isTrueConduit(int j)
 
 //=============================================================================
 
+int usesNodeInflow(int j)
+//
+//  Input:   j = index of a non-conduit link
+//  Output:  returns TRUE if link's flow depends on its inlet node's inflow
+//  Purpose: identifies links whose flow must be found after the flows of
+//           all links with lower indexes have been added to their nodes.
+//
+{
+    return ( Link[j].type == PUMP || Link[j].type == CONDUIT );
+}
+
+//=============================================================================
+
+int sortConduits()
+//
+//  Input:   none
+//  Output:  returns FALSE if memory could not be allocated, TRUE otherwise
+//  Purpose: lists the indexes of all non-dummy conduits grouped by cross
+//           section shape and, within each shape, in breadth-first order
+//           through the network so that consecutive conduits share nodes.
+//
+//  The conduit records themselves are then renumbered to follow this
+//  order, so that the flow loop reads the Conduit array sequentially.
+//  Links and nodes keep their input order since their indexes also
+//  identify them in the output file, controls and the API.
+//
+{
+    int i, j, k, shape;
+    int* order;
+    TConduit* conduits;
+
+    ConduitCount = 0;
+    ConduitOrder = (int *) calloc(Nobjects[LINK] + 1, sizeof(int));
+    order = (int *) calloc(Nobjects[LINK] + 1, sizeof(int));
+    conduits = (TConduit *) calloc(Nlinks[CONDUIT] + 1, sizeof(TConduit));
+    if ( ConduitOrder == NULL || order == NULL || conduits == NULL ||
+         !toposort_sortLinksByLocality(order) )
+    {
+        FREE(order);
+        FREE(conduits);
+        return FALSE;
+    }
+    for ( shape = 0; shape <= STREET_XSECT; shape++ )
+    {
+        for ( i = 0; i < Nobjects[LINK]; i++ )
+        {
+            j = order[i];
+            if ( isTrueConduit(j) && Link[j].xsect.type == shape )
+                ConduitOrder[ConduitCount++] = j;
+        }
+    }
+
+    // --- renumber true conduits in sorted order, followed by dummy ones
+    k = 0;
+    for ( i = 0; i < ConduitCount; i++ )
+    {
+        j = ConduitOrder[i];
+        conduits[k] = Conduit[Link[j].subIndex];
+        Link[j].subIndex = k++;
+    }
+    for ( j = 0; j < Nobjects[LINK]; j++ )
+    {
+        if ( Link[j].type == CONDUIT && !isTrueConduit(j) )
+        {
+            conduits[k] = Conduit[Link[j].subIndex];
+            Link[j].subIndex = k++;
+        }
+    }
+    FREE(Conduit);
+    Conduit = conduits;
+    FREE(order);
+    return TRUE;
+}
+
+//=============================================================================
+
 void findNonConduitFlow(int i, double dt)
 //
 //  Input:   i = link index
@@ -601,14 +784,21 @@ int findNodeDepths(double dt)
     int i;
     double yOld = 0.0;       // previous node depth (ft)
 
+    #pragma omp single
+    NotConverged = FALSE;
+
     // --- compute outfall depths based on flow in connecting link
+    //     (an outfall has only one connecting link)
+    #pragma omp for
     for ( i = 0; i < Nobjects[LINK]; i++ ) link_setOutfallDepth(i);
 
+    // --- solve for head changes at all nodes simultaneously
+    //     (shared out among the team of threads)
+    if ( SolverMethod == NEWTON ) findNewtonSteps(dt);
+
     // --- compute new depth for all non-outfall nodes and determine if
     //     depth change from previous iteration is below tolerance
-#pragma omp parallel num_threads(NumThreads)
-{
-    #pragma omp for private(yOld)
+    #pragma omp for reduction(|:NotConverged)
     for ( i = 0; i < Nobjects[NODE]; i++ )
     {
         if ( Node[i].type == OUTFALL ) continue;
@@ -618,17 +808,12 @@ int findNodeDepths(double dt)
         if ( fabs(yOld - Node[i].newDepth) > HeadTol )
         {
             Xnode[i].converged = FALSE;
+            NotConverged = TRUE;
         }
     }
-}
 
    // --- return FALSE if any non-Outfall node failed to converge
-    for (i = 0; i < Nobjects[NODE]; i++)
-    {
-        if ( Node[i].type == OUTFALL ) continue;
-        if (Xnode[i].converged == FALSE) return FALSE;
-    }
-    return TRUE;
+    return !NotConverged;
 }
 
 //=============================================================================
@@ -674,21 +859,7 @@ void setNodeDepth(int i, double dt)
     dV = 0.5 * (Node[i].oldNetInflow + dQ) * dt;
 
     // --- determine if node is EXTRAN surcharged
-    if (SurchargeMethod == EXTRAN)
-    {
-        // --- ponded nodes don't surcharge
-        if (isPonded) isSurcharged = FALSE;
-
-        // --- closed storage units that are full are in surcharge
-        else if (Node[i].type == STORAGE)
-        {
-            isSurcharged = (Node[i].surDepth > 0.0 &&
-                            yLast > Node[i].fullDepth);
-        }
-
-        // --- surcharge occurs when node depth exceeds top of its highest link
-        else isSurcharged = (yCrown > 0.0 && yLast > yCrown);
-    }
+    isSurcharged = isSurchargedNode(i, isPonded);
 
     // --- if node not surcharged, base depth change on surface area        
     if (!isSurcharged)
@@ -699,8 +870,12 @@ void setNodeDepth(int i, double dt)
         // --- save non-ponded surface area for use in surcharge algorithm
         if ( !isPonded ) Xnode[i].oldSurfArea = surfArea;
 
+        // --- use head change found by the Newton solver instead
+        if ( SolverMethod == NEWTON && !Xnode[i].fixedHead )
+            yNew = yLast + Dhead[i];
+
         // --- apply under-relaxation to new depth estimate
-        if ( Steps > 0 )
+        else if ( Steps > 0 )
         {
             yNew = (1.0 - Omega) * yLast + Omega * yNew;
         }
@@ -732,6 +907,7 @@ void setNodeDepth(int i, double dt)
         // --- compute new estimate of node depth
         if ( denom == 0.0 ) dy = 0.0;
         else dy = corr * dQ / denom;
+        if ( SolverMethod == NEWTON && !Xnode[i].fixedHead ) dy = Dhead[i];
         yNew = yLast + dy;
         if ( yNew < yCrown ) yNew = yCrown - FUDGE;
 
@@ -763,6 +939,269 @@ void setNodeDepth(int i, double dt)
 
 //=============================================================================
 
+int isSurchargedNode(int i, int isPonded)
+//
+//  Input:   i = node index
+//           isPonded = TRUE if water is currently ponded at the node
+//  Output:  returns TRUE if node is surcharged under the EXTRAN method
+//  Purpose: determines if a node is surcharged at its current depth.
+//
+{
+    double yCrown = Node[i].crownElev - Node[i].invertElev;
+    double yLast = Node[i].newDepth;
+
+    if ( SurchargeMethod != EXTRAN ) return FALSE;
+
+    // --- ponded nodes don't surcharge
+    if ( isPonded ) return FALSE;
+
+    // --- closed storage units that are full are in surcharge
+    if ( Node[i].type == STORAGE )
+        return (Node[i].surDepth > 0.0 && yLast > Node[i].fullDepth);
+
+    // --- surcharge occurs when node depth exceeds top of its highest link
+    return (yCrown > 0.0 && yLast > yCrown);
+}
+
+//=============================================================================
+
+int findNodeLinks()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: lists the links whose dqdh couples the heads of their end
+//           nodes in the Jacobian of the Newton solver, by node.
+//
+//  A Type 4 pump's flow depends only on its inlet node's depth, so it
+//  adds its dqdh to that node's diagonal only (as in the Picard method)
+//  and is not listed.
+//
+{
+    int i, j, k;
+    int* count;
+
+    NodeLinkStart = (int *) calloc(Nobjects[NODE] + 1, sizeof(int));
+    NodeLinks = (int *) calloc(2 * Nobjects[LINK] + 1, sizeof(int));
+    if ( NodeLinkStart == NULL || NodeLinks == NULL ) return FALSE;
+
+    // --- count each node's links
+    for ( j = 0; j < Nobjects[LINK]; j++ )
+    {
+        if ( Link[j].type == PUMP &&
+             Pump[Link[j].subIndex].type == TYPE4_PUMP ) continue;
+        if ( Link[j].node1 == Link[j].node2 ) continue;
+        NodeLinkStart[Link[j].node1 + 1]++;
+        NodeLinkStart[Link[j].node2 + 1]++;
+    }
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+        NodeLinkStart[i + 1] += NodeLinkStart[i];
+
+    // --- list them, using the end of each node's list as a counter
+    count = (int *) calloc(Nobjects[NODE] + 1, sizeof(int));
+    if ( count == NULL ) return FALSE;
+    for ( j = 0; j < Nobjects[LINK]; j++ )
+    {
+        if ( Link[j].type == PUMP &&
+             Pump[Link[j].subIndex].type == TYPE4_PUMP ) continue;
+        if ( Link[j].node1 == Link[j].node2 ) continue;
+        k = Link[j].node1;
+        NodeLinks[NodeLinkStart[k] + count[k]++] = j;
+        k = Link[j].node2;
+        NodeLinks[NodeLinkStart[k] + count[k]++] = j;
+    }
+    FREE(count);
+    return TRUE;
+}
+
+//=============================================================================
+
+void findNewtonSteps(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  none
+//  Purpose: finds the change in head at each node that satisfies the
+//           linearized continuity equations of all nodes at once.
+//
+//  This is a hybrid scheme: only the node heads get a Newton update. Link
+//  flows are still found from their own equations on each iteration, and
+//  outfalls and nodes that are flooded keep their Picard updates.
+//  Each node's continuity residual depends on the heads at both ends of
+//  its connecting links through their dqdh values. Rows for nodes that
+//  are not surcharged are scaled by 2 so that the resulting Jacobian is
+//  symmetric and diagonally dominant and can be solved by the conjugate
+//  gradient method. Must be called by all threads of a parallel region.
+//
+{
+    int    i;
+    int    canPond;                    // TRUE if node can pond overflows
+    int    isPonded;                   // TRUE if node is currently ponded
+    double yCrown;                     // depth to node crown (ft)
+    double yLast;                      // previous node depth (ft)
+    double yMax;                       // max. non-flooded depth (ft)
+    double dQ;                         // inflow minus outflow at node (cfs)
+    double a;                          // storage term (ft2/sec)
+    double f;                          // relative surcharge depth
+
+    #pragma omp for
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+    {
+        Dhead[i] = 0.0;
+        Jdiag[i] = 1.0;
+        Jresid[i] = 0.0;
+
+        // --- head at outfall nodes is fixed
+        Xnode[i].fixedHead = TRUE;
+        if ( Node[i].type == OUTFALL ) continue;
+
+        canPond = (AllowPonding && Node[i].pondedArea > 0.0);
+        isPonded = (canPond && Node[i].newDepth > Node[i].fullDepth);
+        yLast = Node[i].newDepth;
+        dQ = Node[i].inflow - Node[i].outflow;
+
+        // --- so is head at a flooded node that would keep rising
+        //     (its excess inflow becomes overflow as in the Picard method)
+        yMax = Node[i].fullDepth;
+        if ( canPond == FALSE ) yMax += Node[i].surDepth;
+        if ( canPond == FALSE && yLast >= yMax && dQ > 0.0 ) continue;
+
+        // --- a surcharged node must have zero net inflow, with storage
+        //     from its last non-surcharged state fading out above crown
+        if ( isSurchargedNode(i, isPonded) )
+        {
+            yCrown = Node[i].crownElev - Node[i].invertElev;
+            a = 0.0;
+            if ( yLast < 1.25 * yCrown )
+            {
+                f = (yLast - yCrown) / yCrown;
+                a = Xnode[i].oldSurfArea / dt * exp(-15.0 * f);
+            }
+            Jdiag[i] = Xnode[i].sumdqdh + a;
+            Jresid[i] = dQ;
+        }
+
+        // --- otherwise change in storage balances the avg. net inflow
+        else
+        {
+            a = 2.0 * MAX(Xnode[i].newSurfArea, MinSurfArea) / dt;
+            Jdiag[i] = Xnode[i].sumdqdh + a;
+            Jresid[i] = Node[i].oldNetInflow + dQ -
+                        a * (yLast - Node[i].oldDepth);
+        }
+
+        // --- a node with no storage or flow sensitivity keeps its head
+        if ( Jdiag[i] <= 0.0 )
+        {
+            Jdiag[i] = 1.0;
+            Jresid[i] = 0.0;
+        }
+        else Xnode[i].fixedHead = FALSE;
+    }
+    solveJacobian(Jresid, Dhead);
+}
+
+//=============================================================================
+
+void multJacobian(double* x, double* y)
+//
+//  Input:   x = vector of node head changes (ft)
+//  Output:  y = product of head Jacobian with x (cfs)
+//  Purpose: multiplies a vector by the Jacobian of the node continuity
+//           equations (each thread computes its share of the rows).
+//
+{
+    int    i, j, k, m;
+
+    #pragma omp for
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+    {
+        y[i] = Jdiag[i] * x[i];
+        if ( Xnode[i].fixedHead ) continue;
+        for ( k = NodeLinkStart[i]; k < NodeLinkStart[i + 1]; k++ )
+        {
+            j = NodeLinks[k];
+            m = Link[j].node1;
+            if ( m == i ) m = Link[j].node2;
+            if ( Xnode[m].fixedHead ) continue;
+            y[i] -= Link[j].dqdh * x[m];
+        }
+    }
+}
+
+//=============================================================================
+
+void solveJacobian(double* b, double* x)
+//
+//  Input:   b = vector of node continuity residuals (cfs)
+//  Output:  x = vector of node head changes (ft)
+//  Purpose: solves the Jacobian system of the node continuity equations
+//           by the diagonally preconditioned conjugate gradient method.
+//
+//  All threads of the team run the iterations together: vector updates
+//  are shared out among them and the dot products are summed by
+//  reduction into shared variables. Each shared sum is reset only after
+//  a barrier that every thread passes once it has read the sum's old
+//  value, so all threads see the same sums and take the same branches.
+//
+{
+    int    i, k;
+    int    n = Nobjects[NODE];
+    double *r = Work,                  // residual vector
+           *p = Work + (n + 1),        // search direction
+           *q = Work + 2 * (n + 1);    // Jacobian times search direction
+    double rz, alpha, beta;
+
+    // --- start from a zero head change
+    #pragma omp single
+    {
+        CgRz = 0.0;
+        CgBnorm = 0.0;
+    }
+    #pragma omp for reduction(+:CgRz, CgBnorm)
+    for ( i = 0; i < n; i++ )
+    {
+        x[i] = 0.0;
+        r[i] = b[i];
+        p[i] = r[i] / Jdiag[i];
+        CgRz += r[i] * p[i];
+        CgBnorm += b[i] * b[i];
+    }
+    if ( CgBnorm == 0.0 ) return;
+
+    for ( k = 0; k < n; k++ )
+    {
+        // --- update solution along current search direction
+        multJacobian(p, q);
+        #pragma omp single
+        CgPq = 0.0;
+        #pragma omp for reduction(+:CgPq)
+        for ( i = 0; i < n; i++ ) CgPq += p[i] * q[i];
+        if ( CgPq <= 0.0 ) break;
+        rz = CgRz;
+        alpha = rz / CgPq;
+        #pragma omp single
+        CgRnorm = 0.0;
+        #pragma omp for reduction(+:CgRnorm)
+        for ( i = 0; i < n; i++ )
+        {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+            CgRnorm += r[i] * r[i];
+        }
+        if ( CgRnorm <= NEWTON_TOL * NEWTON_TOL * CgBnorm ) break;
+
+        // --- find next search direction
+        #pragma omp single
+        CgRz = 0.0;
+        #pragma omp for reduction(+:CgRz)
+        for ( i = 0; i < n; i++ ) CgRz += r[i] * r[i] / Jdiag[i];
+        beta = CgRz / rz;
+        #pragma omp for
+        for ( i = 0; i < n; i++ ) p[i] = r[i] / Jdiag[i] + beta * p[i];
+    }
+}
+
+//=============================================================================
+
 double getFloodedDepth(int i, int canPond, double dV, double yNew,
                        double yMax, double dt)
 //
@@ -811,8 +1250,13 @@ double getVariableStep(double maxStep)
     double tMinNode;                    // allowable time step for nodes (sec)
 
     // --- find stable time step for links & then nodes
+    //     (with multirate routing, links whose Courant step is shorter
+    //     than the network's time step take sub-steps)
     tMin = maxStep;
-    tMinLink = getLinkStep(tMin, &minLink);
+    if ( RateLevels > 0 )
+        tMinLink = getLinkStep(tMin / (1 << RateLevels), &minLink) *
+                   (1 << RateLevels);
+    else tMinLink = getLinkStep(tMin, &minLink);
     tMinNode = getNodeStep(tMinLink, &minNode);
 
     // --- use smaller of the link and node time step
@@ -842,42 +1286,110 @@ double getLinkStep(double tMin, int *minLink)
 //
 {
     int    i;                           // link index
-    int    k;                           // conduit index
-    double q;                           // conduit flow (cfs)
+    int    iMin;                        // critical link of a thread
     double t;                           // time step (sec)
+    double tThread;                     // critical time step of a thread
     double tLink = tMin;                // critical link time step (sec)
 
     // --- examine each conduit link
+#pragma omp parallel num_threads(NumThreads) private(t, tThread, iMin)
+{
+    tThread = tMin;
+    iMin = -1;
+    #pragma omp for nowait
     for ( i = 0; i < Nobjects[LINK]; i++ )
     {
         if ( Link[i].type == CONDUIT )
         {
-            // --- skip conduits with negligible flow, area or Fr
-            k = Link[i].subIndex;
-            q = fabs(Link[i].newFlow) / Conduit[k].barrels;
-            if ( q <= FUDGE 
-            ||   Conduit[k].a1 <= FUDGE
-            ||   Link[i].froude <= 0.01 
-               ) continue;
-
-            // --- compute time step to satisfy Courant condition
-            t = Link[i].newVolume / Conduit[k].barrels / q;
-            t = t * Conduit[k].modLength / link_getLength(i);
-            t = t * Link[i].froude / (1.0 + Link[i].froude) * CourantFactor;
-
-            // --- update critical link time step
-            if ( t < tLink )
+            // --- update thread's critical link time step
+            t = getConduitStep(i);
+            if ( t >= 0.0 && t < tThread )
             {
-                tLink = t;
-                *minLink = i;
+                tThread = t;
+                iMin = i;
             }
         }
     }
+
+    // --- combine thread results (ties go to the lower link index,
+    //     as in a serial scan)
+    #pragma omp critical(linkstep)
+    {
+        if ( iMin >= 0 && ( tThread < tLink ||
+             (tThread == tLink && iMin < *minLink) ) )
+        {
+            tLink = tThread;
+            *minLink = iMin;
+        }
+    }
+}
     return tLink;
 }
 
 //=============================================================================
 
+double getConduitStep(int i)
+//
+//  Input:   i = conduit link index
+//  Output:  returns critical time step (sec) or -1 if conduit does not
+//           limit the time step
+//  Purpose: finds critical time step for a conduit based on Courant
+//           criterion.
+//
+{
+    int    k = Link[i].subIndex;        // conduit index
+    double q;                           // conduit flow (cfs)
+    double t;                           // time step (sec)
+
+    // --- skip conduits with negligible flow, area or Fr
+    q = fabs(Link[i].newFlow) / Conduit[k].barrels;
+    if ( q <= FUDGE 
+    ||   Conduit[k].a1 <= FUDGE
+    ||   Link[i].froude <= 0.01 
+       ) return -1.0;
+
+    // --- compute time step to satisfy Courant condition
+    t = Link[i].newVolume / Conduit[k].barrels / q;
+    t = t * Conduit[k].modLength / link_getLength(i);
+    t = t * Link[i].froude / (1.0 + Link[i].froude) * CourantFactor;
+    return t;
+}
+
+//=============================================================================
+
+void setRateLevels(double tStep)
+//
+//  Input:   tStep = time step (sec)
+//  Output:  none
+//  Purpose: assigns each conduit the number of times the time step must
+//           be halved to satisfy its Courant criterion.
+//
+//  A conduit at level m takes 2^m sub-steps per time step. This is
+//  link-only sub-stepping: nodes are not split into rate classes, so node
+//  depths and the flows that enter the node continuity balance are still
+//  found once per time step. Both ends of a conduit see the same flow and
+//  the network's mass balance is not affected.
+//
+{
+    int    i;
+    char   m;
+    double t;
+
+    #pragma omp for
+    for ( i = 0; i < Nobjects[LINK]; i++ )
+    {
+        RateLevel[i] = 0;
+        if ( !isTrueConduit(i) ) continue;
+        t = getConduitStep(i);
+        if ( t < 0.0 || CourantFactor == 0.0 ) continue;
+        m = 0;
+        while ( m < RateLevels && t * (1 << m) < tStep ) m++;
+        RateLevel[i] = m;
+    }
+}
+
+//=============================================================================
+
 double getNodeStep(double tMin, int *minNode)
 //
 //  Input:   tMin = critical time step found so far (sec)
@@ -888,13 +1400,21 @@ double getNodeStep(double tMin, int *minNode)
 //
 {
     int    i;                           // node index
+    int    iMin;                        // critical node of a thread
     double maxDepth;                    // max. depth allowed at node (ft)
     double dYdT;                        // change in depth per unit time (ft/sec)
     double t1;                          // time needed to reach depth limit (sec)
+    double tThread;                     // critical time step of a thread
     double tNode = tMin;                // critical node time step (sec)
 
     // --- find smallest time so that estimated change in nodal depth
     //     does not exceed safety factor * maxdepth
+#pragma omp parallel num_threads(NumThreads) \
+    private(maxDepth, dYdT, t1, tThread, iMin)
+{
+    tThread = tMin;
+    iMin = -1;
+    #pragma omp for nowait
     for ( i = 0; i < Nobjects[NODE]; i++ )
     {
         // --- see if node can be skipped
@@ -911,11 +1431,23 @@ double getNodeStep(double tMin, int *minNode)
 
         // --- compute time to reach max. depth & compare with critical time
         t1 = maxDepth / dYdT;
-        if ( t1 < tNode )
+        if ( t1 < tThread )
         {
-            tNode = t1;
-            *minNode = i;
+            tThread = t1;
+            iMin = i;
         }
     }
+
+    // --- combine thread results (ties go to the lower node index)
+    #pragma omp critical(nodestep)
+    {
+        if ( iMin >= 0 && ( tThread < tNode ||
+             (tThread == tNode && iMin < *minNode) ) )
+        {
+            tNode = tThread;
+            *minNode = iMin;
+        }
+    }
+}
     return tNode;
 }
@@ -382,6 +382,10 @@ enum  CompatibilityType {
       EXTRAN,                          // original EXTRAN method
       SLOT};                           // Preissmann slot method
 
+ enum  SolverMethodType {
+      PICARD,                          // successive approximation
+      NEWTON};                         // hybrid: Newton update of node heads
+
  enum InflowType {
       EXTERNAL_INFLOW,                 // user-supplied external inflow
       DRY_WEATHER_INFLOW,              // user-supplied dry weather inflow
@@ -486,7 +490,7 @@ enum  CompatibilityType {
       s_SYMBOL,       s_BACKDROP,     s_TAG,          s_PROFILE,
       s_MAP,          s_LID_CONTROL,  s_LID_USAGE,    s_GWF,
       s_ADJUST,       s_EVENT,        s_STREET,       s_INLET_USAGE,
-      s_INLET};
+      s_INLET,        s_HEAT_SENS};
 
  enum InputOptionType {
     FLOW_UNITS, INFIL_MODEL, ROUTE_MODEL,
@@ -505,6 +509,8 @@ enum  CompatibilityType {
 	/* END modification by Alejandro Figueroa | EAWAG */
     SYS_FLOW_TOL, LAT_FLOW_TOL, IGNORE_RDII,
     MIN_ROUTE_STEP, NUM_THREADS, SURCHARGE_METHOD,
+    XSECT_TABLES, SOLVER_METHOD, RATE_LEVELS,
+    FRIC_TOL, INPUT_CACHE,
 	/* START modification by Peter Schlagbauer | TUGraz; Revised by Alejandro Figueroa | EAWAG */
 	TEMP_MODEL,		 DENSITY,			 SPEC_HEAT_CAPACITY,
 	HUMIDITY, EXT_UNIT, GLOBTPAT, ASCII_OUT, 
@@ -26,6 +26,7 @@
 #include "error.h"
 
 char  ErrString[256];
+#pragma omp threadprivate(ErrString)
 
 char* error_getMsg(int errCode, char* msg)
 {
@@ -125,6 +125,7 @@ enum  ErrorType {
       ERR_RAIN_FILE_FORMAT     = 319,
       ERR_RAIN_IFACE_FORMAT    = 320,
       ERR_RAIN_FILE_GAGE       = 321,
+      ERR_RAIN_FILE_NONE       = 322,
 
 // ... Runoff File Errors
       ERR_RUNOFF_FILE_OPEN     = 323,
@@ -174,6 +175,7 @@ enum  ErrorType {
 
 // ... SWMM-HEAT
       ERR_MISSING_WTEMPERATURE = 700,
+      ERR_HEAT_SENS_LINK       = 701,
       
 // ... Additional Errors
       MAXERRMSG = 1000
@@ -78,7 +78,7 @@ void  exfil_initState(int k)
 //  Purpose: initializes the state of a storage unit's exfiltration object.
 //
 {
-    int i;
+    int i, m;
     double a, alast, d;
     TTable* aCurve;
     TExfil* exfil = Storage[k].exfil;
@@ -106,10 +106,13 @@ void  exfil_initState(int k)
                 Storage[k].exfil->btmArea = table_lookupEx(aCurve, 0.0);
 
                 // --- find min/max bank depths and max. bank area
-                table_getFirstEntry(aCurve, &d, &a);
-                alast = a;
-                while ( table_getNextEntry(aCurve, &d, &a) )
+                //     (entries are read directly since storage units
+                //     sharing a curve are initialized in parallel)
+                alast = aCurve->nEntries > 0 ? aCurve->entries[0].y : 0.0;
+                for (m = 1; m < aCurve->nEntries; m++)
                 {
+                    d = aCurve->entries[m].x;
+                    a = aCurve->entries[m].y;
                     if ( a < alast ) break;
                     else if ( a > alast )
                     {
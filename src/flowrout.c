@@ -44,6 +44,16 @@ static const double OMEGA   = 0.55;    // under-relaxation parameter
 static const int    MAXITER = 10;      // max. iterations for storage updating
 static const double STOPTOL = 0.005;   // storage updating stopping tolerance
 
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static int  NumLevels;        // number of wavefronts in Steady/KW routing
+static int* LevelStart;       // start of each wavefront in NodeOrder
+static int* NodeOrder;        // node indexes listed by wavefront
+static int* OutletPos;        // position of node's first outlet in links array
+static int* InletStart;       // start of node's inlet links in InletLinks
+static int* InletLinks;       // inlet links of each node in topo-sorted order
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -69,13 +79,18 @@ static void   setNewLinkState(int link);
 static void   updateNodeDepth(int node, double y);
 static int    steadyflow_execute(int link, double* qin, double* qout,
               double tStep);
+static void   createWavefronts(int links[]);
+static void   freeWavefronts(void);
+static int    routeNodeOutlets(int node, int links[], int routingModel,
+              double tStep);
 
 
 //=============================================================================
 
-void flowrout_init(int routingModel)
+void flowrout_init(int links[], int routingModel)
 //
-//  Input:   routingModel = routing model code
+//  Input:   links = array of link indexes in topo-sorted order
+//           routingModel = routing model code
 //  Output:  none
 //  Purpose: initializes flow routing system.
 //
@@ -96,7 +111,12 @@ void flowrout_init(int routingModel)
     }
 
     // --- validate network layout for kinematic wave routing
-    else validateTreeLayout();
+    //     and group its nodes into wavefronts
+    else
+    {
+        validateTreeLayout();
+        createWavefronts(links);
+    }
 
     // --- initialize node & link volumes
     initNodes();
@@ -113,6 +133,7 @@ void  flowrout_close(int routingModel)
 //
 {
     if ( routingModel == DW ) dynwave_close();
+    else freeWavefronts();
 }
 
 //=============================================================================
@@ -143,10 +164,7 @@ int flowrout_execute(int links[], int routingModel, double tStep)
 //  Purpose: routes flow through conveyance network over current time step.
 //
 {
-    int   i, j;
-    int   n1;                          // upstream node of link
-    double qin;                        // link inflow (cfs)
-    double qout;                       // link outflow (cfs)
+    int   i, j, k;
     double steps;                      // computational step count
 
     // --- set overflows to drain any ponded water
@@ -168,17 +186,68 @@ int flowrout_execute(int links[], int routingModel, double tStep)
         return dynwave_execute(tStep);
     }
 
-    // --- otherwise examine each link, moving from upstream to downstream
+    // --- otherwise route flow out of each wavefront of nodes in turn,
+    //     moving from upstream to downstream (the nodes of a wavefront
+    //     only receive flow from earlier wavefronts so they can be
+    //     routed in parallel)
     steps = 0.0;
-    for (i = 0; i < Nobjects[LINK]; i++)
+#pragma omp parallel num_threads(NumThreads) private(i, k) \
+    reduction(+:steps)
+{
+    for (k = 0; k < NumLevels; k++)
     {
-        // --- see if upstream node is a storage unit whose state needs updating
-        j = links[i];
-        n1 = Link[j].node1;
-        if ( Node[n1].type == STORAGE ) updateStorageState(n1, i, links, tStep);
+        #pragma omp for
+        for (i = LevelStart[k]; i < LevelStart[k+1]; i++)
+        {
+            steps += routeNodeOutlets(NodeOrder[i], links, routingModel,
+                                      tStep);
+        }
+    }
+}
+    if ( Nobjects[LINK] > 0 ) steps /= Nobjects[LINK];
 
+    // --- update state of each non-updated node and link
+    for ( j=0; j<Nobjects[NODE]; j++) setNewNodeState(j, tStep);
+    for ( j=0; j<Nobjects[LINK]; j++) setNewLinkState(j);
+    return (int)(steps+0.5);
+}
+
+//=============================================================================
+
+int routeNodeOutlets(int i, int links[], int routingModel, double tStep)
+//
+//  Input:   i = node index
+//           links = array of link indexes in topo-sorted order
+//           routingModel = type of routing method used
+//           tStep = routing time step (sec)
+//  Output:  returns number of computational steps taken
+//  Purpose: collects the flow entering a node and routes it through each of
+//           the node's outlet links under Steady or Kin. Wave routing.
+//
+{
+    int    j, k;
+    int    steps = 0;
+    double qin;                        // link inflow (cfs)
+    double qout;                       // link outflow (cfs)
+
+    // --- add outflow from each inlet link to node's inflow
+    //     (in topo-sorted order so that results don't depend on threads)
+    for (k = InletStart[i]; k < InletStart[i+1]; k++)
+    {
+        Node[i].inflow += Link[InletLinks[k]].newFlow;
+    }
+
+    // --- see if node is a storage unit whose state needs updating
+    k = OutletPos[i];
+    if ( k < 0 ) return 0;
+    if ( Node[i].type == STORAGE ) updateStorageState(i, k, links, tStep);
+
+    // --- examine each outlet link (these are contiguous in links array)
+    for ( ; k < Nobjects[LINK] && Link[links[k]].node1 == i; k++)
+    {
         // --- retrieve inflow at upstream end of link
-        qin  = getLinkInflow(j, tStep);
+        j = links[k];
+        qin = getLinkInflow(j, tStep);
 
         // --- route flow through link
         if ( routingModel == SF )
@@ -187,16 +256,108 @@ int flowrout_execute(int links[], int routingModel, double tStep)
             steps += kinwave_execute(j, &qin, &qout, tStep);
         Link[j].newFlow = qout;
 
-        // adjust outflow at upstream node and inflow at downstream node
-        Node[ Link[j].node1 ].outflow += qin;
-        Node[ Link[j].node2 ].inflow += qout;
+        // --- adjust outflow at upstream node
+        Node[i].outflow += qin;
     }
-    if ( Nobjects[LINK] > 0 ) steps /= Nobjects[LINK];
+    return steps;
+}
 
-    // --- update state of each non-updated node and link
-    for ( j=0; j<Nobjects[NODE]; j++) setNewNodeState(j, tStep);
-    for ( j=0; j<Nobjects[LINK]; j++) setNewLinkState(j);
-    return (int)(steps+0.5);
+//=============================================================================
+
+void createWavefronts(int links[])
+//
+//  Input:   links = array of link indexes in topo-sorted order
+//  Output:  none
+//  Purpose: groups nodes into wavefronts for Steady or Kin. Wave routing.
+//
+//  A node's wavefront is its level in the sorted network (one more than
+//  the highest wavefront of the nodes that send flow to it), so all of a
+//  node's inlet links leave nodes from earlier wavefronts.
+//
+{
+    int  i, j, k, n1, n2;
+    int  nNodes = Nobjects[NODE];
+    int  nLinks = Nobjects[LINK];
+    int* level;
+
+    NumLevels = 0;
+    LevelStart = NULL;
+    NodeOrder = NULL;
+    OutletPos = NULL;
+    InletStart = NULL;
+    InletLinks = NULL;
+    if ( nLinks == 0 ) return;
+    NodeOrder = (int *) calloc(nNodes, sizeof(int));
+    OutletPos = (int *) calloc(nNodes, sizeof(int));
+    InletStart = (int *) calloc(nNodes+1, sizeof(int));
+    InletLinks = (int *) calloc(nLinks, sizeof(int));
+    level = (int *) calloc(nNodes, sizeof(int));
+    if ( !NodeOrder || !OutletPos || !InletStart || !InletLinks || !level )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        FREE(level);
+        return;
+    }
+
+    // --- find each node's wavefront, first outlet position, and number
+    //     of inlet links
+    NumLevels = toposort_getLevels(links, level);
+    for (i = 0; i < nNodes; i++) OutletPos[i] = -1;
+    for (k = 0; k < nLinks; k++)
+    {
+        j = links[k];
+        n1 = Link[j].node1;
+        n2 = Link[j].node2;
+        if ( OutletPos[n1] < 0 ) OutletPos[n1] = k;
+        InletStart[n2+1]++;
+    }
+
+    // --- list the inlet links of each node in topo-sorted order
+    for (i = 0; i < nNodes; i++) InletStart[i+1] += InletStart[i];
+    for (k = 0; k < nLinks; k++)
+    {
+        n2 = Link[links[k]].node2;
+        InletLinks[InletStart[n2]] = links[k];
+        InletStart[n2]++;
+    }
+    for (i = nNodes; i > 0; i--) InletStart[i] = InletStart[i-1];
+    InletStart[0] = 0;
+
+    // --- list the nodes of each wavefront
+    LevelStart = (int *) calloc(NumLevels+1, sizeof(int));
+    if ( !LevelStart )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        FREE(level);
+        return;
+    }
+    for (i = 0; i < nNodes; i++) LevelStart[level[i]+1]++;
+    for (k = 0; k < NumLevels; k++) LevelStart[k+1] += LevelStart[k];
+    for (i = 0; i < nNodes; i++)
+    {
+        NodeOrder[LevelStart[level[i]]] = i;
+        LevelStart[level[i]]++;
+    }
+    for (k = NumLevels; k > 0; k--) LevelStart[k] = LevelStart[k-1];
+    LevelStart[0] = 0;
+    FREE(level);
+}
+
+//=============================================================================
+
+void freeWavefronts()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees memory used for Steady or Kin. Wave routing wavefronts.
+//
+{
+    FREE(LevelStart);
+    FREE(NodeOrder);
+    FREE(OutletPos);
+    FREE(InletStart);
+    FREE(InletLinks);
+    NumLevels = 0;
 }
 
 //=============================================================================
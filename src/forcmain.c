@@ -97,17 +97,37 @@ double forcemain_getFricSlope(int j, double v, double hrad)
 //  Note:    the pipe's roughness factor was saved in xsect.sBot in
 //           conduit_validate() in LINK.C.
 //
+//  If the FRICTION_TOLERANCE option is set, the Darcy-Weisbach friction
+//  factor is saved with the Reynolds number and hydraulic radius it was
+//  found for, and is re-used while both stay within FricTol of those
+//  values. Results then depend on the values the factor was last found
+//  for, so this is off by default.
+//
 {
+    int    k;
     double re, f;
-    TXsect xsect = Link[j].xsect;
+    TXsect* xsect = &Link[j].xsect;
     switch ( ForceMainEqn )
     {
       case H_W:
-        return xsect.sBot * pow(v, 0.852) / pow(hrad, 1.1667);
+        return xsect->sBot * pow(v, 0.852) / pow(hrad, 1.1667);
       case D_W:
+        k = Link[j].subIndex;
         re = forcemain_getReynolds(v, hrad);
-        f = forcemain_getFricFactor(xsect.rBot, hrad, re);
-        return f * xsect.sBot * v / hrad;
+        if ( FricTol > 0.0 && Conduit[k].fricFactor > 0.0 &&
+             fabs(re - Conduit[k].fricRe) <= FricTol * re &&
+             fabs(hrad - Conduit[k].fricHrad) <= FricTol * hrad )
+        {
+            f = Conduit[k].fricFactor;
+        }
+        else
+        {
+            f = forcemain_getFricFactor(xsect->rBot, hrad, re);
+            Conduit[k].fricRe = re;
+            Conduit[k].fricHrad = hrad;
+            Conduit[k].fricFactor = f;
+        }
+        return f * xsect->sBot * v / hrad;
     }
     return 0.0;
 }
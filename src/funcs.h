@@ -60,6 +60,10 @@ void     project_freeMatrix(double** m);
 int     input_countObjects(void);
 int     input_readData(void);
 
+int     inpcache_load(char* text, size_t size);
+void    inpcache_save(void);
+void    inpcache_close(void);
+
 //-----------------------------------------------------------------------------
 //   Report Writer Methods
 //-----------------------------------------------------------------------------
@@ -100,6 +104,10 @@ void    report_writeErrorCode(void);
 void    report_writeInputErrorMsg(int k, int sect, char* line, long lineCount);
 void    report_writeWarningMsg(char* msg, char* id); 
 void    report_writeTseriesErrorMsg(int code, TTable *tseries);
+void    report_deferMsgs(void);
+void    report_setMsgObject(int j);
+int     report_getErrorCode(void);
+void    report_writeDeferredMsgs(void);
 
 void    inputrpt_writeInput(void);
 void    statsrpt_writeReport(void);
@@ -121,6 +129,9 @@ DateTime climate_getNextEvapDate(void);
 //-----------------------------------------------------------------------------
 void    rain_open(void);
 void    rain_close(void);
+void    rain_convert(char* fname);
+long    rain_findPeriod(int gage, DateTime aDate);
+int     rain_getPeriod(int gage, DateTime* aDate, float* depth);
 
 //-----------------------------------------------------------------------------
 //   Snowmelt Processing Methods
@@ -196,7 +207,6 @@ double  gwater_getVolume(int subcatch);
 //   RDII Methods
 //-----------------------------------------------------------------------------
 int     rdii_readRdiiInflow(char* tok[], int ntoks);
-void    rdii_deleteRdiiInflow(int node);
 void    rdii_initUnitHyd(int unitHyd);
 int     rdii_readUnitHydParams(char* tok[], int ntoks);
 void    rdii_openRdii(void);
@@ -228,12 +238,14 @@ double  landuse_getCoPollutLoad(int p, double washoff[]);
 //-----------------------------------------------------------------------------
 //   Flow/Quality Routing Methods
 //-----------------------------------------------------------------------------
-void    flowrout_init(int routingModel);
+void    flowrout_init(int links[], int routingModel);
 void    flowrout_close(int routingModel);
 double  flowrout_getRoutingStep(int routingModel, double fixedStep);
 int     flowrout_execute(int links[], int routingModel, double tStep);
 
 void    toposort_sortLinks(int links[]);
+int     toposort_sortLinksByLocality(int links[]);
+int     toposort_getLevels(int links[], int level[]);
 int     kinwave_execute(int link, double* qin, double* qout, double tStep);
 
 void    dynwave_validate(void);
@@ -242,6 +254,8 @@ void    dynwave_close(void);
 double  dynwave_getRoutingStep(double fixedStep);
 int     dynwave_execute(double tStep);
 void    dwflow_findConduitFlow(int j, int steps, double omega, double dt);
+void    dwflow_findConduitSubsteps(int j, int steps, double omega, double dt,
+        int n);
 
 void    qualrout_init(void);
 void    qualrout_execute(double tStep);
@@ -249,6 +263,10 @@ void    qualrout_execute(double tStep);
 void    temprout_execute(double tStep);
 void    temprout_init(void);
 /* END modification by Alejandro Figueroa | EAWAG */
+int     temprout_readSensParams(char* tok[], int ntoks);
+int     temprout_open(void);
+void    temprout_close(void);
+void    temprout_writeSensReport(void);
 
 //-----------------------------------------------------------------------------
 //   Treatment Methods
@@ -271,6 +289,11 @@ void    massbal_updateRunoffTotals(int type, double v);
 void    massbal_updateLoadingTotals(int type, int pollut, double w);
 void    massbal_updateGwaterTotals(double vInfil, double vUpperEvap,
         double vLowerEvap, double vLowerPerc, double vGwater);
+int     massbal_openLogs(int n);
+void    massbal_closeLogs(void);
+void    massbal_startLog(int i);
+void    massbal_stopLog(void);
+int     massbal_commitLogs(void);
 void    massbal_updateRoutingTotals(double tStep);
 
 
@@ -406,8 +429,6 @@ double  inflow_getExtInflow(TExtInflow* inflow, DateTime aDate);
 double  inflow_getDwfInflow(TDwfInflow* inflow, int m, int d, int h);
 double  getPatternFactor(int p, int month, int day, int hour);
 
-void    inflow_deleteExtInflows(int node);
-void    inflow_deleteDwfInflows(int node);
 
 //-----------------------------------------------------------------------------
 //   Routing Interface File Methods
@@ -438,6 +459,7 @@ int     link_readXsectParams(char* tok[], int ntoks);
 int     link_readLossParams(char* tok[], int ntoks);
 
 void    link_validate(int link);
+void    link_adjustEndNodes(int link);
 void    link_initState(int link);
 void    link_setOldHydState(int link);
 void    link_setOldQualState(int link);
@@ -471,6 +493,8 @@ void    xsect_setIrregXsectParams(TXsect *xsect);
 void    xsect_setCustomXsectParams(TXsect *xsect);
 void    xsect_setStreetXsectParams(TXsect *xsect);
 double  xsect_getAmax(TXsect* xsect);
+int     xsect_createTables(void);
+void    xsect_deleteTables(void);
 
 double  xsect_getSofA(TXsect* xsect, double area);
 double  xsect_getYofA(TXsect* xsect, double area);
@@ -481,6 +505,9 @@ double  xsect_getAofY(TXsect* xsect, double y);
 double  xsect_getRofY(TXsect* xsect, double y);
 double  xsect_getWofY(TXsect* xsect, double y);
 double  xsect_getYcrit(TXsect* xsect, double q);
+double  xsect_getCircAofY(TXsect* xsect, double y);
+double  xsect_getCircWofY(TXsect* xsect, double y);
+double  xsect_getCircRofY(TXsect* xsect, double y);
 /* START modification by Alejandro Figueroa | EAWAG */
 double getWidth(TXsect* xsect, double y);                 
 double getHydRad(TXsect* xsect, double y);
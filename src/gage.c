@@ -283,8 +283,9 @@ void  gage_initState(int j)
     // --- for gage with file data:
     if ( Gage[j].dataSource == RAIN_FILE )
     {
-        // --- set current file position to start of period of record
-        Gage[j].currentFilePos = Gage[j].startFilePos;
+        // --- set current file position to the last period of record
+        //     that ends by the start of the simulation
+        Gage[j].currentPeriod = rain_findPeriod(j, StartDateTime);
 
         // --- assign units conversion factor
         //     (rain depths on interface file are in inches)
@@ -585,14 +586,9 @@ int getFirstRainfall(int j)
     // --- use rain interface file if applicable
     if ( Gage[j].dataSource == RAIN_FILE )
     {
-        if ( Frain.file && Gage[j].endFilePos > Gage[j].startFilePos )
+        // --- retrieve 1st date & rainfall volume from file
+        if ( rain_getPeriod(j, &Gage[j].startDate, &vFirst) )
         {
-            // --- retrieve 1st date & rainfall volume from file
-            fseek(Frain.file, Gage[j].startFilePos, SEEK_SET);
-            fread(&Gage[j].startDate, sizeof(DateTime), 1, Frain.file);
-            fread(&vFirst, sizeof(float), 1, Frain.file);
-            Gage[j].currentFilePos = ftell(Frain.file);
-
             // --- convert rainfall to intensity
             Gage[j].rainfall = convertRainfall(j, (double)vFirst);
             return 1;
@@ -642,12 +638,8 @@ int getNextRainfall(int j)
     {
         if ( Gage[j].dataSource == RAIN_FILE )
         {
-            if ( Frain.file && Gage[j].currentFilePos < Gage[j].endFilePos )
+            if ( rain_getPeriod(j, &Gage[j].nextDate, &vNext) )
             {
-                fseek(Frain.file, Gage[j].currentFilePos, SEEK_SET);
-                fread(&Gage[j].nextDate, sizeof(DateTime), 1, Frain.file);
-                fread(&vNext, sizeof(float), 1, Frain.file);
-                Gage[j].currentFilePos = ftell(Frain.file);
                 rNext = convertRainfall(j, (double)vNext);
             }
             else return 0;
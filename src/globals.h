@@ -80,6 +80,7 @@ EXTERN int
                   ForceMainEqn,             // Flow equation for force mains
                   LinkOffsets,              // Link offset convention
                   SurchargeMethod,          // EXTRAN or SLOT method 
+                  SolverMethod,             // PICARD or NEWTON method
                   AllowPonding,             // Allow water to pond at nodes
                   InertDamping,             // Degree of inertial damping
                   NormalFlowLtd,            // Normal flow limited
@@ -88,6 +89,8 @@ EXTERN int
                   SkipSteadyState,          // Skip over steady state periods
                   IgnoreRainfall,           // Ignore rainfall/runoff
                   IgnoreRDII,               // Ignore RDII
+                  XsectTables,              // Use xsect geometry lookup tables
+                  InputCache,               // Cache tables read from input file
                   IgnoreSnowmelt,           // Ignore snowmelt
                   IgnoreGwater,             // Ignore groundwater
                   IgnoreRouting,            // Ignore flow routing
@@ -104,6 +107,7 @@ EXTERN int
                   SweepStart,               // Day of year when sweeping starts
                   SweepEnd,                 // Day of year when sweeping ends
                   MaxTrials,                // Max. trials for DW routing
+                  RateLevels,               // Max. levels of DW link sub-steps
                   NumThreads,               // Number of parallel threads used
                   NumEvents,                // Number of detailed events
                   /* START modification by Alejandro Figueroa | EAWAG */
@@ -126,6 +130,7 @@ EXTERN double
                   TempError,                // Temperature routing error
 				  /* END modification by Alejandro Figueroa | EAWAG */
                   HeadTol,                  // DW routing head tolerance (ft)
+                  FricTol,                  // Force main friction factor tol.
                   SysFlowTol,               // Tolerance for steady system flow
                   LatFlowTol,               // Tolerance for steady nodal inflow
                   CrownCutoff;              // Fractional pipe crown cutoff
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <math.h>
 #include "headers.h"
+#include "mempool.h"
 #include "odesolve.h"
 
 //-----------------------------------------------------------------------------
@@ -57,33 +58,44 @@ static char* GWVarWords[] = {"HGW", "HSW", "HCB", "HGS", "KS", "K",
                              "THETA", "PHI", "FI", "FU", "A", NULL};
 
 //-----------------------------------------------------------------------------
-//  Shared variables
+//  Data Structures
 //-----------------------------------------------------------------------------
 //  NOTE: all flux rates are in ft/sec, all depths are in ft.
-static double    Area;            // subcatchment area (ft2)
-static double    Infil;           // infiltration rate from surface
-static double    MaxEvap;         // max. evaporation rate
-static double    AvailEvap;       // available evaporation rate
-static double    UpperEvap;       // evaporation rate from upper GW zone
-static double    LowerEvap;       // evaporation rate from lower GW zone
-static double    UpperPerc;       // percolation rate from upper to lower zone
-static double    LowerLoss;       // loss rate from lower GW zone
-static double    GWFlow;          // flow rate from lower zone to conveyance node
-static double    MaxUpperPerc;    // upper limit on UpperPerc
-static double    MaxGWFlowPos;    // upper limit on GWFlow when its positve
-static double    MaxGWFlowNeg;    // upper limit on GWFlow when its negative
-static double    FracPerv;        // fraction of surface that is pervious
-static double    TotalDepth;      // total depth of GW aquifer
-static double    Theta;           // moisture content of upper zone
-static double    HydCon;          // unsaturated hydraulic conductivity (ft/s)
-static double    Hgw;             // ht. of saturated zone
-static double    Hstar;           // ht. from aquifer bottom to node invert
-static double    Hsw;             // ht. from aquifer bottom to water surface
-static double    Tstep;           // current time step (sec)
-static TAquifer  A;               // aquifer being analyzed
-static TGroundwater* GW;          // groundwater object being analyzed
-static MathExpr* LatFlowExpr;     // user-supplied lateral GW flow expression
-static MathExpr* DeepFlowExpr;    // user-supplied deep GW flow expression
+typedef struct
+{
+    double    area;               // subcatchment area (ft2)
+    double    infil;              // infiltration rate from surface
+    double    maxEvap;            // max. evaporation rate
+    double    availEvap;          // available evaporation rate
+    double    upperEvap;          // evaporation rate from upper GW zone
+    double    lowerEvap;          // evaporation rate from lower GW zone
+    double    upperPerc;          // percolation rate from upper to lower zone
+    double    lowerLoss;          // loss rate from lower GW zone
+    double    gwFlow;             // flow rate from lower zone to conveyance node
+    double    maxUpperPerc;       // upper limit on upperPerc
+    double    maxGWFlowPos;       // upper limit on gwFlow when its positve
+    double    maxGWFlowNeg;       // upper limit on gwFlow when its negative
+    double    fracPerv;           // fraction of surface that is pervious
+    double    totalDepth;         // total depth of GW aquifer
+    double    theta;              // moisture content of upper zone
+    double    hydCon;             // unsaturated hydraulic conductivity (ft/s)
+    double    hgw;                // ht. of saturated zone
+    double    hstar;              // ht. from aquifer bottom to node invert
+    double    hsw;                // ht. from aquifer bottom to water surface
+    double    tStep;              // current time step (sec)
+    TAquifer  aquifer;            // aquifer being analyzed
+    TGroundwater* gw;             // groundwater object being analyzed
+    MathExpr* latFlowExpr;        // user-supplied lateral GW flow expression
+    MathExpr* deepFlowExpr;       // user-supplied deep GW flow expression
+}  TGwState;
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+// GW state seen by getVariableValue() while a user-supplied flow
+// expression is evaluated (mathexpr_eval() only passes a variable index)
+static TGwState* ExprState;
+#pragma omp threadprivate(ExprState)
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
@@ -103,12 +115,12 @@ static MathExpr* DeepFlowExpr;    // user-supplied deep GW flow expression
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
-static void   getDxDt(double t, double* x, double* dxdt);
-static void   getFluxes(double upperVolume, double lowerDepth);
-static void   getEvapRates(double theta, double upperDepth);
-static double getUpperPerc(double theta, double upperDepth);
-static double getGWFlow(double lowerDepth);
-static void   updateMassBal(double area,  double tStep);
+static void   getDxDt(double t, double* x, double* dxdt, void* data);
+static void   getFluxes(TGwState* gs, double upperVolume, double lowerDepth);
+static void   getEvapRates(TGwState* gs, double theta, double upperDepth);
+static double getUpperPerc(TGwState* gs, double theta, double upperDepth);
+static double getGWFlow(TGwState* gs, double lowerDepth);
+static void   updateMassBal(TGwState* gs, double area,  double tStep);
 
 // Used to process custom GW outflow equations
 static int    getVariableIndex(char* s);
@@ -230,7 +242,7 @@ int gwater_readGroundwaterParams(char* tok[], int ntoks)
     // --- create a groundwater flow object
     if ( !Subcatch[j].groundwater )
     {
-        gw = (TGroundwater *) malloc(sizeof(TGroundwater));
+        gw = AllocArray(TGroundwater, 1);
         if ( !gw ) return error_setInpError(ERR_MEMORY, "");
         Subcatch[j].groundwater = gw;
     }
@@ -488,123 +500,128 @@ void gwater_getGroundwater(int j, double evap, double infil, double tStep)
     double x[2];                       // upper moisture content & lower depth 
     double vUpper;                     // upper vol. available for percolation
     double nodeFlow;                   // max. possible GW flow from node
+    TGwState state;                    // GW state for this subcatchment
+    TGwState* gs = &state;
 
     // --- save subcatchment's groundwater and aquifer objects to 
-    //     shared variables
-    GW = Subcatch[j].groundwater;
-    if ( GW == NULL ) return;
-    LatFlowExpr = Subcatch[j].gwLatFlowExpr;
-    DeepFlowExpr = Subcatch[j].gwDeepFlowExpr;
-    A = Aquifer[GW->aquifer];
+    //     the GW state
+    gs->gw = Subcatch[j].groundwater;
+    if ( gs->gw == NULL ) return;
+    gs->latFlowExpr = Subcatch[j].gwLatFlowExpr;
+    gs->deepFlowExpr = Subcatch[j].gwDeepFlowExpr;
+    gs->aquifer = Aquifer[gs->gw->aquifer];
 
     // --- get fraction of total area that is pervious
-    FracPerv = subcatch_getFracPerv(j);
-    if ( FracPerv <= 0.0 ) return;
-    Area = Subcatch[j].area;
+    gs->fracPerv = subcatch_getFracPerv(j);
+    if ( gs->fracPerv <= 0.0 ) return;
+    gs->area = Subcatch[j].area;
 
     // --- convert infiltration volume (ft3) to equivalent rate
     //     over entire GW (subcatchment) area
-    infil = infil / Area / tStep;
-    Infil = infil;
-    Tstep = tStep;
+    infil = infil / gs->area / tStep;
+    gs->infil = infil;
+    gs->tStep = tStep;
 
     // --- convert pervious surface evaporation already exerted (ft3)
     //     to equivalent rate over entire GW (subcatchment) area
-    evap = evap / Area / tStep;
+    evap = evap / gs->area / tStep;
 
     // --- convert max. surface evap rate (ft/sec) to a rate
     //     that applies to GW evap (GW evap can only occur
     //     through the pervious land surface area)
-    MaxEvap = Evap.rate * FracPerv;
+    gs->maxEvap = Evap.rate * gs->fracPerv;
 
     // --- available subsurface evaporation is difference between max.
     //     rate and pervious surface evap already exerted
-    AvailEvap = MAX((MaxEvap - evap), 0.0);
+    gs->availEvap = MAX((gs->maxEvap - evap), 0.0);
 
-    // --- save total depth & outlet node properties to shared variables
-    TotalDepth = GW->surfElev - GW->bottomElev;
-    if ( TotalDepth <= 0.0 ) return;
-    n = GW->node;
+    // --- save total depth & outlet node properties to the GW state
+    gs->totalDepth = gs->gw->surfElev - gs->gw->bottomElev;
+    if ( gs->totalDepth <= 0.0 ) return;
+    n = gs->gw->node;
 
     // --- establish min. water table height above aquifer bottom at which
     //     GW flow can occur (override node's invert if a value was provided
     //     in the GW object)
-    if ( GW->nodeElev != MISSING ) Hstar = GW->nodeElev - GW->bottomElev;
-    else Hstar = Node[n].invertElev - GW->bottomElev;
+    if ( gs->gw->nodeElev != MISSING )
+        gs->hstar = gs->gw->nodeElev - gs->gw->bottomElev;
+    else gs->hstar = Node[n].invertElev - gs->gw->bottomElev;
     
     // --- establish surface water height (relative to aquifer bottom)
     //     for drainage system node connected to the GW aquifer
-    if ( GW->fixedDepth > 0.0 )
+    if ( gs->gw->fixedDepth > 0.0 )
     {
-        Hsw = GW->fixedDepth + Node[n].invertElev - GW->bottomElev;
+        gs->hsw = gs->gw->fixedDepth + Node[n].invertElev - gs->gw->bottomElev;
     }
-    else Hsw = Node[n].newDepth + Node[n].invertElev - GW->bottomElev;
+    else gs->hsw = Node[n].newDepth + Node[n].invertElev - gs->gw->bottomElev;
 
     // --- store state variables (upper zone moisture content, lower zone
     //     depth) in work vector x
-    x[THETA] = GW->theta;
-    x[LOWERDEPTH] = GW->lowerDepth;
+    x[THETA] = gs->gw->theta;
+    x[LOWERDEPTH] = gs->gw->lowerDepth;
 
     // --- set limit on percolation rate from upper to lower GW zone
-    vUpper = (TotalDepth - x[LOWERDEPTH]) * (x[THETA] - A.fieldCapacity);
+    vUpper = (gs->totalDepth - x[LOWERDEPTH]) *
+             (x[THETA] - gs->aquifer.fieldCapacity);
     vUpper = MAX(0.0, vUpper); 
-    MaxUpperPerc = vUpper / tStep;
+    gs->maxUpperPerc = vUpper / tStep;
 
     // --- set limit on GW flow out of aquifer based on volume of lower zone
-    MaxGWFlowPos = x[LOWERDEPTH]*A.porosity / tStep;
+    gs->maxGWFlowPos = x[LOWERDEPTH]*gs->aquifer.porosity / tStep;
 
     // --- set limit on GW flow into aquifer from drainage system node
     //     based on min. of capacity of upper zone and drainage system
     //     inflow to the node
-    MaxGWFlowNeg = (TotalDepth - x[LOWERDEPTH]) * (A.porosity - x[THETA])
-                   / tStep;
-    nodeFlow = (Node[n].inflow + Node[n].newVolume/tStep) / Area;
-    MaxGWFlowNeg = -MIN(MaxGWFlowNeg, nodeFlow);
+    gs->maxGWFlowNeg = (gs->totalDepth - x[LOWERDEPTH]) *
+                       (gs->aquifer.porosity - x[THETA]) / tStep;
+    nodeFlow = (Node[n].inflow + Node[n].newVolume/tStep) / gs->area;
+    gs->maxGWFlowNeg = -MIN(gs->maxGWFlowNeg, nodeFlow);
     
     // --- integrate eqns. for d(Theta)/dt and d(LowerDepth)/dt
-    //     NOTE: ODE solver must have been initialized previously
-    odesolve_integrate(x, 2, 0, tStep, GWTOL, tStep, getDxDt);
+    odesolve_integrate(x, 2, 0, tStep, GWTOL, tStep, getDxDt, gs);
     
     // --- keep state variables within allowable bounds
-    x[THETA] = MAX(x[THETA], A.wiltingPoint);
-    if ( x[THETA] >= A.porosity )
+    x[THETA] = MAX(x[THETA], gs->aquifer.wiltingPoint);
+    if ( x[THETA] >= gs->aquifer.porosity )
     {
-        x[THETA] = A.porosity - XTOL;
-        x[LOWERDEPTH] = TotalDepth - XTOL;
+        x[THETA] = gs->aquifer.porosity - XTOL;
+        x[LOWERDEPTH] = gs->totalDepth - XTOL;
     }
     x[LOWERDEPTH] = MAX(x[LOWERDEPTH],  0.0);
-    if ( x[LOWERDEPTH] >= TotalDepth )
+    if ( x[LOWERDEPTH] >= gs->totalDepth )
     {
-        x[LOWERDEPTH] = TotalDepth - XTOL;
+        x[LOWERDEPTH] = gs->totalDepth - XTOL;
     }
 
     // --- save new values of state values
-    GW->theta = x[THETA];
-    GW->lowerDepth  = x[LOWERDEPTH];
-    getFluxes(GW->theta, GW->lowerDepth);
-    GW->oldFlow = GW->newFlow;
-    GW->newFlow = GWFlow;
-    GW->evapLoss = UpperEvap + LowerEvap;
+    gs->gw->theta = x[THETA];
+    gs->gw->lowerDepth  = x[LOWERDEPTH];
+    getFluxes(gs, gs->gw->theta, gs->gw->lowerDepth);
+    gs->gw->oldFlow = gs->gw->newFlow;
+    gs->gw->newFlow = gs->gwFlow;
+    gs->gw->evapLoss = gs->upperEvap + gs->lowerEvap;
 
     //--- find max. infiltration volume (as depth over
     //    the pervious portion of the subcatchment)
     //    that upper zone can support in next time step
-    GW->maxInfilVol = (TotalDepth - x[LOWERDEPTH]) *
-                      (A.porosity - x[THETA]) / FracPerv;
+    gs->gw->maxInfilVol = (gs->totalDepth - x[LOWERDEPTH]) *
+                          (gs->aquifer.porosity - x[THETA]) / gs->fracPerv;
 
     // --- update GW mass balance
-    updateMassBal(Area, tStep);
+    updateMassBal(gs, gs->area, tStep);
 
     // --- update GW statistics 
-    stats_updateGwaterStats(j, infil, GW->evapLoss, GWFlow, LowerLoss,
-        GW->theta, GW->lowerDepth + GW->bottomElev, tStep);
+    stats_updateGwaterStats(j, infil, gs->gw->evapLoss, gs->gwFlow,
+        gs->lowerLoss, gs->gw->theta, gs->gw->lowerDepth + gs->gw->bottomElev,
+        tStep);
 }
 
 //=============================================================================
 
-void updateMassBal(double area, double tStep)
+void updateMassBal(TGwState* gs, double area, double tStep)
 //
-//  Input:   area  = subcatchment area (ft2)
+//  Input:   gs    = GW state
+//           area  = subcatchment area (ft2)
 //           tStep = time step (sec)
 //  Output:  none
 //  Purpose: updates GW mass balance with volumes of water fluxes.
@@ -617,20 +634,21 @@ void updateMassBal(double area, double tStep)
     double vGwater;                    // volume of exchanged groundwater
     double ft2sec = area * tStep;
 
-    vInfil     = Infil * ft2sec;
-    vUpperEvap = UpperEvap * ft2sec;
-    vLowerEvap = LowerEvap * ft2sec;
-    vLowerPerc = LowerLoss * ft2sec;
-    vGwater    = 0.5 * (GW->oldFlow + GW->newFlow) * ft2sec;
+    vInfil     = gs->infil * ft2sec;
+    vUpperEvap = gs->upperEvap * ft2sec;
+    vLowerEvap = gs->lowerEvap * ft2sec;
+    vLowerPerc = gs->lowerLoss * ft2sec;
+    vGwater    = 0.5 * (gs->gw->oldFlow + gs->gw->newFlow) * ft2sec;
     massbal_updateGwaterTotals(vInfil, vUpperEvap, vLowerEvap, vLowerPerc,
                                vGwater);
 }
 
 //=============================================================================
 
-void  getFluxes(double theta, double lowerDepth)
+void  getFluxes(TGwState* gs, double theta, double lowerDepth)
 //
-//  Input:   upperVolume = vol. depth of upper zone (ft)
+//  Input:   gs          = GW state
+//           upperVolume = vol. depth of upper zone (ft)
 //           upperDepth  = depth of upper zone (ft)
 //  Output:  none
 //  Purpose: computes water fluxes into/out of upper/lower GW zones.
@@ -640,44 +658,48 @@ void  getFluxes(double theta, double lowerDepth)
 
     // --- find upper zone depth
     lowerDepth = MAX(lowerDepth, 0.0);
-    lowerDepth = MIN(lowerDepth, TotalDepth);
-    upperDepth = TotalDepth - lowerDepth;
+    lowerDepth = MIN(lowerDepth, gs->totalDepth);
+    upperDepth = gs->totalDepth - lowerDepth;
 
-    // --- save lower depth and theta to global variables
-    Hgw = lowerDepth;
-    Theta = theta;
+    // --- save lower depth and theta to the GW state
+    gs->hgw = lowerDepth;
+    gs->theta = theta;
 
     // --- find evaporation rate from both zones
-    getEvapRates(theta, upperDepth);
+    getEvapRates(gs, theta, upperDepth);
 
     // --- find percolation rate from upper to lower zone
-    UpperPerc = getUpperPerc(theta, upperDepth);
-    UpperPerc = MIN(UpperPerc, MaxUpperPerc);
+    gs->upperPerc = getUpperPerc(gs, theta, upperDepth);
+    gs->upperPerc = MIN(gs->upperPerc, gs->maxUpperPerc);
 
     // --- find loss rate to deep GW
-    if ( DeepFlowExpr != NULL )
-        LowerLoss = mathexpr_eval(DeepFlowExpr, getVariableValue) /
-                    UCF(RAINFALL);
+    ExprState = gs;
+    if ( gs->deepFlowExpr != NULL )
+        gs->lowerLoss = mathexpr_eval(gs->deepFlowExpr, getVariableValue) /
+                        UCF(RAINFALL);
     else
-        LowerLoss = A.lowerLossCoeff * lowerDepth / TotalDepth;
-    LowerLoss = MIN(LowerLoss, lowerDepth/Tstep);
+        gs->lowerLoss = gs->aquifer.lowerLossCoeff * lowerDepth /
+                        gs->totalDepth;
+    gs->lowerLoss = MIN(gs->lowerLoss, lowerDepth/gs->tStep);
 
     // --- find GW flow rate from lower zone to drainage system node
-    GWFlow = getGWFlow(lowerDepth);
-    if ( LatFlowExpr != NULL )
+    gs->gwFlow = getGWFlow(gs, lowerDepth);
+    if ( gs->latFlowExpr != NULL )
     {
-        GWFlow += mathexpr_eval(LatFlowExpr, getVariableValue) / UCF(GWFLOW);
+        gs->gwFlow += mathexpr_eval(gs->latFlowExpr, getVariableValue) /
+                      UCF(GWFLOW);
     }
-    if ( GWFlow >= 0.0 ) GWFlow = MIN(GWFlow, MaxGWFlowPos);
-    else GWFlow = MAX(GWFlow, MaxGWFlowNeg);
+    if ( gs->gwFlow >= 0.0 ) gs->gwFlow = MIN(gs->gwFlow, gs->maxGWFlowPos);
+    else gs->gwFlow = MAX(gs->gwFlow, gs->maxGWFlowNeg);
 }
 
 //=============================================================================
 
-void  getDxDt(double t, double* x, double* dxdt)
+void  getDxDt(double t, double* x, double* dxdt, void* data)
 //
 //  Input:   t    = current time (not used)
 //           x    = array of state variables
+//           data = GW state
 //  Output:  dxdt = array of time derivatives of state variables
 //  Purpose: computes time derivatives of upper moisture content 
 //           and lower depth.
@@ -686,14 +708,15 @@ void  getDxDt(double t, double* x, double* dxdt)
     double qUpper;    // inflow - outflow for upper zone (ft/sec)
     double qLower;    // inflow - outflow for lower zone (ft/sec)
     double denom;
+    TGwState* gs = (TGwState *)data;
 
-    getFluxes(x[THETA], x[LOWERDEPTH]);
-    qUpper = Infil - UpperEvap - UpperPerc;
-    qLower = UpperPerc - LowerLoss - LowerEvap - GWFlow;
+    getFluxes(gs, x[THETA], x[LOWERDEPTH]);
+    qUpper = gs->infil - gs->upperEvap - gs->upperPerc;
+    qLower = gs->upperPerc - gs->lowerLoss - gs->lowerEvap - gs->gwFlow;
 
     // --- d(upper zone moisture)/dt = (net upper zone flow) /
     //                                 (upper zone depth)
-    denom = TotalDepth - x[LOWERDEPTH];
+    denom = gs->totalDepth - x[LOWERDEPTH];
     if (denom > 0.0)
         dxdt[THETA] = qUpper / denom;
     else
@@ -701,7 +724,7 @@ void  getDxDt(double t, double* x, double* dxdt)
 
     // --- d(lower zone depth)/dt = (net lower zone flow) /
     //                              (upper zone moisture deficit)
-    denom = A.porosity - x[THETA];
+    denom = gs->aquifer.porosity - x[THETA];
     if (denom > 0.0)
         dxdt[LOWERDEPTH] = qLower / denom;
     else
@@ -710,9 +733,10 @@ void  getDxDt(double t, double* x, double* dxdt)
 
 //=============================================================================
 
-void getEvapRates(double theta, double upperDepth)
+void getEvapRates(TGwState* gs, double theta, double upperDepth)
 //
-//  Input:   theta      = moisture content of upper zone
+//  Input:   gs         = GW state
+//           theta      = moisture content of upper zone
 //           upperDepth = depth of upper zone (ft)
 //  Output:  none
 //  Purpose: computes evapotranspiration out of upper & lower zones.
@@ -723,14 +747,14 @@ void getEvapRates(double theta, double upperDepth)
     double lowerFrac, upperFrac;
 
     // --- no GW evaporation when infiltration is occurring
-    UpperEvap = 0.0;
-    LowerEvap = 0.0;
-    if ( Infil > 0.0 ) return;
+    gs->upperEvap = 0.0;
+    gs->lowerEvap = 0.0;
+    if ( gs->infil > 0.0 ) return;
 
     // --- get monthly-adjusted upper zone evap fraction
-    upperFrac = A.upperEvapFrac;
+    upperFrac = gs->aquifer.upperEvapFrac;
     f = 1.0;
-    p = A.upperEvapPat;
+    p = gs->aquifer.upperEvapPat;
     if ( p >= 0 )
     {
         month = datetime_monthOfYear(getDateTime(NewRunoffTime));
@@ -740,35 +764,37 @@ void getEvapRates(double theta, double upperDepth)
 
     // --- upper zone evaporation requires that soil moisture
     //     be above the wilting point
-    if ( theta > A.wiltingPoint )
+    if ( theta > gs->aquifer.wiltingPoint )
     {
         // --- actual evap is upper zone fraction applied to max. potential
         //     rate, limited by the available rate after any surface evap 
-        UpperEvap = upperFrac * MaxEvap;
-        UpperEvap = MIN(UpperEvap, AvailEvap);
+        gs->upperEvap = upperFrac * gs->maxEvap;
+        gs->upperEvap = MIN(gs->upperEvap, gs->availEvap);
     }
 
     // --- check if lower zone evaporation is possible
-    if ( A.lowerEvapDepth > 0.0 )
+    if ( gs->aquifer.lowerEvapDepth > 0.0 )
     {
         // --- find the fraction of the lower evaporation depth that
         //     extends into the saturated lower zone
-        lowerFrac = (A.lowerEvapDepth - upperDepth) / A.lowerEvapDepth;
+        lowerFrac = (gs->aquifer.lowerEvapDepth - upperDepth) /
+                    gs->aquifer.lowerEvapDepth;
         lowerFrac = MAX(0.0, lowerFrac);
         lowerFrac = MIN(lowerFrac, 1.0);
 
         // --- make the lower zone evap rate proportional to this fraction
         //     and the evap not used in the upper zone
-        LowerEvap = lowerFrac * (1.0 - upperFrac) * MaxEvap;
-        LowerEvap = MIN(LowerEvap, (AvailEvap - UpperEvap));
+        gs->lowerEvap = lowerFrac * (1.0 - upperFrac) * gs->maxEvap;
+        gs->lowerEvap = MIN(gs->lowerEvap, (gs->availEvap - gs->upperEvap));
     }
 }
 
 //=============================================================================
 
-double getUpperPerc(double theta, double upperDepth)
+double getUpperPerc(TGwState* gs, double theta, double upperDepth)
 //
-//  Input:   theta      = moisture content of upper zone
+//  Input:   gs         = GW state
+//           theta      = moisture content of upper zone
 //           upperDepth = depth of upper zone (ft)
 //  Output:  returns percolation rate (ft/sec)
 //  Purpose: finds percolation rate from upper to lower zone.
@@ -778,27 +804,29 @@ double getUpperPerc(double theta, double upperDepth)
     double dhdz;                        // avg. change in head with depth
     double hydcon;                      // unsaturated hydraulic conductivity
 
-    // --- no perc. from upper zone if no depth or moisture content too low    
-    if ( upperDepth <= 0.0 || theta <= A.fieldCapacity ) return 0.0;
-
     // --- compute hyd. conductivity as function of moisture content
-    delta = theta - A.porosity;
-    hydcon = A.conductivity * exp(delta * A.conductSlope);
+    //     (saved for use in user-supplied GW flow expressions)
+    delta = theta - gs->aquifer.porosity;
+    hydcon = gs->aquifer.conductivity * exp(delta * gs->aquifer.conductSlope);
+    gs->hydCon = hydcon;
+
+    // --- no perc. from upper zone if no depth or moisture content too low    
+    if ( upperDepth <= 0.0 || theta <= gs->aquifer.fieldCapacity ) return 0.0;
 
     // --- compute integral of dh/dz term
-    delta = theta - A.fieldCapacity;
-    dhdz = 1.0 + A.tensionSlope * 2.0 * delta / upperDepth;
+    delta = theta - gs->aquifer.fieldCapacity;
+    dhdz = 1.0 + gs->aquifer.tensionSlope * 2.0 * delta / upperDepth;
 
     // --- compute upper zone percolation rate
-    HydCon = hydcon;
     return hydcon * dhdz;
 }
 
 //=============================================================================
 
-double getGWFlow(double lowerDepth)
+double getGWFlow(TGwState* gs, double lowerDepth)
 //
-//  Input:   lowerDepth = depth of lower zone (ft)
+//  Input:   gs         = GW state
+//           lowerDepth = depth of lower zone (ft)
 //  Output:  returns groundwater flow rate (ft/sec)
 //  Purpose: finds groundwater outflow from lower saturated zone.
 //
@@ -806,26 +834,27 @@ double getGWFlow(double lowerDepth)
     double q, t1, t2, t3;
 
     // --- water table must be above Hstar for flow to occur
-    if ( lowerDepth <= Hstar ) return 0.0;
+    if ( lowerDepth <= gs->hstar ) return 0.0;
 
     // --- compute groundwater component of flow
-    if ( GW->b1 == 0.0 ) t1 = GW->a1;
-    else t1 = GW->a1 * pow( (lowerDepth - Hstar)*UCF(LENGTH), GW->b1);
+    if ( gs->gw->b1 == 0.0 ) t1 = gs->gw->a1;
+    else t1 = gs->gw->a1 * pow( (lowerDepth - gs->hstar)*UCF(LENGTH),
+                                gs->gw->b1);
 
     // --- compute surface water component of flow
-    if ( GW->b2 == 0.0 ) t2 = GW->a2;
-    else if (Hsw > Hstar)
+    if ( gs->gw->b2 == 0.0 ) t2 = gs->gw->a2;
+    else if (gs->hsw > gs->hstar)
     {
-        t2 = GW->a2 * pow( (Hsw - Hstar)*UCF(LENGTH), GW->b2);
+        t2 = gs->gw->a2 * pow( (gs->hsw - gs->hstar)*UCF(LENGTH), gs->gw->b2);
     }
     else t2 = 0.0;
 
     // --- compute groundwater/surface water interaction term
-    t3 = GW->a3 * lowerDepth * Hsw * UCF(LENGTH) * UCF(LENGTH);
+    t3 = gs->gw->a3 * lowerDepth * gs->hsw * UCF(LENGTH) * UCF(LENGTH);
 
     // --- compute total groundwater flow
     q = (t1 - t2 + t3) / UCF(GWFLOW); 
-    if ( q < 0.0 && GW->a3 != 0.0 ) q = 0.0;
+    if ( q < 0.0 && gs->gw->a3 != 0.0 ) q = 0.0;
     return q;
 }
 
@@ -854,19 +883,21 @@ double getVariableValue(int varIndex)
 //  Purpose: finds current value of a GW variable.
 //
 {
+    TGwState* gs = ExprState;
+
     switch (varIndex)
     {
-    case gwvHGW:  return Hgw * UCF(LENGTH);
-    case gwvHSW:  return Hsw * UCF(LENGTH);
-    case gwvHCB:  return Hstar * UCF(LENGTH);
-    case gwvHGS:  return TotalDepth * UCF(LENGTH);
-    case gwvKS:   return A.conductivity * UCF(RAINFALL);
-    case gwvK:    return HydCon * UCF(RAINFALL);
-    case gwvTHETA:return Theta;
-    case gwvPHI:  return A.porosity;
-    case gwvFI:   return Infil * UCF(RAINFALL); 
-    case gwvFU:   return UpperPerc * UCF(RAINFALL);
-    case gwvA:    return Area * UCF(LANDAREA);
+    case gwvHGW:  return gs->hgw * UCF(LENGTH);
+    case gwvHSW:  return gs->hsw * UCF(LENGTH);
+    case gwvHCB:  return gs->hstar * UCF(LENGTH);
+    case gwvHGS:  return gs->totalDepth * UCF(LENGTH);
+    case gwvKS:   return gs->aquifer.conductivity * UCF(RAINFALL);
+    case gwvK:    return gs->hydCon * UCF(RAINFALL);
+    case gwvTHETA:return gs->theta;
+    case gwvPHI:  return gs->aquifer.porosity;
+    case gwvFI:   return gs->infil * UCF(RAINFALL); 
+    case gwvFU:   return gs->upperPerc * UCF(RAINFALL);
+    case gwvA:    return gs->area * UCF(LANDAREA);
     default:      return 0.0;
     }
 }
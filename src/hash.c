@@ -13,6 +13,12 @@
 //      HTinsert() - inserts a string & its index value into a hash table
 //      HTfind()   - retrieves the index value of a string from a table
 //      HTfree()   - frees a hash table
+//
+//   The table uses open addressing with linear probing and doubles in size
+//   whenever it becomes half full, so look-ups stay short no matter how
+//   many strings are stored. Each slot keeps its key's full hash code and
+//   length so that most non-matching keys are rejected without comparing
+//   strings.
 //-----------------------------------------------------------------------------
 
 #include <stdlib.h>
@@ -29,89 +35,110 @@ int  samestr(const char *s1, const char *s2)
    return(0);
 }                                       /*  End of samestr  */
 
-/* Use Fletcher's checksum to compute 2-byte hash of string */
-unsigned int hash(const char *str)
+/* Use FNV-1a to compute a 32-bit hash of upper-cased string & its length */
+unsigned int hash(const char *str, int *len)
 {
-    unsigned int sum1= 0, check1;
-    unsigned long sum2= 0L;
-	while(  '\0' != *str  )
+    unsigned int code = 2166136261u;
+    const char *s = str;
+    while ( '\0' != *s )
     {
-        sum1 += UCHAR(*str);
-        str++;
-        if (  255 <= sum1  ) sum1 -= 255;
-        sum2 += sum1;
+        code ^= (unsigned char)UCHAR(*s);
+        code *= 16777619u;
+        s++;
     }
-    check1= sum2;
-    check1 %= 255;
-    check1= 255 - (sum1+check1) % 255;
-    sum1= 255 - (sum1+check1) % 255;
-    return( ( ( check1 << 8 )  |  sum1  ) % HTMAXSIZE);
+    *len = (int)(s - str);
+    return(code);
+}
+
+/* Find slot holding key or the empty slot where it belongs */
+static struct HTentry *findSlot(HTtable *ht, const char *key,
+                                unsigned int code, int len)
+{
+        unsigned int mask = ht->size - 1;
+        unsigned int i = code & mask;
+        struct HTentry *entry = &ht->entry[i];
+        while (entry->key != NULL)
+        {
+            if ( entry->code == code && entry->len == len &&
+                 samestr(entry->key, key) ) break;
+            i = (i + 1) & mask;
+            entry = &ht->entry[i];
+        }
+        return(entry);
+}
+
+/* Double the number of slots in a table */
+static int grow(HTtable *ht)
+{
+        unsigned int i, j, mask;
+        unsigned int size = 2 * ht->size;
+        struct HTentry *entry;
+        entry = (struct HTentry *) calloc(size, sizeof(struct HTentry));
+        if (entry == NULL) return(0);
+        mask = size - 1;
+        for (i=0; i<ht->size; i++)
+        {
+            if (ht->entry[i].key == NULL) continue;
+            j = ht->entry[i].code & mask;
+            while (entry[j].key != NULL) j = (j + 1) & mask;
+            entry[j] = ht->entry[i];
+        }
+        free(ht->entry);
+        ht->entry = entry;
+        ht->size = size;
+        return(1);
 }
 
 HTtable *HTcreate()
 {
-        int i;
-        HTtable *ht = (HTtable *) calloc(HTMAXSIZE, sizeof(HTtable));
-        if (ht != NULL) for (i=0; i<HTMAXSIZE; i++) ht[i] = NULL;
+        HTtable *ht = (HTtable *) malloc(sizeof(HTtable));
+        if (ht == NULL) return(NULL);
+        ht->entry = (struct HTentry *) calloc(HTMINSIZE,
+                                              sizeof(struct HTentry));
+        if (ht->entry == NULL)
+        {
+            free(ht);
+            return(NULL);
+        }
+        ht->size = HTMINSIZE;
+        ht->count = 0;
         return(ht);
 }
 
 int     HTinsert(HTtable *ht, char *key, int data)
 {
-        unsigned int i = hash(key);
+        int len;
+        unsigned int code = hash(key, &len);
         struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(0);
-        entry = (struct HTentry *) malloc(sizeof(struct HTentry));
-        if (entry == NULL) return(0);
+        if ( 2 * (ht->count + 1) > ht->size && !grow(ht) ) return(0);
+        entry = findSlot(ht, key, code, len);
+        if (entry->key == NULL) ht->count++;
         entry->key = key;
+        entry->code = code;
+        entry->len = len;
         entry->data = data;
-        entry->next = ht[i];
-        ht[i] = entry;
         return(1);
 }
 
 int     HTfind(HTtable *ht, const char *key)
 {
-        unsigned int i = hash(key);
-        struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(NOTFOUND);
-        entry = ht[i];
-        while (entry != NULL)
-        {
-            if ( samestr(entry->key,key) ) return(entry->data);
-            entry = entry->next;
-        }
-        return(NOTFOUND);
+        int len;
+        unsigned int code = hash(key, &len);
+        struct HTentry *entry = findSlot(ht, key, code, len);
+        if (entry->key == NULL) return(NOTFOUND);
+        return(entry->data);
 }
 
 char    *HTfindKey(HTtable *ht, const char *key)
 {
-        unsigned int i = hash(key);
-        struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(NULL);
-        entry = ht[i];
-        while (entry != NULL)
-        {
-            if ( samestr(entry->key,key) ) return(entry->key);
-            entry = entry->next;
-        }
-        return(NULL);
+        int len;
+        unsigned int code = hash(key, &len);
+        struct HTentry *entry = findSlot(ht, key, code, len);
+        return(entry->key);
 }
 
 void    HTfree(HTtable *ht)
 {
-        struct HTentry *entry,
-                       *nextentry;
-        int i;
-        for (i=0; i<HTMAXSIZE; i++)
-        {
-            entry = ht[i];
-            while (entry != NULL)
-            {
-                nextentry = entry->next;
-                free(entry);
-                entry = nextentry;
-            }
-        }
+        free(ht->entry);
         free(ht);
 }
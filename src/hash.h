@@ -8,17 +8,23 @@
 #define HASH_H
 
 
-#define HTMAXSIZE 1999
+#define HTMINSIZE 256       // initial number of table slots (a power of 2)
 #define NOTFOUND  -1
 
 struct HTentry
 {
-    char   *key;
-    int    data;
-    struct HTentry *next;
+    char         *key;      // NULL if slot is empty
+    unsigned int code;      // hash code of key
+    int          len;       // length of key
+    int          data;
 };
 
-typedef struct HTentry *HTtable;
+typedef struct
+{
+    struct HTentry *entry;  // array of table slots
+    unsigned int   size;    // number of slots (a power of 2)
+    unsigned int   count;   // number of slots in use
+}  HTtable;
 
 HTtable* HTcreate(void);
 int      HTinsert(HTtable *, char *, int);
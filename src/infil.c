@@ -52,6 +52,7 @@ TInfil *Infil;
 
 static double Fumax;   // saturated water volume in upper soil zone (ft)
 static double InfilFactor;
+#pragma omp threadprivate(Fumax, InfilFactor)
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in infil.h)
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "headers.h"
+#include "mempool.h"
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
@@ -26,8 +27,6 @@
 //  inflow_initDwfPattern   (called createObjects in project.c)
 //  inflow_readExtInflow    (called by input_readLine)
 //  inflow_readDwfInflow    (called by input_readLine)
-//  inflow_deleteExtInflows (called by deleteObjects in project.c)
-//  inflow_deleteDwfInflows (called by deleteObjects in project.c)
 //  inflow_getExtInflow     (called by addExternalInflows in routing.c)
 //  inflow_setExtInflow     (called by setNodeInflow in swmm5.c)
 //  inflow_getDwfInflow     (called by addDryWeatherInflows in routing.c)
@@ -180,7 +179,7 @@ int inflow_setExtInflow(int j, int param, int type, int tseries, int basePat,
     // --- if it doesn't exist, then create it
     if ( inflow == NULL )
     {
-        inflow = (TExtInflow *) malloc(sizeof(TExtInflow));
+        inflow = AllocArray(TExtInflow, 1);
         if ( inflow == NULL ) 
         {
             return error_setInpError(ERR_MEMORY, "");
@@ -202,26 +201,6 @@ int inflow_setExtInflow(int j, int param, int type, int tseries, int basePat,
 
 //=============================================================================
 
-void inflow_deleteExtInflows(int j)
-//
-//  Input:   j = node index
-//  Output:  none
-//  Purpose: deletes all time series inflow data for a node.
-//
-{
-    TExtInflow* inflow1;
-    TExtInflow* inflow2;
-    inflow1 = Node[j].extInflow;
-    while ( inflow1 )
-    {
-        inflow2 = inflow1->next;
-        free(inflow1);
-        inflow1 = inflow2; 
-    }
-}
-
-//=============================================================================
-
 double inflow_getExtInflow(TExtInflow* inflow, DateTime aDate)
 //
 //  Input:   inflow = external inflow data structure
@@ -318,7 +297,7 @@ int inflow_readDwfInflow(char* tok[], int ntoks)
     // --- if it doesn't exist, then create it
     if ( inflow == NULL )
     {
-        inflow = (TDwfInflow *) malloc(sizeof(TDwfInflow));
+        inflow = AllocArray(TDwfInflow, 1);
         if ( inflow == NULL ) return error_setInpError(ERR_MEMORY, "");
         inflow->next = Node[j].dwfInflow;
         Node[j].dwfInflow = inflow;
@@ -333,26 +312,6 @@ int inflow_readDwfInflow(char* tok[], int ntoks)
 
 //=============================================================================
 
-void inflow_deleteDwfInflows(int j)
-//
-//  Input:   j = node index
-//  Output:  none
-//  Purpose: deletes all dry weather inflow data for a node.
-//
-{
-    TDwfInflow* inflow1;
-    TDwfInflow* inflow2;
-    inflow1 = Node[j].dwfInflow;
-    while ( inflow1 )
-    {
-        inflow2 = inflow1->next;
-        free(inflow1);
-        inflow1 = inflow2; 
-    }
-}
-
-//=============================================================================
-
 void   inflow_initDwfInflow(TDwfInflow* inflow)
 //
 //  Input:   inflow = dry weather inflow data structure
@@ -0,0 +1,433 @@
+//-----------------------------------------------------------------------------
+//   inpcache.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Input table cache functions.
+//
+//   When the INPUT_CACHE option is set, the curve and time series tables
+//   read from a project's input file are saved to a binary cache file
+//   (the input file's name with ".cache" appended). The next time the same
+//   input file is opened the tables are loaded from the cache with a single
+//   bulk read instead of being parsed again from the file's text.
+//
+//   The cache is keyed by a hash of the input file's contents and of the
+//   directory it resides in (which is prepended to the names of external
+//   time series files). A cache whose key, version, or table counts do not
+//   match the current project is ignored and the tables are read from the
+//   input file as usual. A cache is only written when the input file was
+//   read without any errors.
+//
+//   Where the platform supports it the cache file is memory-mapped as a
+//   shared, read-only image and the tables' x/y entries point directly into
+//   it (each table's entries are stored aligned within the file for this
+//   purpose). Processes that run the same input file therefore share a
+//   single copy of its table data. Otherwise the file is read into one
+//   block of memory that the tables' entries point into. The image is
+//   released when the project is closed.
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "headers.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#define USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+static const char CacheStamp[] = "SWMM5-TABLES";
+static const int  CacheVersion = 3;
+#define ENTRY_ALIGN 8                  // alignment of entries in cache file
+
+//-----------------------------------------------------------------------------
+//  Local Variables
+//-----------------------------------------------------------------------------
+static char CacheName[MAXFNAME+1];     // name of cache file
+static unsigned long long CacheKey;    // hash of input file contents
+static char* Image;                    // contents of cache file
+static long  ImageSize;                // size of Image in bytes
+static int   ImageMapped;              // TRUE if Image is memory-mapped
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+// inpcache_load                          (called by input_readData)
+// inpcache_save                          (called by input_readData)
+// inpcache_close                         (called by project_close)
+
+//-----------------------------------------------------------------------------
+// Function declarations
+//-----------------------------------------------------------------------------
+static unsigned long long getKey(unsigned long long key, const char* s,
+                                 size_t n);
+static int  openImage(void);
+static int  readTables(char* p, char* end);
+static int  readTable(TTable* table, int type, char** p, char* end);
+static int  readBytes(void* v, size_t n, char** p, char* end);
+static int  skipPadding(char** p, char* end);
+static int  saveTable(TTable* table, FILE* f);
+static void resetTables(void);
+
+//=============================================================================
+
+int  inpcache_load(char* text, size_t size)
+//
+//  Input:   text = contents of input file
+//           size = number of characters in text
+//  Output:  returns TRUE if curves & time series were loaded from the
+//           cache file, FALSE if not
+//  Purpose: loads the project's curve and time series tables from a
+//           previously saved cache file.
+//
+{
+    int    loaded = FALSE;
+
+    // --- find the key & name of the cache file for the input file
+    CacheKey = getKey(14695981039346656037ULL, text, size);
+    CacheKey = getKey(CacheKey, InpDir, strlen(InpDir));
+    if ( snprintf(CacheName, MAXFNAME+1, "%s.cache", Finp.name) > MAXFNAME )
+    {
+        CacheName[0] = '\0';
+        return FALSE;
+    }
+
+    // --- point the project's tables into the cache file's image
+    if ( openImage() ) loaded = readTables(Image, Image + ImageSize);
+    if ( !loaded )
+    {
+        resetTables();
+        inpcache_close();
+    }
+    return loaded;
+}
+
+//=============================================================================
+
+void  inpcache_save()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: saves the project's curve and time series tables to a cache
+//           file for the input file.
+//
+//  Failure to write the cache is not an error since the tables will
+//  simply be read from the input file the next time it is opened.
+//
+{
+    FILE* f;
+    char  tmpName[MAXFNAME+21];
+    int   j;
+    int   ok;
+
+    // --- write to a uniquely named file that is then renamed, so that
+    //     other processes never see (or have mapped) a partial cache file
+    if ( CacheName[0] == '\0' ) return;
+    if ( snprintf(tmpName, sizeof(tmpName), "%s.%d", CacheName,
+         (int)getpid()) >= (int)sizeof(tmpName) ) return;
+    f = fopen(tmpName, "wb");
+    if ( f == NULL ) return;
+    ok = fwrite(CacheStamp, sizeof(char), strlen(CacheStamp), f) ==
+             strlen(CacheStamp) &&
+         fwrite(&CacheVersion, sizeof(int), 1, f) == 1 &&
+         fwrite(&CacheKey, sizeof(CacheKey), 1, f) == 1 &&
+         fwrite(&Nobjects[CURVE], sizeof(int), 1, f) == 1 &&
+         fwrite(&Nobjects[TSERIES], sizeof(int), 1, f) == 1;
+    for (j = 0; ok && j < Nobjects[CURVE]; j++)
+        ok = saveTable(&Curve[j], f);
+    for (j = 0; ok && j < Nobjects[TSERIES]; j++)
+        ok = saveTable(&Tseries[j], f);
+    if ( fclose(f) != 0 ) ok = FALSE;
+
+    // --- replace any existing cache file (which can't be done by renaming
+    //     on all platforms)
+    if ( ok && rename(tmpName, CacheName) != 0 )
+    {
+        remove(CacheName);
+        ok = rename(tmpName, CacheName) == 0;
+    }
+    if ( !ok ) remove(tmpName);
+}
+
+//=============================================================================
+
+void  inpcache_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: releases the image of a cache file whose tables were loaded.
+//
+//  The tables pointing into the image must have been deleted beforehand.
+//
+{
+    if ( Image == NULL ) return;
+#ifdef USE_MMAP
+    if ( ImageMapped ) munmap(Image, ImageSize);
+    else
+#endif
+    free(Image);
+    Image = NULL;
+    ImageSize = 0;
+    ImageMapped = FALSE;
+}
+
+//=============================================================================
+
+int  openImage()
+//
+//  Input:   none
+//  Output:  returns TRUE if an image of the cache file was made, FALSE if not
+//  Purpose: maps the cache file into memory, or else reads it into memory.
+//
+{
+    FILE*  f;
+    long   n;
+    void*  p;
+#ifdef USE_MMAP
+    int    fd;
+    struct stat st;
+
+    // --- map the file as a shared, read-only image
+    fd = open(CacheName, O_RDONLY);
+    if ( fd < 0 ) return FALSE;
+    if ( fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size <= LONG_MAX )
+    {
+        p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if ( p != MAP_FAILED )
+        {
+            Image = (char *) p;
+            ImageSize = (long) st.st_size;
+            ImageMapped = TRUE;
+        }
+    }
+    close(fd);
+    if ( Image ) return TRUE;
+#endif
+
+    // --- read the entire file into memory
+    f = fopen(CacheName, "rb");
+    if ( f == NULL ) return FALSE;
+    if ( fseek(f, 0, SEEK_END) == 0 && (n = ftell(f)) > 0 )
+    {
+        rewind(f);
+        p = malloc(n);
+        if ( p && fread(p, 1, n, f) == (size_t)n )
+        {
+            Image = (char *) p;
+            ImageSize = n;
+        }
+        else free(p);
+    }
+    fclose(f);
+    return Image != NULL;
+}
+
+//=============================================================================
+
+unsigned long long getKey(unsigned long long key, const char* s, size_t n)
+//
+//  Input:   key = hash value of preceding data
+//           s = array of characters
+//           n = number of characters in s
+//  Output:  returns updated hash value
+//  Purpose: adds a block of characters to an FNV-1a hash value.
+//
+{
+    const unsigned char* c = (const unsigned char *)s;
+    const unsigned char* end = c + n;
+    while ( c < end )
+    {
+        key ^= *c++;
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+//=============================================================================
+
+int  readTables(char* p, char* end)
+//
+//  Input:   p = start of cache file contents
+//           end = end of cache file contents
+//  Output:  returns TRUE if cache file matches project, FALSE if not
+//  Purpose: reads the curve and time series tables from a cache file's
+//           contents.
+//
+{
+    char  stamp[sizeof(CacheStamp)] = "";
+    int   version, nCurves, nTseries, j;
+    unsigned long long key;
+
+    // --- check that cache was made for the current input file
+    if ( !readBytes(stamp, strlen(CacheStamp), &p, end) ||
+         strcmp(stamp, CacheStamp) != 0 ) return FALSE;
+    if ( !readBytes(&version, sizeof(int), &p, end) ||
+         version != CacheVersion ) return FALSE;
+    if ( !readBytes(&key, sizeof(key), &p, end) ||
+         key != CacheKey ) return FALSE;
+    if ( !readBytes(&nCurves, sizeof(int), &p, end) ||
+         !readBytes(&nTseries, sizeof(int), &p, end) ) return FALSE;
+    if ( nCurves != Nobjects[CURVE] || nTseries != Nobjects[TSERIES] )
+        return FALSE;
+
+    // --- read each table
+    for (j = 0; j < nCurves; j++)
+        if ( !readTable(&Curve[j], CURVE, &p, end) ) return FALSE;
+    for (j = 0; j < nTseries; j++)
+        if ( !readTable(&Tseries[j], TSERIES, &p, end) ) return FALSE;
+    return p == end;
+}
+
+//=============================================================================
+
+int  readTable(TTable* table, int type, char** p, char* end)
+//
+//  Input:   table = a curve or time series
+//           type = CURVE or TSERIES
+//           p = current position in cache file contents
+//           end = end of cache file contents
+//  Output:  returns TRUE if table read successfully, FALSE if not
+//  Purpose: reads a table's properties and x/y entries from a cache file.
+//
+{
+    char   id[MAXLINE+1];
+    int    len;
+    int    n;
+
+    // --- ID name (empty if table had no data)
+    if ( !readBytes(&len, sizeof(int), p, end) ) return FALSE;
+    if ( len < 0 || len > MAXLINE ) return FALSE;
+    if ( !readBytes(id, len, p, end) ) return FALSE;
+    id[len] = '\0';
+    if ( len > 0 )
+    {
+        table->ID = project_findID(type, id);
+        if ( table->ID == NULL ) return FALSE;
+    }
+
+    // --- curve type, external file & last input date
+    if ( !readBytes(&table->curveType, sizeof(int), p, end) ||
+         !readBytes(&table->file.mode, sizeof(char), p, end) ) return FALSE;
+    if ( table->file.mode == USE_FILE &&
+        !readBytes(table->file.name, MAXFNAME+1, p, end) ) return FALSE;
+    if ( !readBytes(&table->lastDate, sizeof(double), p, end) ) return FALSE;
+
+    // --- x/y entries (used in place, so the table doesn't own them)
+    if ( !readBytes(&n, sizeof(int), p, end) ) return FALSE;
+    if ( !skipPadding(p, end) ) return FALSE;
+    if ( n < 0 || n > (end - *p) / (long)sizeof(TTableEntry) ) return FALSE;
+    if ( n == 0 ) return TRUE;
+    table->entries = (TTableEntry *) *p;
+    table->nEntries = n;
+    table->maxEntries = 0;
+    *p += n * sizeof(TTableEntry);
+    return TRUE;
+}
+
+//=============================================================================
+
+int  readBytes(void* v, size_t n, char** p, char* end)
+//
+//  Input:   v = location to receive data
+//           n = number of bytes to read
+//           p = current position in cache file contents
+//           end = end of cache file contents
+//  Output:  returns TRUE if n bytes were available, FALSE if not
+//  Purpose: copies the next n bytes of a cache file's contents.
+//
+{
+    if ( (size_t)(end - *p) < n ) return FALSE;
+    memcpy(v, *p, n);
+    *p += n;
+    return TRUE;
+}
+
+//=============================================================================
+
+int  skipPadding(char** p, char* end)
+//
+//  Input:   p = current position in cache file contents
+//           end = end of cache file contents
+//  Output:  returns TRUE if the padding was present, FALSE if not
+//  Purpose: moves past the padding that aligns a table's entries.
+//
+{
+    size_t pad = (ENTRY_ALIGN - (*p - Image) % ENTRY_ALIGN) % ENTRY_ALIGN;
+    if ( (size_t)(end - *p) < pad ) return FALSE;
+    *p += pad;
+    return TRUE;
+}
+
+//=============================================================================
+
+int  saveTable(TTable* table, FILE* f)
+//
+//  Input:   table = a curve or time series
+//           f = cache file
+//  Output:  returns TRUE if table written successfully, FALSE if not
+//  Purpose: writes a table's properties and x/y entries to a cache file.
+//
+{
+    static const char zeros[ENTRY_ALIGN] = "";
+    int   len = table->ID ? (int)strlen(table->ID) : 0;
+    int   n = table->nEntries;
+    long  pad;
+    int   ok;
+
+    ok = fwrite(&len, sizeof(int), 1, f) == 1 &&
+         fwrite(table->ID, sizeof(char), len, f) == (size_t)len &&
+         fwrite(&table->curveType, sizeof(int), 1, f) == 1 &&
+         fwrite(&table->file.mode, sizeof(char), 1, f) == 1;
+    if ( ok && table->file.mode == USE_FILE )
+        ok = fwrite(table->file.name, sizeof(char), MAXFNAME+1, f) ==
+                 MAXFNAME+1;
+    ok = ok && fwrite(&table->lastDate, sizeof(double), 1, f) == 1 &&
+         fwrite(&n, sizeof(int), 1, f) == 1;
+
+    // --- align the entries within the file
+    if ( ok )
+    {
+        pad = ftell(f);
+        pad = pad < 0 ? -1 : (ENTRY_ALIGN - pad % ENTRY_ALIGN) % ENTRY_ALIGN;
+        ok = pad >= 0 && fwrite(zeros, 1, pad, f) == (size_t)pad;
+    }
+    ok = ok && fwrite(table->entries, sizeof(TTableEntry), n, f) == (size_t)n;
+    return ok;
+}
+
+//=============================================================================
+
+void  resetTables()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: discards any tables partly loaded from a cache file that turned
+//           out not to match the project.
+//
+{
+    int j;
+    for (j = 0; j < Nobjects[CURVE]; j++)
+    {
+        table_deleteEntries(&Curve[j]);
+        table_init(&Curve[j]);
+    }
+    for (j = 0; j < Nobjects[TSERIES]; j++)
+    {
+        table_deleteEntries(&Tseries[j]);
+        table_init(&Tseries[j]);
+        Tseries[j].lastDate = StartDate + StartTime;
+    }
+}
@@ -27,6 +27,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+
+// Protect against lack of compiler support for OpenMP
+#if defined(_OPENMP)
+  #include <omp.h>
+#else
+  static int omp_get_max_threads(void) { return 1; }
+#endif
+
 #include "headers.h"
 #include "lid.h"
 
@@ -34,17 +42,56 @@
 //  Constants
 //-----------------------------------------------------------------------------
 static const int MAXERRS = 100;        // Max. input errors reported
+static const double Pow10[] =          // powers of 10 exact in double precision
+    {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct                         // consecutive lines of a table's data
+{
+    char* start;                       // position of first line in InpText
+    int   sect;                        // input section of lines
+    int   table;                       // index of curve or time series
+    long  first;                       // table data line count of first line
+    long  count;                       // number of data lines
+    long  lineCount;                   // file line count of first line
+}  TTableLines;
+
+typedef struct                         // error found in a table's data line
+{
+    long  line;                        // table data line count of line
+    long  lineCount;                   // file line count of line
+    char* pos;                         // position of line in InpText
+    int   code;                        // error code
+    char  msg[MAXMSG+1];               // error message argument
+}  TTableError;
+
+//-----------------------------------------------------------------------------
+//  Imported variables
+//-----------------------------------------------------------------------------
+extern char ErrString[256];            // defined in ERROR.C
+#pragma omp threadprivate(ErrString)
 
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
 static char *Tok[MAXTOKS];             // String tokens from line of input
 static int  Ntokens;                   // Number of tokens in line of input
+#pragma omp threadprivate(Tok, Ntokens)
 static int  Mobjects[MAX_OBJ_TYPES];   // Working number of objects of each type
 static int  Mnodes[MAX_NODE_TYPES];    // Working number of node objects
 static int  Mlinks[MAX_LINK_TYPES];    // Working number of link objects
 static int  Mevents;                   // Working number of event periods
 
+static char* InpText;                  // Contents of input file
+static char* InpEnd;                   // End of input file contents
+static TTableLines* TableLines;        // Runs of curve & time series lines
+static int   NumTableLines;            // Number of runs of table lines
+static TTableError* TableErrors;       // Errors in curve & time series lines
+static int   NumTableErrors;           // Number of table line errors
+
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -63,6 +110,23 @@ static int  readControl(char* tok[], int ntoks);
 static int  readNode(int type);
 static int  readLink(int type);
 static int  readEvent(char* tok[], int ntoks);
+static int  loadInputFile(void);
+static void freeInputFile(void);
+static char* readLine(char* line, char** pos);
+static int  isMapSection(int sect);
+static long skipLines(char** pos);
+static int  isTableSection(int sect);
+static int  getTableThreads(void);
+static int  findTableLines(void);
+static int  addTableLines(char* start, int sect, int table, long first,
+            long lineCount);
+static int  readTableLines(void);
+static int  readTableRuns(int sect, char* used, char* end, int nThreads);
+static void readTableRun(TTableLines* run);
+static int  readTseriesLines(char* end, int errsum);
+static int  compareTableLines(const void* a, const void* b);
+static int  compareTableErrors(const void* a, const void* b);
+static int  getFastDouble(char *s, double *y);
 
 //=============================================================================
 
@@ -81,6 +145,7 @@ int input_countObjects()
     int   errsum = 0;                  // number of errors found                   
     int   i;
     long  lineCount = 0;
+    char  *pos;                        // position in input file contents
 
     // --- initialize number of objects & set default values
     if ( ErrorCode ) return ErrorCode;
@@ -90,9 +155,21 @@ int input_countObjects()
     for (i = 0; i < MAX_LINK_TYPES; i++) Nlinks[i] = 0;
     controls_init();
 
+    // --- read entire input file into memory
+    if ( !loadInputFile() )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
     // --- make pass through data file counting number of each object
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    pos = InpText;
+    for (;;)
     {
+        // --- skip over map data that doesn't define any objects
+        if ( isMapSection(sect) ) lineCount += skipLines(&pos);
+        if ( readLine(line, &pos) == NULL ) break;
+
         // --- skip blank lines & those beginning with a comment
         lineCount++;
         sstrncpy(wLine, line, MAXLINE);     // make working copy of line
@@ -153,11 +230,21 @@ int input_readData()
     int   lineLength;             // number of characters in input line
     int   i;
     long  lineCount = 0;
+    long  tableLine = 0;          // number of curve & time series data lines
+    int   run = 0;                // current run of table data lines
+    int   err = 0;                // current table data line error
+    char* pos;                    // position in input file contents
+    int   cached = FALSE;         // TRUE if tables loaded from cache file
+    int   curvesRead = FALSE;     // TRUE if curves were read ahead
 
     // --- initialize working item count arrays
     //     (final counts in Mobjects, Mnodes & Mlinks should
     //      match those in Nobjects, Nnodes and Nlinks).
-    if ( ErrorCode ) return ErrorCode;
+    if ( ErrorCode )
+    {
+        freeInputFile();
+        return ErrorCode;
+    }
     error_setInpError(0, "");
     for (i = 0; i < MAX_OBJ_TYPES; i++)  Mobjects[i] = 0;
     for (i = 0; i < MAX_NODE_TYPES; i++) Mnodes[i] = 0;
@@ -170,12 +257,22 @@ int input_readData()
         Tseries[i].lastDate = StartDate + StartTime;
     }
 
+    // --- load curve & time series data from the input file's cache
+    //     or else locate them so that curves can be read in parallel
+    //     ahead of other data and time series after it
+    if ( InputCache ) cached = inpcache_load(InpText, InpEnd - InpText);
+    if ( !cached ) curvesRead = readTableLines();
+
     // --- read each line from input file
     sect = 0;
     errsum = 0;
-    rewind(Finp.file);
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    pos = InpText;
+    for (;;)
     {
+        // --- skip over map data not used by the engine
+        if ( isMapSection(sect) ) lineCount += skipLines(&pos);
+        if ( readLine(line, &pos) == NULL ) break;
+
         // --- make copy of line and scan for tokens
         lineCount++;
         sstrncpy(wLine, line, MAXLINE);
@@ -226,9 +323,34 @@ int input_readData()
         }
 
         // --- otherwise parse tokens from input line
+        //     (unless a curve already read in parallel, in which case any
+        //     error found is reported now, in file order, or a time series
+        //     that is read later)
         else
         {
-            inperr = parseLine(sect, line);
+            if ( isTableSection(sect) && cached ) inperr = 0;
+            else if ( isTableSection(sect) )
+            {
+                while ( run < NumTableLines &&
+                        TableLines[run].first + TableLines[run].count <=
+                            tableLine ) run++;
+                if ( run < NumTableLines && TableLines[run].table >= 0 &&
+                     TableLines[run].first <= tableLine &&
+                     (sect == s_TIMESERIES || curvesRead) )
+                {
+                    inperr = 0;
+                    if ( err < NumTableErrors &&
+                         TableErrors[err].line == tableLine )
+                    {
+                        inperr = error_setInpError(TableErrors[err].code,
+                                                   TableErrors[err].msg);
+                        err++;
+                    }
+                }
+                else inperr = parseLine(sect, line);
+                tableLine++;
+            }
+            else inperr = parseLine(sect, line);
             if ( inperr > 0 )
             {
                 errsum++;
@@ -241,13 +363,519 @@ int input_readData()
         if (errsum > MAXERRS) break;
     }   /* End of while */
 
+    // --- read the time series used by other objects
+    if ( !cached && errsum <= MAXERRS ) errsum = readTseriesLines(pos, errsum);
+
     // --- check for errors
+    freeInputFile();
     if (errsum > 0)  ErrorCode = ERR_INPUT;
+
+    // --- save tables to a cache file for next time
+    if ( InputCache && !cached && !ErrorCode ) inpcache_save();
     return ErrorCode;
 }
 
 //=============================================================================
 
+int  loadInputFile()
+//
+//  Input:   none
+//  Output:  returns FALSE if memory could not be allocated, TRUE otherwise
+//  Purpose: reads the contents of the input file into memory with a
+//           single bulk read so that it can be scanned without further
+//           file access.
+//
+{
+    size_t size = 1 << 20;             // size of allocated buffer
+    size_t n = 0;                      // number of characters read
+    char*  text;
+    char*  bigger;
+
+    InpText = NULL;
+    InpEnd = NULL;
+    TableLines = NULL;
+    NumTableLines = 0;
+    TableErrors = NULL;
+    NumTableErrors = 0;
+    text = (char *) malloc(size);
+    if ( text == NULL ) return FALSE;
+    for (;;)
+    {
+        n += fread(text + n, 1, size - n - 1, Finp.file);
+        if ( n < size - 1 ) break;
+        size *= 2;
+        bigger = (char *) realloc(text, size);
+        if ( bigger == NULL )
+        {
+            free(text);
+            return FALSE;
+        }
+        text = bigger;
+    }
+    text[n] = '\0';
+    InpText = text;
+    InpEnd = text + n;
+    return TRUE;
+}
+
+//=============================================================================
+
+void  freeInputFile()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees memory holding the input file's contents.
+//
+{
+    FREE(InpText);
+    FREE(TableLines);
+    FREE(TableErrors);
+    InpEnd = NULL;
+    NumTableLines = 0;
+    NumTableErrors = 0;
+}
+
+//=============================================================================
+
+char* readLine(char* line, char** pos)
+//
+//  Input:   line = buffer of MAXLINE+1 characters
+//           pos = current position in input file contents
+//  Output:  line = next line of input file;
+//           returns NULL at end of file
+//  Purpose: retrieves the next line of the input file in the same way
+//           that fgets() with a limit of MAXLINE would.
+//
+{
+    size_t n;
+    char*  eol;
+
+    if ( *pos >= InpEnd ) return NULL;
+    n = MIN((size_t)(InpEnd - *pos), MAXLINE - 1);
+    eol = (char *) memchr(*pos, '\n', n);
+    if ( eol ) n = eol - *pos + 1;
+    memcpy(line, *pos, n);
+    line[n] = '\0';
+    *pos += n;
+    return line;
+}
+
+//=============================================================================
+
+int  isMapSection(int sect)
+//
+//  Input:   sect = input data section
+//  Output:  returns TRUE if section's data is not used by the engine
+//  Purpose: identifies the sections that only hold data for drawing the
+//           project's map and profiles.
+//
+{
+    return ( sect >= s_COORDINATE && sect <= s_MAP );
+}
+
+//=============================================================================
+
+long  skipLines(char** pos)
+//
+//  Input:   pos = current position in input file contents
+//  Output:  pos = position of the next line that may start a new section;
+//           returns number of lines skipped
+//  Purpose: skips over the remaining lines of a section without
+//           tokenizing them.
+//
+//  Lines are split up in the same way as readLine() does, so the line
+//  count is the same as if each line had been read.
+//
+{
+    char* p = *pos;
+    char* eol;
+    size_t n;
+    long  count = 0;
+
+    while ( p < InpEnd )
+    {
+        // --- stop at a line whose first token could be a section heading
+        n = MIN((size_t)(InpEnd - p), MAXLINE - 1);
+        eol = p + strspn(p, SEPSTR);
+        if ( eol < p + n && (*eol == '[' || *eol == '"') ) break;
+
+        // --- move to start of next line
+        eol = (char *) memchr(p, '\n', n);
+        if ( eol ) n = eol - p + 1;
+        p += n;
+        count++;
+    }
+    *pos = p;
+    return count;
+}
+
+//=============================================================================
+
+int  isTableSection(int sect)
+//
+//  Input:   sect = input data section
+//  Output:  returns TRUE if section's data can be read in parallel
+//  Purpose: identifies the curve and time series sections, whose lines only
+//           depend on earlier lines for the same table.
+//
+{
+    return ( sect == s_CURVE || sect == s_TIMESERIES );
+}
+
+//=============================================================================
+
+int  getTableThreads()
+//
+//  Input:   none
+//  Output:  returns number of threads used to read table data
+//  Purpose: finds how many threads can read curve & time series data.
+//
+//  The THREADS option was read when objects were counted, so the number
+//  of threads is the same one that project_validate() will settle on.
+//
+{
+    int nThreads = NumThreads;
+    if ( nThreads == 0 ) nThreads = omp_get_max_threads();
+    else nThreads = MIN(nThreads, omp_get_max_threads());
+    if ( Nobjects[LINK] < 4 * nThreads ) nThreads = 1;
+    return nThreads;
+}
+
+//=============================================================================
+
+int  readTableLines()
+//
+//  Input:   none
+//  Output:  returns TRUE if curve data was read, FALSE otherwise
+//  Purpose: locates the data lines of all curves and time series and
+//           reads the curves in parallel, saving any errors found to be
+//           reported in file order later.
+//
+//  Time series data is left to be read by readTseriesLines() once the
+//  rest of the input file has been read.
+//
+{
+    int nThreads = getTableThreads();
+
+    if ( !findTableLines() )
+    {
+        FREE(TableLines);
+        NumTableLines = 0;
+        return FALSE;
+    }
+    if ( nThreads <= 1 ) return FALSE;
+    return readTableRuns(s_CURVE, NULL, InpEnd, nThreads);
+}
+
+//=============================================================================
+
+int  readTableRuns(int sect, char* used, char* end, int nThreads)
+//
+//  Input:   sect = s_CURVE or s_TIMESERIES
+//           used = TRUE for each table to be read (NULL if all are read)
+//           end = position in input file contents where reading stopped
+//           nThreads = number of threads to use
+//  Output:  returns FALSE if memory could not be allocated, TRUE otherwise
+//  Purpose: reads the data lines of a section's tables in parallel.
+//
+//  Each table's lines are read by a single thread in the order they appear
+//  in the file, so the table ends up the same as when read serially.
+//
+{
+    int i, k, m, n;
+    int* order;                        // runs sorted by table
+    int* group;                        // start of each table's runs in order
+
+    // --- find runs of lines for the tables to be read
+    if ( NumTableLines == 0 ) return TRUE;
+    order = (int *) calloc(NumTableLines, sizeof(int));
+    group = (int *) calloc(NumTableLines + 1, sizeof(int));
+    if ( order == NULL || group == NULL )
+    {
+        FREE(order);
+        FREE(group);
+        return FALSE;
+    }
+    m = 0;
+    for (i = 0; i < NumTableLines; i++)
+    {
+        k = TableLines[i].table;
+        if ( TableLines[i].sect != sect || k < 0 ) continue;
+        if ( TableLines[i].start >= end ) continue;
+        if ( used == NULL || used[k] ) order[m++] = i;
+    }
+
+    // --- sort runs by table and then by position in file
+    //     and note where each table's runs begin
+    qsort(order, m, sizeof(int), compareTableLines);
+    n = 0;
+    for (i = 0; i < m; i++)
+    {
+        k = order[i];
+        if ( i == 0 || TableLines[k].table != TableLines[order[i-1]].table )
+            group[n++] = i;
+    }
+    group[n] = m;
+
+    // --- read each table's runs of lines on one thread
+#pragma omp parallel for num_threads(nThreads) private(i) schedule(dynamic)
+    for (k = 0; k < n; k++)
+    {
+        for (i = group[k]; i < group[k+1]; i++)
+            readTableRun(&TableLines[order[i]]);
+    }
+    FREE(order);
+    FREE(group);
+
+    // --- sort any errors found by position in file
+    if ( NumTableErrors > 1 ) qsort(TableErrors, NumTableErrors,
+        sizeof(TTableError), compareTableErrors);
+    return TRUE;
+}
+
+//=============================================================================
+
+int  readTseriesLines(char* end, int errsum)
+//
+//  Input:   end = position in input file contents where reading stopped
+//           errsum = number of input errors found so far
+//  Output:  returns updated number of input errors
+//  Purpose: reads the data of the time series used by other objects and
+//           reports any errors found.
+//
+//  Time series are read once all other objects have been read, so that
+//  those that nothing refers to are never parsed.
+//
+{
+    int   i, k;
+    int   inperr;
+    char  line[MAXLINE+1];
+    char* pos;
+    char* used;                        // TRUE if time series is used
+
+    if ( Nobjects[TSERIES] == 0 ) return errsum;
+
+    // --- find which time series are used
+    used = (char *) calloc(Nobjects[TSERIES], sizeof(char));
+    if ( used == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return errsum;
+    }
+    for (k = 0; k < Nobjects[TSERIES]; k++)
+        used[k] = (char)(Tseries[k].refersTo >= 0);
+    for (i = 0; i < Nobjects[GAGE]; i++)
+    {
+        k = Gage[i].tSeries;
+        if ( Gage[i].dataSource == RAIN_TSERIES && k >= 0 ) used[k] = TRUE;
+    }
+
+    // --- read their data, discarding any curve errors already reported
+    FREE(TableErrors);
+    NumTableErrors = 0;
+    if ( !readTableRuns(s_TIMESERIES, used, end, getTableThreads()) )
+        report_writeErrorMsg(ERR_MEMORY, "");
+    FREE(used);
+
+    // --- report errors found
+    for (i = 0; i < NumTableErrors; i++)
+    {
+        pos = TableErrors[i].pos;
+        readLine(line, &pos);
+        inperr = error_setInpError(TableErrors[i].code, TableErrors[i].msg);
+        errsum++;
+        if ( errsum > MAXERRS )
+        {
+            report_writeLine(FMT19);
+            break;
+        }
+        report_writeInputErrorMsg(inperr, s_TIMESERIES, line,
+                                  TableErrors[i].lineCount);
+    }
+    return errsum;
+}
+
+//=============================================================================
+
+int  findTableLines()
+//
+//  Input:   none
+//  Output:  returns FALSE if memory could not be allocated, TRUE otherwise
+//  Purpose: splits the data lines of the curve and time series sections
+//           into runs of consecutive lines that belong to the same table.
+//
+{
+    char  line[MAXLINE+1];
+    char  wLine[MAXLINE+1];
+    char  lastID[MAXLINE+1] = "";
+    char* pos = InpText;
+    char* start;
+    int   sect = -1, table = -1;
+    long  tableLine = 0;
+    long  lineCount = 0;
+
+    for (;;)
+    {
+        if ( !isTableSection(sect) ) lineCount += skipLines(&pos);
+        start = pos;
+        if ( readLine(line, &pos) == NULL ) break;
+        lineCount++;
+        sstrncpy(wLine, line, MAXLINE);
+        Ntokens = getTokens(wLine);
+        if ( Ntokens == 0 || *Tok[0] == ';' ) continue;
+
+        // --- check for start of new section
+        if ( *Tok[0] == '[' )
+        {
+            sect = findmatch(Tok[0], SectWords);
+            if ( sect < 0 ) break;
+            lastID[0] = '\0';
+            continue;
+        }
+        if ( !isTableSection(sect) ) continue;
+
+        // --- start a new run if table ID differs from that of last line
+        if ( strcmp(Tok[0], lastID) != 0 )
+        {
+            sstrncpy(lastID, Tok[0], MAXLINE);
+            if ( sect == s_CURVE ) table = project_findObject(CURVE, Tok[0]);
+            else
+            {
+                // --- assign time series its ID name now in case its
+                //     data is never read
+                table = project_findObject(TSERIES, Tok[0]);
+                if ( table >= 0 && Tseries[table].ID == NULL )
+                    Tseries[table].ID = project_findID(TSERIES, Tok[0]);
+            }
+            if ( !addTableLines(start, sect, table, tableLine, lineCount) )
+                return FALSE;
+        }
+        TableLines[NumTableLines-1].count++;
+        tableLine++;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+int  addTableLines(char* start, int sect, int table, long first,
+                   long lineCount)
+//
+//  Input:   start = position of run's first line in input file contents
+//           sect = input section of run
+//           table = index of curve or time series (-1 if not found)
+//           first = table data line count of run's first line
+//           lineCount = file line count of run's first line
+//  Output:  returns FALSE if memory could not be allocated, TRUE otherwise
+//  Purpose: adds a new run of table data lines to the TableLines array.
+//
+{
+    TTableLines* lines;
+
+    if ( (NumTableLines & (NumTableLines - 1)) == 0 )
+    {
+        lines = (TTableLines *) realloc(TableLines,
+                2 * (size_t)MAX(NumTableLines, 1) * sizeof(TTableLines));
+        if ( lines == NULL ) return FALSE;
+        TableLines = lines;
+    }
+    lines = &TableLines[NumTableLines];
+    lines->start = start;
+    lines->sect = sect;
+    lines->table = table;
+    lines->first = first;
+    lines->count = 0;
+    lines->lineCount = lineCount;
+    NumTableLines++;
+    return TRUE;
+}
+
+//=============================================================================
+
+void  readTableRun(TTableLines* run)
+//
+//  Input:   run = a run of consecutive data lines for the same table
+//  Output:  none
+//  Purpose: parses each line in a run of curve or time series data lines.
+//
+{
+    char  line[MAXLINE+1];
+    char  wLine[MAXLINE+1];
+    char* pos = run->start;
+    char* start;
+    long  n = 0;
+    long  lineCount = run->lineCount - 1;
+    int   inperr;
+    TTableError* errors;
+
+    for (;;)
+    {
+        start = pos;
+        if ( n >= run->count || readLine(line, &pos) == NULL ) break;
+        lineCount++;
+        sstrncpy(wLine, line, MAXLINE);
+        Ntokens = getTokens(wLine);
+        if ( Ntokens == 0 || *Tok[0] == ';' ) continue;
+        inperr = parseLine(run->sect, line);
+        if ( inperr > 0 )
+        {
+            #pragma omp critical(tableErrors)
+            {
+                errors = (TTableError *) realloc(TableErrors,
+                         (NumTableErrors + 1) * sizeof(TTableError));
+                if ( errors )
+                {
+                    TableErrors = errors;
+                    errors = &TableErrors[NumTableErrors];
+                    errors->line = run->first + n;
+                    errors->lineCount = lineCount;
+                    errors->pos = start;
+                    errors->code = inperr;
+                    sstrncpy(errors->msg, ErrString, MAXMSG);
+                    NumTableErrors++;
+                }
+                else report_writeErrorMsg(ERR_MEMORY, "");
+            }
+        }
+        n++;
+    }
+}
+
+//=============================================================================
+
+int  compareTableLines(const void* a, const void* b)
+//
+//  Purpose: orders indexes of runs of table lines by section and table
+//           index (with runs for unknown tables last) and then by position
+//           in the input file.
+//
+{
+    const TTableLines* r1 = &TableLines[*(const int *)a];
+    const TTableLines* r2 = &TableLines[*(const int *)b];
+    unsigned int t1 = (unsigned int)r1->table;
+    unsigned int t2 = (unsigned int)r2->table;
+    if ( r1->sect != r2->sect && r1->table >= 0 && r2->table >= 0 )
+        return r1->sect < r2->sect ? -1 : 1;
+    if ( t1 != t2 ) return t1 < t2 ? -1 : 1;
+    if ( r1->first != r2->first ) return r1->first < r2->first ? -1 : 1;
+    return 0;
+}
+
+//=============================================================================
+
+int  compareTableErrors(const void* a, const void* b)
+//
+//  Purpose: orders table line errors by position in the input file.
+//
+{
+    long n1 = ((const TTableError *)a)->line;
+    long n2 = ((const TTableError *)b)->line;
+    if ( n1 != n2 ) return n1 < n2 ? -1 : 1;
+    return 0;
+}
+
+//=============================================================================
+
 int  addObject(int objType, char* id)
 //
 //  Input:   objType = object type index
@@ -641,6 +1269,9 @@ int  parseLine(int sect, char *line)
       case s_INLET_USAGE:
         return inlet_readUsageParams(Tok, Ntokens);
 
+      case s_HEAT_SENS:
+        return temprout_readSensParams(Tok, Ntokens);
+
       default: return 0;
     }
 }
@@ -885,6 +1516,7 @@ int  getDouble(char *s, double *y)
 //
 {
     char *endptr;
+    if ( getFastDouble(s, y) ) return(1);
     *y = strtod(s, &endptr);
     if (*endptr > 0) return(0);
     return(1);
@@ -892,6 +1524,38 @@ int  getDouble(char *s, double *y)
 
 //=============================================================================
 
+int  getFastDouble(char *s, double *y)
+//
+//  Input:   s = a character string
+//  Output:  y = converted value of s,
+//           returns 1 if s is a plain decimal number that could be
+//           converted exactly, 0 if strtod() must be used instead
+//  Purpose: quickly converts a simple decimal string to a double.
+//
+//  Numbers with at most 15 significant digits and no more than 22 decimal
+//  places are an integer divided by an exact power of 10, so a single
+//  division gives the same correctly rounded value as strtod().
+//
+{
+    double x = 0.0;
+    int    neg = 0, digits = 0, places = 0;
+    char   *c = s;
+
+    if ( *c == '-' || *c == '+' ) neg = (*c++ == '-');
+    for ( ; *c >= '0' && *c <= '9'; c++, digits++ ) x = 10.0*x + (*c - '0');
+    if ( *c == '.' )
+    {
+        for ( c++; *c >= '0' && *c <= '9'; c++, digits++, places++ )
+            x = 10.0*x + (*c - '0');
+    }
+    if ( *c != '\0' || digits == 0 || digits > 15 || places > 22 ) return 0;
+    if ( places > 0 ) x /= Pow10[places];
+    *y = neg ? -x : x;
+    return 1;
+}
+
+//=============================================================================
+
 int  getTokens(char *s)
 //
 //  Input:   s = a character string
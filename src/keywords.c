@@ -97,6 +97,9 @@ char* OptionWords[]        = { w_FLOW_UNITS,        w_INFIL_MODEL,
                                w_SYS_FLOW_TOL,      w_LAT_FLOW_TOL,
                                w_IGNORE_RDII,       w_MIN_ROUTE_STEP,
                                w_NUM_THREADS,       w_SURCHARGE_METHOD,
+                               w_XSECT_TABLES,      w_SOLVER_METHOD,
+                               w_RATE_LEVELS,       w_FRIC_TOL,
+                               w_INPUT_CACHE,
 							   /* START modification by Peter Schlagbauer | TUGraz; Revised by Alejandro Figueroa | Eawag */
 		       	               w_TEMP_MODEL,			   
 			                   w_DENSITY,			w_SPEC_HEAT_CAPACITY,
@@ -157,9 +160,11 @@ char* SectWords[]          = { ws_TITLE,          ws_OPTION,
                                ws_LID_USAGE,      ws_GWF,
                                ws_ADJUST,         ws_EVENT,
                                ws_STREET,         ws_INLET_USAGE,
-                               ws_INLET,          NULL};
+                               ws_INLET,          ws_HEAT_SENS,
+                               NULL};
 char* SnowmeltWords[]      = { w_PLOWABLE, w_IMPERV, w_PERV, w_REMOVAL, NULL};
 char* SurchargeWords[]     = { w_EXTRAN, w_SLOT, NULL};
+char* SolverWords[]        = { w_PICARD, w_NEWTON, NULL};
 char* TempKeyWords[]       = { w_TIMESERIES, w_FILE, w_WINDSPEED, w_SNOWMELT,
                                w_ADC, NULL};
 char* TransectKeyWords[]   = { w_NC, w_X1, w_GR, NULL};
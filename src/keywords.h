@@ -62,6 +62,7 @@ extern char* RuleKeyWords[];
 extern char* SectWords[];
 extern char* SnowmeltWords[];
 extern char* SurchargeWords[];
+extern char* SolverWords[];
 extern char* TempKeyWords[];
 extern char* TransectKeyWords[];
 extern char* TreatTypeWords[];
@@ -783,6 +783,9 @@ double landuse_getExternalBuildup(int i, int p, double buildup, double tStep)
     // --- get buildup rate (mass/unit/day) over the interval
     if ( ts >= 0 )
     {        
+        // --- time series lookups update the series' current position
+        //     so they are made by one thread at a time
+        #pragma omp critical(tseries)
         rate = sf * table_tseriesLookup(&Tseries[ts],
                getDateTime(NewRunoffTime), FALSE);
     }
@@ -78,6 +78,7 @@
 #include <math.h>
 #include "headers.h"
 #include "lid.h"
+#include "mempool.h"
 
 #define ERR_PAVE_LAYER " - check pavement layer parameters"
 #define ERR_SOIL_LAYER " - check soil layer parameters"
@@ -150,10 +151,6 @@ static int        LidCount;            // number of LID processes
 static TLidGroup* LidGroups;           // array of LID process groups
 static int        GroupCount;          // number of LID groups (subcatchments)
 
-static double     EvapRate;            // evaporation rate (ft/s)
-static double     NativeInfil;         // native soil infil. rate (ft/s)
-static double     MaxNativeInfil;      // native soil infil. rate limit (ft/s)
-
 //-----------------------------------------------------------------------------
 //  Imported Variables (from SUBCATCH.C)
 //-----------------------------------------------------------------------------
@@ -166,6 +163,8 @@ extern double     VlidIn;              // impervious area flow to LID units
 extern double     VlidOut;             // surface outflow from LID units
 extern double     VlidDrain;           // drain outflow from LID units
 extern double     VlidReturn;          // LID outflow returned to pervious area
+#pragma omp threadprivate(Vevap, Vpevap, Vinfil, VlidInfil, VlidIn, VlidOut, \
+    VlidDrain, VlidReturn)
 extern char       HasWetLids;          // TRUE if any LIDs are wet
                                        // (from RUNOFF.C)
 
@@ -225,11 +224,13 @@ static double getImpervAreaRunoff(int j);
 static double getPervAreaRunoff(int j);
 static double getSurfaceDepth(int subcatch);
 static double getRainInflow(int j, TLidUnit*  lidUnit);
-static void   findNativeInfil(int j, double tStep);
+static void   findNativeInfil(int j, double tStep, double* nativeInfil,
+              double* maxNativeInfil);
 
 
 static void   evalLidUnit(int j, TLidUnit* lidUnit, double lidArea,
-              double lidInflow, double tStep, double *qRunoff,
+              double lidInflow, double evapRate, double nativeInfil,
+              double maxNativeInfil, double tStep, double *qRunoff,
               double *qDrain, double *qReturn);
 
 //=============================================================================
@@ -321,32 +322,28 @@ void lid_delete()
 
 void freeLidGroup(int j)
 //
-//  Purpose: frees all LID units associated with a subcatchment.
+//  Purpose: closes the detailed report files of all LID units associated
+//           with a subcatchment.
 //  Input:   j = group (or subcatchment) index
 //  Output:  none
 //
+//  NOTE: the group and its units come from the project's memory pool and
+//        are freed along with it.
+//
 {
     TLidGroup  lidGroup = LidGroups[j];
     TLidList*  lidList;
     TLidUnit*  lidUnit;
-    TLidList*  nextLidUnit;
 
     if ( lidGroup == NULL ) return;
     lidList = lidGroup->lidList;
     while (lidList)
     {
         lidUnit = lidList->lidUnit;
-        if ( lidUnit->rptFile )
-        {
-            if ( lidUnit->rptFile->file ) fclose(lidUnit->rptFile->file);
-            free(lidUnit->rptFile);
-        }
-        nextLidUnit = lidList->nextLidUnit;
-        free(lidUnit);
-        free(lidList);
-        lidList = nextLidUnit;
+        if ( lidUnit->rptFile && lidUnit->rptFile->file )
+            fclose(lidUnit->rptFile->file);
+        lidList = lidList->nextLidUnit;
     }
-    free(lidGroup);
     LidGroups[j] = NULL;
 }
 
@@ -519,24 +516,20 @@ int addLidUnit(int j, int k, int n, double x[], char* fname,
     lidGroup = LidGroups[j];
     if ( !lidGroup )
     {
-        lidGroup = (struct LidGroup *) malloc(sizeof(struct LidGroup));
+        lidGroup = AllocArray(struct LidGroup, 1);
         if ( !lidGroup ) return error_setInpError(ERR_MEMORY, "");
         lidGroup->lidList = NULL;
         LidGroups[j] = lidGroup;
     }
 
     //... create a new LID unit to add to the group
-    lidUnit = (TLidUnit *) malloc(sizeof(TLidUnit));
+    lidUnit = AllocArray(TLidUnit, 1);
     if ( !lidUnit ) return error_setInpError(ERR_MEMORY, "");
     lidUnit->rptFile = NULL;
 
     //... add the LID unit to the group
-    lidList = (TLidList *) malloc(sizeof(TLidList));
-    if ( !lidList )
-    {
-        free(lidUnit);
-        return error_setInpError(ERR_MEMORY, "");
-    }
+    lidList = AllocArray(TLidList, 1);
+    if ( !lidList ) return error_setInpError(ERR_MEMORY, "");
     lidList->lidUnit = lidUnit;
     lidList->nextLidUnit = lidGroup->lidList;
     lidGroup->lidList = lidList;
@@ -568,7 +561,7 @@ int createLidRptFile(TLidUnit* lidUnit, char* fname)
 {
     TLidRptFile* rptFile;
     
-    rptFile = (TLidRptFile *) malloc(sizeof(TLidRptFile));
+    rptFile = AllocArray(TLidRptFile, 1);
     if ( rptFile == NULL ) return 0;
     lidUnit->rptFile = rptFile;
     rptFile->file = fopen(fname, "wt");
@@ -1641,6 +1634,9 @@ void lid_getRunoff(int j, double tStep)
     double qRunoff = 0.0;         // surface runoff from all LID units (cfs)
     double qDrain = 0.0;          // drain flow from all LID units (cfs)
     double qReturn = 0.0;         // LID outflow returned to pervious area (cfs) 
+    double evapRate;              // evaporation rate (ft/s)
+    double nativeInfil;           // native soil infil. rate (ft/s)
+    double maxNativeInfil;        // native soil infil. rate limit (ft/s)
 
     //... return if there are no LID's
     theLidGroup = LidGroups[j];
@@ -1649,11 +1645,11 @@ void lid_getRunoff(int j, double tStep)
     if ( !lidList ) return;
 
     //... determine if evaporation can occur
-    EvapRate = Evap.rate;
-    if ( Evap.dryOnly && Subcatch[j].rainfall > 0.0 ) EvapRate = 0.0;
+    evapRate = Evap.rate;
+    if ( Evap.dryOnly && Subcatch[j].rainfall > 0.0 ) evapRate = 0.0;
 
     //... find subcatchment's infiltration rate into native soil
-    findNativeInfil(j, tStep);
+    findNativeInfil(j, tStep, &nativeInfil, &maxNativeInfil);
 
     //... get impervious and pervious area runoff from non-LID
     //    portion of subcatchment (cfs)
@@ -1692,7 +1688,8 @@ void lid_getRunoff(int j, double tStep)
             //... evaluate the LID unit's performance, updating the LID group's
             //    total surface runoff, drain flow, and flow returned to
             //    pervious area 
-            evalLidUnit(j, lidUnit, lidArea, lidInflow, tStep,
+            evalLidUnit(j, lidUnit, lidArea, lidInflow, evapRate,
+                        nativeInfil, maxNativeInfil, tStep,
                         &qRunoff, &qDrain, &qReturn);
         }
         lidList = lidList->nextLidUnit;
@@ -1710,13 +1707,15 @@ void lid_getRunoff(int j, double tStep)
 
 //=============================================================================
 
-void findNativeInfil(int j, double tStep)
+void findNativeInfil(int j, double tStep, double* nativeInfil,
+                     double* maxNativeInfil)
 //
 //  Purpose: determines a subcatchment's current infiltration rate into
 //           its native soil.
 //  Input:   j = subcatchment index
 //           tStep    = time step (sec)
-//  Output:  sets values for module-level variables NativeInfil
+//  Output:  nativeInfil    = native soil infil. rate (ft/s)
+//           maxNativeInfil = groundwater-imposed limit on that rate (ft/s)
 //
 {
     double nonLidArea;
@@ -1725,24 +1724,24 @@ void findNativeInfil(int j, double tStep)
     nonLidArea = Subcatch[j].area - Subcatch[j].lidArea;
     if ( nonLidArea > 0.0 && Subcatch[j].fracImperv < 1.0 )
     {
-        NativeInfil = Vinfil / nonLidArea / tStep;
+        *nativeInfil = Vinfil / nonLidArea / tStep;
     }
 
     //... otherwise find infil. rate for the subcatchment's rainfall + runon
     else
     {
-        NativeInfil = infil_getInfil(j, tStep,
-                                     Subcatch[j].rainfall,
-                                     Subcatch[j].runon,
-                                     getSurfaceDepth(j));
+        *nativeInfil = infil_getInfil(j, tStep,
+                                      Subcatch[j].rainfall,
+                                      Subcatch[j].runon,
+                                      getSurfaceDepth(j));
     }
 
     //... see if there is any groundwater-imposed limit on infil.
     if ( !IgnoreGwater && Subcatch[j].groundwater )
     {
-        MaxNativeInfil = Subcatch[j].groundwater->maxInfilVol / tStep;
+        *maxNativeInfil = Subcatch[j].groundwater->maxInfilVol / tStep;
     }
-    else MaxNativeInfil = BIG;
+    else *maxNativeInfil = BIG;
 }
 
 //=============================================================================
@@ -1821,13 +1820,17 @@ double getPervAreaRunoff(int j)
 //=============================================================================
 
 void evalLidUnit(int j, TLidUnit* lidUnit, double lidArea, double lidInflow,
-    double tStep, double *qRunoff, double *qDrain, double *qReturn)
+    double evapRate, double nativeInfil, double maxNativeInfil, double tStep,
+    double *qRunoff, double *qDrain, double *qReturn)
 //
 //  Purpose: evaluates performance of a specific LID unit over current time step.
 //  Input:   j         = subcatchment index
 //           lidUnit   = ptr. to LID unit being evaluated
 //           lidArea   = area of LID unit
 //           lidInflow = inflow to LID unit (ft/s)
+//           evapRate  = evaporation rate (ft/s)
+//           nativeInfil    = native soil infil. rate (ft/s)
+//           maxNativeInfil = native soil infil. rate limit (ft/s)
 //           tStep     = time step (sec)
 //  Output:  qRunoff   = sum of surface runoff from all LIDs (cfs)
 //           qDrain    = sum of drain flows from all LIDs (cfs)
@@ -1835,6 +1838,7 @@ void evalLidUnit(int j, TLidUnit* lidUnit, double lidArea, double lidInflow,
 //
 {
     TLidProc* lidProc;       // LID process associated with lidUnit
+    TLidState lidState;      // work area for evaluating lidUnit
     double lidRunoff,        // surface runoff from LID unit (cfs)
            lidEvap,          // evaporation rate from LID unit (ft/s)
            lidInfil,         // infiltration rate from LID unit (ft/s)
@@ -1848,9 +1852,10 @@ void evalLidUnit(int j, TLidUnit* lidUnit, double lidArea, double lidInflow,
     lidInfil = 0.0;
 
     //... find surface runoff from the LID unit (in cfs)
-    lidRunoff = lidproc_getOutflow(lidUnit, lidProc, lidInflow, EvapRate,
-                                  NativeInfil, MaxNativeInfil, tStep,
-                                  &lidEvap, &lidInfil, &lidDrain) * lidArea;
+    lidRunoff = lidproc_getOutflow(&lidState, lidUnit, lidProc, lidInflow,
+                                   evapRate, nativeInfil, maxNativeInfil,
+                                   tStep, &lidEvap, &lidInfil, &lidDrain) *
+                lidArea;
     
     //... convert drain flow to CFS
     lidDrain *= lidArea;
@@ -1894,7 +1899,7 @@ void evalLidUnit(int j, TLidUnit* lidUnit, double lidArea, double lidInflow,
     else lidUnit->dryTime += tStep;
 
     //... update LID water balance and save results
-    lidproc_saveResults(lidUnit, UCF(RAINFALL), UCF(RAINDEPTH));
+    lidproc_saveResults(&lidState, lidUnit, UCF(RAINFALL), UCF(RAINDEPTH));
 
     //... update LID group totals
     *qRunoff += lidRunoff;
@@ -201,6 +201,38 @@ typedef struct
     TWaterBalance  waterBalance;     // water balance quantites
 }  TLidUnit;
 
+// LID Computational State - work area used by lidproc_getOutflow
+// to evaluate a single LID unit over a time step
+typedef struct
+{
+    TLidUnit* lidUnit;            // ptr. to a subcatchment's LID unit
+    TLidProc* lidProc;            // ptr. to a LID process
+
+    double    tStep;              // current time step (sec)
+    double    evapRate;           // evaporation rate (ft/s)
+    double    maxNativeInfil;     // native soil infil. rate limit (ft/s)
+
+    double    surfaceInflow;      // precip. + runon to LID unit (ft/s)
+    double    surfaceInfil;       // infil. rate from surface layer (ft/s)
+    double    surfaceEvap;        // evap. rate from surface layer (ft/s)
+    double    surfaceOutflow;     // outflow from surface layer (ft/s)
+    double    surfaceVolume;      // volume in surface storage (ft)
+
+    double    paveEvap;           // evap. from pavement layer (ft/s)
+    double    pavePerc;           // percolation from pavement layer (ft/s)
+    double    paveVolume;         // volume stored in pavement layer  (ft)
+
+    double    soilEvap;           // evap. from soil layer (ft/s)
+    double    soilPerc;           // percolation from soil layer (ft/s)
+    double    soilVolume;         // volume in soil/pavement storage (ft)
+
+    double    storageInflow;      // inflow rate to storage layer (ft/s)
+    double    storageExfil;       // exfil. rate from storage layer (ft/s)
+    double    storageEvap;        // evap.rate from storage layer (ft/s)
+    double    storageDrain;       // underdrain flow rate layer (ft/s)
+    double    storageVolume;      // volume in storage layer (ft)
+}  TLidState;
+
 //-----------------------------------------------------------------------------
 //   LID Methods
 //-----------------------------------------------------------------------------
@@ -229,11 +261,12 @@ void     lid_writeWaterBalance(void);
 
 void     lidproc_initWaterBalance(TLidUnit *lidUnit, double initVol);
 
-double   lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc,
-         double inflow, double evap, double infil, double maxInfil,
-         double tStep, double* lidEvap, double* lidInfil, double* lidDrain);
+double   lidproc_getOutflow(TLidState* st, TLidUnit* lidUnit,
+         TLidProc* lidProc, double inflow, double evap, double infil,
+         double maxInfil, double tStep, double* lidEvap, double* lidInfil,
+         double* lidDrain);
 
-void     lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall,
-         double ucfRainDepth);
+void     lidproc_saveResults(TLidState* st, TLidUnit* lidUnit,
+         double ucfRainfall, double ucfRainDepth);
 
 #endif
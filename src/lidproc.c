@@ -103,38 +103,6 @@ enum LidRptVars {
 //-----------------------------------------------------------------------------
 extern char HasWetLids;      // TRUE if any LIDs are wet (declared in runoff.c)
 
-//-----------------------------------------------------------------------------
-//  Local Variables
-//-----------------------------------------------------------------------------
-static TLidUnit*  theLidUnit;     // ptr. to a subcatchment's LID unit
-static TLidProc*  theLidProc;     // ptr. to a LID process
-
-static double     Tstep;          // current time step (sec)
-static double     EvapRate;       // evaporation rate (ft/s)
-static double     MaxNativeInfil; // native soil infil. rate limit (ft/s)
-
-static double     SurfaceInflow;  // precip. + runon to LID unit (ft/s)
-static double     SurfaceInfil;   // infil. rate from surface layer (ft/s)
-static double     SurfaceEvap;    // evap. rate from surface layer (ft/s)
-static double     SurfaceOutflow; // outflow from surface layer (ft/s)
-static double     SurfaceVolume;  // volume in surface storage (ft)
-
-static double     PaveEvap;       // evap. from pavement layer (ft/s)
-static double     PavePerc;       // percolation from pavement layer (ft/s)
-static double     PaveVolume;     // volume stored in pavement layer  (ft)
-
-static double     SoilEvap;       // evap. from soil layer (ft/s)
-static double     SoilPerc;       // percolation from soil layer (ft/s)
-static double     SoilVolume;     // volume in soil/pavement storage (ft)
-
-static double     StorageInflow;  // inflow rate to storage layer (ft/s)
-static double     StorageExfil;   // exfil. rate from storage layer (ft/s)
-static double     StorageEvap;    // evap.rate from storage layer (ft/s)
-static double     StorageDrain;   // underdrain flow rate layer (ft/s)
-static double     StorageVolume;  // volume in storage layer (ft)
-
-static double     Xold[MAX_LAYERS];  // previous moisture level in LID layers
-
 //-----------------------------------------------------------------------------
 //  External Functions (declared in lid.h)
 //-----------------------------------------------------------------------------
@@ -145,33 +113,35 @@ static double     Xold[MAX_LAYERS];  // previous moisture level in LID layers
 //-----------------------------------------------------------------------------
 // Local Functions
 //-----------------------------------------------------------------------------
-static void   barrelFluxRates(double x[], double f[]);
-static void   biocellFluxRates(double x[], double f[]);
-static void   greenRoofFluxRates(double x[], double f[]);
-static void   pavementFluxRates(double x[], double f[]);
-static void   trenchFluxRates(double x[], double f[]);
-static void   swaleFluxRates(double x[], double f[]);
-static void   roofFluxRates(double x[], double f[]);
-
-static double getSurfaceOutflowRate(double depth);
-static double getSurfaceOverflowRate(double* surfaceDepth);
-static double getPavementPermRate(void);
-static double getSoilPercRate(double theta);
-static double getStorageExfilRate(void);
-static double getStorageDrainRate(double storageDepth, double soilTheta,
-              double paveDepth, double surfaceDepth);
-static double getDrainMatOutflow(double depth);
-static void   getEvapRates(double surfaceVol, double paveVol,
+static void   barrelFluxRates(TLidState* st, double x[], double f[]);
+static void   biocellFluxRates(TLidState* st, double x[], double f[]);
+static void   greenRoofFluxRates(TLidState* st, double x[], double f[]);
+static void   pavementFluxRates(TLidState* st, double x[], double f[]);
+static void   trenchFluxRates(TLidState* st, double x[], double f[]);
+static void   swaleFluxRates(TLidState* st, double x[], double f[]);
+static void   roofFluxRates(TLidState* st, double x[], double f[]);
+
+static double getSurfaceOutflowRate(TLidState* st, double depth);
+static double getSurfaceOverflowRate(TLidState* st, double* surfaceDepth);
+static double getPavementPermRate(TLidState* st);
+static double getSoilPercRate(TLidState* st, double theta);
+static double getStorageExfilRate(TLidState* st);
+static double getStorageDrainRate(TLidState* st, double storageDepth,
+              double soilTheta, double paveDepth, double surfaceDepth);
+static double getDrainMatOutflow(TLidState* st, double depth);
+static void   getEvapRates(TLidState* st, double surfaceVol, double paveVol,
               double soilVol, double storageVol, double pervFrac);
 
-static void   updateWaterBalance(TLidUnit *lidUnit, double inflow,
-                                 double evap, double infil, double surfFlow,
-                                 double drainFlow, double storage);
+static void   updateWaterBalance(TLidState* st, TLidUnit *lidUnit,
+                                 double inflow, double evap, double infil,
+                                 double surfFlow, double drainFlow,
+                                 double storage);
 
-static int    modpuls_solve(int n, double* x, double* xOld, double* xPrev,
-                            double* xMin, double* xMax, double* xTol,
-                            double* qOld, double* q, double dt, double omega,
-                            void (*derivs)(double*, double*));
+static int    modpuls_solve(TLidState* st, int n, double* x, double* xOld,
+                            double* xPrev, double* xMin, double* xMax,
+                            double* xTol, double* qOld, double* q, double dt,
+                            double omega,
+                            void (*derivs)(TLidState*, double*, double*));
 
 //=============================================================================
 
@@ -194,13 +164,14 @@ void lidproc_initWaterBalance(TLidUnit *lidUnit, double initVol)
 
 //=============================================================================
 
-double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
-                          double evap, double infil, double maxInfil,
-                          double tStep, double* lidEvap,
+double lidproc_getOutflow(TLidState* st, TLidUnit* lidUnit, TLidProc* lidProc,
+                          double inflow, double evap, double infil,
+                          double maxInfil, double tStep, double* lidEvap,
                           double* lidInfil, double* lidDrain)
 //
 //  Purpose: computes runoff outflow from a single LID unit.
-//  Input:   lidUnit  = ptr. to specific LID unit being analyzed
+//  Input:   st       = work area for the LID unit's computations
+//           lidUnit  = ptr. to specific LID unit being analyzed
 //           lidProc  = ptr. to generic LID process of the LID unit
 //           inflow   = runoff rate captured by LID unit (ft/s)
 //           evap     = potential evaporation rate (ft/s)
@@ -228,81 +199,80 @@ double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
     double omega = 0.0;          // integration time weighting
 
     //... define a pointer to function that computes flux rates through the LID
-    void (*fluxRates) (double *, double *) = NULL;
+    void (*fluxRates) (TLidState *, double *, double *) = NULL;
 
     //... save references to the LID process and LID unit
-    theLidProc = lidProc;
-    theLidUnit = lidUnit;
+    st->lidProc = lidProc;
+    st->lidUnit = lidUnit;
 
-    //... save evap, max. infil. & time step to shared variables
-    EvapRate = evap;
-    MaxNativeInfil = maxInfil;
-    Tstep = tStep;
+    //... save evap, max. infil. & time step to the work area
+    st->evapRate = evap;
+    st->maxNativeInfil = maxInfil;
+    st->tStep = tStep;
 
     //... store current moisture levels in vector x
-    x[SURF] = theLidUnit->surfaceDepth;
-    x[SOIL] = theLidUnit->soilMoisture;
-    x[STOR] = theLidUnit->storageDepth;
-    x[PAVE] = theLidUnit->paveDepth;
+    x[SURF] = st->lidUnit->surfaceDepth;
+    x[SOIL] = st->lidUnit->soilMoisture;
+    x[STOR] = st->lidUnit->storageDepth;
+    x[PAVE] = st->lidUnit->paveDepth;
 
     //... initialize layer moisture volumes, flux rates and moisture limits
-    SurfaceVolume  = 0.0;
-    PaveVolume     = 0.0;
-    SoilVolume     = 0.0;
-    StorageVolume  = 0.0;
-    SurfaceInflow  = inflow;
-    SurfaceInfil   = 0.0;
-    SurfaceEvap    = 0.0;
-    SurfaceOutflow = 0.0;
-    PaveEvap       = 0.0;
-    PavePerc       = 0.0;
-    SoilEvap       = 0.0;
-    SoilPerc       = 0.0;
-    StorageInflow  = 0.0;
-    StorageExfil   = 0.0;
-    StorageEvap    = 0.0;
-    StorageDrain   = 0.0;
+    st->surfaceVolume  = 0.0;
+    st->paveVolume     = 0.0;
+    st->soilVolume     = 0.0;
+    st->storageVolume  = 0.0;
+    st->surfaceInflow  = inflow;
+    st->surfaceInfil   = 0.0;
+    st->surfaceEvap    = 0.0;
+    st->surfaceOutflow = 0.0;
+    st->paveEvap       = 0.0;
+    st->pavePerc       = 0.0;
+    st->soilEvap       = 0.0;
+    st->soilPerc       = 0.0;
+    st->storageInflow  = 0.0;
+    st->storageExfil   = 0.0;
+    st->storageEvap    = 0.0;
+    st->storageDrain   = 0.0;
     for (i = 0; i < MAX_LAYERS; i++)
     {
         f[i] = 0.0;
-        fOld[i] = theLidUnit->oldFluxRates[i];
+        fOld[i] = st->lidUnit->oldFluxRates[i];
         xMin[i] = 0.0;
         xMax[i] = BIG;
-        Xold[i] = x[i];
     }
 
     //... find Green-Ampt infiltration from surface layer
-    if ( theLidProc->lidType == POROUS_PAVEMENT ) SurfaceInfil = 0.0;
-    else if ( theLidUnit->soilInfil.Ks > 0.0 )
+    if ( st->lidProc->lidType == POROUS_PAVEMENT ) st->surfaceInfil = 0.0;
+    else if ( st->lidUnit->soilInfil.Ks > 0.0 )
     {
-        SurfaceInfil =
-            grnampt_getInfil(&theLidUnit->soilInfil, Tstep,
-                             SurfaceInflow, theLidUnit->surfaceDepth,
+        st->surfaceInfil =
+            grnampt_getInfil(&st->lidUnit->soilInfil, st->tStep,
+                             st->surfaceInflow, st->lidUnit->surfaceDepth,
                              MOD_GREEN_AMPT);
     }
-    else SurfaceInfil = infil;
+    else st->surfaceInfil = infil;
 
     //... set moisture limits for soil & storage layers
-    if ( theLidProc->soil.thickness > 0.0 )
+    if ( st->lidProc->soil.thickness > 0.0 )
     {
-        xMin[SOIL] = theLidProc->soil.wiltPoint;
-        xMax[SOIL] = theLidProc->soil.porosity;
+        xMin[SOIL] = st->lidProc->soil.wiltPoint;
+        xMax[SOIL] = st->lidProc->soil.porosity;
     }
-    if ( theLidProc->pavement.thickness > 0.0 )
+    if ( st->lidProc->pavement.thickness > 0.0 )
     {
-        xMax[PAVE] = theLidProc->pavement.thickness;
+        xMax[PAVE] = st->lidProc->pavement.thickness;
     }
-    if ( theLidProc->storage.thickness > 0.0 )
+    if ( st->lidProc->storage.thickness > 0.0 )
     {
-        xMax[STOR] = theLidProc->storage.thickness;
+        xMax[STOR] = st->lidProc->storage.thickness;
     }
-    if ( theLidProc->lidType == GREEN_ROOF )
+    if ( st->lidProc->lidType == GREEN_ROOF )
     {
-        xMax[STOR] = theLidProc->drainMat.thickness;
+        xMax[STOR] = st->lidProc->drainMat.thickness;
     }
 
     //... determine which flux rate function to use
-    switch (theLidProc->lidType)
+    switch (st->lidProc->lidType)
     {
     case BIO_CELL:
     case RAIN_GARDEN:     fluxRates = &biocellFluxRates;   break;
@@ -318,7 +288,7 @@ double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
     }
 
     //... update moisture levels and flux rates over the time step
-    i = modpuls_solve(MAX_LAYERS, x, xOld, xPrev, xMin, xMax, xTol,
+    i = modpuls_solve(st, MAX_LAYERS, x, xOld, xPrev, xMin, xMax, xTol,
                      fOld, f, tStep, omega, fluxRates);
 
 /** For debugging only ********************************************
@@ -329,39 +299,41 @@ double lidproc_getOutflow(TLidUnit* lidUnit, TLidProc* lidProc, double inflow,
             theDate, theTime);
         fprintf(Frpt.file,
         "\n              for LID %s placed in subcatchment %s.",
-            theLidProc->ID, theSubcatch->ID);
+            st->lidProc->ID, theSubcatch->ID);
     }
 *******************************************************************/
 
     //... add any surface overflow to surface outflow
-    if ( theLidProc->surface.canOverflow || theLidUnit->fullWidth == 0.0 )
+    if ( st->lidProc->surface.canOverflow || st->lidUnit->fullWidth == 0.0 )
     {
-        SurfaceOutflow += getSurfaceOverflowRate(&x[SURF]);
+        st->surfaceOutflow += getSurfaceOverflowRate(st, &x[SURF]);
     }
 
     //... save updated results
-    theLidUnit->surfaceDepth = x[SURF];
-    theLidUnit->paveDepth    = x[PAVE];
-    theLidUnit->soilMoisture = x[SOIL];
-    theLidUnit->storageDepth = x[STOR];
-    for (i = 0; i < MAX_LAYERS; i++) theLidUnit->oldFluxRates[i] = f[i];
+    st->lidUnit->surfaceDepth = x[SURF];
+    st->lidUnit->paveDepth    = x[PAVE];
+    st->lidUnit->soilMoisture = x[SOIL];
+    st->lidUnit->storageDepth = x[STOR];
+    for (i = 0; i < MAX_LAYERS; i++) st->lidUnit->oldFluxRates[i] = f[i];
 
     //... assign values to LID unit evaporation, infiltration & drain flow
-    *lidEvap = SurfaceEvap + PaveEvap + SoilEvap + StorageEvap;
-    *lidInfil = StorageExfil;
-    *lidDrain = StorageDrain;
+    *lidEvap = st->surfaceEvap + st->paveEvap + st->soilEvap + st->storageEvap;
+    *lidInfil = st->storageExfil;
+    *lidDrain = st->storageDrain;
 
     //... return surface outflow (per unit area) from unit
-    return SurfaceOutflow;
+    return st->surfaceOutflow;
 }
 
 //=============================================================================
 
-void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDepth)
+void lidproc_saveResults(TLidState* st, TLidUnit* lidUnit, double ucfRainfall,
+                         double ucfRainDepth)
 //
 //  Purpose: updates the mass balance for an LID unit and saves
 //           current flux rates to the LID report file.
-//  Input:   lidUnit = ptr. to LID unit
+//  Input:   st      = work area used by lidproc_getOutflow for the unit
+//           lidUnit = ptr. to LID unit
 //           ucfRainfall = units conversion factor for rainfall rate
 //           ucfDepth = units conversion factor for rainfall depth
 //  Output:  none
@@ -376,52 +348,60 @@ void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDe
     double elapsedHrs;                 // elapsed hours
 
     //... find total evap. rate and stored volume
-    totalEvap = SurfaceEvap + PaveEvap + SoilEvap + StorageEvap; 
-    totalVolume = SurfaceVolume + PaveVolume + SoilVolume + StorageVolume;
+    totalEvap = st->surfaceEvap + st->paveEvap + st->soilEvap +
+                st->storageEvap;
+    totalVolume = st->surfaceVolume + st->paveVolume + st->soilVolume +
+                  st->storageVolume;
 
     //... update mass balance totals
-    updateWaterBalance(theLidUnit, SurfaceInflow, totalEvap, StorageExfil,
-                       SurfaceOutflow, StorageDrain, totalVolume);
+    updateWaterBalance(st, lidUnit, st->surfaceInflow, totalEvap,
+                       st->storageExfil, st->surfaceOutflow, st->storageDrain,
+                       totalVolume);
 
     //... check if dry-weather conditions hold
-    if ( SurfaceInflow  < MINFLOW &&
-         SurfaceOutflow < MINFLOW &&
-         StorageDrain   < MINFLOW &&
-         StorageExfil   < MINFLOW &&
+    if ( st->surfaceInflow  < MINFLOW &&
+         st->surfaceOutflow < MINFLOW &&
+         st->storageDrain   < MINFLOW &&
+         st->storageExfil   < MINFLOW &&
          totalEvap      < MINFLOW
        ) isDry = TRUE;
 
-    //... update status of HasWetLids
-    if ( !isDry ) HasWetLids = TRUE;
+    //... update status of HasWetLids (LID units of different
+    //    subcatchments can be evaluated concurrently)
+    if ( !isDry )
+    {
+        #pragma omp atomic write
+        HasWetLids = TRUE;
+    }
 
     //... write results to LID report file
     if ( lidUnit->rptFile )
     {
         //... convert rate results to original units (in/hr or mm/hr)
         ucf = ucfRainfall;
-        rptVars[SURF_INFLOW]  = SurfaceInflow*ucf;
+        rptVars[SURF_INFLOW]  = st->surfaceInflow*ucf;
         rptVars[TOTAL_EVAP]   = totalEvap*ucf;
-        rptVars[SURF_INFIL]   = SurfaceInfil*ucf;
-        rptVars[PAVE_PERC]    = PavePerc*ucf;
-        rptVars[SOIL_PERC]    = SoilPerc*ucf;
-        rptVars[STOR_EXFIL]   = StorageExfil*ucf;
-        rptVars[SURF_OUTFLOW] = SurfaceOutflow*ucf;
-        rptVars[STOR_DRAIN]   = StorageDrain*ucf;
+        rptVars[SURF_INFIL]   = st->surfaceInfil*ucf;
+        rptVars[PAVE_PERC]    = st->pavePerc*ucf;
+        rptVars[SOIL_PERC]    = st->soilPerc*ucf;
+        rptVars[STOR_EXFIL]   = st->storageExfil*ucf;
+        rptVars[SURF_OUTFLOW] = st->surfaceOutflow*ucf;
+        rptVars[STOR_DRAIN]   = st->storageDrain*ucf;
 
         //... convert storage results to original units (in or mm)
         ucf = ucfRainDepth;
-        rptVars[SURF_DEPTH] = theLidUnit->surfaceDepth*ucf;
-        rptVars[PAVE_DEPTH] = theLidUnit->paveDepth*ucf;
-        rptVars[SOIL_MOIST] = theLidUnit->soilMoisture;
-        rptVars[STOR_DEPTH] = theLidUnit->storageDepth*ucf;
+        rptVars[SURF_DEPTH] = lidUnit->surfaceDepth*ucf;
+        rptVars[PAVE_DEPTH] = lidUnit->paveDepth*ucf;
+        rptVars[SOIL_MOIST] = lidUnit->soilMoisture;
+        rptVars[STOR_DEPTH] = lidUnit->storageDepth*ucf;
 
         //... if the current LID state is wet but the previous state was dry
         //    for more than one period then write the saved previous results
         //    to the report file thus marking the end of a dry period
-        if ( !isDry && theLidUnit->rptFile->wasDry > 1)
+        if ( !isDry && lidUnit->rptFile->wasDry > 1)
         {
-            fprintf(theLidUnit->rptFile->file, "%s",
-                theLidUnit->rptFile->results);
+            fprintf(lidUnit->rptFile->file, "%s",
+                lidUnit->rptFile->results);
         }
 
         //... write the current results to a string which is saved between
@@ -429,7 +409,7 @@ void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDe
         elapsedHrs = NewRunoffTime / 1000.0 / 3600.0;
         datetime_getTimeStamp(
             M_D_Y, getDateTime(NewRunoffTime), TIME_STAMP_SIZE, timeStamp);
-        snprintf(theLidUnit->rptFile->results, sizeof(theLidUnit->rptFile->results),
+        snprintf(lidUnit->rptFile->results, sizeof(lidUnit->rptFile->results),
              "\n%20s\t %8.3f\t %8.3f\t %8.4f\t %8.3f\t %8.3f\t %8.3f\t %8.3f\t"
              "%8.3f\t %8.3f\t %8.3f\t %8.3f\t %8.3f\t %8.3f",
              timeStamp, elapsedHrs, rptVars[0], rptVars[1], rptVars[2],
@@ -441,57 +421,61 @@ void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDe
         {
             //... if the previous state was wet then write the current
             //    results to file marking the start of a dry period
-            if ( theLidUnit->rptFile->wasDry == 0 )
+            if ( lidUnit->rptFile->wasDry == 0 )
             {
-                fprintf(theLidUnit->rptFile->file, "%s",
-                    theLidUnit->rptFile->results);
+                fprintf(lidUnit->rptFile->file, "%s",
+                    lidUnit->rptFile->results);
             }
 
             //... increment the number of successive dry periods
-            theLidUnit->rptFile->wasDry++;
+            lidUnit->rptFile->wasDry++;
         }
 
         //... if the current LID state is wet
         else
         {
             //... write the current results to the report file
-            fprintf(theLidUnit->rptFile->file, "%s",
-                theLidUnit->rptFile->results);
+            fprintf(lidUnit->rptFile->file, "%s",
+                lidUnit->rptFile->results);
 
             //... re-set the number of successive dry periods to 0
-            theLidUnit->rptFile->wasDry = 0; 
+            lidUnit->rptFile->wasDry = 0; 
         }
     }
 }
 
 //=============================================================================
 
-void roofFluxRates(double x[], double f[])
+void roofFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates for roof disconnection.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
     double surfaceDepth = x[SURF];
 
-    getEvapRates(surfaceDepth, 0.0, 0.0, 0.0, 1.0);
-    SurfaceVolume = surfaceDepth;
-    SurfaceInfil = 0.0;
-    if ( theLidProc->surface.alpha > 0.0 )
-      SurfaceOutflow = getSurfaceOutflowRate(surfaceDepth);
-    else getSurfaceOverflowRate(&surfaceDepth);
-    StorageDrain = MIN(theLidProc->drain.coeff/UCF(RAINFALL), SurfaceOutflow);
-    SurfaceOutflow -= StorageDrain;
-    f[SURF] = (SurfaceInflow - SurfaceEvap - StorageDrain - SurfaceOutflow);
+    getEvapRates(st, surfaceDepth, 0.0, 0.0, 0.0, 1.0);
+    st->surfaceVolume = surfaceDepth;
+    st->surfaceInfil = 0.0;
+    if ( st->lidProc->surface.alpha > 0.0 )
+      st->surfaceOutflow = getSurfaceOutflowRate(st, surfaceDepth);
+    else getSurfaceOverflowRate(st, &surfaceDepth);
+    st->storageDrain = MIN(st->lidProc->drain.coeff/UCF(RAINFALL),
+                           st->surfaceOutflow);
+    st->surfaceOutflow -= st->storageDrain;
+    f[SURF] = (st->surfaceInflow - st->surfaceEvap - st->storageDrain -
+               st->surfaceOutflow);
 }
 
 //=============================================================================
 
-void greenRoofFluxRates(double x[], double f[])
+void greenRoofFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates from the layers of a green roof.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
@@ -505,12 +489,12 @@ void greenRoofFluxRates(double x[], double f[])
     double maxRate;
 
     // Green roof properties
-    double soilThickness    = theLidProc->soil.thickness;
-    double storageThickness = theLidProc->storage.thickness;
-    double soilPorosity     = theLidProc->soil.porosity;
-    double storageVoidFrac  = theLidProc->storage.voidFrac;
-    double soilFieldCap     = theLidProc->soil.fieldCap;
-    double soilWiltPoint    = theLidProc->soil.wiltPoint;
+    double soilThickness    = st->lidProc->soil.thickness;
+    double storageThickness = st->lidProc->storage.thickness;
+    double soilPorosity     = st->lidProc->soil.porosity;
+    double storageVoidFrac  = st->lidProc->storage.voidFrac;
+    double soilFieldCap     = st->lidProc->soil.fieldCap;
+    double soilWiltPoint    = st->lidProc->soil.wiltPoint;
 
     //... retrieve moisture levels from input vector
     surfaceDepth = x[SURF];
@@ -518,78 +502,80 @@ void greenRoofFluxRates(double x[], double f[])
     storageDepth = x[STOR];
 
     //... convert moisture levels to volumes
-    SurfaceVolume = surfaceDepth * theLidProc->surface.voidFrac;
-    SoilVolume = soilTheta * soilThickness;
-    StorageVolume = storageDepth * storageVoidFrac;
+    st->surfaceVolume = surfaceDepth * st->lidProc->surface.voidFrac;
+    st->soilVolume = soilTheta * soilThickness;
+    st->storageVolume = storageDepth * storageVoidFrac;
 
     //... get ET rates
-    availVolume = SoilVolume - soilWiltPoint * soilThickness;
-    getEvapRates(SurfaceVolume, 0.0, availVolume, StorageVolume, 1.0);
-    if ( soilTheta >= soilPorosity ) StorageEvap = 0.0;
+    availVolume = st->soilVolume - soilWiltPoint * soilThickness;
+    getEvapRates(st, st->surfaceVolume, 0.0, availVolume, st->storageVolume,
+                 1.0);
+    if ( soilTheta >= soilPorosity ) st->storageEvap = 0.0;
 
     //... soil layer perc rate
-    SoilPerc = getSoilPercRate(soilTheta);
+    st->soilPerc = getSoilPercRate(st, soilTheta);
 
     //... limit perc rate by available water
     availVolume = (soilTheta - soilFieldCap) * soilThickness;
-    maxRate = MAX(availVolume, 0.0) / Tstep - SoilEvap;
-    SoilPerc = MIN(SoilPerc, maxRate);
-    SoilPerc = MAX(SoilPerc, 0.0);
+    maxRate = MAX(availVolume, 0.0) / st->tStep - st->soilEvap;
+    st->soilPerc = MIN(st->soilPerc, maxRate);
+    st->soilPerc = MAX(st->soilPerc, 0.0);
 
     //... storage (drain mat) outflow rate
-    StorageExfil = 0.0;
-    StorageDrain = getDrainMatOutflow(storageDepth);
+    st->storageExfil = 0.0;
+    st->storageDrain = getDrainMatOutflow(st, storageDepth);
 
     //... unit is full
     if ( soilTheta >= soilPorosity && storageDepth >= storageThickness )
     {
         //... outflow from both layers equals limiting rate
-        maxRate = MIN(SoilPerc, StorageDrain);
-        SoilPerc = maxRate;
-        StorageDrain = maxRate;
+        maxRate = MIN(st->soilPerc, st->storageDrain);
+        st->soilPerc = maxRate;
+        st->storageDrain = maxRate;
 
         //... adjust inflow rate to soil layer
-        SurfaceInfil = MIN(SurfaceInfil, maxRate);
+        st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
     }
 
     //... unit not full
     else
     {
         //... limit drainmat outflow by available storage volume
-        maxRate = storageDepth * storageVoidFrac / Tstep - StorageEvap;
-        if ( storageDepth >= storageThickness ) maxRate += SoilPerc;
+        maxRate = storageDepth * storageVoidFrac / st->tStep - st->storageEvap;
+        if ( storageDepth >= storageThickness ) maxRate += st->soilPerc;
         maxRate = MAX(maxRate, 0.0);
-        StorageDrain = MIN(StorageDrain, maxRate);
+        st->storageDrain = MIN(st->storageDrain, maxRate);
 
         //... limit soil perc inflow by unused storage volume
-        maxRate = (storageThickness - storageDepth) * storageVoidFrac / Tstep +
-                  StorageDrain + StorageEvap;
-        SoilPerc = MIN(SoilPerc, maxRate);
+        maxRate = (storageThickness - storageDepth) * storageVoidFrac /
+                  st->tStep + st->storageDrain + st->storageEvap;
+        st->soilPerc = MIN(st->soilPerc, maxRate);
                 
         //... adjust surface infil. so soil porosity not exceeded
-        maxRate = (soilPorosity - soilTheta) * soilThickness / Tstep +
-                  SoilPerc + SoilEvap;
-        SurfaceInfil = MIN(SurfaceInfil, maxRate);
+        maxRate = (soilPorosity - soilTheta) * soilThickness / st->tStep +
+                  st->soilPerc + st->soilEvap;
+        st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
     }
 
     // ... find surface outflow rate
-    SurfaceOutflow = getSurfaceOutflowRate(surfaceDepth);
+    st->surfaceOutflow = getSurfaceOutflowRate(st, surfaceDepth);
 
     // ... compute overall layer flux rates
-    f[SURF] = (SurfaceInflow - SurfaceEvap - SurfaceInfil - SurfaceOutflow) /
-              theLidProc->surface.voidFrac;
-    f[SOIL] = (SurfaceInfil - SoilEvap - SoilPerc) /
-              theLidProc->soil.thickness;
-    f[STOR] = (SoilPerc - StorageEvap - StorageDrain) /
-              theLidProc->storage.voidFrac;
+    f[SURF] = (st->surfaceInflow - st->surfaceEvap - st->surfaceInfil -
+               st->surfaceOutflow) / st->lidProc->surface.voidFrac;
+    f[SOIL] = (st->surfaceInfil - st->soilEvap - st->soilPerc) /
+              st->lidProc->soil.thickness;
+    f[STOR] = (st->soilPerc - st->storageEvap - st->storageDrain) /
+              st->lidProc->storage.voidFrac;
 }
 
 //=============================================================================
 
-void biocellFluxRates(double x[], double f[])
+void biocellFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates from the layers of a bio-retention cell LID.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
@@ -603,12 +589,12 @@ void biocellFluxRates(double x[], double f[])
     double maxRate;
 
     // LID layer properties
-    double soilThickness    = theLidProc->soil.thickness;
-    double soilPorosity     = theLidProc->soil.porosity;
-    double soilFieldCap     = theLidProc->soil.fieldCap;
-    double soilWiltPoint    = theLidProc->soil.wiltPoint;
-    double storageThickness = theLidProc->storage.thickness;
-    double storageVoidFrac  = theLidProc->storage.voidFrac;
+    double soilThickness    = st->lidProc->soil.thickness;
+    double soilPorosity     = st->lidProc->soil.porosity;
+    double soilFieldCap     = st->lidProc->soil.fieldCap;
+    double soilWiltPoint    = st->lidProc->soil.wiltPoint;
+    double storageThickness = st->lidProc->storage.thickness;
+    double storageVoidFrac  = st->lidProc->storage.voidFrac;
 
     //... retrieve moisture levels from input vector
     surfaceDepth = x[SURF];
@@ -616,47 +602,48 @@ void biocellFluxRates(double x[], double f[])
     storageDepth = x[STOR];
 
     //... convert moisture levels to volumes
-    SurfaceVolume = surfaceDepth * theLidProc->surface.voidFrac;
-    SoilVolume    = soilTheta * soilThickness;
-    StorageVolume = storageDepth * storageVoidFrac;
+    st->surfaceVolume = surfaceDepth * st->lidProc->surface.voidFrac;
+    st->soilVolume    = soilTheta * soilThickness;
+    st->storageVolume = storageDepth * storageVoidFrac;
 
     //... get ET rates
-    availVolume = SoilVolume - soilWiltPoint * soilThickness;
-    getEvapRates(SurfaceVolume, 0.0, availVolume, StorageVolume, 1.0);
-    if ( soilTheta >= soilPorosity ) StorageEvap = 0.0;
+    availVolume = st->soilVolume - soilWiltPoint * soilThickness;
+    getEvapRates(st, st->surfaceVolume, 0.0, availVolume, st->storageVolume,
+                 1.0);
+    if ( soilTheta >= soilPorosity ) st->storageEvap = 0.0;
 
     //... soil layer perc rate
-    SoilPerc = getSoilPercRate(soilTheta);
+    st->soilPerc = getSoilPercRate(st, soilTheta);
 
     //... limit perc rate by available water
     availVolume =  (soilTheta - soilFieldCap) * soilThickness;
-    maxRate = MAX(availVolume, 0.0) / Tstep - SoilEvap;
-    SoilPerc = MIN(SoilPerc, maxRate);
-    SoilPerc = MAX(SoilPerc, 0.0);
+    maxRate = MAX(availVolume, 0.0) / st->tStep - st->soilEvap;
+    st->soilPerc = MIN(st->soilPerc, maxRate);
+    st->soilPerc = MAX(st->soilPerc, 0.0);
 
     //... exfiltration rate out of storage layer
-    StorageExfil = getStorageExfilRate();
+    st->storageExfil = getStorageExfilRate(st);
 
     //... underdrain flow rate
-    StorageDrain = 0.0;
-    if ( theLidProc->drain.coeff > 0.0 )
+    st->storageDrain = 0.0;
+    if ( st->lidProc->drain.coeff > 0.0 )
     {
-        StorageDrain = getStorageDrainRate(storageDepth, soilTheta, 0.0,
+        st->storageDrain = getStorageDrainRate(st, storageDepth, soilTheta, 0.0,
                                            surfaceDepth);
     }
 
     //... special case of no storage layer present
     if ( storageThickness == 0.0 )
     {
-        StorageEvap = 0.0;
-        maxRate = MIN(SoilPerc, StorageExfil);
-        SoilPerc = maxRate;
-        StorageExfil = maxRate;
+        st->storageEvap = 0.0;
+        maxRate = MIN(st->soilPerc, st->storageExfil);
+        st->soilPerc = maxRate;
+        st->storageExfil = maxRate;
 
         //... limit surface infil. by unused soil volume
-        maxRate = (soilPorosity - soilTheta) * soilThickness / Tstep +
-                  SoilPerc + SoilEvap;
-        SurfaceInfil = MIN(SurfaceInfil, maxRate);
+        maxRate = (soilPorosity - soilTheta) * soilThickness / st->tStep +
+                  st->soilPerc + st->soilEvap;
+        st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
     }
 
     else
@@ -665,77 +652,80 @@ void biocellFluxRates(double x[], double f[])
         if ( soilTheta >= soilPorosity && storageDepth >= storageThickness )
         {
             //... limiting rate is smaller of soil perc and storage outflow
-            maxRate = StorageExfil + StorageDrain;
-            if ( SoilPerc < maxRate )
+            maxRate = st->storageExfil + st->storageDrain;
+            if ( st->soilPerc < maxRate )
             {
-                maxRate = SoilPerc;
-                if ( maxRate > StorageExfil ) StorageDrain = maxRate - StorageExfil;
+                maxRate = st->soilPerc;
+                if ( maxRate > st->storageExfil )
+                    st->storageDrain = maxRate - st->storageExfil;
                 else
                 {
-                    StorageExfil = maxRate;
-                    StorageDrain = 0.0;
+                    st->storageExfil = maxRate;
+                    st->storageDrain = 0.0;
                 }
             }
-            else SoilPerc = maxRate;
+            else st->soilPerc = maxRate;
 
             //... apply limiting rate to surface infil.
-            SurfaceInfil = MIN(SurfaceInfil, maxRate);
+            st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
         }
 
         //... either layer not full
         else
         {
             //... limit storage exfiltration by available storage volume
-            maxRate = SoilPerc - StorageEvap + storageDepth*storageVoidFrac/Tstep;
-            StorageExfil = MIN(StorageExfil, maxRate);
-            StorageExfil = MAX(StorageExfil, 0.0);
+            maxRate = st->soilPerc - st->storageEvap +
+                      storageDepth*storageVoidFrac/st->tStep;
+            st->storageExfil = MIN(st->storageExfil, maxRate);
+            st->storageExfil = MAX(st->storageExfil, 0.0);
 
             //... limit underdrain flow by volume above drain offset
-            if ( StorageDrain > 0.0 )
+            if ( st->storageDrain > 0.0 )
             {
-                maxRate = -StorageExfil - StorageEvap;
-                if ( storageDepth >= storageThickness) maxRate += SoilPerc;
-                if ( theLidProc->drain.offset <= storageDepth )
+                maxRate = -st->storageExfil - st->storageEvap;
+                if ( storageDepth >= storageThickness) maxRate += st->soilPerc;
+                if ( st->lidProc->drain.offset <= storageDepth )
                 {
-                    maxRate += (storageDepth - theLidProc->drain.offset) *
-                               storageVoidFrac/Tstep;
+                    maxRate += (storageDepth - st->lidProc->drain.offset) *
+                               storageVoidFrac/st->tStep;
                 }
                 maxRate = MAX(maxRate, 0.0);
-                StorageDrain = MIN(StorageDrain, maxRate);
+                st->storageDrain = MIN(st->storageDrain, maxRate);
             }
         
             //... limit soil perc by unused storage volume
-            maxRate = StorageExfil + StorageDrain + StorageEvap +
+            maxRate = st->storageExfil + st->storageDrain + st->storageEvap +
                       (storageThickness - storageDepth) *
-                      storageVoidFrac/Tstep;
-            SoilPerc = MIN(SoilPerc, maxRate);
+                      storageVoidFrac/st->tStep;
+            st->soilPerc = MIN(st->soilPerc, maxRate);
 
             //... limit surface infil. by unused soil volume
-            maxRate = (soilPorosity - soilTheta) * soilThickness / Tstep +
-                      SoilPerc + SoilEvap;
-            SurfaceInfil = MIN(SurfaceInfil, maxRate);
+            maxRate = (soilPorosity - soilTheta) * soilThickness / st->tStep +
+                      st->soilPerc + st->soilEvap;
+            st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
         }
     }
     
     //... find surface layer outflow rate
-    SurfaceOutflow = getSurfaceOutflowRate(surfaceDepth);
+    st->surfaceOutflow = getSurfaceOutflowRate(st, surfaceDepth);
 
     //... compute overall layer flux rates
-    f[SURF] = (SurfaceInflow - SurfaceEvap - SurfaceInfil - SurfaceOutflow) /
-              theLidProc->surface.voidFrac;
-    f[SOIL] = (SurfaceInfil - SoilEvap - SoilPerc) / 
-              theLidProc->soil.thickness;
+    f[SURF] = (st->surfaceInflow - st->surfaceEvap - st->surfaceInfil -
+               st->surfaceOutflow) / st->lidProc->surface.voidFrac;
+    f[SOIL] = (st->surfaceInfil - st->soilEvap - st->soilPerc) / 
+              st->lidProc->soil.thickness;
     if ( storageThickness == 0.0 ) f[STOR] = 0.0;
-    else f[STOR] = (SoilPerc - StorageEvap - StorageExfil - StorageDrain) /
-                   theLidProc->storage.voidFrac;
+    else f[STOR] = (st->soilPerc - st->storageEvap - st->storageExfil -
+                    st->storageDrain) / st->lidProc->storage.voidFrac;
 }
 
 //=============================================================================
 
-void trenchFluxRates(double x[], double f[])
+void trenchFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates from the layers of an infiltration trench LID.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
@@ -748,82 +738,85 @@ void trenchFluxRates(double x[], double f[])
     double maxRate;
 
     // Storage layer properties
-    double storageThickness = theLidProc->storage.thickness;
-    double storageVoidFrac = theLidProc->storage.voidFrac;
+    double storageThickness = st->lidProc->storage.thickness;
+    double storageVoidFrac = st->lidProc->storage.voidFrac;
 
     //... retrieve moisture levels from input vector
     surfaceDepth = x[SURF];
     storageDepth = x[STOR];
 
     //... convert moisture levels to volumes
-    SurfaceVolume = surfaceDepth * theLidProc->surface.voidFrac;
-    SoilVolume = 0.0;
-    StorageVolume = storageDepth * storageVoidFrac;
+    st->surfaceVolume = surfaceDepth * st->lidProc->surface.voidFrac;
+    st->soilVolume = 0.0;
+    st->storageVolume = storageDepth * storageVoidFrac;
 
     //... get ET rates
     availVolume = (storageThickness - storageDepth) * storageVoidFrac;
-    getEvapRates(SurfaceVolume, 0.0, 0.0, StorageVolume, 1.0);
+    getEvapRates(st, st->surfaceVolume, 0.0, 0.0, st->storageVolume, 1.0);
 
     //... no storage evap if surface ponded
-    if ( surfaceDepth > 0.0 ) StorageEvap = 0.0;
+    if ( surfaceDepth > 0.0 ) st->storageEvap = 0.0;
 
     //... nominal storage inflow
-    StorageInflow = SurfaceInflow + SurfaceVolume / Tstep;
+    st->storageInflow = st->surfaceInflow + st->surfaceVolume / st->tStep;
 
     //... exfiltration rate out of storage layer
-   StorageExfil = getStorageExfilRate();
+   st->storageExfil = getStorageExfilRate(st);
 
     //... underdrain flow rate
-    StorageDrain = 0.0;
-    if ( theLidProc->drain.coeff > 0.0 )
+    st->storageDrain = 0.0;
+    if ( st->lidProc->drain.coeff > 0.0 )
     {
-        StorageDrain = getStorageDrainRate(storageDepth, 0.0, 0.0, surfaceDepth);
+        st->storageDrain = getStorageDrainRate(st, storageDepth, 0.0, 0.0,
+                                               surfaceDepth);
     }
 
     //... limit storage exfiltration by available storage volume
-    maxRate = StorageInflow - StorageEvap + storageDepth*storageVoidFrac/Tstep;
-    StorageExfil = MIN(StorageExfil, maxRate);
-    StorageExfil = MAX(StorageExfil, 0.0);
+    maxRate = st->storageInflow - st->storageEvap +
+              storageDepth*storageVoidFrac/st->tStep;
+    st->storageExfil = MIN(st->storageExfil, maxRate);
+    st->storageExfil = MAX(st->storageExfil, 0.0);
 
     //... limit underdrain flow by volume above drain offset
-    if ( StorageDrain > 0.0 )
+    if ( st->storageDrain > 0.0 )
     {
-        maxRate = -StorageExfil - StorageEvap;
-        if (storageDepth >= storageThickness ) maxRate += StorageInflow;
-        if ( theLidProc->drain.offset <= storageDepth )
+        maxRate = -st->storageExfil - st->storageEvap;
+        if (storageDepth >= storageThickness ) maxRate += st->storageInflow;
+        if ( st->lidProc->drain.offset <= storageDepth )
         {
-            maxRate += (storageDepth - theLidProc->drain.offset) *
-                       storageVoidFrac/Tstep;
+            maxRate += (storageDepth - st->lidProc->drain.offset) *
+                       storageVoidFrac/st->tStep;
         }
         maxRate = MAX(maxRate, 0.0);
-        StorageDrain = MIN(StorageDrain, maxRate);
+        st->storageDrain = MIN(st->storageDrain, maxRate);
     }
 
     //... limit storage inflow to not exceed storage layer capacity
-    maxRate = (storageThickness - storageDepth)*storageVoidFrac/Tstep +
-              StorageExfil + StorageEvap + StorageDrain;
-    StorageInflow = MIN(StorageInflow, maxRate);
+    maxRate = (storageThickness - storageDepth)*storageVoidFrac/st->tStep +
+              st->storageExfil + st->storageEvap + st->storageDrain;
+    st->storageInflow = MIN(st->storageInflow, maxRate);
 
     //... equate surface infil to storage inflow
-    SurfaceInfil = StorageInflow;
+    st->surfaceInfil = st->storageInflow;
 
     //... find surface outflow rate
-    SurfaceOutflow = getSurfaceOutflowRate(surfaceDepth);
+    st->surfaceOutflow = getSurfaceOutflowRate(st, surfaceDepth);
 
     // ... find net fluxes for each layer
-    f[SURF] = (SurfaceInflow - SurfaceEvap - StorageInflow - SurfaceOutflow) /
-              theLidProc->surface.voidFrac;;
-    f[STOR] = (StorageInflow - StorageEvap - StorageExfil - StorageDrain) /
-              theLidProc->storage.voidFrac;
+    f[SURF] = (st->surfaceInflow - st->surfaceEvap - st->storageInflow -
+               st->surfaceOutflow) / st->lidProc->surface.voidFrac;;
+    f[STOR] = (st->storageInflow - st->storageEvap - st->storageExfil -
+               st->storageDrain) / st->lidProc->storage.voidFrac;
     f[SOIL] = 0.0;
 }
 
 //=============================================================================
 
-void pavementFluxRates(double x[], double f[])
+void pavementFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates for the layers of a porous pavement LID.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
@@ -834,20 +827,20 @@ void pavementFluxRates(double x[], double f[])
     double storageDepth;
 
     //... Intermediate variables
-    double pervFrac = (1.0 - theLidProc->pavement.impervFrac);
+    double pervFrac = (1.0 - st->lidProc->pavement.impervFrac);
     double storageInflow;    // inflow rate to storage layer (ft/s)
     double availVolume;
     double maxRate;
 
     //... LID layer properties
-    double paveVoidFrac     = theLidProc->pavement.voidFrac * pervFrac;
-    double paveThickness    = theLidProc->pavement.thickness;
-    double soilThickness    = theLidProc->soil.thickness;
-    double soilPorosity     = theLidProc->soil.porosity;
-    double soilFieldCap     = theLidProc->soil.fieldCap;
-    double soilWiltPoint    = theLidProc->soil.wiltPoint;
-    double storageThickness = theLidProc->storage.thickness;
-    double storageVoidFrac  = theLidProc->storage.voidFrac;
+    double paveVoidFrac     = st->lidProc->pavement.voidFrac * pervFrac;
+    double paveThickness    = st->lidProc->pavement.thickness;
+    double soilThickness    = st->lidProc->soil.thickness;
+    double soilPorosity     = st->lidProc->soil.porosity;
+    double soilFieldCap     = st->lidProc->soil.fieldCap;
+    double soilWiltPoint    = st->lidProc->soil.wiltPoint;
+    double storageThickness = st->lidProc->storage.thickness;
+    double storageVoidFrac  = st->lidProc->storage.voidFrac;
 
     //... retrieve moisture levels from input vector
     surfaceDepth = x[SURF];
@@ -856,55 +849,55 @@ void pavementFluxRates(double x[], double f[])
     storageDepth = x[STOR];
 
     //... convert moisture levels to volumes
-    SurfaceVolume = surfaceDepth * theLidProc->surface.voidFrac;
-    PaveVolume = paveDepth * paveVoidFrac;
-    SoilVolume = soilTheta * soilThickness;
-    StorageVolume = storageDepth * storageVoidFrac;
+    st->surfaceVolume = surfaceDepth * st->lidProc->surface.voidFrac;
+    st->paveVolume = paveDepth * paveVoidFrac;
+    st->soilVolume = soilTheta * soilThickness;
+    st->storageVolume = storageDepth * storageVoidFrac;
 
     //... get ET rates
-    availVolume = SoilVolume - soilWiltPoint * soilThickness;
-    getEvapRates(SurfaceVolume, PaveVolume, availVolume, StorageVolume,
-                 pervFrac);
+    availVolume = st->soilVolume - soilWiltPoint * soilThickness;
+    getEvapRates(st, st->surfaceVolume, st->paveVolume, availVolume,
+                 st->storageVolume, pervFrac);
 
     //... no storage evap if soil or pavement layer saturated
     if ( paveDepth >= paveThickness ||
        ( soilThickness > 0.0 && soilTheta >= soilPorosity )
-       ) StorageEvap = 0.0;
+       ) st->storageEvap = 0.0;
 
     //... find nominal rate of surface infiltration into pavement layer
-    SurfaceInfil = SurfaceInflow + (SurfaceVolume / Tstep);
+    st->surfaceInfil = st->surfaceInflow + (st->surfaceVolume / st->tStep);
 
     //... find perc rate out of pavement layer
-    PavePerc = getPavementPermRate() * pervFrac;
+    st->pavePerc = getPavementPermRate(st) * pervFrac;
 
     //... surface infiltration can't exceed pavement permeability
-    SurfaceInfil = MIN(SurfaceInfil, PavePerc);
+    st->surfaceInfil = MIN(st->surfaceInfil, st->pavePerc);
 
     //... limit pavement perc by available water
-    maxRate = PaveVolume/Tstep + SurfaceInfil - PaveEvap;
+    maxRate = st->paveVolume/st->tStep + st->surfaceInfil - st->paveEvap;
     maxRate = MAX(maxRate, 0.0);
-    PavePerc = MIN(PavePerc, maxRate);
+    st->pavePerc = MIN(st->pavePerc, maxRate);
 
     //... find soil layer perc rate
     if ( soilThickness > 0.0 )
     {
-        SoilPerc = getSoilPercRate(soilTheta);
+        st->soilPerc = getSoilPercRate(st, soilTheta);
         availVolume = (soilTheta - soilFieldCap) * soilThickness;
-        maxRate = MAX(availVolume, 0.0) / Tstep - SoilEvap;
-        SoilPerc = MIN(SoilPerc, maxRate);
-        SoilPerc = MAX(SoilPerc, 0.0);
+        maxRate = MAX(availVolume, 0.0) / st->tStep - st->soilEvap;
+        st->soilPerc = MIN(st->soilPerc, maxRate);
+        st->soilPerc = MAX(st->soilPerc, 0.0);
     }
-    else SoilPerc = PavePerc;
+    else st->soilPerc = st->pavePerc;
 
     //... exfiltration rate out of storage layer
-    StorageExfil = getStorageExfilRate();
+    st->storageExfil = getStorageExfilRate(st);
 
     //... underdrain flow rate
-    StorageDrain = 0.0;
-    if ( theLidProc->drain.coeff > 0.0 )
+    st->storageDrain = 0.0;
+    if ( st->lidProc->drain.coeff > 0.0 )
     {
-        StorageDrain = getStorageDrainRate(storageDepth, soilTheta, paveDepth,
-                                           surfaceDepth);
+        st->storageDrain = getStorageDrainRate(st, storageDepth, soilTheta,
+                                               paveDepth, surfaceDepth);
     }
 
     //... check for adjacent saturated layers
@@ -915,22 +908,22 @@ void pavementFluxRates(double x[], double f[])
          paveDepth >= paveThickness )
     {
         //... pavement outflow can't exceed storage outflow
-        maxRate = StorageEvap + StorageDrain + StorageExfil;
-        if ( PavePerc > maxRate ) PavePerc = maxRate;
+        maxRate = st->storageEvap + st->storageDrain + st->storageExfil;
+        if ( st->pavePerc > maxRate ) st->pavePerc = maxRate;
 
         //... storage outflow can't exceed pavement outflow
         else
         {
             //... use up available exfiltration capacity first
-            StorageExfil = MIN(StorageExfil, PavePerc);
-            StorageDrain = PavePerc - StorageExfil;
+            st->storageExfil = MIN(st->storageExfil, st->pavePerc);
+            st->storageDrain = st->pavePerc - st->storageExfil;
         }
 
         //... set soil perc to pavement perc
-        SoilPerc = PavePerc;
+        st->soilPerc = st->pavePerc;
 
         //... limit surface infil. by pavement perc
-        SurfaceInfil = MIN(SurfaceInfil, PavePerc);
+        st->surfaceInfil = MIN(st->surfaceInfil, st->pavePerc);
     }
 
     //... pavement, soil & storage layers are full
@@ -940,22 +933,23 @@ void pavementFluxRates(double x[], double f[])
               paveDepth >= paveThickness )
     {
         //... find which layer has limiting flux rate
-        maxRate = StorageExfil + StorageDrain;
-        if ( SoilPerc < maxRate) maxRate = SoilPerc;
-        else maxRate = MIN(maxRate, PavePerc);
+        maxRate = st->storageExfil + st->storageDrain;
+        if ( st->soilPerc < maxRate) maxRate = st->soilPerc;
+        else maxRate = MIN(maxRate, st->pavePerc);
 
         //... use up available storage exfiltration capacity first
-        if ( maxRate > StorageExfil ) StorageDrain = maxRate - StorageExfil;
+        if ( maxRate > st->storageExfil )
+            st->storageDrain = maxRate - st->storageExfil;
         else
         {
-            StorageExfil = maxRate;
-            StorageDrain = 0.0;
+            st->storageExfil = maxRate;
+            st->storageDrain = 0.0;
         }
-        SoilPerc = maxRate;
-        PavePerc = maxRate;
+        st->soilPerc = maxRate;
+        st->pavePerc = maxRate;
 
         //... limit surface infil. by pavement perc
-        SurfaceInfil = MIN(SurfaceInfil, PavePerc);
+        st->surfaceInfil = MIN(st->surfaceInfil, st->pavePerc);
     }
 
     //... storage & soil layers are full
@@ -964,22 +958,22 @@ void pavementFluxRates(double x[], double f[])
               soilTheta >= soilPorosity )
     {
         //... soil perc can't exceed storage outflow
-        maxRate = StorageDrain + StorageExfil;
-        if ( SoilPerc > maxRate ) SoilPerc = maxRate;
+        maxRate = st->storageDrain + st->storageExfil;
+        if ( st->soilPerc > maxRate ) st->soilPerc = maxRate;
 
         //... storage outflow can't exceed soil perc
         else
         {
             //... use up available exfiltration capacity first
-            StorageExfil = MIN(StorageExfil, SoilPerc);
-            StorageDrain = SoilPerc - StorageExfil;
+            st->storageExfil = MIN(st->storageExfil, st->soilPerc);
+            st->storageDrain = st->soilPerc - st->storageExfil;
         }
-        PavePerc = MIN(PavePerc, SoilPerc);        
+        st->pavePerc = MIN(st->pavePerc, st->soilPerc);        
 
         //... limit surface infil. by available pavement volume
         availVolume = (paveThickness - paveDepth) * paveVoidFrac;
-        maxRate = availVolume / Tstep + PavePerc + PaveEvap;
-        SurfaceInfil = MIN(SurfaceInfil, maxRate);
+        maxRate = availVolume / st->tStep + st->pavePerc + st->paveEvap;
+        st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
     }
 
     //... soil and pavement layers are full
@@ -987,11 +981,12 @@ void pavementFluxRates(double x[], double f[])
               paveDepth >= paveThickness &&
               soilTheta >= soilPorosity )
     {
-        PavePerc = MIN(PavePerc, SoilPerc);
-        SoilPerc = PavePerc;
-        SurfaceInfil = MIN(SurfaceInfil,PavePerc); 
-        maxRate = MAX(StorageVolume / Tstep + SoilPerc - StorageEvap, 0.0);
-	    StorageExfil = MIN(StorageExfil, maxRate); 
+        st->pavePerc = MIN(st->pavePerc, st->soilPerc);
+        st->soilPerc = st->pavePerc;
+        st->surfaceInfil = MIN(st->surfaceInfil,st->pavePerc); 
+        maxRate = MAX(st->storageVolume / st->tStep + st->soilPerc -
+                      st->storageEvap, 0.0);
+	    st->storageExfil = MIN(st->storageExfil, maxRate); 
     }
 
     //... no adjoining layers are full
@@ -999,69 +994,73 @@ void pavementFluxRates(double x[], double f[])
     {
         //... limit storage exfiltration by available storage volume
         //    (if no soil layer, SoilPerc is same as PavePerc)
-        maxRate = SoilPerc - StorageEvap + StorageVolume / Tstep;
+        maxRate = st->soilPerc - st->storageEvap +
+                  st->storageVolume / st->tStep;
         maxRate = MAX(0.0, maxRate);
-        StorageExfil = MIN(StorageExfil, maxRate);
+        st->storageExfil = MIN(st->storageExfil, maxRate);
 
         //... limit underdrain flow by volume above drain offset
-        if ( StorageDrain > 0.0 )
+        if ( st->storageDrain > 0.0 )
         {
-            maxRate = -StorageExfil - StorageEvap;
-            if (storageDepth >= storageThickness ) maxRate += SoilPerc;
-            if ( theLidProc->drain.offset <= storageDepth ) 
+            maxRate = -st->storageExfil - st->storageEvap;
+            if (storageDepth >= storageThickness ) maxRate += st->soilPerc;
+            if ( st->lidProc->drain.offset <= storageDepth ) 
             {
-                maxRate += (storageDepth - theLidProc->drain.offset) *
-                           storageVoidFrac/Tstep;
+                maxRate += (storageDepth - st->lidProc->drain.offset) *
+                           storageVoidFrac/st->tStep;
             }
             maxRate = MAX(maxRate, 0.0);
-            StorageDrain = MIN(StorageDrain, maxRate);
+            st->storageDrain = MIN(st->storageDrain, maxRate);
         }
 
         //... limit soil & pavement outflow by unused storage volume
         availVolume = (storageThickness - storageDepth) * storageVoidFrac;
-        maxRate = availVolume/Tstep + StorageEvap + StorageDrain + StorageExfil;
+        maxRate = availVolume/st->tStep + st->storageEvap + st->storageDrain +
+                  st->storageExfil;
         maxRate = MAX(maxRate, 0.0);
         if ( soilThickness > 0.0 )
         {
-            SoilPerc = MIN(SoilPerc, maxRate);
-            maxRate = (soilPorosity - soilTheta) * soilThickness / Tstep +
-                      SoilPerc;
+            st->soilPerc = MIN(st->soilPerc, maxRate);
+            maxRate = (soilPorosity - soilTheta) * soilThickness / st->tStep +
+                      st->soilPerc;
         }
-        PavePerc = MIN(PavePerc, maxRate);
+        st->pavePerc = MIN(st->pavePerc, maxRate);
 
         //... limit surface infil. by available pavement volume
         availVolume = (paveThickness - paveDepth) * paveVoidFrac;
-        maxRate = availVolume / Tstep + PavePerc + PaveEvap;
-        SurfaceInfil = MIN(SurfaceInfil, maxRate);
+        maxRate = availVolume / st->tStep + st->pavePerc + st->paveEvap;
+        st->surfaceInfil = MIN(st->surfaceInfil, maxRate);
     }
 
     //... surface outflow
-    SurfaceOutflow = getSurfaceOutflowRate(surfaceDepth);
+    st->surfaceOutflow = getSurfaceOutflowRate(st, surfaceDepth);
 
     //... compute overall layer flux rates
-    f[SURF] = SurfaceInflow - SurfaceEvap - SurfaceInfil - SurfaceOutflow;
-    f[PAVE] = (SurfaceInfil - PaveEvap - PavePerc) / paveVoidFrac;
-    if ( theLidProc->soil.thickness > 0.0)
+    f[SURF] = st->surfaceInflow - st->surfaceEvap - st->surfaceInfil -
+              st->surfaceOutflow;
+    f[PAVE] = (st->surfaceInfil - st->paveEvap - st->pavePerc) / paveVoidFrac;
+    if ( st->lidProc->soil.thickness > 0.0)
     {
-        f[SOIL] = (PavePerc - SoilEvap - SoilPerc) / soilThickness;
-        storageInflow = SoilPerc;
+        f[SOIL] = (st->pavePerc - st->soilEvap - st->soilPerc) / soilThickness;
+        storageInflow = st->soilPerc;
     }
     else
     {
         f[SOIL] = 0.0;
-        storageInflow = PavePerc;
-        SoilPerc = 0.0;
+        storageInflow = st->pavePerc;
+        st->soilPerc = 0.0;
     }
-    f[STOR] = (storageInflow - StorageEvap - StorageExfil - StorageDrain) /
-              storageVoidFrac;
+    f[STOR] = (storageInflow - st->storageEvap - st->storageExfil -
+               st->storageDrain) / storageVoidFrac;
 }
 
 //=============================================================================
 
-void swaleFluxRates(double x[], double f[])
+void swaleFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates from a vegetative swale LID.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
@@ -1083,57 +1082,57 @@ void swaleFluxRates(double x[], double f[])
 
     //... retrieve state variable from work vector
     depth = x[SURF];
-    depth = MIN(depth, theLidProc->surface.thickness);
+    depth = MIN(depth, st->lidProc->surface.thickness);
 
     //... depression storage depth
     dStore = 0.0;
 
     //... get swale's bottom width
     //    (0.5 ft minimum to avoid numerical problems)
-    slope = theLidProc->surface.sideSlope;
-    topWidth = theLidUnit->fullWidth;
+    slope = st->lidProc->surface.sideSlope;
+    topWidth = st->lidUnit->fullWidth;
     topWidth = MAX(topWidth, 0.5);
-    botWidth = topWidth - 2.0 * slope * theLidProc->surface.thickness;
+    botWidth = topWidth - 2.0 * slope * st->lidProc->surface.thickness;
     if ( botWidth < 0.5 )
     {
         botWidth = 0.5;
-        slope = 0.5 * (topWidth - 0.5) / theLidProc->surface.thickness;
+        slope = 0.5 * (topWidth - 0.5) / st->lidProc->surface.thickness;
     }
 
     //... swale's length
-    lidArea = theLidUnit->area;
+    lidArea = st->lidUnit->area;
     length = lidArea / topWidth;
 
     //... top width, surface area and flow area of current ponded depth
     surfWidth = botWidth + 2.0 * slope * depth;
     surfArea = length * surfWidth;
     flowArea = (depth * (botWidth + slope * depth)) *
-               theLidProc->surface.voidFrac;
+               st->lidProc->surface.voidFrac;
 
     //... wet volume and effective depth
     volume = length * flowArea;
 
     //... surface inflow into swale (cfs)
-    surfInflow = SurfaceInflow * lidArea;
+    surfInflow = st->surfaceInflow * lidArea;
 
     //... ET rate in cfs
-    SurfaceEvap = EvapRate * surfArea;
-    SurfaceEvap = MIN(SurfaceEvap, volume/Tstep);
+    st->surfaceEvap = st->evapRate * surfArea;
+    st->surfaceEvap = MIN(st->surfaceEvap, volume/st->tStep);
 
     //... infiltration rate to native soil in cfs
-    StorageExfil = SurfaceInfil * surfArea;
+    st->storageExfil = st->surfaceInfil * surfArea;
 
     //... no surface outflow if depth below depression storage
     xDepth = depth - dStore;
-    if ( xDepth <= ZERO ) SurfaceOutflow = 0.0;
+    if ( xDepth <= ZERO ) st->surfaceOutflow = 0.0;
 
     //... otherwise compute a surface outflow
     else
     {
         //... modify flow area to remove depression storage,
         flowArea -= (dStore * (botWidth + slope * dStore)) *
-                     theLidProc->surface.voidFrac;
-        if ( flowArea < ZERO ) SurfaceOutflow = 0.0;
+                     st->lidProc->surface.voidFrac;
+        if ( flowArea < ZERO ) st->surfaceOutflow = 0.0;
         else
         {
             //... compute hydraulic radius
@@ -1142,41 +1141,42 @@ void swaleFluxRates(double x[], double f[])
             hydRadius = flowArea / hydRadius;
 
             //... use Manning Eqn. to find outflow rate in cfs
-            SurfaceOutflow = theLidProc->surface.alpha * flowArea *
+            st->surfaceOutflow = st->lidProc->surface.alpha * flowArea *
                              pow(hydRadius, 2./3.);
         }
     }
 
     //... net flux rate (dV/dt) in cfs
-    dVdT = surfInflow - SurfaceEvap - StorageExfil - SurfaceOutflow;
+    dVdT = surfInflow - st->surfaceEvap - st->storageExfil - st->surfaceOutflow;
 
     //... when full, any net positive inflow becomes spillage
-    if ( depth == theLidProc->surface.thickness && dVdT > 0.0 )
+    if ( depth == st->lidProc->surface.thickness && dVdT > 0.0 )
     {
-        SurfaceOutflow += dVdT;
+        st->surfaceOutflow += dVdT;
         dVdT = 0.0;
     }
 
     //... convert flux rates to ft/s
-    SurfaceEvap /= lidArea;
-    StorageExfil /= lidArea;
-    SurfaceOutflow /= lidArea;
+    st->surfaceEvap /= lidArea;
+    st->storageExfil /= lidArea;
+    st->surfaceOutflow /= lidArea;
     f[SURF] = dVdT / surfArea;
     f[SOIL] = 0.0;
     f[STOR] = 0.0;
 
     //... assign values to layer volumes
-    SurfaceVolume = volume / lidArea;
-    SoilVolume = 0.0;
-    StorageVolume = 0.0;
+    st->surfaceVolume = volume / lidArea;
+    st->soilVolume = 0.0;
+    st->storageVolume = 0.0;
 }
 
 //=============================================================================
 
-void barrelFluxRates(double x[], double f[])
+void barrelFluxRates(TLidState* st, double x[], double f[])
 //
 //  Purpose: computes flux rates for a rain barrel LID.
-//  Input:   x = vector of storage levels
+//  Input:   st = LID work area
+//           x = vector of storage levels
 //  Output:  f = vector of flux rates
 //
 {
@@ -1185,48 +1185,50 @@ void barrelFluxRates(double x[], double f[])
     double maxValue;
 
     //... assign values to layer volumes
-    SurfaceVolume = 0.0;
-    SoilVolume = 0.0;
-    StorageVolume = storageDepth;
+    st->surfaceVolume = 0.0;
+    st->soilVolume = 0.0;
+    st->storageVolume = storageDepth;
 
     //... initialize flows
-    SurfaceInfil = 0.0;
-    SurfaceOutflow = 0.0;
-    StorageDrain = 0.0;
+    st->surfaceInfil = 0.0;
+    st->surfaceOutflow = 0.0;
+    st->storageDrain = 0.0;
 
     //... compute outflow if time since last rain exceeds drain delay
     //    (dryTime is updated in lid.evalLidUnit at each time step)
-    if ( theLidProc->drain.delay == 0.0 ||
-        theLidUnit->dryTime >= theLidProc->drain.delay )
+    if ( st->lidProc->drain.delay == 0.0 ||
+        st->lidUnit->dryTime >= st->lidProc->drain.delay )
     {
-        head = storageDepth - theLidProc->drain.offset;
+        head = storageDepth - st->lidProc->drain.offset;
         if ( head > 0.0 )
         {
-            StorageDrain = getStorageDrainRate(storageDepth, 0.0, 0.0, 0.0);
-            maxValue = (head/Tstep);
-            StorageDrain = MIN(StorageDrain, maxValue);
+            st->storageDrain = getStorageDrainRate(st, storageDepth, 0.0, 0.0,
+                                                   0.0);
+            maxValue = (head/st->tStep);
+            st->storageDrain = MIN(st->storageDrain, maxValue);
         }
     }
 
     //... limit inflow to available storage
-    StorageInflow = SurfaceInflow;
-    maxValue = (theLidProc->storage.thickness - storageDepth) / Tstep +
-        StorageDrain;
-    StorageInflow = MIN(StorageInflow, maxValue);
-    SurfaceInfil = StorageInflow;
+    st->storageInflow = st->surfaceInflow;
+    maxValue = (st->lidProc->storage.thickness - storageDepth) / st->tStep +
+        st->storageDrain;
+    st->storageInflow = MIN(st->storageInflow, maxValue);
+    st->surfaceInfil = st->storageInflow;
 
     //... assign values to layer flux rates
-    f[SURF] = SurfaceInflow - StorageInflow;
-    f[STOR] = StorageInflow - StorageDrain;
+    f[SURF] = st->surfaceInflow - st->storageInflow;
+    f[STOR] = st->storageInflow - st->storageDrain;
     f[SOIL] = 0.0;
 }
 
 //=============================================================================
 
-double getSurfaceOutflowRate(double depth)
+double getSurfaceOutflowRate(TLidState* st, double depth)
 //
 //  Purpose: computes outflow rate from a LID's surface layer.
-//  Input:   depth = depth of ponded water on surface layer (ft)
+//  Input:   st = LID work area
+//           depth = depth of ponded water on surface layer (ft)
 //  Output:  returns outflow from surface layer (ft/s)
 //
 //  Note: this function should not be applied to swales or rain barrels.
@@ -1236,29 +1238,29 @@ double getSurfaceOutflowRate(double depth)
     double outflow;
 
     //... no outflow if ponded depth below storage depth
-    delta = depth - theLidProc->surface.thickness;
+    delta = depth - st->lidProc->surface.thickness;
     if ( delta < 0.0 ) return 0.0;
 
     //... compute outflow from overland flow Manning equation
-    outflow = theLidProc->surface.alpha * pow(delta, 5.0/3.0) *
-              theLidUnit->fullWidth / theLidUnit->area;
-    outflow = MIN(outflow, delta / Tstep);
+    outflow = st->lidProc->surface.alpha * pow(delta, 5.0/3.0) *
+              st->lidUnit->fullWidth / st->lidUnit->area;
+    outflow = MIN(outflow, delta / st->tStep);
     return outflow;
 }
 
 //=============================================================================
 
-double getPavementPermRate()
+double getPavementPermRate(TLidState* st)
 //
 //  Purpose: computes reduced permeability of a pavement layer due to
 //           clogging.
-//  Input:   none
+//  Input:   st = LID work area
 //  Output:  returns the reduced permeability of the pavement layer (ft/s).
 //
 {
     double permReduction = 0.0;
-    double clogFactor= theLidProc->pavement.clogFactor;
-    double regenDays = theLidProc->pavement.regenDays;
+    double clogFactor= st->lidProc->pavement.clogFactor;
+    double regenDays = st->lidProc->pavement.regenDays;
 
     // ... find permeability reduction due to clogging     
     if ( clogFactor > 0.0 )
@@ -1268,84 +1270,89 @@ double getPavementPermRate()
         //      volumetric loading that the pavement has received)
         if ( regenDays > 0.0 )
         {
-            if ( OldRunoffTime / 1000.0 / SECperDAY >= theLidUnit->nextRegenDay )
+            if ( OldRunoffTime / 1000.0 / SECperDAY >=
+                 st->lidUnit->nextRegenDay )
             {
                 // ... reduce total volume treated by degree of regeneration
-                theLidUnit->volTreated *= 
-                    (1.0 - theLidProc->pavement.regenDegree);
+                st->lidUnit->volTreated *= 
+                    (1.0 - st->lidProc->pavement.regenDegree);
 
                 // ... update next day that regenration occurs
-                theLidUnit->nextRegenDay += regenDays;
+                st->lidUnit->nextRegenDay += regenDays;
             }
         }
 
         // ... find permeabiity reduction factor
-        permReduction = theLidUnit->volTreated / clogFactor;
+        permReduction = st->lidUnit->volTreated / clogFactor;
         permReduction = MIN(permReduction, 1.0);
     }
 
     // ... return the effective pavement permeability
-    return theLidProc->pavement.kSat * (1.0 - permReduction);
+    return st->lidProc->pavement.kSat * (1.0 - permReduction);
 }
 
 //=============================================================================
 
-double getSoilPercRate(double theta)
+double getSoilPercRate(TLidState* st, double theta)
 //
 //  Purpose: computes percolation rate of water through a LID's soil layer.
-//  Input:   theta = moisture content (fraction)
+//  Input:   st = LID work area
+//           theta = moisture content (fraction)
 //  Output:  returns percolation rate within soil layer (ft/s)
 //
 {
     double delta;            // moisture deficit
 
     // ... no percolation if soil moisture <= field capacity
-    if ( theta <= theLidProc->soil.fieldCap ) return 0.0;
+    if ( theta <= st->lidProc->soil.fieldCap ) return 0.0;
 
     // ... perc rate = unsaturated hydraulic conductivity
-    delta = theLidProc->soil.porosity - theta;
-    return theLidProc->soil.kSat * exp(-delta * theLidProc->soil.kSlope);
+    delta = st->lidProc->soil.porosity - theta;
+    return st->lidProc->soil.kSat * exp(-delta * st->lidProc->soil.kSlope);
 
 }
 
 //=============================================================================
 
-double getStorageExfilRate()
+double getStorageExfilRate(TLidState* st)
 //
 //  Purpose: computes exfiltration rate from storage zone into
 //           native soil beneath a LID.
-//  Input:   depth = depth of water storage zone (ft)
+//  Input:   st = LID work area
+//           depth = depth of water storage zone (ft)
 //  Output:  returns infiltration rate (ft/s)
 //
 {
     double infil = 0.0;
     double clogFactor = 0.0;
 
-    if ( theLidProc->storage.kSat == 0.0 ) return 0.0;
-    if ( MaxNativeInfil == 0.0 ) return 0.0;
+    if ( st->lidProc->storage.kSat == 0.0 ) return 0.0;
+    if ( st->maxNativeInfil == 0.0 ) return 0.0;
 
     //... reduction due to clogging
-    clogFactor = theLidProc->storage.clogFactor;
+    clogFactor = st->lidProc->storage.clogFactor;
     if ( clogFactor > 0.0 )
     {
-        clogFactor = theLidUnit->waterBalance.inflow / clogFactor;
+        clogFactor = st->lidUnit->waterBalance.inflow / clogFactor;
         clogFactor = MIN(clogFactor, 1.0);
     }
 
     //... infiltration rate = storage Ksat reduced by any clogging
-    infil = theLidProc->storage.kSat * (1.0 - clogFactor);
+    infil = st->lidProc->storage.kSat * (1.0 - clogFactor);
 
     //... limit infiltration rate by any groundwater-imposed limit
-    return MIN(infil, MaxNativeInfil);
+    return MIN(infil, st->maxNativeInfil);
 }
 
 //=============================================================================
 
-double  getStorageDrainRate(double storageDepth, double soilTheta, 
-                            double paveDepth, double surfaceDepth)
+double  getStorageDrainRate(TLidState* st, double storageDepth,
+                            double soilTheta, double paveDepth,
+                            double surfaceDepth)
 //
 //  Purpose: computes underdrain flow rate in a LID's storage layer.
-//  Input:   storageDepth = depth of water in storage layer (ft)
+//  Input:   st           = LID work area
+//           storageDepth = depth of water in storage layer (ft)
 //           soilTheta    = moisture content of soil layer
 //           paveDepth    = effective depth of water in pavement layer (ft)
 //           surfaceDepth = depth of ponded water on surface layer (ft)
@@ -1356,14 +1363,14 @@ double  getStorageDrainRate(double storageDepth, double soilTheta,
 //           layers above it (soil, pavement, and surface in that order)
 //           minus the drain outlet offset.
 {
-    int    curve = theLidProc->drain.qCurve;
+    int    curve = st->lidProc->drain.qCurve;
     double head = storageDepth;
     double outflow = 0.0;
-    double paveThickness    = theLidProc->pavement.thickness;
-    double soilThickness    = theLidProc->soil.thickness;
-    double soilPorosity     = theLidProc->soil.porosity;
-    double soilFieldCap     = theLidProc->soil.fieldCap;
-    double storageThickness = theLidProc->storage.thickness;
+    double paveThickness    = st->lidProc->pavement.thickness;
+    double soilThickness    = st->lidProc->soil.thickness;
+    double soilPorosity     = st->lidProc->soil.porosity;
+    double soilFieldCap     = st->lidProc->soil.fieldCap;
+    double storageThickness = st->lidProc->storage.thickness;
 
     // --- storage layer is full
     if ( storageDepth >= storageThickness )
@@ -1403,13 +1410,13 @@ double  getStorageDrainRate(double storageDepth, double soilTheta,
     // --- no outflow if:
     //     a) no prior outflow and head below open threshold
     //     b) prior outflow and head below closed threshold
-    if ( theLidUnit->oldDrainFlow == 0.0 &&
-         head <= theLidProc->drain.hOpen ) return 0.0;
-    if ( theLidUnit->oldDrainFlow > 0.0 &&
-         head <= theLidProc->drain.hClose ) return 0.0;
+    if ( st->lidUnit->oldDrainFlow == 0.0 &&
+         head <= st->lidProc->drain.hOpen ) return 0.0;
+    if ( st->lidUnit->oldDrainFlow > 0.0 &&
+         head <= st->lidProc->drain.hClose ) return 0.0;
 
     // --- make head relative to drain offset
-    head -= theLidProc->drain.offset;
+    head -= st->lidProc->drain.offset;
 
     // --- compute drain outflow from underdrain flow equation in user units
     //     (head in inches or mm, flow rate in in/hr or mm/hr)
@@ -1419,8 +1426,8 @@ double  getStorageDrainRate(double storageDepth, double soilTheta,
         head *= UCF(RAINDEPTH);
 
         // --- compute drain outflow in user units
-        outflow = theLidProc->drain.coeff *
-                  pow(head, theLidProc->drain.expon);
+        outflow = st->lidProc->drain.coeff *
+                  pow(head, st->lidProc->drain.expon);
 
         // --- apply user-supplied control curve to outflow
         if (curve >= 0)  outflow *= table_lookup(&Curve[curve], head);
@@ -1433,33 +1440,35 @@ double  getStorageDrainRate(double storageDepth, double soilTheta,
 
 //=============================================================================
 
-double getDrainMatOutflow(double depth)
+double getDrainMatOutflow(TLidState* st, double depth)
 //
 //  Purpose: computes flow rate through a green roof's drainage mat.
-//  Input:   depth = depth of water in drainage mat (ft)
+//  Input:   st = LID work area
+//           depth = depth of water in drainage mat (ft)
 //  Output:  returns flow in drainage mat (ft/s)
 //
 {
     //... default is to pass all inflow
-    double result = SoilPerc;
+    double result = st->soilPerc;
 
     //... otherwise use Manning eqn. if its parameters were supplied
-    if ( theLidProc->drainMat.alpha > 0.0 )
+    if ( st->lidProc->drainMat.alpha > 0.0 )
     {
-        result = theLidProc->drainMat.alpha * pow(depth, 5.0/3.0) *
-                 theLidUnit->fullWidth / theLidUnit->area *
-                 theLidProc->drainMat.voidFrac;
+        result = st->lidProc->drainMat.alpha * pow(depth, 5.0/3.0) *
+                 st->lidUnit->fullWidth / st->lidUnit->area *
+                 st->lidProc->drainMat.voidFrac;
     }
     return result;
 }
 
 //=============================================================================
 
-void getEvapRates(double surfaceVol, double paveVol, double soilVol,
-    double storageVol, double pervFrac)
+void getEvapRates(TLidState* st, double surfaceVol, double paveVol,
+    double soilVol, double storageVol, double pervFrac)
 //
 //  Purpose: computes surface, pavement, soil, and storage evaporation rates.
-//  Input:   surfaceVol = volume/area of ponded water on surface layer (ft)
+//  Input:   st         = LID work area
+//           surfaceVol = volume/area of ponded water on surface layer (ft)
 //           paveVol    = volume/area of water in pavement pores (ft)
 //           soilVol    = volume/area of water in soil (or pavement) pores (ft)
 //           storageVol = volume/area of water in storage layer (ft)
@@ -1470,57 +1479,60 @@ void getEvapRates(double surfaceVol, double paveVol, double soilVol,
     double availEvap;
 
     //... surface evaporation flux
-    availEvap = EvapRate;
-    SurfaceEvap = MIN(availEvap, surfaceVol/Tstep);
-    SurfaceEvap = MAX(0.0, SurfaceEvap);
-    availEvap = MAX(0.0, (availEvap - SurfaceEvap));
+    availEvap = st->evapRate;
+    st->surfaceEvap = MIN(availEvap, surfaceVol/st->tStep);
+    st->surfaceEvap = MAX(0.0, st->surfaceEvap);
+    availEvap = MAX(0.0, (availEvap - st->surfaceEvap));
     availEvap *= pervFrac;
 
     //... no subsurface evap if water is infiltrating
-    if ( SurfaceInfil > 0.0 )
+    if ( st->surfaceInfil > 0.0 )
     {
-        PaveEvap = 0.0;
-        SoilEvap = 0.0;
-        StorageEvap = 0.0;
+        st->paveEvap = 0.0;
+        st->soilEvap = 0.0;
+        st->storageEvap = 0.0;
     }
     else
     {
         //... pavement evaporation flux
-        PaveEvap = MIN(availEvap, paveVol / Tstep);
-        availEvap = MAX(0.0, (availEvap - PaveEvap));
+        st->paveEvap = MIN(availEvap, paveVol / st->tStep);
+        availEvap = MAX(0.0, (availEvap - st->paveEvap));
 
         //... soil evaporation flux
-        SoilEvap = MIN(availEvap, soilVol / Tstep);
-        availEvap = MAX(0.0, (availEvap - SoilEvap));
+        st->soilEvap = MIN(availEvap, soilVol / st->tStep);
+        availEvap = MAX(0.0, (availEvap - st->soilEvap));
 
         //... storage evaporation flux
-        StorageEvap = MIN(availEvap, storageVol / Tstep);
+        st->storageEvap = MIN(availEvap, storageVol / st->tStep);
     }
 }
 
 //=============================================================================
 
-double getSurfaceOverflowRate(double* surfaceDepth)
+double getSurfaceOverflowRate(TLidState* st, double* surfaceDepth)
 //
 //  Purpose: finds surface overflow rate from a LID unit.
-//  Input:   surfaceDepth = depth of water stored in surface layer (ft)
+//  Input:   st = LID work area
+//           surfaceDepth = depth of water stored in surface layer (ft)
 //  Output:  returns the overflow rate (ft/s)
 //
 {
-    double delta = *surfaceDepth - theLidProc->surface.thickness;
+    double delta = *surfaceDepth - st->lidProc->surface.thickness;
     if (  delta <= 0.0 ) return 0.0;
-    *surfaceDepth = theLidProc->surface.thickness;
-    return delta * theLidProc->surface.voidFrac / Tstep;
+    *surfaceDepth = st->lidProc->surface.thickness;
+    return delta * st->lidProc->surface.voidFrac / st->tStep;
 }
 
 //=============================================================================
 
-void updateWaterBalance(TLidUnit *lidUnit, double inflow, double evap,
-    double infil, double surfFlow, double drainFlow, double storage)
+void updateWaterBalance(TLidState* st, TLidUnit *lidUnit, double inflow,
+    double evap, double infil, double surfFlow, double drainFlow,
+    double storage)
 //
 //  Purpose: updates components of the water mass balance for a LID unit
 //           over the current time step.
-//  Input:   lidUnit   = a particular LID unit
+//  Input:   st        = LID work area (supplies the time step)
+//           lidUnit   = a particular LID unit
 //           inflow    = runon + rainfall to the LID unit (ft/s)
 //           evap      = evaporation rate from the unit (ft/s)
 //           infil     = infiltration out the bottom of the unit (ft/s)
@@ -1530,25 +1542,26 @@ void updateWaterBalance(TLidUnit *lidUnit, double inflow, double evap,
 //  Output:  none
 //
 {
-    lidUnit->volTreated += inflow * Tstep;
-    lidUnit->waterBalance.inflow += inflow * Tstep;
-    lidUnit->waterBalance.evap += evap * Tstep;
-    lidUnit->waterBalance.infil += infil * Tstep;
-    lidUnit->waterBalance.surfFlow += surfFlow * Tstep;
-    lidUnit->waterBalance.drainFlow += drainFlow * Tstep;
+    lidUnit->volTreated += inflow * st->tStep;
+    lidUnit->waterBalance.inflow += inflow * st->tStep;
+    lidUnit->waterBalance.evap += evap * st->tStep;
+    lidUnit->waterBalance.infil += infil * st->tStep;
+    lidUnit->waterBalance.surfFlow += surfFlow * st->tStep;
+    lidUnit->waterBalance.drainFlow += drainFlow * st->tStep;
     lidUnit->waterBalance.finalVol = storage;
 }
 
 //=============================================================================
 
-int modpuls_solve(int n, double* x, double* xOld, double* xPrev,
-                  double* xMin, double* xMax, double* xTol,
+int modpuls_solve(TLidState* st, int n, double* x, double* xOld,
+                  double* xPrev, double* xMin, double* xMax, double* xTol,
                   double* qOld, double* q, double dt, double omega,
-                  void (*derivs)(double*, double*))
+                  void (*derivs)(TLidState*, double*, double*))
 //
 //  Purpose: solves system of equations dx/dt = q(x) for x at end of time step
 //           dt using a modified Puls method.
-//  Input:   n = number of state variables
+//  Input:   st = LID work area passed on to derivs
+//           n = number of state variables
 //           x = vector of state variables
 //           xOld = state variable values at start of time step
 //           xPrev = state variable values from previous iteration
@@ -1583,7 +1596,7 @@ int modpuls_solve(int n, double* x, double* xOld, double* xPrev,
     {
         //... compute flux rates for current state levels
         canStop = 1;
-        derivs(x, q);
+        derivs(st, x, q);
 
         //... update state levels based on current flux rates
         for (i=0; i<n; i++)
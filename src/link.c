@@ -70,6 +70,7 @@ static const double MIN_DELTA_Z = 0.001; // minimum elevation change for conduit
 //  link_readXsectParams   (called by parseLine in input.c)
 //  link_readLossParams    (called by parseLine in input.c)
 //  link_validate          (called by project_validate in project.c)
+//  link_adjustEndNodes    (called by project_validate in project.c)
 //  link_initState         (called by initObjects in swmm5.c)
 //  link_setOldHydState    (called by routing_execute in routing.c)
 //  link_setOldQualState   (called by routing_execute in routing.c)
@@ -416,9 +417,10 @@ void  link_validate(int j)
 //  Output:  none
 //  Purpose: validates a link's properties.
 //
+//  NOTE: links are validated in parallel, so this function must not
+//        modify any other object (see link_adjustEndNodes).
+//
 {
-    int   n;
-
     if ( LinkOffsets == ELEV_OFFSET ) link_convertOffsets(j);
     switch ( Link[j].type )
     {
@@ -446,6 +448,29 @@ void  link_validate(int j)
               else report_writeWarningMsg(WARN10a, Link[j].ID);
           }
     }    
+}
+
+//=============================================================================
+
+void link_adjustEndNodes(int j)
+//
+//  Input:   j = link index
+//  Output:  none
+//  Purpose: adjusts the full depth or volume of a validated link's end nodes
+//           to accommodate the link.
+//
+{
+    int   n;
+    int   k = Link[j].subIndex;
+
+    // --- assign wet well volume to inlet node of Type 1 pump
+    if ( Link[j].type == PUMP && Pump[k].type == TYPE1_PUMP )
+    {
+        n = Link[j].node1;
+        if ( Node[n].type != STORAGE )
+            Node[n].fullVolume = MAX(Node[n].fullVolume,
+                                     Pump[k].xMax / UCF(VOLUME));
+    }
 
     // --- force max. depth of end nodes to be >= link crown height
     //     at non-storage nodes
@@ -1190,7 +1215,7 @@ void  conduit_validate(int j, int k)
         else if ( Link[j].xsect.aFull <= 0.0 )
             report_writeErrorMsg(ERR_XSECT, Link[j].ID);
     }
-    if ( ErrorCode ) return;
+    if ( report_getErrorCode() ) return;
 
     // --- check for negative offsets
     if ( Link[j].offset1 < 0.0 )
@@ -1451,6 +1476,7 @@ void  conduit_initState(int j, int k)
     Link[j].oldDepth = Link[j].newDepth;
     Conduit[k].evapLossRate = 0.0;
     Conduit[k].seepLossRate = 0.0;
+    Conduit[k].fricFactor = 0.0;
 }
 
 //=============================================================================
@@ -1616,8 +1642,8 @@ void  pump_validate(int j, int k)
 //  Purpose: validates a pump's properties
 //
 {
-    int    m, n1;
-    double x, y;
+    int    i, m;
+    TTableEntry* entry;
 
     Link[j].xsect.yFull = 0.0;
 
@@ -1637,15 +1663,16 @@ void  pump_validate(int j, int k)
         else
         {
             Pump[k].type = Curve[m].curveType - PUMP1_CURVE;
-            if ( table_getFirstEntry(&Curve[m], &x, &y) )
+            entry = Curve[m].entries;
+            if ( Curve[m].nEntries > 0 )
             {
-                Link[j].qFull = y;
-                Pump[k].xMin = x;
-                Pump[k].xMax = x;
-                while ( table_getNextEntry(&Curve[m], &x, &y) )
+                Link[j].qFull = entry[0].y;
+                Pump[k].xMin = entry[0].x;
+                Pump[k].xMax = entry[0].x;
+                for (i = 1; i < Curve[m].nEntries; i++)
                 {
-                    Link[j].qFull = MAX(y, Link[j].qFull);
-                    Pump[k].xMax = x;
+                    Link[j].qFull = MAX(entry[i].y, Link[j].qFull);
+                    Pump[k].xMax = entry[i].x;
                 }
             }
             Link[j].qFull /= UCF(FLOW);
@@ -1656,15 +1683,6 @@ void  pump_validate(int j, int k)
     if ( Pump[k].yOn > 0.0 && Pump[k].yOn <= Pump[k].yOff )
         report_writeErrorMsg(ERR_PUMP_LIMITS, Link[j].ID);
 
-    // --- assign wet well volume to inlet node of Type 1 pump
-    if ( Pump[k].type == TYPE1_PUMP )
-    {
-        n1 = Link[j].node1;
-        if ( Node[n1].type != STORAGE )
-            Node[n1].fullVolume = MAX(Node[n1].fullVolume,
-                                      Pump[k].xMax / UCF(VOLUME));
-    }
-
 }
 
 //=============================================================================
@@ -25,6 +25,10 @@ int  main(int argc, char *argv[])
 //  where f1 = name of input file, f2 = name of report file, and
 //  f3 = name of binary output file if saved (or blank if not saved).
 //
+//  Command line to convert a project's rainfall data files to a binary
+//  rainfall interface file is: runswmm --rainfall f1  f2  f3
+//  where f3 = name of the rainfall interface file.
+//
 {
     char *inputFile;
     char *reportFile;
@@ -61,7 +65,9 @@ int  main(int argc, char *argv[])
             printf("\t--help (-h)       SWMM Help\n");
             printf("\t--version (-v)    Build Version\n");
             printf("\nRUNNING A SIMULATION:\n");
-            printf("\t runswmm <input file> <report file> <optional output file>\n\n");
+            printf("\t runswmm <input file> <report file> <optional output file>\n");
+            printf("\nSAVING RAINFALL DATA FILES TO A BINARY RAINFALL FILE:\n");
+            printf("\t runswmm --rainfall <input file> <report file> <rainfall file>\n\n");
         }
         else if (strcmp(arg1, "--version") == 0 || strcmp(arg1, "-v") == 0)
         {
@@ -73,6 +79,23 @@ int  main(int argc, char *argv[])
             printf("\nUnknown Argument (See Help --help)\n\n");
         }
     }
+    else if (strcmp(argv[1], "--rainfall") == 0 || strcmp(argv[1], "-r") == 0)
+    {
+        if (argc != 5)
+        {
+            printf("\nNot Enough Arguments (See Help --help)\n\n");
+            return 0;
+        }
+        printf("\n... EPA SWMM %d.%d (Build %d.%d.%0d)\n", vMajor, vMinor,
+            vMajor, vMinor, vRelease);
+
+        // --- save rainfall interface file
+        swmm_convertRainfall(argv[2], argv[3], argv[4]);
+        runTime = difftime(time(0), start);
+        printf("\n\n... EPA SWMM completed in %.2f seconds.", runTime);
+        if ( swmm_getError(errMsg, msgLen) > 0 ) printf(" There are errors.\n");
+        else printf("\n");
+    }
     else
     {
         // --- extract file names from command line arguments
@@ -64,6 +64,36 @@ double*  NodeInflow;              // total inflow volume to each node (ft3)
 double*  NodeOutflow;             // total outflow volume from each node (ft3)
 double   TotalArea;               // total drainage area (ft2)
 
+//-----------------------------------------------------------------------------
+//  Update logs
+//-----------------------------------------------------------------------------
+//  When runoff is computed in parallel each thread records its updates to the
+//  runoff, loading and groundwater totals in its own log. The logs are then
+//  replayed in thread order, which (under a static schedule) is subcatchment
+//  order, so the totals are summed exactly as in a serial run.
+enum LogEntryType {RUNOFF_ENTRY, LOADING_ENTRY, GWATER_ENTRY};
+
+typedef struct
+{
+    char    kind;                 // type of total updated (see LogEntryType)
+    char    type;                 // flow, loading or groundwater component
+    int     p;                    // pollutant index (for loadings)
+    double  v;                    // volume or mass added to the total
+}   TLogEntry;
+
+typedef struct
+{
+    int        count;             // number of entries recorded
+    int        size;              // number of entries allocated
+    char       failed;            // TRUE if an entry could not be recorded
+    TLogEntry* entry;             // array of recorded entries
+}   TUpdateLog;
+
+static int         Nlogs;         // number of update logs
+static TUpdateLog* Logs;          // array of update logs
+static TUpdateLog* CurrentLog;    // log used by the current thread (or NULL)
+#pragma omp threadprivate(CurrentLog)
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -74,6 +104,11 @@ double   TotalArea;               // total drainage area (ft2)
 //  massbal_updateDrainTotals   (called from evalLidUnit in lid.c)
 //  massbal_updateLoadingTotals (called from subcatch_getBuildup)
 //  massbal_updateGwaterTotals  (called from updateMassBal in gwater.c)
+//  massbal_openLogs            (called from runoff_open)
+//  massbal_closeLogs           (called from runoff_close)
+//  massbal_startLog            (called from runoff_execute)
+//  massbal_stopLog             (called from runoff_execute)
+//  massbal_commitLogs          (called from runoff_execute)
 //  massbal_updateRoutingTotals (called from routing_execute)
 //  massbal_initTimeStepTotals  (called from routing_execute)
 //  massbal_addInflowFlow       (called from routing.c)
@@ -102,6 +137,7 @@ double massbal_getQualError(void);
 /* START modification by Alejandro Figueroa | EAWAG */
 double massbal_getTempError(void);
 /* END modification by Alejandro Figueroa | EAWAG */
+static void addToLog(int kind, int type, int p, double v);
 
 //=============================================================================
 
@@ -381,6 +417,11 @@ void massbal_updateRunoffTotals(int flowType, double v)
 //  Purpose: updates runoff totals after current time step.
 //
 {
+    if ( CurrentLog )
+    {
+        addToLog(RUNOFF_ENTRY, flowType, 0, v);
+        return;
+    }
     switch(flowType)
     {
     case RUNOFF_RAINFALL: RunoffTotals.rainfall += v; break;
@@ -406,6 +447,15 @@ void massbal_updateGwaterTotals(double vInfil, double vUpperEvap, double vLowerE
 //  Purpose: updates groundwater totals after current time step.
 //
 {
+    if ( CurrentLog )
+    {
+        addToLog(GWATER_ENTRY, 0, 0, vInfil);
+        addToLog(GWATER_ENTRY, 1, 0, vUpperEvap);
+        addToLog(GWATER_ENTRY, 2, 0, vLowerEvap);
+        addToLog(GWATER_ENTRY, 3, 0, vLowerPerc);
+        addToLog(GWATER_ENTRY, 4, 0, vGwater);
+        return;
+    }
     GwaterTotals.infil     += vInfil;
     GwaterTotals.upperEvap += vUpperEvap;
     GwaterTotals.lowerEvap += vLowerEvap;
@@ -415,6 +465,109 @@ void massbal_updateGwaterTotals(double vInfil, double vUpperEvap, double vLowerE
 
 //=============================================================================
 
+int massbal_openLogs(int n)
+//
+//  Input:   n = number of update logs (one per thread)
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: allocates the logs that defer updates to runoff totals made
+//           by parallel threads.
+//
+{
+    Nlogs = 0;
+    CurrentLog = NULL;
+    Logs = (TUpdateLog *) calloc(n, sizeof(TUpdateLog));
+    if ( Logs == NULL ) return FALSE;
+    Nlogs = n;
+    return TRUE;
+}
+
+//=============================================================================
+
+void massbal_closeLogs()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory used by the update logs.
+//
+{
+    int i;
+
+    if ( Logs ) for (i = 0; i < Nlogs; i++) FREE(Logs[i].entry);
+    FREE(Logs);
+    Nlogs = 0;
+    CurrentLog = NULL;
+}
+
+//=============================================================================
+
+void massbal_startLog(int i)
+//
+//  Input:   i = index of an update log
+//  Output:  none
+//  Purpose: has the calling thread record its updates to the runoff,
+//           loading and groundwater totals in log i.
+//
+{
+    if ( i >= 0 && i < Nlogs ) CurrentLog = &Logs[i];
+}
+
+//=============================================================================
+
+void massbal_stopLog()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: has the calling thread update totals directly again.
+//
+{
+    CurrentLog = NULL;
+}
+
+//=============================================================================
+
+int massbal_commitLogs()
+//
+//  Input:   none
+//  Output:  returns FALSE if any log ran out of memory, TRUE otherwise
+//  Purpose: adds the updates recorded in each log, in log order, to the
+//           runoff, loading and groundwater totals and empties the logs.
+//
+{
+    int        i, k;
+    int        result = TRUE;
+    TLogEntry* e;
+    double*    gwTotal[] = {&GwaterTotals.infil, &GwaterTotals.upperEvap,
+                            &GwaterTotals.lowerEvap, &GwaterTotals.lowerPerc,
+                            &GwaterTotals.gwater};
+
+    CurrentLog = NULL;
+    for (i = 0; i < Nlogs; i++)
+    {
+        for (k = 0; k < Logs[i].count; k++)
+        {
+            e = &Logs[i].entry[k];
+            switch (e->kind)
+            {
+            case RUNOFF_ENTRY:
+                massbal_updateRunoffTotals(e->type, e->v);
+                break;
+            case LOADING_ENTRY:
+                massbal_updateLoadingTotals(e->type, e->p, e->v);
+                break;
+            case GWATER_ENTRY:
+                *gwTotal[(int)e->type] += e->v;
+                break;
+            }
+        }
+        if ( Logs[i].failed ) result = FALSE;
+        Logs[i].count = 0;
+        Logs[i].failed = FALSE;
+    }
+    return result;
+}
+
+//=============================================================================
+
 void massbal_initTimeStepTotals()
 //
 //  Input:   none
@@ -497,6 +650,11 @@ void massbal_updateLoadingTotals(int type, int p, double w)
 //  Purpose: adds inflow mass loading to loading totals for current time step.
 //
 {
+    if ( CurrentLog )
+    {
+        addToLog(LOADING_ENTRY, type, p, w);
+        return;
+    }
     switch (type)
     {
       case BUILDUP_LOAD:     LoadingTotals[p].buildup    += w; break;
@@ -1286,3 +1444,43 @@ double tempbal_getStoredMass()
     return storedMass;
 }
 /* END modification by Alejandro Figueroa | EAWAG */
+
+//=============================================================================
+
+void addToLog(int kind, int type, int p, double v)
+//
+//  Input:   kind = type of total being updated (see LogEntryType)
+//           type = flow, loading or groundwater component of the total
+//           p = pollutant index
+//           v = volume or mass added to the total
+//  Output:  none
+//  Purpose: records an update to a runoff phase total in the calling
+//           thread's update log.
+//
+{
+    TUpdateLog* log = CurrentLog;
+    TLogEntry*  entry;
+    int         size;
+
+    // --- enlarge the log if it is full
+    if ( log->count == log->size )
+    {
+        size = MAX(2 * log->size, 1024);
+        entry = (TLogEntry *) realloc(log->entry, size * sizeof(TLogEntry));
+        if ( entry == NULL )
+        {
+            log->failed = TRUE;
+            return;
+        }
+        log->entry = entry;
+        log->size = size;
+    }
+
+    // --- append the update to the log
+    entry = &log->entry[log->count];
+    entry->kind = (char)kind;
+    entry->type = (char)type;
+    entry->p = p;
+    entry->v = v;
+    log->count++;
+}
@@ -9,14 +9,20 @@
 //  Modified by L. Rossman, 8/13/94.
 //
 //  AllocInit()     - create an alloc pool, returns the old pool handle
-//  Alloc()         - allocate memory
+//  Alloc()         - allocate zero-filled memory
 //  AllocReset()    - reset the current pool
 //  AllocSetPool()  - set the current pool
 //  AllocFree()     - free the memory used by the current pool.
+//
+//  Besides object ID names, the pool holds the small objects and arrays
+//  that each project object owns for its whole lifetime so that they are
+//  all released at once when the project is closed. The pool is not
+//  thread safe.
 //-----------------------------------------------------------------------------
 
 
 #include <stdlib.h>
+#include <string.h>
 #include "mempool.h"
 
 /*
@@ -26,6 +32,13 @@
 
 #define ALLOC_BLOCK_SIZE   64000       /*(62*1024)*/
 
+/*
+**  ALLOC_ALIGN - alignment of each allocation, suitable for doubles and
+**  pointers (must be a power of 2 that divides ALLOC_BLOCK_SIZE).
+*/
+
+#define ALLOC_ALIGN        8
+
 /*
 **  alloc_hdr_t - Header for each block of memory.
 */
@@ -58,24 +71,31 @@ static alloc_root_t *root;
 /*
 **  AllocHdr()
 **
-**  Private routine to allocate a header and memory block.
+**  Private routine to allocate a header and a zero-filled memory
+**  block of at least the given size.
 */
 
-static alloc_hdr_t *AllocHdr(void);
+static alloc_hdr_t *AllocHdr(long size);
                 
-static alloc_hdr_t * AllocHdr()
+static alloc_hdr_t * AllocHdr(long size)
 {
     alloc_hdr_t     *hdr;
     char            *block;
 
-    block = (char *) malloc(ALLOC_BLOCK_SIZE);
+    if (size < ALLOC_BLOCK_SIZE) size = ALLOC_BLOCK_SIZE;
+    block = (char *) calloc(size, 1);
     hdr   = (alloc_hdr_t *) malloc(sizeof(alloc_hdr_t));
 
-    if (hdr == NULL || block == NULL) return(NULL);
+    if (hdr == NULL || block == NULL)
+    {
+        free(block);
+        free(hdr);
+        return(NULL);
+    }
     hdr->block = block;
     hdr->free  = block;
     hdr->next  = NULL;
-    hdr->end   = block + ALLOC_BLOCK_SIZE;
+    hdr->end   = block + size;
 
     return(hdr);
 }
@@ -94,7 +114,7 @@ alloc_handle_t * AllocInit()
 
     root = (alloc_root_t *) malloc(sizeof(alloc_root_t));
     if (root == NULL) return(NULL);
-    if ( (root->first = AllocHdr()) == NULL) return(NULL);
+    if ( (root->first = AllocHdr(ALLOC_BLOCK_SIZE)) == NULL) return(NULL);
     root->current = root->first;
     newpool = (alloc_handle_t *) root;
     return(newpool);
@@ -111,43 +131,42 @@ alloc_handle_t * AllocInit()
 char * Alloc(long size)
 {
     alloc_hdr_t  *hdr = root->current;
+    alloc_hdr_t  *newhdr;
     char         *ptr;
 
     /*
-    **  Align to 4 byte boundary - should be ok for most machines.
-    **  Change this if your machine has weird alignment requirements.
+    **  Align to an 8 byte boundary so that doubles and pointers
+    **  can be stored in the memory returned.
     */
-    size = (size + 3) & 0xfffffffc;
-
-    ptr = hdr->free;
-    hdr->free += size;
+    size = (size + ALLOC_ALIGN - 1) & ~(long)(ALLOC_ALIGN - 1);
 
-    /* Check if the current block is exhausted. */
+    /* Check if the current block has room. */
 
-    if (hdr->free >= hdr->end)
+    if (size > hdr->end - hdr->free)
     {
-        /* Is the next block already allocated? */
+        /* Is the next block already allocated and big enough? */
 
-        if (hdr->next != NULL)
+        if (hdr->next != NULL && size <= hdr->next->end - hdr->next->block)
         {
             /* re-use block */
             hdr->next->free = hdr->next->block;
+            memset(hdr->next->block, 0, hdr->next->end - hdr->next->block);
             root->current = hdr->next;
         }
         else
         {
-            /* extend the pool with a new block */
-            if ( (hdr->next = AllocHdr()) == NULL) return(NULL);
-            root->current = hdr->next;
+            /* extend the pool with a new block (big enough for size) */
+            if ( (newhdr = AllocHdr(size)) == NULL) return(NULL);
+            newhdr->next = hdr->next;
+            hdr->next = newhdr;
+            root->current = newhdr;
         }
-
-        /* set ptr to the first location in the next block */
-        ptr = root->current->free;
-        root->current->free += size;
     }
 
     /* Return pointer to allocated memory. */
 
+    ptr = root->current->free;
+    root->current->free += size;
     return(ptr);
 }
 
@@ -177,6 +196,8 @@ void  AllocReset()
 {
     root->current = root->first;
     root->current->free = root->current->block;
+    memset(root->current->block, 0,
+           root->current->end - root->current->block);
 }
 
 
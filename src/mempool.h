@@ -22,5 +22,12 @@ alloc_handle_t *AllocSetPool(alloc_handle_t *);
 void            AllocReset(void);
 void            AllocFreePool(void);
 
+/*
+**  AllocArray() - allocate a zero-filled array of n items of a given type
+**  from the current pool.
+*/
+
+#define AllocArray(type, n)  ((type *) Alloc((long)((n) * sizeof(type))))
+
 
 #endif //MEMPOOL_H
@@ -1566,17 +1566,23 @@ void outfall_setOutletDepth(int j, double yNorm, double yCrit, double z)
         stage = Outfall[i].fixedStage;
         break;
 
+      // --- table lookups update the table's current position
+      //     so they are made by one thread at a time
       case TIDAL_OUTFALL:
         k = Outfall[i].tideCurve;
-        table_getFirstEntry(&Curve[k], &x, &y);
-        currentDate = NewRoutingTime / MSECperDAY;
-        x += ( currentDate - floor(currentDate) ) * 24.0;
-        stage = table_lookup(&Curve[k], x) / UCF(LENGTH);
+        #pragma omp critical(tseries)
+        {
+            table_getFirstEntry(&Curve[k], &x, &y);
+            currentDate = NewRoutingTime / MSECperDAY;
+            x += ( currentDate - floor(currentDate) ) * 24.0;
+            stage = table_lookup(&Curve[k], x) / UCF(LENGTH);
+        }
         break;
 
       case TIMESERIES_OUTFALL:
         k = Outfall[i].stageSeries;
         currentDate = StartDateTime + NewRoutingTime / MSECperDAY;
+        #pragma omp critical(tseries)
         stage = table_tseriesLookup(&Tseries[k], currentDate, TRUE) /
                 UCF(LENGTH);
         break;
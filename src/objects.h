@@ -82,15 +82,13 @@ typedef struct
 }  TFile;
 
 //-----------------------------------------
-// LINKED LIST ENTRY FOR TABLES/TIME SERIES
+// DATA POINT FOR TABLES/TIME SERIES
 //-----------------------------------------
-struct  TableEntry
+typedef struct
 {
    double  x;
    double  y;
-   struct  TableEntry* next;
-};
-typedef struct TableEntry TTableEntry;
+}  TTableEntry;
 
 //-------------------------
 // CURVE/TIME SERIES OBJECT
@@ -104,10 +102,15 @@ typedef struct
    double        lastDate;        // last input date for time series
    double        x1, x2;          // current bracket on x-values
    double        y1, y2;          // current bracket on y-values
-   TTableEntry*  firstEntry;      // first data point
-   TTableEntry*  lastEntry;       // last data point
-   TTableEntry*  thisEntry;       // current data point
+   TTableEntry*  entries;         // data points (a block of them if in file)
+   int           nEntries;        // number of data points in entries
+   int           maxEntries;      // allocated size of entries (0 if
+                                  //   entries are in a shared cache)
+   int           thisEntry;       // index of current data point
    TFile         file;            // external data file
+   char          scratchName[MAXFNAME+1]; // binary copy of external file
+   int           fileStart;       // index in file of first point in entries
+   int           fileEnd;         // index in file of point at end of text
 }  TTable;
 
 //-----------------
@@ -128,9 +131,12 @@ typedef struct
    int           rainUnits;       // rain depth units (US or SI)
    double        snowFactor;      // snow catch deficiency correction
    //-----------------------------
-   long          startFilePos;    // starting byte position in Rain file
-   long          endFilePos;      // ending byte position in Rain file
-   long          currentFilePos;  // current byte position in Rain file
+   long long     startFilePos;    // starting byte of dates in Rain file
+   long long     depthFilePos;    // starting byte of depths in Rain file
+                                  // (-1 if each depth follows its date)
+   long          filePeriods;     // number of rain periods in Rain file
+   long          sortedPeriods;   // number of leading periods in date order
+   long          currentPeriod;   // index of next period in Rain file
    double        rainAccum;       // cumulative rainfall
    double        unitsFactor;     // units conversion factor (to inches or mm)
    DateTime      startDate;       // start date of current rainfall
@@ -535,6 +541,7 @@ typedef struct
    double        oldTemp;         // previous temperature state
    double        newTemp;         // current temperature state
    /* END modification by Alejandro Figueroa | EAWAG */
+   int           sensIndex;       // heat sensitivity report index (-1 if none)
    double        oldFlowInflow;   // previous flow inflow
    double        oldNetInflow;    // previous net inflow
    double        qualInflow;      // inflow seen for quality routing (cfs)
@@ -624,6 +631,7 @@ typedef struct
    double        aBot;            // area of bottom section
    double        sBot;            // slope of bottom section
    double        rBot;            // radius of bottom section
+   int           geomTable;       // index of geometry lookup tables (or -1)
 }  TXsect;
 
 //--------------------------------------
@@ -732,6 +740,7 @@ typedef struct
    /* END modification by Alejandro Figueroa | EAWAG */
    double        oldTemp1;        // previous temperature at upstream end (node1)
    double        oldTemp2;        // previous temperature at downstream end (node2)
+   int           sensIndex;       // heat sensitivity parameter index (-1 if none)
    int           flowClass;       // flow classification
    double        dqdh;            // change in flow w.r.t. head (ft2/sec)
    signed char   direction;       // flow direction flag
@@ -763,6 +772,9 @@ typedef struct
    char          superCritical;   // super-critical flow flag
    char          hasLosses;       // local losses flag
    char          fullState;       // determines if either or both ends full
+   double        fricRe;          // Reynolds no. of saved friction factor
+   double        fricHrad;        // hyd. radius of saved friction factor (ft)
+   double        fricFactor;      // saved force main friction factor
    /* START modification by Alejandro Figueroa | Eawag */
    double		 thickness;		  // wall thickness (ft)
    double		 kPipe;			  // thermal conductivity pipe (W/m.K)
@@ -1175,6 +1187,8 @@ typedef struct
     double       humidity;
 	char          extUnit;
     int         GTPattern;
+    int         nSensLinks;       // number of heat sensitivity conduits
+    int         nSensNodes;       // number of heat sensitivity report nodes
 }  TTempModel;
 /* END modification by Peter Schlagbauer | TUGraz; Revised by Alejandro Figueroa | Eawag */
 
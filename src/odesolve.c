@@ -24,92 +24,60 @@
 //-----------------------------------------------------------------------------
 //    Local declarations
 //-----------------------------------------------------------------------------
-int      nmax;      // max. number of equations
-double*  y;         // dependent variable
-double*  yscal;     // scaling factors
-double*  yerr;      // integration errors
-double*  ytemp;     // temporary values of y
-double*  dydx;      // derivatives of y
-double*  ak;        // derivatives at intermediate points
-
+// Workspace used for a single integration. It is declared locally in
+// odesolve_integrate so that several systems can be integrated at once.
+typedef struct
+{
+    double   y[ODE_MAXEQNS];       // dependent variable
+    double   yscal[ODE_MAXEQNS];   // scaling factors
+    double   yerr[ODE_MAXEQNS];    // integration errors
+    double   ytemp[ODE_MAXEQNS];   // temporary values of y
+    double   dydx[ODE_MAXEQNS];    // derivatives of y
+    double   ak[5*ODE_MAXEQNS];    // derivatives at intermediate points
+}   TOdeWork;
 
 // function that integrates over an error-controlled stepsize
-int rkqs(double* x, int n, double htry, double eps, double* hdid,
-         double* hnext, void (*derivs)(double, double*, double*));
+int rkqs(TOdeWork* w, double* x, int n, double htry, double eps, double* hdid,
+         double* hnext, void (*derivs)(double, double*, double*, void*),
+         void* data);
 
 // function that performs the Runge-Kutta integration step
-void rkck(double x, int n, double h, void (*derivs)(double, double*, double*));
-
-
-//-----------------------------------------------------------------------------
-//    open the ODE solver to solve system of n equations
-//    (return 1 if successful, 0 if not)
-//-----------------------------------------------------------------------------
-int odesolve_open(int n)
-{
-    int n5 = n*5;
-    nmax  = 0;
-    y     = (double *) calloc(n, sizeof(double));
-    yscal = (double *) calloc(n, sizeof(double));
-    dydx  = (double *) calloc(n, sizeof(double));
-    yerr  = (double *) calloc(n, sizeof(double));
-    ytemp = (double *) calloc(n, sizeof(double));
-    ak    = (double *) calloc(n5, sizeof(double));
-    if ( !y || !yscal || !dydx || !yerr || !ytemp || !ak ) return 0;
-    nmax = n;
-    return 1;
-}
-
-
-//-----------------------------------------------------------------------------
-//    close the ODE solver
-//-----------------------------------------------------------------------------
-void odesolve_close()
-{
-    if ( y ) free(y);
-    y = NULL;
-    if ( yscal ) free(yscal);
-    yscal = NULL;
-    if ( dydx ) free(dydx);
-    dydx = NULL;
-    if ( yerr ) free(yerr);
-    yerr = NULL;
-    if ( ytemp ) free(ytemp);
-    ytemp = NULL;
-    if ( ak ) free(ak);
-    ak = NULL;
-    nmax = 0;
-}
+void rkck(TOdeWork* w, double x, int n, double h,
+          void (*derivs)(double, double*, double*, void*), void* data);
 
 
 int odesolve_integrate(double ystart[], int n, double x1, double x2,
-      double eps, double h1, void (*derivs)(double, double*, double*))
+      double eps, double h1, void (*derivs)(double, double*, double*, void*),
+      void* data)
 //---------------------------------------------------------------
 //   Driver function for Runge-Kutta integration with adaptive
 //   stepsize control. Integrates starting n values in ystart[]
 //   from x1 to x2 with accuracy eps. h1 is the initial stepsize
 //   guess and derivs is a user-supplied function that computes
-//   derivatives dy/dx of y. On completion, ystart[] contains the
-//   new values of y at the end of the integration interval.
+//   derivatives dy/dx of y. data is passed on to derivs and
+//   holds whatever state it needs. On completion, ystart[]
+//   contains the new values of y at the end of the integration
+//   interval.
 //---------------------------------------------------------------
 {
-    int    i, errcode, nstp;
-    double hdid, hnext;
-    double x = x1;
-    double h = h1;
-    if (nmax < n) return 1;
-    for (i=0; i<n; i++) y[i] = ystart[i];
+    int      i, errcode, nstp;
+    double   hdid, hnext;
+    double   x = x1;
+    double   h = h1;
+    TOdeWork w;
+    if (n > ODE_MAXEQNS) return 1;
+    for (i=0; i<n; i++) w.y[i] = ystart[i];
     for (nstp=1; nstp<=MAXSTP; nstp++)
     {
-        derivs(x,y,dydx);
+        derivs(x,w.y,w.dydx,data);
         for (i=0; i<n; i++)
-            yscal[i] = fabs(y[i]) + fabs(dydx[i]*h) + TINY;
+            w.yscal[i] = fabs(w.y[i]) + fabs(w.dydx[i]*h) + TINY;
         if ((x+h-x2)*(x+h-x1) > 0.0) h = x2 - x;
-        errcode = rkqs(&x,n,h,eps,&hdid,&hnext,derivs);
+        errcode = rkqs(&w,&x,n,h,eps,&hdid,&hnext,derivs,data);
         if (errcode) break;
         if ((x-x2)*(x2-x1) >= 0.0)
         {
-            for (i=0; i<n; i++) ystart[i] = y[i];
+            for (i=0; i<n; i++) ystart[i] = w.y[i];
             return 0;
         }
         if (fabs(hnext) <= 0.0) return 2;
@@ -119,14 +87,15 @@ int odesolve_integrate(double ystart[], int n, double x1, double x2,
 }
 
 
-int rkqs(double* x, int n, double htry, double eps, double* hdid,
-         double* hnext, void (*derivs)(double, double*, double*))
+int rkqs(TOdeWork* w, double* x, int n, double htry, double eps, double* hdid,
+         double* hnext, void (*derivs)(double, double*, double*, void*),
+         void* data)
 //---------------------------------------------------------------
 //   Fifth-order Runge-Kutta integration step with monitoring of
 //   local truncation error to assure accuracy and adjust stepsize.
 //   Inputs are current value of x, trial step size (htry), and
 //   accuracy (eps). Outputs are stepsize taken (hdid) and estimated
-//   next stepsize (hnext). Also updated are the values of y[].
+//   next stepsize (hnext). Also updated are the values of w->y[].
 //---------------------------------------------------------------
 {
     int i;
@@ -137,13 +106,13 @@ int rkqs(double* x, int n, double htry, double eps, double* hdid,
     for (;;)
     {
         // --- take a Runge-Kutta-Cash-Karp step
-        rkck(xold, n, h, derivs);
+        rkck(w, xold, n, h, derivs, data);
 
         // --- compute scaled maximum error
         errmax = 0.0;
         for (i=0; i<n; i++)
         {
-            err = fabs(yerr[i]/yscal[i]);
+            err = fabs(w->yerr[i]/w->yscal[i]);
             if (err > errmax) errmax = err;
         }
         errmax /= eps;
@@ -173,16 +142,17 @@ int rkqs(double* x, int n, double htry, double eps, double* hdid,
             if (errmax > ERRCON) *hnext = SAFETY*h*pow(errmax,PGROW);
             else *hnext = 5.0*h;
             *x += (*hdid=h);
-            for (i=0; i<n; i++) y[i] = ytemp[i];
+            for (i=0; i<n; i++) w->y[i] = w->ytemp[i];
             return 0;
         }
     }
 }
 
 
-void rkck(double x, int n, double h, void (*derivs)(double, double*, double*))
+void rkck(TOdeWork* w, double x, int n, double h,
+          void (*derivs)(double, double*, double*, void*), void* data)
 //----------------------------------------------------------------------
-//   Uses the Runge-Kutta-Cash-Karp method to advance y[] at x
+//   Uses the Runge-Kutta-Cash-Karp method to advance w->y[] at x
 //   over stepsize h.
 //----------------------------------------------------------------------
 {
@@ -199,36 +169,36 @@ void rkck(double x, int n, double h, void (*derivs)(double, double*, double*))
     int n2 = n*2;
     int n3 = n*3;
     int n4 = n*4;
-    double *ak2 = (ak);
-    double *ak3 = ((ak)+(n));
-    double *ak4 = ((ak)+(n2));
-    double *ak5 = ((ak)+(n3));
-    double *ak6 = ((ak)+(n4));
+    double *ak2 = (w->ak);
+    double *ak3 = ((w->ak)+(n));
+    double *ak4 = ((w->ak)+(n2));
+    double *ak5 = ((w->ak)+(n3));
+    double *ak6 = ((w->ak)+(n4));
 
     for (i=0; i<n; i++)
-        ytemp[i] = y[i] + b21*h*dydx[i];
-    derivs(x+a2*h,ytemp,ak2);
+        w->ytemp[i] = w->y[i] + b21*h*w->dydx[i];
+    derivs(x+a2*h,w->ytemp,ak2,data);
 
     for (i=0; i<n; i++)
-        ytemp[i] = y[i] + h*(b31*dydx[i]+b32*ak2[i]);
-    derivs(x+a3*h,ytemp,ak3);
+        w->ytemp[i] = w->y[i] + h*(b31*w->dydx[i]+b32*ak2[i]);
+    derivs(x+a3*h,w->ytemp,ak3,data);
 
     for (i=0; i<n; i++)
-        ytemp[i] = y[i] + h*(b41*dydx[i]+b42*ak2[i] + b43*ak3[i]);
-    derivs(x+a4*h,ytemp,ak4);
+        w->ytemp[i] = w->y[i] + h*(b41*w->dydx[i]+b42*ak2[i] + b43*ak3[i]);
+    derivs(x+a4*h,w->ytemp,ak4,data);
 
     for (i=0; i<n; i++)
-        ytemp[i] = y[i] + h*(b51*dydx[i]+b52*ak2[i] + b53*ak3[i] + b54*ak4[i]);
-    derivs(x+a5*h,ytemp,ak5);
+        w->ytemp[i] = w->y[i] + h*(b51*w->dydx[i]+b52*ak2[i] + b53*ak3[i] + b54*ak4[i]);
+    derivs(x+a5*h,w->ytemp,ak5,data);
 
     for (i=0; i<n; i++)
-        ytemp[i] = y[i] + h*(b61*dydx[i]+b62*ak2[i] + b63*ak3[i] + b64*ak4[i]
+        w->ytemp[i] = w->y[i] + h*(b61*w->dydx[i]+b62*ak2[i] + b63*ak3[i] + b64*ak4[i]
                    + b65*ak5[i]);
-    derivs(x+a6*h,ytemp,ak6);
+    derivs(x+a6*h,w->ytemp,ak6,data);
 
     for (i=0; i<n; i++)
-        ytemp[i] = y[i] + h*(c1*dydx[i] + c3*ak3[i] + c4*ak4[i] + c6*ak6[i]);
+        w->ytemp[i] = w->y[i] + h*(c1*w->dydx[i] + c3*ak3[i] + c4*ak4[i] + c6*ak6[i]);
 
     for (i=0; i<n; i++)
-        yerr[i] = h*(dc1*dydx[i] +dc3*ak3[i] + dc4*ak4[i] + dc5*ak5[i] + dc6*ak6[i]);
+        w->yerr[i] = h*(dc1*w->dydx[i] +dc3*ak3[i] + dc4*ak4[i] + dc5*ak5[i] + dc6*ak6[i]);
 }
@@ -9,11 +9,14 @@
 #define ODESOLVE_H
 
 
-// functions that open, close, and use the ODE solver
-int  odesolve_open(int n);
-void odesolve_close(void);
+// max. number of equations the ODE solver can integrate at once
+#define ODE_MAXEQNS 4
+
+// function that uses the ODE solver (derivs receives the data pointer
+// passed to odesolve_integrate)
 int  odesolve_integrate(double ystart[], int n, double x1, double x2,
-     double eps, double h1, void (*derivs)(double, double*, double*));
+     double eps, double h1, void (*derivs)(double, double*, double*, void*),
+     void* data);
 
 
 #endif //ODESOLVE_H
@@ -106,6 +106,9 @@ static void createObjects(void);
 static void deleteObjects(void);
 static void createHashTables(void);
 static void deleteHashTables(void);
+static void forEachObject(int type, void (*func)(int));
+static void validateCurve(int i);
+static void validateTseries(int i);
 
 
 //=============================================================================
@@ -192,19 +195,15 @@ void project_validate()
 {
     int i;
     int j;
-    int err;
+
+    // --- adjust number of parallel threads to be used
+    if ( NumThreads == 0 ) NumThreads = omp_get_max_threads();
+    else NumThreads = MIN(NumThreads, omp_get_max_threads());
+    if ( Nobjects[LINK] < 4 * NumThreads ) NumThreads = 1;
 
     // --- validate Curves and TimeSeries
-    for ( i=0; i<Nobjects[CURVE]; i++ )
-    {
-         err = table_validate(&Curve[i]);
-         if ( err ) report_writeErrorMsg(ERR_CURVE_SEQUENCE, Curve[i].ID);
-    }
-    for ( i=0; i<Nobjects[TSERIES]; i++ )
-    {
-        err = table_validate(&Tseries[i]);
-        if ( err ) report_writeTseriesErrorMsg(err, &Tseries[i]);
-    }
+    forEachObject(CURVE, validateCurve);
+    forEachObject(TSERIES, validateTseries);
 
     // --- validate hydrology objects
     //     (NOTE: order is important !!!!)
@@ -213,7 +212,14 @@ void project_validate()
     if ( Nobjects[SNOWMELT] == 0 ) IgnoreSnowmelt = TRUE;
     if ( Nobjects[AQUIFER]  == 0 ) IgnoreGwater   = TRUE;
     for ( i=0; i<Nobjects[AQUIFER]; i++ )  gwater_validateAquifer(i);
-    for ( i=0; i<Nobjects[SUBCATCH]; i++ ) subcatch_validate(i);
+    forEachObject(SUBCATCH, subcatch_validate);
+    for ( i=0; i<Nobjects[SUBCATCH]; i++ )
+    {
+        // --- mark each subcatchment's rain gage as being used
+        //     (done serially since gages are shared by subcatchments)
+        j = Subcatch[i].gage;
+        if ( j >= 0 ) Gage[j].isUsed = TRUE;
+    }
     for ( i=0; i<Nobjects[GAGE]; i++ )     gage_validate(i);
     for ( i=0; i<Nobjects[SNOWMELT]; i++ ) snow_validateSnowmelt(i);
 
@@ -234,8 +240,13 @@ void project_validate()
     // --- validate links before nodes, since the latter can
     //     result in adjustment of node depths
     for ( i=0; i<Nobjects[NODE]; i++) Node[i].oldDepth = Node[i].fullDepth;
-    for ( i=0; i<Nobjects[LINK]; i++) link_validate(i);
-    for ( i=0; i<Nobjects[NODE]; i++) node_validate(i);
+    forEachObject(LINK, link_validate);
+    for ( i=0; i<Nobjects[LINK]; i++) link_adjustEndNodes(i);
+    forEachObject(NODE, node_validate);
+
+    // --- build geometry lookup tables for conduit cross sections
+    if ( XsectTables && !ErrorCode && !xsect_createTables() )
+        report_writeErrorMsg(ERR_MEMORY, "");
 
     // --- adjust time steps if necessary
     if ( DryStep < WetStep )
@@ -263,11 +274,6 @@ void project_validate()
     // --- validate street/channel inlets
     inlet_validate();
 
-    // --- adjust number of parallel threads to be used
-    if ( NumThreads == 0 ) NumThreads = omp_get_max_threads();
-    else NumThreads = MIN(NumThreads, omp_get_max_threads());
-    if ( Nobjects[LINK] < 4 * NumThreads ) NumThreads = 1;
-
     // --- SWMM-HEAT Check that the temperature model has a WTEMPERATURE object
     if (TempModel.active == 1) {
         if (WTemperature.ID ==  NULL){
@@ -285,7 +291,9 @@ void project_close()
 //  Purpose: closes a SWMM project.
 //
 {
+    xsect_deleteTables();
     deleteObjects();
+    inpcache_close();
     deleteHashTables();
 }
 
@@ -303,10 +311,14 @@ int  project_init(void)
     lid_initState();
     for (j=0; j<Nobjects[TSERIES]; j++)  table_tseriesInit(&Tseries[j]);
     for (j=0; j<Nobjects[GAGE]; j++)     gage_initState(j);
+    forEachObject(SUBCATCH, subcatch_initState);
+    forEachObject(NODE, node_initState);
+    forEachObject(LINK, link_initState);
+
+    // --- number the objects being reported on
     k = 1;
     for (j=0; j<Nobjects[SUBCATCH]; j++)
     {
-        subcatch_initState(j);
         if (Subcatch[j].rptFlag > 0)
         {
             Subcatch[j].rptFlag = k;
@@ -316,7 +328,6 @@ int  project_init(void)
     k = 1;
     for (j=0; j<Nobjects[NODE]; j++)
     {
-        node_initState(j);
         if (Node[j].rptFlag > 0)
         {
             Node[j].rptFlag = k;
@@ -326,7 +337,6 @@ int  project_init(void)
     k = 1;        
     for (j=0; j<Nobjects[LINK]; j++)
     {
-        link_initState(j);
         if (Link[j].rptFlag > 0)
         {
             Link[j].rptFlag = k;
@@ -338,6 +348,61 @@ int  project_init(void)
 
 //=============================================================================
 
+void forEachObject(int type, void (*func)(int))
+//
+//  Input:   type = object type
+//           func = validation or initialization function for one object
+//  Output:  none
+//  Purpose: applies a function to each object of a given type in parallel.
+//
+//  NOTE: func may only modify the object it is applied to. Any error or
+//        warning messages it writes are deferred and then written in
+//        order of object index, so the report doesn't depend on the
+//        number of threads used.
+//
+{
+    int i;
+    int n = Nobjects[type];
+
+    report_deferMsgs();
+#pragma omp parallel for num_threads(NumThreads) schedule(dynamic, 16)
+    for (i = 0; i < n; i++)
+    {
+        report_setMsgObject(i);
+        func(i);
+    }
+    report_writeDeferredMsgs();
+}
+
+//=============================================================================
+
+void validateCurve(int i)
+//
+//  Input:   i = curve index
+//  Output:  none
+//  Purpose: checks a curve's data.
+//
+{
+    if ( table_validate(&Curve[i]) )
+        report_writeErrorMsg(ERR_CURVE_SEQUENCE, Curve[i].ID);
+}
+
+//=============================================================================
+
+void validateTseries(int i)
+//
+//  Input:   i = time series index
+//  Output:  none
+//  Purpose: checks a time series' data, converting any external file
+//           it uses.
+//
+{
+    int err = table_validate(&Tseries[i]);
+    if ( err ) report_writeTseriesErrorMsg(err, &Tseries[i]);
+}
+
+//=============================================================================
+
 int   project_addObject(int type, char *id, int n)
 //
 //  Input:   type = object type
@@ -616,6 +681,8 @@ int project_readOption(char* s1, char* s2)
       case IGNORE_ROUTING:
       case IGNORE_QUALITY:
       case IGNORE_RDII:
+      case XSECT_TABLES:
+      case INPUT_CACHE:
         m = findmatch(s2, NoYesWords);
         if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
         switch ( k )
@@ -629,6 +696,8 @@ int project_readOption(char* s1, char* s2)
           case IGNORE_ROUTING:    IgnoreRouting   = m;  break;
           case IGNORE_QUALITY:    IgnoreQuality   = m;  break;
           case IGNORE_RDII:       IgnoreRDII      = m;  break;
+          case XSECT_TABLES:      XsectTables     = m;  break;
+          case INPUT_CACHE:       InputCache      = m;  break;
         }
         break;
 
@@ -734,6 +803,15 @@ int project_readOption(char* s1, char* s2)
         MaxTrials = m;
         break;
 
+      // --- number of times the dynamic wave time step can be halved
+      //     for conduits whose Courant step is shorter than the network's
+      //     (link-only sub-stepping; nodes still use the full time step)
+      case RATE_LEVELS:
+        m = atoi(s2);
+        if ( m < 0 || m > 4 ) return error_setInpError(ERR_NUMBER, s2);
+        RateLevels = m;
+        break;
+
       // --- head convergence tolerance for dynamic wave routing
       case HEAD_TOL:
         if ( !getDouble(s2, &HeadTol) )
@@ -742,6 +820,15 @@ int project_readOption(char* s1, char* s2)
         }
         break;
 
+      // --- relative change in Reynolds number & hydraulic radius within
+      //     which a force main's Darcy-Weisbach friction factor is re-used
+      case FRIC_TOL:
+        if ( !getDouble(s2, &FricTol) || FricTol < 0.0 )
+        {
+            return error_setInpError(ERR_NUMBER, s2);
+        }
+        break;
+
       // --- steady state tolerance on system inflow - outflow
       case SYS_FLOW_TOL:
         if ( !getDouble(s2, &SysFlowTol) )
@@ -767,6 +854,13 @@ int project_readOption(char* s1, char* s2)
           SurchargeMethod = m;
           break;
 
+      // --- method used to solve the dynamic wave equations
+      case SOLVER_METHOD:
+          m = findmatch(s2, SolverWords);
+          if (m < 0) return error_setInpError(ERR_KEYWORD, s2);
+          SolverMethod = m;
+          break;
+
       case TEMPDIR: // Temporary Directory
         sstrncpy(TempDir, s2, MAXFNAME);
         break;
@@ -884,6 +978,7 @@ void setDefaults()
    InfilModel      = HORTON;           // Horton infiltration method
    RouteModel      = DW;               // Dynamic wave flow routing method
    SurchargeMethod = EXTRAN;           // Use EXTRAN method for surcharging
+   SolverMethod    = PICARD;           // Use Picard iterations for DW routing
    CrownCutoff     = 0.96;             // Fractional pipe crown cutoff 
    AllowPonding    = FALSE;            // No ponding at nodes
    InertDamping    = PARTIAL_DAMPING;  // Partial inertial damping
@@ -912,10 +1007,14 @@ void setDefaults()
    ReportStep      = 900;              // Reporting time step (secs)
    StartDryDays    = 0.0;              // Antecedent dry days
    MaxTrials       = 0;                // Force use of default max. trials 
+   RateLevels      = 0;                // No multirate DW routing
    HeadTol         = 0.0;              // Force use of default head tolerance
+   FricTol         = 0.0;              // Don't re-use friction factors
    SysFlowTol      = 0.05;             // System flow tolerance for steady state
    LatFlowTol      = 0.05;             // Lateral flow tolerance for steady state
    NumThreads      = 1;                // Number of parallel threads to use
+   XsectTables     = FALSE;            // Use exact cross section geometry
+   InputCache      = FALSE;            // Don't cache input file tables
    NumEvents       = 0;                // Number of detailed routing events
 
    // Deprecated options
@@ -1104,19 +1203,20 @@ void createObjects()
     infil_create(Nobjects[SUBCATCH]);
 
     // --- allocate memory for water quality state variables
+    //     (these and the other small arrays owned by individual objects
+    //     come from the project's memory pool and are freed along with it)
     for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
-        Subcatch[j].initBuildup =
-                              (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].oldQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].newQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].pondedQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Subcatch[j].totalLoad  = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        Subcatch[j].initBuildup = AllocArray(double, Nobjects[POLLUT]);
+        Subcatch[j].oldQual = AllocArray(double, Nobjects[POLLUT]);
+        Subcatch[j].newQual = AllocArray(double, Nobjects[POLLUT]);
+        Subcatch[j].pondedQual = AllocArray(double, Nobjects[POLLUT]);
+        Subcatch[j].totalLoad  = AllocArray(double, Nobjects[POLLUT]);
     }
     for (j = 0; j < Nobjects[NODE]; j++)
     {
-        Node[j].oldQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Node[j].newQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        Node[j].oldQual = AllocArray(double, Nobjects[POLLUT]);
+        Node[j].newQual = AllocArray(double, Nobjects[POLLUT]);
         Node[j].extInflow = NULL;
         Node[j].dwfInflow = NULL;
         Node[j].rdiiInflow = NULL;
@@ -1125,29 +1225,26 @@ void createObjects()
     for (j = 0; j < Nobjects[LINK]; j++)
     {
         Link[j].inlet = NULL;
-        Link[j].oldQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Link[j].newQual = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Link[j].totalLoad = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        Link[j].oldQual = AllocArray(double, Nobjects[POLLUT]);
+        Link[j].newQual = AllocArray(double, Nobjects[POLLUT]);
+        Link[j].totalLoad = AllocArray(double, Nobjects[POLLUT]);
     }
 
     // --- allocate memory for land use buildup/washoff functions
     for (j = 0; j < Nobjects[LANDUSE]; j++)
     {
-        Landuse[j].buildupFunc =
-            (TBuildup *) calloc(Nobjects[POLLUT], sizeof(TBuildup));
-        Landuse[j].washoffFunc =
-            (TWashoff *) calloc(Nobjects[POLLUT], sizeof(TWashoff));
+        Landuse[j].buildupFunc = AllocArray(TBuildup, Nobjects[POLLUT]);
+        Landuse[j].washoffFunc = AllocArray(TWashoff, Nobjects[POLLUT]);
     }
 
     // --- allocate memory for subcatchment landuse factors
     for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
-        Subcatch[j].landFactor =
-            (TLandFactor *) calloc(Nobjects[LANDUSE], sizeof(TLandFactor));
+        Subcatch[j].landFactor = AllocArray(TLandFactor, Nobjects[LANDUSE]);
         for (k = 0; k < Nobjects[LANDUSE]; k++)
         {
             Subcatch[j].landFactor[k].buildup =
-                (double *) calloc(Nobjects[POLLUT], sizeof(double));
+                AllocArray(double, Nobjects[POLLUT]);
         }
     }
 
@@ -1199,6 +1296,7 @@ void createObjects()
     for (j = 0; j < Nobjects[LINK]; j++)
     {
         Link[j].xsect.type   = -1;
+        Link[j].xsect.geomTable = -1;
         Link[j].cLossInlet   = 0.0;
         Link[j].cLossOutlet  = 0.0;
         Link[j].cLossAvg     = 0.0;
@@ -1206,6 +1304,12 @@ void createObjects()
     }
     for (j = 0; j < Nlinks[PUMP]; j++) Pump[j].pumpCurve  = -1;
 
+    // --- initialize heat sensitivity analysis indexes
+    for (j = 0; j < Nobjects[NODE]; j++) Node[j].sensIndex = -1;
+    for (j = 0; j < Nobjects[LINK]; j++) Link[j].sensIndex = -1;
+    TempModel.nSensLinks = 0;
+    TempModel.nSensNodes = 0;
+
     // --- initialize reporting flags
     for (j = 0; j < Nobjects[SUBCATCH]; j++) Subcatch[j].rptFlag = FALSE;
     for (j = 0; j < Nobjects[NODE]; j++) Node[j].rptFlag = FALSE;
@@ -1227,51 +1331,22 @@ void deleteObjects()
 //
 //  NOTE: care is taken to first free objects that are properties of another
 //        object before the latter is freed (e.g., we must free a
-//        subcatchment's land use factors before freeing the subcatchment).
+//        subcatchment's groundwater flow expressions before freeing the
+//        subcatchment).
+//
+//  NOTE: the small objects and arrays owned by individual objects (such as
+//        land use factors, water quality state variables, nodal inflows,
+//        groundwater and snowpack objects, LID units and control rule
+//        clauses) come from the project's memory pool and are freed all
+//        at once in deleteHashTables().
 //
 {
-    int j, k;
+    int j;
 
-    // --- free memory for landuse factors & groundwater
+    // --- free memory for groundwater flow expressions
     if ( Subcatch ) for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
-        for (k = 0; k < Nobjects[LANDUSE]; k++)
-        {
-            FREE(Subcatch[j].landFactor[k].buildup);
-        }
-        FREE(Subcatch[j].landFactor);
-        FREE(Subcatch[j].groundwater);
         gwater_deleteFlowExpression(j);
-        FREE(Subcatch[j].snowpack);
-    }
-
-    // --- free memory for buildup/washoff functions
-    if ( Landuse ) for (j = 0; j < Nobjects[LANDUSE]; j++)
-    {
-        FREE(Landuse[j].buildupFunc);
-        FREE(Landuse[j].washoffFunc)
-    }
-
-    // --- free memory for water quality state variables
-    if ( Subcatch ) for (j = 0; j < Nobjects[SUBCATCH]; j++)
-    {
-        FREE(Subcatch[j].initBuildup);
-        FREE(Subcatch[j].oldQual);
-        FREE(Subcatch[j].newQual);
-        FREE(Subcatch[j].pondedQual);
-        FREE(Subcatch[j].totalLoad);
-    }
-    if ( Node ) for (j = 0; j < Nobjects[NODE]; j++)
-    {
-        FREE(Node[j].oldQual);
-        FREE(Node[j].newQual);
-    }
-    if ( Link ) for (j = 0; j < Nobjects[LINK]; j++)
-    {
-        FREE(Link[j].oldQual);
-        FREE(Link[j].newQual);
-        FREE(Link[j].totalLoad);
-        // Any inlet assigned to Link[j].inlet is freed in inlet_delete().
     }
 
     // --- free memory used for rainfall infiltration
@@ -1292,12 +1367,9 @@ void deleteObjects()
     if ( Node ) for (j = 0; j < Nnodes[OUTFALL]; j++)
         FREE(Outfall[j].wRouted);
 
-    // --- free memory used for nodal inflows & treatment functions
+    // --- free memory used for treatment functions
     if ( Node ) for (j = 0; j < Nobjects[NODE]; j++)
     {
-        inflow_deleteExtInflows(j);
-        inflow_deleteDwfInflows(j);
-        rdii_deleteRdiiInflow(j);
         treatmnt_delete(j);
     }
 
@@ -1381,7 +1453,7 @@ void deleteHashTables()
         if ( Htable[j] != NULL ) HTfree(Htable[j]);
     }
 
-    // --- free object ID memory pool
+    // --- free object ID & object property memory pool
     if ( MemPoolAllocated ) AllocFreePool();
 }
 
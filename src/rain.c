@@ -25,17 +25,28 @@
 //                        StaID  Year  Month  Day  Hour  Minute  Rainfall
 //
 //   The layout of the SWMM binary rainfall interface file is:
-//     File stamp ("SWMM5-RAIN") (10 bytes)
+//     File stamp ("SWMM5-RCOL") (10 bytes)
 //     Number of SWMM rain gages in file (4-byte int)
 //     Repeated for each rain gage:
-//       recording station ID (not SWMM rain gage ID) (MAXMSG+1 (=80) bytes)
+//       recording station ID (not SWMM rain gage ID) (MAXMSG+1 bytes)
 //       gage recording interval (seconds) (4-byte int)
-//       starting byte of rain data in file (4-byte int)
-//       ending byte+1 of rain data in file (4-byte int)
+//       number of time periods with non-zero rain (8-byte int)
+//       number of leading periods in increasing date order (8-byte int)
+//       starting byte of period dates in file (8-byte int)
+//       starting byte of period rain depths in file (8-byte int)
 //     For each gage:
-//       For each time period with non-zero rain:
-//         Date/time for start of period (8-byte double)
-//         Rain depth (inches) (4-byte float)
+//       Date/time for start of each period (8-byte doubles)
+//       Rain depth (inches) for each period (4-byte floats)
+//
+//   A gage's dates are stored apart from its rain depths so that they can
+//   be searched to find where the gage's record for a simulation begins.
+//   The file can be created ahead of time from the rain gages' data files
+//   by swmm_convertRainfall() (or SAVE RAINFALL in the [FILES] section)
+//   and then re-used by other runs.
+//
+//   Files in the earlier layout, with stamp "SWMM5-RAIN" and for each gage
+//   a station ID, interval, and starting & ending+1 byte of its data, with
+//   each period's date followed by its rain depth, can still be used.
 //
 //   Update History
 //   ==============
@@ -50,10 +61,24 @@
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
+// Large File Support
+#ifdef _MSC_VER    // Windows (32-bit and 64-bit)
+  #define F_OFF __int64
+  #define F_SEEK _fseeki64
+  #define F_TELL _ftelli64
+#else              // Other platforms
+  #define F_OFF off_t
+  #define F_SEEK fseeko
+  #define F_TELL ftello
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include "headers.h"
 
+// Definition of 8-byte integer type used for file positions & counts
+#define INT8  long long
+
 //-----------------------------------------------------------------------------
 //  Constants
 //-----------------------------------------------------------------------------
@@ -62,6 +87,20 @@ enum RainFileFormat {UNKNOWN_FORMAT, NWS_TAPE, NWS_SPACE_DELIMITED,
                      AES_HLY, CMC_HLY, CMC_FIF, STD_SPACE_DELIMITED};
 enum ConditionCodes {NO_CONDITION, ACCUMULATED_PERIOD, DELETED_PERIOD,
                      MISSING_PERIOD};
+static const int RAINBLOCK = 1024;     // rain periods read at a time
+static const int RECORDSIZE =          // bytes used by a period in
+    sizeof(DateTime) + sizeof(float);  // earlier file layout
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct                         // block of a gage's rain periods
+{
+    DateTime* dates;                   // start date of each period
+    float*    depths;                  // rain depth of each period (in)
+    long      first;                   // index of first period in block
+    int       count;                   // number of periods in block
+}  TRainBlock;
 
 //-----------------------------------------------------------------------------
 //  Shared variables
@@ -81,20 +120,33 @@ DateTime   PreviousDate;               // date of previous rainfall record
 int        GageIndex;                  // index of rain gage analyzed
 int        hasStationName;             // true if data contains station name
 
+static DateTime*   RainDates;          // dates of gage's periods being saved
+static float*      RainDepths;         // depths of gage's periods being saved
+static long        RainCount;          // number of periods being saved
+static long        RainCapacity;       // size of RainDates & RainDepths
+static TRainBlock* RainBlocks;         // periods read for each gage
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
-//  rain_open   (called by swmm_start in swmm5.c)
-//  rain_close  (called by swmm_end in swmm5.c)
+//  rain_open         (called by swmm_start in swmm5.c)
+//  rain_close        (called by swmm_end in swmm5.c)
+//  rain_convert      (called by swmm_convertRainfall in swmm5.c)
+//  rain_findPeriod   (called by gage_initState in gage.c)
+//  rain_getPeriod    (called by getFirstRainfall & getNextRainfall in gage.c)
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
+static int  countRainFileGages(void);
 static void createRainFile(int count);
 static int  rainFileConflict(int i);
 static void initRainFile(void);
-static int  findGageInFile(int i, int kount);
+static int  findGageInFile(int i, int kount, int columnar);
 static int  addGageToRainFile(int i);
+static int  writeGageData(long* nSorted);
+static DateTime readPeriodDate(int j, long k);
+static int  readPeriods(int j, long k);
 static int  findFileFormat(FILE *f, int i, int *hdrLines);
 static int  findNWSOnlineFormat(FILE *f, char *line);
 static void readFile(FILE *f, int fileFormat, int hdrLines, DateTime day1,
@@ -108,6 +160,7 @@ static int  readStdLine(char *line, DateTime day1, DateTime day2);
 static void saveAccumRainfall(DateTime date1, int hour, int minute, long v);
 static void saveRainfall(DateTime date1, int hour, int minute, float x,
             char isMissing);
+static int  growRainPeriods(void);
 static void setCondition(char flag);
 static int  getNWSInterval(char *elemType);
 static int  parseStdLine(char *line, int *year, int *month, int *day,
@@ -122,15 +175,10 @@ void  rain_open(void)
 //  Purpose: opens binary rain interface file and RDII processor.
 //
 {
-    int i;
     int count;
 
     // --- see how many gages get their data from a file
-    count = 0;
-    for (i = 0; i < Nobjects[GAGE]; i++)
-    {
-        if ( Gage[i].dataSource == RAIN_FILE ) count++;
-    }
+    count = countRainFileGages();
     Frain.file = NULL;
     if ( count == 0 )
     {
@@ -188,17 +236,134 @@ void rain_close(void)
 //  Purpose: closes rain interface file and RDII processor.
 //
 {
+    int j;
+
     if ( Frain.file )
     {
         fclose(Frain.file);
         if ( Frain.mode == SCRATCH_FILE ) remove(Frain.name);
     }
     Frain.file = NULL;
+    if ( RainBlocks )
+    {
+        for (j = 0; j < Nobjects[GAGE]; j++)
+        {
+            FREE(RainBlocks[j].dates);
+            FREE(RainBlocks[j].depths);
+        }
+        FREE(RainBlocks);
+    }
     rdii_closeRdii();
 }
 
 //=============================================================================
 
+void rain_convert(char* fname)
+//
+//  Input:   fname = name of rain interface file to create
+//  Output:  none
+//  Purpose: saves the rainfall of all gages that use rain data files to
+//           a rain interface file without running a simulation.
+//
+{
+    int count = countRainFileGages();
+
+    if ( ErrorCode ) return;
+    Frain.mode = SAVE_FILE;
+    sstrncpy(Frain.name, fname, MAXFNAME);
+    if ( count == 0 )
+    {
+        report_writeErrorMsg(ERR_RAIN_FILE_NONE, Frain.name);
+        return;
+    }
+    if ( (Frain.file = fopen(Frain.name, "w+b")) == NULL)
+    {
+        report_writeErrorMsg(ERR_RAIN_FILE_OPEN, Frain.name);
+        return;
+    }
+    createRainFile(count);
+    if ( Frain.file ) fclose(Frain.file);
+    Frain.file = NULL;
+}
+
+//=============================================================================
+
+long rain_findPeriod(int j, DateTime aDate)
+//
+//  Input:   j = rain gage index
+//           aDate = date when gage's rainfall is first needed
+//  Output:  returns index of period to begin reading gage's data from
+//  Purpose: finds the last period of a gage's rain file data that ends
+//           by a given date.
+//
+//  Periods that end before this one are never needed, so a gage whose
+//  record begins long before the simulation doesn't have to read them.
+//  The dates of the leading periods that are in increasing order are
+//  searched by bisection.
+//
+{
+    long lo = -1;                      // last period known to end by aDate
+    long hi = Gage[j].sortedPeriods;   // first period not known to do so
+    long k;
+
+    if ( Frain.file == NULL ) return 0;
+    while ( hi - lo > 1 )
+    {
+        k = (lo + hi) / 2;
+        if ( datetime_addSeconds(readPeriodDate(j, k),
+             Gage[j].rainInterval) <= aDate ) lo = k;
+        else hi = k;
+    }
+    return MAX(lo, 0);
+}
+
+//=============================================================================
+
+int rain_getPeriod(int j, DateTime* aDate, float* depth)
+//
+//  Input:   j = rain gage index
+//  Output:  aDate = start date of gage's current rain period
+//           depth = rain depth (inches) of the period;
+//           returns TRUE if successful, FALSE if no periods are left
+//  Purpose: retrieves a gage's current period of rain file data and moves
+//           on to the next one.
+//
+{
+    TRainBlock* block;
+    long k = Gage[j].currentPeriod;
+
+    if ( Frain.file == NULL || RainBlocks == NULL ) return FALSE;
+    if ( k >= Gage[j].filePeriods ) return FALSE;
+    block = &RainBlocks[j];
+    if ( k < block->first || k >= block->first + block->count )
+    {
+        if ( !readPeriods(j, k) ) return FALSE;
+    }
+    *aDate = block->dates[k - block->first];
+    *depth = block->depths[k - block->first];
+    Gage[j].currentPeriod++;
+    return TRUE;
+}
+
+//=============================================================================
+
+int countRainFileGages()
+//
+//  Input:   none
+//  Output:  returns number of rain gages that use rain data files
+//  Purpose: counts the rain gages that get their data from a file.
+//
+{
+    int i, count = 0;
+    for (i = 0; i < Nobjects[GAGE]; i++)
+    {
+        if ( Gage[i].dataSource == RAIN_FILE ) count++;
+    }
+    return count;
+}
+
+//=============================================================================
+
 void createRainFile(int count)
 //
 //  Input:   count = number of files to include in rain interface file
@@ -208,13 +373,17 @@ void createRainFile(int count)
 {
     int   i, k;
     int   kount = count;               // number of gages in data file
-    int   filePos1;                    // starting byte of gage's header data
-    int   filePos2;                    // starting byte of gage's rain data
-    int   filePos3;                    // starting byte of next gage's data
+    F_OFF filePos1;                    // starting byte of gage's header data
+    INT8  filePos2;                    // starting byte of gage's rain data
+    INT8  filePos3;                    // starting byte of gage's rain depths
     int   interval;                    // recording interval (sec)
+    INT8  nPeriods;                    // number of rain periods
+    INT8  nSorted8;                    // number of periods in date order
+    long  nSorted;
     int   dummy = -1;
-    char  staID[MAXMSG+1];             // gage's ID name
-    char  fileStamp[] = "SWMM5-RAIN";
+    INT8  dummy8 = -1;
+    char  staID[MAXMSG+1] = "";        // gage's ID name
+    char  fileStamp[] = "SWMM5-RCOL";
 
     // --- make sure interface file is open and no error condition
     if ( ErrorCode || !Frain.file ) return;
@@ -222,7 +391,7 @@ void createRainFile(int count)
     // --- write file stamp & # gages to file
     fwrite(fileStamp, sizeof(char), strlen(fileStamp), Frain.file);
     fwrite(&kount, sizeof(int), 1, Frain.file);
-    filePos1 = ftell(Frain.file);
+    filePos1 = F_TELL(Frain.file);
 
     // --- write default fill-in header records to file for each gage
     //     (will be replaced later with actual records)
@@ -231,10 +400,14 @@ void createRainFile(int count)
     for ( i = 0;  i < count; i++ )
     {
         fwrite(staID, sizeof(char), MAXMSG+1, Frain.file);
-        for ( k = 1; k <= 3; k++ )
-            fwrite(&dummy, sizeof(int), 1, Frain.file);
+        fwrite(&dummy, sizeof(int), 1, Frain.file);
+        for ( k = 1; k <= 4; k++ )
+            fwrite(&dummy8, sizeof(INT8), 1, Frain.file);
     }
-    filePos2 = ftell(Frain.file);
+    filePos2 = F_TELL(Frain.file);
+    RainDates = NULL;
+    RainDepths = NULL;
+    RainCapacity = 0;
 
     // --- loop through project's  rain gages,
     //     looking for ones using rain files
@@ -244,25 +417,31 @@ void createRainFile(int count)
         if ( rainFileConflict(i) ) break;
 
         // --- position rain file to where data for gage will begin
-        fseek(Frain.file, filePos2, SEEK_SET);
+        F_SEEK(Frain.file, (F_OFF)filePos2, SEEK_SET);
 
         // --- add gage's data to rain file
-        if ( addGageToRainFile(i) )
+        if ( addGageToRainFile(i) && writeGageData(&nSorted) )
         {
             // --- write header records for gage to beginning of rain file
-            filePos3 = ftell(Frain.file);
-            fseek(Frain.file, filePos1, SEEK_SET);
+            nPeriods = RainCount;
+            nSorted8 = nSorted;
+            filePos3 = filePos2 + nPeriods * (INT8)sizeof(DateTime);
+            F_SEEK(Frain.file, filePos1, SEEK_SET);
             sstrncpy(staID, Gage[i].staID, MAXMSG);
             interval = Interval;
             fwrite(staID,      sizeof(char), MAXMSG+1, Frain.file);
             fwrite(&interval,  sizeof(int), 1, Frain.file);
-            fwrite(&filePos2,  sizeof(int), 1, Frain.file);
-            fwrite(&filePos3,  sizeof(int), 1, Frain.file);
-            filePos1 = ftell(Frain.file);
-            filePos2 = filePos3;
+            fwrite(&nPeriods,  sizeof(INT8), 1, Frain.file);
+            fwrite(&nSorted8,  sizeof(INT8), 1, Frain.file);
+            fwrite(&filePos2,  sizeof(INT8), 1, Frain.file);
+            fwrite(&filePos3,  sizeof(INT8), 1, Frain.file);
+            filePos1 = F_TELL(Frain.file);
+            filePos2 = filePos3 + nPeriods * (INT8)sizeof(float);
             report_writeRainStats(i, &RainStats);
         }
     }
+    FREE(RainDates);
+    FREE(RainDepths);
 
     // --- if there was an error condition, then delete newly created file
     if ( ErrorCode )
@@ -312,6 +491,7 @@ int addGageToRainFile(int i)
 
     // --- let StationID point to NULL
     StationID = NULL;
+    RainCount = 0;
 
     // --- check that rain file exists
     if ( (f = fopen(Gage[i].fname, "rt")) == NULL )
@@ -338,6 +518,36 @@ int addGageToRainFile(int i)
 
 //=============================================================================
 
+int writeGageData(long* nSorted)
+//
+//  Input:   none
+//  Output:  nSorted = number of leading periods in increasing date order;
+//           returns 1 if successful, 0 if not
+//  Purpose: writes the dates and then the rain depths of the periods read
+//           from a gage's data file to the rain interface file.
+//
+{
+    long k;
+
+    for (k = 1; k < RainCount; k++)
+    {
+        if ( RainDates[k] <= RainDates[k-1] ) break;
+    }
+    *nSorted = MIN(k, RainCount);
+    if ( RainCount == 0 ) return 1;
+    if ( fwrite(RainDates, sizeof(DateTime), RainCount, Frain.file) <
+             (size_t)RainCount ||
+         fwrite(RainDepths, sizeof(float), RainCount, Frain.file) <
+             (size_t)RainCount )
+    {
+        report_writeErrorMsg(ERR_RAIN_FILE_OPEN, Frain.name);
+        return 0;
+    }
+    return 1;
+}
+
+//=============================================================================
+
 void initRainFile(void)
 //
 //  Input:   none
@@ -345,11 +555,13 @@ void initRainFile(void)
 //  Purpose: initializes rain interface file for reading.
 //
 {
-    char  fileStamp[] = "SWMM5-RAIN";
+    char  fileStamp[] = "SWMM5-RCOL";
+    char  oldStamp[] = "SWMM5-RAIN";
     char  fStamp[] = "SWMM5-RAIN";
     int   i;
     int   kount;
-    long  filePos;
+    int   columnar;
+    F_OFF filePos;
 
     // --- make sure interface file is open and no error condition
     if ( ErrorCode || !Frain.file ) return;
@@ -357,13 +569,22 @@ void initRainFile(void)
     // --- check that interface file contains proper file stamp
     rewind(Frain.file);
     fread(fStamp, sizeof(char), strlen(fileStamp), Frain.file);
-    if ( strcmp(fStamp, fileStamp) != 0 )
+    columnar = ( strcmp(fStamp, fileStamp) == 0 );
+    if ( !columnar && strcmp(fStamp, oldStamp) != 0 )
     {
         report_writeErrorMsg(ERR_RAIN_IFACE_FORMAT, "");
         return;
     }
     fread(&kount, sizeof(int), 1, Frain.file);
-    filePos = ftell(Frain.file);
+    filePos = F_TELL(Frain.file);
+
+    // --- allocate a block of rain periods for each gage
+    RainBlocks = (TRainBlock *) calloc(Nobjects[GAGE], sizeof(TRainBlock));
+    if ( RainBlocks == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return;
+    }
 
     // --- locate information for each raingage in interface file
     for ( i = 0; i < Nobjects[GAGE]; i++ )
@@ -371,44 +592,78 @@ void initRainFile(void)
         if ( ErrorCode || Gage[i].dataSource != RAIN_FILE ) continue;
 
         // --- match station ID for gage with one in file
-        fseek(Frain.file, filePos, SEEK_SET);
-        if ( !findGageInFile(i, (int)kount) ||
-             Gage[i].startFilePos == Gage[i].endFilePos )
+        F_SEEK(Frain.file, filePos, SEEK_SET);
+        if ( !findGageInFile(i, (int)kount, columnar) ||
+             Gage[i].filePeriods == 0 )
         {
             report_writeErrorMsg(ERR_RAIN_FILE_GAGE, Gage[i].ID);
+            continue;
         }
+        RainBlocks[i].dates =
+            (DateTime *) calloc(RAINBLOCK, sizeof(DateTime));
+        RainBlocks[i].depths = (float *) calloc(RAINBLOCK, sizeof(float));
+        if ( !RainBlocks[i].dates || !RainBlocks[i].depths )
+            report_writeErrorMsg(ERR_MEMORY, "");
     }
 }
 
 //=============================================================================
 
-int findGageInFile(int i, int kount)
+int findGageInFile(int i, int kount, int columnar)
 //
 //  Input:   i     = rain gage index
 //           kount = number of rain gages stored on interface file
+//           columnar = TRUE if file has current layout, FALSE if earlier
 //  Output:  returns TRUE if successful, FALSE if not
 //  Purpose: checks if rain gage's station ID appears in interface file.
 //
 {
     int   k;
-    int  interval;
-    int  filePos1, filePos2;
+    int   interval;
+    int   oldPos1, oldPos2;            // byte positions in earlier layout
+    INT8  nPeriods = 0, nSorted = 0;
+    INT8  filePos1, filePos2;
     char  staID[MAXMSG+1] = "";
 
     for ( k = 1; k <= kount; k++ )
     {
         fread(staID,      sizeof(char), MAXMSG+1, Frain.file);
         fread(&interval,  sizeof(int), 1, Frain.file);
-        fread(&filePos1,  sizeof(int), 1, Frain.file);
-        fread(&filePos2,  sizeof(int), 1, Frain.file);
+        if ( columnar )
+        {
+            fread(&nPeriods, sizeof(INT8), 1, Frain.file);
+            fread(&nSorted,  sizeof(INT8), 1, Frain.file);
+            fread(&filePos1, sizeof(INT8), 1, Frain.file);
+            fread(&filePos2, sizeof(INT8), 1, Frain.file);
+        }
+        else
+        {
+            fread(&oldPos1,  sizeof(int), 1, Frain.file);
+            fread(&oldPos2,  sizeof(int), 1, Frain.file);
+            filePos1 = oldPos1;
+            filePos2 = oldPos2;
+        }
         if ( strcmp(staID, Gage[i].staID) == 0 )
         {
             // --- match found; save file parameters
+            //     (periods of earlier layout aren't searched by date)
             Gage[i].rainType     = RAINFALL_VOLUME;
             Gage[i].rainInterval = interval;
-            Gage[i].startFilePos = (long)filePos1;
-            Gage[i].endFilePos   = (long)filePos2;
-            Gage[i].currentFilePos = Gage[i].startFilePos;
+            Gage[i].startFilePos = filePos1;
+            if ( columnar )
+            {
+                Gage[i].depthFilePos = filePos2;
+                Gage[i].filePeriods = (long)nPeriods;
+                Gage[i].sortedPeriods = (long)nSorted;
+            }
+            else
+            {
+                Gage[i].depthFilePos = -1;
+                Gage[i].filePeriods =
+                    (long)((filePos2 - filePos1) / RECORDSIZE);
+                Gage[i].sortedPeriods = 0;
+            }
+            Gage[i].currentPeriod = 0;
             return TRUE;
         }
     }
@@ -417,6 +672,72 @@ int findGageInFile(int i, int kount)
 
 //=============================================================================
 
+DateTime readPeriodDate(int j, long k)
+//
+//  Input:   j = rain gage index
+//           k = index of one of gage's rain periods
+//  Output:  returns start date of the period
+//  Purpose: reads the date of a single rain period from the interface file.
+//
+{
+    DateTime aDate = NO_DATE;
+    long     size = sizeof(DateTime);
+
+    if ( Gage[j].depthFilePos < 0 ) size = RECORDSIZE;
+    F_SEEK(Frain.file, (F_OFF)(Gage[j].startFilePos + k * size), SEEK_SET);
+    fread(&aDate, sizeof(DateTime), 1, Frain.file);
+    return aDate;
+}
+
+//=============================================================================
+
+int readPeriods(int j, long k)
+//
+//  Input:   j = rain gage index
+//           k = index of one of gage's rain periods
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: reads a block of a gage's rain periods, beginning with period k,
+//           from the interface file.
+//
+{
+    TRainBlock* block = &RainBlocks[j];
+    int i, n = (int)MIN(RAINBLOCK, Gage[j].filePeriods - k);
+
+    if ( block->dates == NULL || block->depths == NULL ) return FALSE;
+    block->first = k;
+    block->count = 0;
+
+    // --- file's current layout has dates and depths in separate columns
+    if ( Gage[j].depthFilePos >= 0 )
+    {
+        F_SEEK(Frain.file, (F_OFF)(Gage[j].startFilePos +
+               k * (INT8)sizeof(DateTime)), SEEK_SET);
+        n = (int)fread(block->dates, sizeof(DateTime), n, Frain.file);
+        F_SEEK(Frain.file, (F_OFF)(Gage[j].depthFilePos +
+               k * (INT8)sizeof(float)), SEEK_SET);
+        n = (int)fread(block->depths, sizeof(float), n, Frain.file);
+    }
+
+    // --- earlier layout has each date followed by its depth
+    else
+    {
+        F_SEEK(Frain.file, (F_OFF)(Gage[j].startFilePos + k * RECORDSIZE),
+               SEEK_SET);
+        for (i = 0; i < n; i++)
+        {
+            if ( fread(&block->dates[i], sizeof(DateTime), 1,
+                       Frain.file) < 1 ||
+                 fread(&block->depths[i], sizeof(float), 1,
+                       Frain.file) < 1 ) break;
+        }
+        n = i;
+    }
+    block->count = n;
+    return ( n > 0 );
+}
+
+//=============================================================================
+
 int findFileFormat(FILE *f, int i, int *hdrLines)
 //
 //  Input:   f = ptr. to rain gage's rainfall data file
@@ -1154,13 +1475,47 @@ void saveRainfall(DateTime date1, int hour, int minute, float x, char isMissing)
         seconds = 3600*hour + 60*minute - TimeOffset;
         date2 = datetime_addSeconds(date1, seconds);
 
-        // --- write date & value (in inches) to interface file
-        fwrite(&date2, sizeof(DateTime), 1, Frain.file);
-        fwrite(&x, sizeof(float), 1, Frain.file);
+        // --- save date & value (in inches) to be written to interface
+        //     file once all of the gage's data has been read
+        if ( RainCount == RainCapacity )
+        {
+            if ( !growRainPeriods() ) return;
+        }
+        RainDates[RainCount] = date2;
+        RainDepths[RainCount] = x;
+        RainCount++;
 
         // --- update actual start & end of record dates
         if ( RainStats.startDate == NO_DATE ) RainStats.startDate = date2;
         RainStats.endDate = date2;
     }
 }
+
+//=============================================================================
+
+int growRainPeriods()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: doubles the number of rain periods that can be saved for
+//           the gage whose data file is being read.
+//
+{
+    long      n = MAX(2 * RainCapacity, RAINBLOCK);
+    DateTime* dates;
+    float*    depths;
+
+    dates = (DateTime *) realloc(RainDates, n * sizeof(DateTime));
+    if ( dates ) RainDates = dates;
+    depths = (float *) realloc(RainDepths, n * sizeof(float));
+    if ( depths ) RainDepths = depths;
+    if ( dates == NULL || depths == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return FALSE;
+    }
+    RainCapacity = n;
+    return TRUE;
+}
+
 //=============================================================================
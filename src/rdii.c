@@ -26,6 +26,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "headers.h"
+#include "mempool.h"
 
 //-----------------------------------------------------------------------------
 // Definition of 4-byte integer, 4-byte real and 8-byte real types
@@ -39,12 +40,22 @@
 // Constants
 //-----------------------------------------------------------------------------
 const double ZERO_RDII = 0.0001;       // Minimum non-zero RDII inflow (cfs)
+const int    CHUNK_STEPS = 256;        // RDII time steps processed at a time
 const char   FileStamp[] = FILE_STAMP;
 
 //-----------------------------------------------------------------------------
 // Data Structures
 //-----------------------------------------------------------------------------
 enum FileTypes {BINARY, TEXT};         // File mode types
+enum UHLimbs   {RISING_LIMB,           // UH periods up to time to peak
+                FALLING_LIMB};         // UH periods from peak to time base
+
+typedef struct                         // Triangular UH shape for a month
+{                                      // -------------------------------------
+   int       lastPeriod[2];            // last UH period on each limb
+   double    a[2];                     // UH ordinate (times r) on each limb
+   double    b[2];                     //   is a + b * UH period
+}  TUHLimbs;
 
 typedef struct                         // Data for a single unit hydrograph
 {                                      // -------------------------------------
@@ -55,6 +66,10 @@ typedef struct                         // Data for a single unit hydrograph
    int       maxPeriods;               // max. past rainfall periods
    long      drySeconds;               // time since last nonzero rainfall
    double    iaUsed;                   // initial abstraction used (in or mm)
+   TUHLimbs  limbs[12];                // UH shape in each month
+   double    rainSum[12][2];           // past rain on each limb by month
+   double    lagSum[12][2];            // same sums weighted by UH period
+   int       rainCount[12][2];         // number of past rains in these sums
 }  TUHData;
 
 typedef struct                         // Data for a unit hydrograph group
@@ -66,6 +81,11 @@ typedef struct                         // Data for a unit hydrograph group
    DateTime  gageDate;                 // calendar date of rain gage period
    DateTime  lastDate;                 // date of last rdii computed
    TUHData   uh[3];                    // data for each unit hydrograph
+   double*   rainDepths;               // gage rain depths over a chunk
+   DateTime* rainDates;                // gage dates of these rain depths
+   int*      rainEnd;                  // end of each time step's rain depths
+   DateTime* gageDates;                // gage date reached at each time step
+   double*   stepRdii;                 // rdii flow at each time step
 }  TUHGroup;
 
 //-----------------------------------------------------------------------------
@@ -73,6 +93,7 @@ typedef struct                         // Data for a unit hydrograph group
 //-----------------------------------------------------------------------------
 static TUHGroup*  UHGroup;             // processing data for each UH group
 static int        RdiiStep;            // RDII time step (sec)
+static DateTime*  StepDates;           // dates of a chunk of RDII time steps
 static int        NumRdiiNodes;        // number of nodes w/ RDII data
 static int*       RdiiNodeIndex;       // indexes of nodes w/ RDII data
 static REAL4*     RdiiNodeFlow;        // inflows for nodes with RDII
@@ -98,7 +119,6 @@ extern double Qcf[];                   // flow units conversion factors
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
 //  rdii_readRdiiInflow     (called from parseLine in input.c)
-//  rdii_deleteRdiiInflow   (called from deleteObjects in project.c)
 //  rdii_initUnitHyd        (called from createObjects in project.c)
 //  rdii_readUnitHydParams  (called from parseLine in input.c)
 //  rdii_openRdii           (called from rain_open)
@@ -120,19 +140,21 @@ static void   openRdiiProcessor(void);
 static int    allocRdiiMemory(void);
 static int    getRainInterval(int i);
 static int    getMaxPeriods(int i, int k);
+static void   setUnitHydLimbs(int i, int k);
 static void   initGageData(void);
 static void   initUnitHydData(void);
 static int    openNewRdiiFile(void);
-static void   getRainfall(DateTime currentDate);
+static void   getRainfall(int s, DateTime currentDate);
 
 static double applyIA(int j, int k, DateTime aDate, double dt,
               double rainDepth);
 static void   updateDryPeriod(int j, int k, double rain, int gageInterval);
-static void   getUnitHydRdii(DateTime currentDate);
-static double getUnitHydConvol(int j, int k, int gageInterval);
-static double getUnitHydOrd(int j, int m, int k, double t);
+static void   clearPastRain(TUHData* uh);
+static void   addPastRain(TUHData* uh, double rain, int month);
+static void   getUnitHydRdii(int j, int nSteps);
+static double getUnitHydConvol(int j, int k);
 
-static int    getNodeRdii(void);
+static int    getNodeRdii(int s);
 static void   saveRdiiFlows(DateTime currentDate);
 static void   closeRdiiProcessor(void);
 static void   freeRdiiMemory(void);
@@ -180,7 +202,7 @@ int rdii_readRdiiInflow(char* tok[], int ntoks)
     inflow = Node[j].rdiiInflow;
     if ( inflow == NULL )
     {
-        inflow = (TRdiiInflow *) malloc(sizeof(TRdiiInflow));
+        inflow = AllocArray(TRdiiInflow, 1);
         if ( !inflow ) return error_setInpError(ERR_MEMORY, "");
     }
 
@@ -384,23 +406,6 @@ void setUnitHydParams(int j, int i, int m, double x[])
     }
 }
 
-//=============================================================================
-
-void rdii_deleteRdiiInflow(int j)
-//
-//  Input:   j = node index
-//  Output:  none
-//  Purpose: deletes the RDII inflow object for a node.
-//
-{
-    if ( Node[j].rdiiInflow )
-    {
-        free(Node[j].rdiiInflow);
-        Node[j].rdiiInflow = NULL;
-    }
-}
-
-
 //=============================================================================
 //                 Reading Inflow Data From a RDII File
 //=============================================================================
@@ -725,9 +730,11 @@ void createRdiiFile()
 //
 {
     int      hasRdii;                  // true when total RDII > 0
+    int      j;                        // UH group index
+    int      s;                        // time step index within a chunk
+    int      nSteps;                   // number of time steps in a chunk
     double   elapsedTime;              // current elapsed time (sec)
     double   duration;                 // duration being analyzed (sec)
-    DateTime currentDate;              // current calendar date/time
 
     // --- set RDII reporting time step to Runoff wet step
     RdiiStep = WetStep;
@@ -760,27 +767,37 @@ void createRdiiFile()
         // --- convert total simulation duration from millisec to sec
         duration = TotalDuration / 1000.0;
 
-        // --- examine rainfall record over each RdiiStep time step
+        // --- examine rainfall record over chunks of RdiiStep time steps
         elapsedTime = 0.0;
         while ( elapsedTime <= duration && !ErrorCode )
         {
-            // --- compute current calendar date/time
-            currentDate = StartDateTime + elapsedTime / SECperDAY;
+            // --- compute calendar date/time of each step in the chunk
+            nSteps = 0;
+            while ( nSteps < CHUNK_STEPS && elapsedTime <= duration )
+            {
+                StepDates[nSteps] = StartDateTime + elapsedTime / SECperDAY;
+                elapsedTime += RdiiStep;
+                nSteps++;
+            }
 
             // --- update rainfall at all rain gages
-            getRainfall(currentDate);
+            //     (in sequence, since UH groups can share a gage)
+            for (s = 0; s < nSteps; s++) getRainfall(s, StepDates[s]);
 
             // --- compute convolutions of past rainfall with UH's
-            getUnitHydRdii(currentDate);
-
-            // --- find RDII at all nodes
-            hasRdii = getNodeRdii();
-
-            // --- save RDII at all nodes to file for current date
-            if ( hasRdii ) saveRdiiFlows(currentDate);
+            //     (each UH group is independent of the others)
+            #pragma omp parallel for num_threads(NumThreads) schedule(dynamic)
+            for (j = 0; j < Nobjects[UNITHYD]; j++)
+            {
+                getUnitHydRdii(j, nSteps);
+            }
 
-            // --- advance one time step
-            elapsedTime += RdiiStep;
+            // --- find RDII at all nodes and save it to file for each date
+            for (s = 0; s < nSteps; s++)
+            {
+                hasRdii = getNodeRdii(s);
+                if ( hasRdii ) saveRdiiFlows(StepDates[s]);
+            }
         }
     }
 
@@ -886,6 +903,7 @@ void openRdiiProcessor()
 
     // --- set RDII processing arrays to NULL
     UHGroup = NULL;
+    StepDates = NULL;
     RdiiNodeIndex = NULL;
     RdiiNodeFlow = NULL;
     TotalRainVol = 0.0;
@@ -935,15 +953,35 @@ int  allocRdiiMemory()
     UHGroup = (TUHGroup *) calloc(Nobjects[UNITHYD], sizeof(TUHGroup));
     if ( !UHGroup ) return FALSE;
 
+    // --- allocate memory for dates of a chunk of time steps
+    StepDates = (DateTime *) calloc(CHUNK_STEPS, sizeof(DateTime));
+    if ( !StepDates ) return FALSE;
+
     // --- allocate memory for past rainfall data for each UH in each group
     for (i=0; i<Nobjects[UNITHYD]; i++)
     {
         UHGroup[i].rainInterval = getRainInterval(i);
+
+        // --- allocate memory for rainfall & RDII over a chunk of time
+        //     steps (each step covers at most RdiiStep / rainInterval + 1
+        //     rain gage periods)
+        n = CHUNK_STEPS * (RdiiStep / UHGroup[i].rainInterval + 2);
+        UHGroup[i].rainDepths = (double *) calloc(n, sizeof(double));
+        UHGroup[i].rainDates = (DateTime *) calloc(n, sizeof(DateTime));
+        UHGroup[i].rainEnd = (int *) calloc(CHUNK_STEPS, sizeof(int));
+        UHGroup[i].gageDates =
+            (DateTime *) calloc(CHUNK_STEPS, sizeof(DateTime));
+        UHGroup[i].stepRdii = (double *) calloc(CHUNK_STEPS, sizeof(double));
+        if ( !UHGroup[i].rainDepths || !UHGroup[i].rainDates ||
+             !UHGroup[i].rainEnd || !UHGroup[i].gageDates ||
+             !UHGroup[i].stepRdii ) return FALSE;
+
         for (k=0; k<3; k++)
         {
             UHGroup[i].uh[k].pastRain = NULL;
             UHGroup[i].uh[k].pastMonth = NULL;
             UHGroup[i].uh[k].maxPeriods = getMaxPeriods(i, k);
+            setUnitHydLimbs(i, k);
             n = UHGroup[i].uh[k].maxPeriods;
             if ( n > 0 )
             {
@@ -1031,6 +1069,75 @@ int  getMaxPeriods(int i, int k)
 
 //=============================================================================
 
+void setUnitHydLimbs(int i, int k)
+//
+//  Input:   i = UH group index
+//           k = UH index
+//  Output:  none
+//  Purpose: tabulates the shape of a UH in each month of the year.
+//
+//  The UH ordinate for UH period p is evaluated at the mid-point time
+//  t = (p - 0.5) * rainInterval of the period. It rises linearly from
+//  0 to a peak value qPeak at time tPeak and then falls linearly back
+//  to 0 at time tBase, so on each limb it equals a + b*p.
+//
+{
+    int    m;                          // month index
+    int    p;                          // UH period
+    int    pMax;                       // max. number of UH periods
+    double dt;                         // rainfall processing interval (sec)
+    double qPeak;                      // peak UH flow (times r)
+    double t1;                         // time to peak on UH (sec)
+    double t2;                         // time after peak on UH (sec)
+    double tBase;                      // base time of UH (sec)
+    TUHLimbs* limbs;
+
+    dt = UHGroup[i].rainInterval;
+    pMax = UHGroup[i].uh[k].maxPeriods;
+    for (m = 0; m < 12; m++)
+    {
+        limbs = &UHGroup[i].uh[k].limbs[m];
+        limbs->lastPeriod[RISING_LIMB] = 0;
+        limbs->lastPeriod[FALLING_LIMB] = 0;
+        limbs->a[RISING_LIMB] = limbs->b[RISING_LIMB] = 0.0;
+        limbs->a[FALLING_LIMB] = limbs->b[FALLING_LIMB] = 0.0;
+
+        // --- skip month if UH doesn't exist or produces no RDII
+        tBase = UnitHyd[i].tBase[m][k];
+        if ( tBase <= 0.0 || UnitHyd[i].r[m][k] == 0.0 ) continue;
+        t1 = UnitHyd[i].tPeak[m][k];
+        t2 = tBase - t1;
+
+        // --- compute peak value of UH in original rainfall units
+        //     (in/hr or mm/hr) times the UH's response ratio
+        qPeak = 2. / tBase * 3600.0 * UnitHyd[i].r[m][k];
+
+        // --- find last UH period on each limb (only the first pMax-1
+        //     periods of past rainfall are convoluted)
+        p = 0;
+        while ( p + 1 < pMax && ((double)(p + 1) - 0.5) * dt <= t1 ) p++;
+        limbs->lastPeriod[RISING_LIMB] = p;
+        while ( p + 1 < pMax && ((double)(p + 1) - 0.5) * dt < tBase ) p++;
+        limbs->lastPeriod[FALLING_LIMB] = p;
+
+        // --- rising limb: q = qPeak * t / t1
+        if ( t1 > 0.0 )
+        {
+            limbs->a[RISING_LIMB] = -0.5 * dt / t1 * qPeak;
+            limbs->b[RISING_LIMB] = dt / t1 * qPeak;
+        }
+
+        // --- falling limb: q = qPeak * (tBase - t) / t2
+        if ( t2 > 0.0 )
+        {
+            limbs->a[FALLING_LIMB] = (tBase + 0.5 * dt) / t2 * qPeak;
+            limbs->b[FALLING_LIMB] = -dt / t2 * qPeak;
+        }
+    }
+}
+
+//=============================================================================
+
 void initGageData()
 //
 //  Input:   none
@@ -1095,6 +1202,7 @@ void initUnitHydData()
                 (UHGroup[i].uh[k].maxPeriods * UHGroup[i].rainInterval) + 1;
             UHGroup[i].uh[k].period = UHGroup[i].uh[k].maxPeriods + 1;
             UHGroup[i].uh[k].hasPastRain = FALSE;
+            clearPastRain(&UHGroup[i].uh[k]);
 
             // --- assign initial abstraction used
             UHGroup[i].uh[k].iaUsed = UnitHyd[i].iaInit[month][k];
@@ -1160,32 +1268,30 @@ int openNewRdiiFile()
 
 //=============================================================================
 
-void getRainfall(DateTime currentDate)
+void getRainfall(int s, DateTime currentDate)
 //
-//  Input:   currentDate = current calendar date/time
+//  Input:   s = index of time step within current chunk
+//           currentDate = current calendar date/time
 //  Output:  none
 //  Purpose: determines rainfall at current RDII processing date.
 //
 //
 {
     int      j;                        // UH group index
-    int      k;                        // UH index
     int      g;                        // rain gage index
-    int      i;                        // past rainfall index
-    int      month;                    // month of current date
+    int      n;                        // rainfall period index
     int      rainInterval;             // rainfall interval (sec)
     double   rainDepth;                // rainfall depth (inches or mm)
-    double   excessDepth;              // excess rainfall depth (inches or mm))
     DateTime gageDate;                 // calendar date for rain gage
 
     // --- examine each UH group
-    month = datetime_monthOfYear(currentDate) - 1;
     for (g = 0; g < Nobjects[GAGE]; g++) Gage[g].isCurrent = FALSE;
     for (j = 0; j < Nobjects[UNITHYD]; j++)
     {
         // --- repeat until gage's date reaches or exceeds current date
         g = UnitHyd[j].rainGage;
         rainInterval = UHGroup[j].rainInterval;
+        n = ( s > 0 ) ? UHGroup[j].rainEnd[s-1] : 0;
         while ( UHGroup[j].gageDate < currentDate )
         {
             // --- get rainfall volume over gage's recording interval
@@ -1202,27 +1308,16 @@ void getRainfall(DateTime currentDate)
             // --- update amount of total rainfall volume (ft3)
             TotalRainVol += rainDepth / UCF(RAINDEPTH) * UHGroup[j].area;
 
-            // --- compute rainfall excess for each UH in the group
-            for (k=0; k<3; k++)
-            {
-                // --- adjust rainfall volume for any initial abstraction
-                excessDepth = applyIA(j, k, gageDate, rainInterval, rainDepth);
-
-                // --- adjust extent of dry period for the UH
-                updateDryPeriod(j, k, excessDepth, rainInterval);
-
-                // --- add rainfall to list of past values,
-                //     wrapping array index if necessary
-                i = UHGroup[j].uh[k].period;
-                if ( i >= UHGroup[j].uh[k].maxPeriods ) i = 0;
-                UHGroup[j].uh[k].pastRain[i] = excessDepth;
-                UHGroup[j].uh[k].pastMonth[i] = (char)month;
-                UHGroup[j].uh[k].period = i + 1;
-            }
+            // --- save rainfall for the UH group's convolutions
+            UHGroup[j].rainDepths[n] = rainDepth;
+            UHGroup[j].rainDates[n] = gageDate;
+            n++;
 
             // --- advance rain date by gage recording interval
             UHGroup[j].gageDate = datetime_addSeconds(gageDate, rainInterval);
         }
+        UHGroup[j].rainEnd[s] = n;
+        UHGroup[j].gageDates[s] = UHGroup[j].gageDate;
     }
 }
 
@@ -1298,6 +1393,7 @@ void updateDryPeriod(int j, int k, double rainDepth, int rainInterval)
                 UHGroup[j].uh[k].pastRain[i] = 0.0;
             }
             UHGroup[j].uh[k].period = 0;
+            clearPastRain(&UHGroup[j].uh[k]);
         }
         UHGroup[j].uh[k].drySeconds = 0;
         UHGroup[j].uh[k].hasPastRain = TRUE;
@@ -1318,136 +1414,230 @@ void updateDryPeriod(int j, int k, double rainDepth, int rainInterval)
 
 //=============================================================================
 
-void getUnitHydRdii(DateTime currentDate)
+void clearPastRain(TUHData* uh)
 //
-//  Input:   currentDate = current calendar date/time
+//  Input:   uh = UH data
 //  Output:  none
-//  Purpose: computes RDII generated by past rainfall for each UH group.
+//  Purpose: empties the past rainfall sums used to convolute a UH.
 //
 {
-    int   j;                           // UH group index
-    int   k;                           // UH index
-    int   rainInterval;                // rainfall time interval (sec)
+    int m, n;
 
-    // --- examine each UH group
-    for (j=0; j<Nobjects[UNITHYD]; j++)
+    for (m = 0; m < 12; m++)
     {
-        // --- skip calculation if group not used by any RDII node or if
-        //     current date hasn't reached last date RDII was computed
-        if ( !UHGroup[j].isUsed ) continue;
-        if ( currentDate < UHGroup[j].lastDate ) continue;
+        for (n = RISING_LIMB; n <= FALLING_LIMB; n++)
+        {
+            uh->rainSum[m][n] = 0.0;
+            uh->lagSum[m][n] = 0.0;
+            uh->rainCount[m][n] = 0;
+        }
+    }
+}
 
-        // --- update date RDII last computed
-        UHGroup[j].lastDate = UHGroup[j].gageDate;
+//=============================================================================
 
-        // --- perform convolution for each UH in the group
-        rainInterval = UHGroup[j].rainInterval;
-        UHGroup[j].rdii = 0.0;
-        for (k=0; k<3; k++)
+void addPastRain(TUHData* uh, double rain, int month)
+//
+//  Input:   uh = UH data
+//           rain = excess rain depth for the new period (in or mm)
+//           month = month of year index of the new period
+//  Output:  none
+//  Purpose: adds a new period of rainfall to the list of past values
+//           and updates the past rainfall sums on each UH limb.
+//
+{
+    int    i;                          // index of new rainfall period
+    int    m;                          // month of year index
+    int    p;                          // UH period
+    int    nPast = uh->maxPeriods;     // size of past rainfall array
+    int*   last;                       // last UH period on each limb
+    double v;                          // past rainfall value
+
+    // --- find where the new period goes, wrapping array index if necessary
+    i = uh->period;
+    if ( i >= nPast ) i = 0;
+
+    // --- past rainfall moves one UH period further along
+    for (m = 0; m < 12; m++)
+    {
+        if ( uh->rainCount[m][RISING_LIMB] + uh->rainCount[m][FALLING_LIMB]
+             == 0 ) continue;
+        uh->lagSum[m][RISING_LIMB] += uh->rainSum[m][RISING_LIMB];
+        uh->lagSum[m][FALLING_LIMB] += uh->rainSum[m][FALLING_LIMB];
+        last = uh->limbs[m].lastPeriod;
+
+        // --- rainfall reaching past the peak moves to the falling limb
+        //     (or past the time base if the UH has no falling limb);
+        //     a UH with no rising limb periods has no rainfall to move
+        //     (and slot i holds the stale value about to be replaced)
+        p = last[RISING_LIMB] + 1;
+        v = uh->pastRain[(i - p + 1 + nPast) % nPast];
+        if ( last[RISING_LIMB] >= 1 && v > 0.0 &&
+             uh->pastMonth[(i - p + 1 + nPast) % nPast] == m )
         {
-            if ( UHGroup[j].uh[k].hasPastRain )
+            uh->rainSum[m][RISING_LIMB] -= v;
+            uh->lagSum[m][RISING_LIMB] -= v * p;
+            uh->rainCount[m][RISING_LIMB]--;
+            if ( p <= last[FALLING_LIMB] )
             {
-                UHGroup[j].rdii += getUnitHydConvol(j, k, rainInterval);
+                uh->rainSum[m][FALLING_LIMB] += v;
+                uh->lagSum[m][FALLING_LIMB] += v * p;
+                uh->rainCount[m][FALLING_LIMB]++;
             }
         }
+
+        // --- rainfall reaching past the time base is dropped
+        p = last[FALLING_LIMB] + 1;
+        v = uh->pastRain[(i - p + 1 + nPast) % nPast];
+        if ( last[FALLING_LIMB] > last[RISING_LIMB] && v > 0.0 &&
+             uh->pastMonth[(i - p + 1 + nPast) % nPast] == m )
+        {
+            uh->rainSum[m][FALLING_LIMB] -= v;
+            uh->lagSum[m][FALLING_LIMB] -= v * p;
+            uh->rainCount[m][FALLING_LIMB]--;
+        }
+
+        // --- start empty sums from 0 again to avoid round off build-up
+        if ( uh->rainCount[m][RISING_LIMB] == 0 )
+        {
+            uh->rainSum[m][RISING_LIMB] = 0.0;
+            uh->lagSum[m][RISING_LIMB] = 0.0;
+        }
+        if ( uh->rainCount[m][FALLING_LIMB] == 0 )
+        {
+            uh->rainSum[m][FALLING_LIMB] = 0.0;
+            uh->lagSum[m][FALLING_LIMB] = 0.0;
+        }
+    }
+
+    // --- save the new rainfall as UH period 1 of its month's UH
+    uh->pastRain[i] = rain;
+    uh->pastMonth[i] = (char)month;
+    uh->period = i + 1;
+    if ( rain > 0.0 )
+    {
+        last = uh->limbs[month].lastPeriod;
+        if ( last[RISING_LIMB] >= 1 )
+        {
+            uh->rainSum[month][RISING_LIMB] += rain;
+            uh->lagSum[month][RISING_LIMB] += rain;
+            uh->rainCount[month][RISING_LIMB]++;
+        }
+        else if ( last[FALLING_LIMB] >= 1 )
+        {
+            uh->rainSum[month][FALLING_LIMB] += rain;
+            uh->lagSum[month][FALLING_LIMB] += rain;
+            uh->rainCount[month][FALLING_LIMB]++;
+        }
     }
 }
 
 //=============================================================================
 
-double getUnitHydConvol(int j, int k, int rainInterval)
+void getUnitHydRdii(int j, int nSteps)
 //
 //  Input:   j = UH group index
-//           k = UH index
-//           rainInterval = rainfall time interval (sec)
-//  Output:  returns a RDII flow value
-//  Purpose: computes convolution of Unit Hydrographs with past rainfall.
+//           nSteps = number of time steps in current chunk
+//  Output:  none
+//  Purpose: computes RDII generated by past rainfall for a UH group
+//           at each time step of the current chunk.
 //
 {
-    int    i;                          // previous rainfall period index
-    int    m;                          // month of year index
-    int    p;                          // UH time period index
-    int    pMax;                       // max. number of periods
-    double t;                          // UH time value (sec)
-    double u;                          // UH ordinate
-    double v;                          // rainfall volume
-    double rdii;                       // RDII flow
-    TUHData* uh;                       // UH data
-
-    // --- initialize RDII, rain period index and UH period index
-    rdii = 0.0;
-    uh = &UHGroup[j].uh[k];
-    i = uh->period - 1;
-    if ( i < 0 ) i = uh->maxPeriods - 1;
-    pMax = uh->maxPeriods;
-    p = 1;
-
-    // --- evaluate each time period of UH's
-    while ( p < pMax )
+    int      k;                        // UH index
+    int      n;                        // rainfall period index
+    int      s;                        // time step index
+    int      month;                    // month of current date
+    int      rainInterval;             // rainfall interval (sec)
+    double   excessDepth;              // excess rainfall depth (inches or mm)
+    TUHGroup* group = &UHGroup[j];     // UH group
+
+    // --- skip calculation if group not used by any RDII node
+    if ( !group->isUsed ) return;
+
+    rainInterval = group->rainInterval;
+    n = 0;
+    for (s = 0; s < nSteps; s++)
     {
-        // --- if rain period has rainfall
-        v = uh->pastRain[i];
-        m = uh->pastMonth[i];
-        if ( v > 0.0 )
+        // --- compute rainfall excess for each UH in the group
+        month = datetime_monthOfYear(StepDates[s]) - 1;
+        for ( ; n < group->rainEnd[s]; n++)
         {
-            // --- find mid-point time of UH period in seconds
-            t = ((double)(p) - 0.5) * (double)rainInterval;
+            for (k=0; k<3; k++)
+            {
+                // --- adjust rainfall volume for any initial abstraction
+                excessDepth = applyIA(j, k, group->rainDates[n],
+                                      rainInterval, group->rainDepths[n]);
 
-            // --- convolute rain volume with UH ordinate
-            u = getUnitHydOrd(j, m, k, t) * UnitHyd[j].r[m][k];
-            rdii += u * v;
+                // --- adjust extent of dry period for the UH
+                updateDryPeriod(j, k, excessDepth, rainInterval);
+
+                // --- add rainfall to list of past values
+                addPastRain(&group->uh[k], excessDepth, month);
+            }
         }
 
-        // --- move to next UH period & previous rainfall period
-        p = p + 1;
-        i = i - 1;
-        if ( i < 0 ) i = uh->maxPeriods - 1;
+        // --- skip convolution if current date hasn't reached last date
+        //     RDII was computed
+        if ( StepDates[s] >= group->lastDate )
+        {
+            // --- update date RDII last computed
+            group->lastDate = group->gageDates[s];
+
+            // --- perform convolution for each UH in the group
+            group->rdii = 0.0;
+            for (k=0; k<3; k++)
+            {
+                if ( group->uh[k].hasPastRain )
+                {
+                    group->rdii += getUnitHydConvol(j, k);
+                }
+            }
+        }
+        group->stepRdii[s] = group->rdii;
     }
-    return rdii;
 }
 
 //=============================================================================
 
-double getUnitHydOrd(int h, int m, int k, double t)
+double getUnitHydConvol(int j, int k)
 //
-//  Input:   h = index of UH group
-//           m = month index
-//           k = individual UH index
-//           t = UH time (sec)
-//  Output:  returns ordinate of a unit hydrograph
-//  Purpose: gets ordinate of a particular unit hydrograph at specified time.
+//  Input:   j = UH group index
+//           k = UH index
+//  Output:  returns a RDII flow value
+//  Purpose: computes convolution of Unit Hydrographs with past rainfall.
+//
+//  The ordinates of a triangular UH vary linearly with UH period along
+//  each of its limbs, so the convolution over a limb only needs the sum
+//  of the past rainfall on it and that sum weighted by UH period. These
+//  are kept up to date by addPastRain() for each month's UH.
 //
 {
-    double qPeak;                      // peak flow of unit hydrograph
-    double f;                          // fraction of time to/from peak on UH
-    double t1;                         // time to peak on UH (sec)
-    double t2;                         // time after peak on UH (sec)
-    double tBase;                      // base time of UH (sec)
-
-    // --- return 0 if past end of UH time base
-    tBase = UnitHyd[h].tBase[m][k];
-    if ( t >= tBase ) return 0.0;
-
-    // --- compute peak value of UH in original rainfall units (in/hr or mm/hr)
-    qPeak = 2. / tBase * 3600.0;
-
-    // --- break UH base into times before & after peak flow
-    t1 = UnitHyd[h].tPeak[m][k];
-    t2 = tBase - t1;
+    int    m;                          // month of year index
+    int    n;                          // UH limb index
+    double rdii = 0.0;                 // RDII flow
+    TUHData*  uh = &UHGroup[j].uh[k];  // UH data
+    TUHLimbs* limbs;                   // UH shape for a month
 
-    // --- find UH flow at time t
-    if ( t <= t1 ) f = t / t1;
-    else           f = 1.0 - (t - t1) / t2;
-    return MAX(f, 0.0) * qPeak;
+    for (m = 0; m < 12; m++)
+    {
+        limbs = &uh->limbs[m];
+        for (n = RISING_LIMB; n <= FALLING_LIMB; n++)
+        {
+            if ( uh->rainCount[m][n] == 0 ) continue;
+            rdii += limbs->a[n] * uh->rainSum[m][n] +
+                    limbs->b[n] * uh->lagSum[m][n];
+        }
+    }
+    return MAX(rdii, 0.0);
 }
 
 //=============================================================================
 
-int getNodeRdii()
+int getNodeRdii(int s)
 //
-//  Input:   none
+//  Input:   s = index of time step within current chunk
 //  Output:  returns TRUE if any node has RDII inflow, FALSE if not
-//  Purpose: computes current RDII inflow at each node.
+//  Purpose: computes RDII inflow at each node for a time step.
 //
 {
     int   hasRdii = FALSE;             // true if any node has some RDII
@@ -1464,7 +1654,8 @@ int getNodeRdii()
 
         // --- apply node's sewer area to UH RDII to get node RDII in CFS
         i = Node[j].rdiiInflow->unitHyd;
-        rdii = UHGroup[i].rdii * Node[j].rdiiInflow->area / UCF(RAINFALL);
+        rdii = UHGroup[i].stepRdii[s] * Node[j].rdiiInflow->area /
+               UCF(RAINFALL);
         if ( rdii < ZERO_RDII ) rdii = 0.0;
         else hasRdii = TRUE;
 
@@ -1531,9 +1722,15 @@ void freeRdiiMemory()
                 FREE(UHGroup[i].uh[k].pastRain);
                 FREE(UHGroup[i].uh[k].pastMonth);
             }
+            FREE(UHGroup[i].rainDepths);
+            FREE(UHGroup[i].rainDates);
+            FREE(UHGroup[i].rainEnd);
+            FREE(UHGroup[i].gageDates);
+            FREE(UHGroup[i].stepRdii);
         }
         FREE(UHGroup);
     }
+    FREE(StepDates);
     FREE(RdiiNodeIndex);
     FREE(RdiiNodeFlow);
 }
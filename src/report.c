@@ -43,6 +43,7 @@
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
@@ -62,6 +63,30 @@
 //-----------------------------------------------------------------------------
 static time_t SysTime;
 
+//-----------------------------------------------------------------------------
+//  Deferred messages
+//-----------------------------------------------------------------------------
+//  Messages written while objects are validated or initialized in parallel
+//  are saved here and then written to the report in order of object index.
+#define WARNING_MSG  -1                // code of a deferred warning message
+
+typedef struct
+{
+    int    object;                     // index of object message is for
+    int    code;                       // error code, WARNING_MSG, or 0
+    long   seq;                        // order in which message was written
+    char*  text;                       // formatted message text
+}  TDeferredMsg;
+
+static TDeferredMsg* DeferredMsgs;     // deferred messages
+static long   DeferredCount;           // number of deferred messages
+static long   DeferredSize;            // allocated size of DeferredMsgs
+static int    DeferringMsgs;           // TRUE if messages are being deferred
+static int    DeferralFailed;          // TRUE if a message couldn't be saved
+static int    MsgObject;               // object a thread's messages are for
+static int    MsgObjectError;          // last error code for MsgObject
+#pragma omp threadprivate(MsgObject, MsgObjectError)
+
 //-----------------------------------------------------------------------------
 //  Imported variables
 //-----------------------------------------------------------------------------
@@ -70,6 +95,7 @@ extern REAL4* SubcatchResults;         // Results vectors defined in OUTPUT.C
 extern REAL4* NodeResults;             //  "
 extern REAL4* LinkResults;             //  "
 extern char   ErrString[81];           // defined in ERROR.C
+#pragma omp threadprivate(ErrString)
 
 
 extern TNodeStats*     NodeStats;
@@ -90,6 +116,8 @@ static void report_NodeHeader(char *id);
 static void report_Links(void);
 static void report_LinkHeader(char *id);
 static void report_RouteStepFreq(TTimeStepStats* timeStepStats);
+static void report_deferMsg(int code, const char* format, ...);
+static int  report_compareMsgs(const void* msg1, const void* msg2);
 
 //=============================================================================
 
@@ -1563,6 +1591,14 @@ void report_writeErrorMsg(int code, char* s)
 //  Purpose: writes error message to report file.
 //
 {
+    char msg[MAXMSG+1];
+
+    if ( DeferringMsgs )
+    {
+        report_deferMsg(code, error_getMsg(code, msg), s);
+        MsgObjectError = code;
+        return;
+    }
     if ( Frpt.file )
     {
         WRITE("");
@@ -1626,6 +1662,11 @@ void report_writeWarningMsg(char* msg, char* id)
 //  Purpose: writes a warning message to the report file.
 //
 {
+    if ( DeferringMsgs )
+    {
+        report_deferMsg(WARNING_MSG, "\n  %s %s", msg, id);
+        return;
+    }
     fprintf(Frpt.file, "\n  %s %s", msg, id);
     Warnings++;
 }
@@ -1649,7 +1690,174 @@ void report_writeTseriesErrorMsg(int code, TTable *tseries)
         datetime_dateToStr(x, theDate);
         datetime_timeToStr(x, theTime);
         report_writeErrorMsg(ERR_TIMESERIES_SEQUENCE, tseries->ID);
-        fprintf(Frpt.file, " at %s %s.", theDate, theTime);
+        if ( DeferringMsgs ) report_deferMsg(0, " at %s %s.", theDate, theTime);
+        else fprintf(Frpt.file, " at %s %s.", theDate, theTime);
     }
     else report_writeErrorMsg(code, tseries->ID);
 }
+
+//=============================================================================
+
+void report_deferMsgs()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: starts saving the error and warning messages written about
+//           objects processed in parallel instead of writing them.
+//
+{
+    DeferredCount = 0;
+    DeferralFailed = FALSE;
+    DeferringMsgs = TRUE;
+}
+
+//=============================================================================
+
+void report_setMsgObject(int j)
+//
+//  Input:   j = object index
+//  Output:  none
+//  Purpose: identifies the object that the calling thread's messages are
+//           about while messages are being deferred.
+//
+{
+    MsgObject = j;
+    MsgObjectError = 0;
+}
+
+//=============================================================================
+
+int report_getErrorCode()
+//
+//  Input:   none
+//  Output:  returns an error code
+//  Purpose: retrieves the last error code reported for the calling thread's
+//           current object while messages are being deferred, or else the
+//           project's error code.
+//
+{
+    if ( DeferringMsgs ) return MsgObjectError;
+    return ErrorCode;
+}
+
+//=============================================================================
+
+void report_writeDeferredMsgs()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes all deferred messages to the report file in order of
+//           object index and stops deferring messages.
+//
+{
+    long i;
+    TDeferredMsg* m;
+
+    DeferringMsgs = FALSE;
+    if ( DeferredCount > 1 )
+        qsort(DeferredMsgs, DeferredCount, sizeof(TDeferredMsg),
+              report_compareMsgs);
+    for (i = 0; i < DeferredCount; i++)
+    {
+        m = &DeferredMsgs[i];
+        if ( m->code == WARNING_MSG )
+        {
+            if ( Frpt.file ) fputs(m->text, Frpt.file);
+            Warnings++;
+        }
+        else if ( m->code > 0 )
+        {
+            if ( Frpt.file )
+            {
+                WRITE("");
+                fputs(m->text, Frpt.file);
+            }
+            ErrorCode = m->code;
+            if ( ErrorCode <= ERR_INPUT || ErrorCode >= ERR_FILE_NAME )
+                snprintf(ErrorMsg, MAXMSG, "%s", m->text);
+        }
+        else if ( Frpt.file ) fputs(m->text, Frpt.file);
+        free(m->text);
+    }
+    FREE(DeferredMsgs);
+    DeferredCount = 0;
+    DeferredSize = 0;
+    if ( DeferralFailed ) report_writeErrorMsg(ERR_MEMORY, "");
+}
+
+//=============================================================================
+
+void report_deferMsg(int code, const char* format, ...)
+//
+//  Input:   code = error code, WARNING_MSG, or 0 for other text
+//           format = format of message text
+//           ... = values to be formatted
+//  Output:  none
+//  Purpose: saves a message about the calling thread's current object.
+//
+{
+    va_list args;
+    char*   text = NULL;
+    int     n;
+    long    size;
+    TDeferredMsg* msgs;
+
+    // --- format the message
+    va_start(args, format);
+    n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if ( n >= 0 ) text = (char *) malloc(n + 1);
+    if ( text )
+    {
+        va_start(args, format);
+        vsnprintf(text, n + 1, format, args);
+        va_end(args);
+    }
+
+    // --- add it to the list of deferred messages
+    #pragma omp critical(deferredMsgs)
+    {
+        if ( text && DeferredCount == DeferredSize )
+        {
+            size = 2 * MAX(DeferredSize, 16);
+            msgs = (TDeferredMsg *) realloc(DeferredMsgs,
+                   size * sizeof(TDeferredMsg));
+            if ( msgs )
+            {
+                DeferredMsgs = msgs;
+                DeferredSize = size;
+            }
+        }
+        if ( text && DeferredCount < DeferredSize )
+        {
+            DeferredMsgs[DeferredCount].object = MsgObject;
+            DeferredMsgs[DeferredCount].code = code;
+            DeferredMsgs[DeferredCount].seq = DeferredCount;
+            DeferredMsgs[DeferredCount].text = text;
+            DeferredCount++;
+        }
+        else
+        {
+            free(text);
+            DeferralFailed = TRUE;
+        }
+    }
+}
+
+//=============================================================================
+
+int report_compareMsgs(const void* msg1, const void* msg2)
+//
+//  Input:   msg1, msg2 = pointers to two deferred messages
+//  Output:  returns -1, 0, or 1
+//  Purpose: orders deferred messages by object index and then by the order
+//           in which they were written.
+//
+{
+    const TDeferredMsg* m1 = (const TDeferredMsg *)msg1;
+    const TDeferredMsg* m2 = (const TDeferredMsg *)msg2;
+
+    if ( m1->object != m2->object ) return m1->object < m2->object ? -1 : 1;
+    if ( m1->seq != m2->seq ) return m1->seq < m2->seq ? -1 : 1;
+    return 0;
+}
@@ -117,8 +117,11 @@ int routing_open()
     // --- open any routing interface files
     iface_openRoutingFiles();
 
+    // --- allocate heat sensitivity state when requested
+    if ( TempModel.active == 1 && !temprout_open() ) return ErrorCode;
+
     // --- initialize flow and quality routing systems
-    flowrout_init(RouteModel);
+    flowrout_init(SortedLinks, RouteModel);
     if ( Fhotstart1.mode == NO_FILE ){
 		qualrout_init();
 		/* START modification by Alejandro Figueroa | EAWAG */
@@ -148,6 +151,7 @@ void routing_close(int routingModel)
     // --- free allocated memory
     flowrout_close(routingModel);
     treatmnt_close();
+    temprout_close();
     FREE(SortedLinks);
 }
 
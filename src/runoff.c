@@ -37,7 +37,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include "headers.h"
-#include "odesolve.h"
+
+// Protect against lack of compiler support for OpenMP
+#if defined(_OPENMP)
+  #include <omp.h>
+#else
+  static int omp_get_thread_num(void) { return 0; }
+#endif
 
 //-----------------------------------------------------------------------------
 // Shared variables
@@ -55,6 +61,7 @@ static long  MaxStepsPos;              // position in Runoff interface file
 //-----------------------------------------------------------------------------
 char    HasWetLids;  // TRUE if any LIDs are wet (used in lidproc.c)
 double* OutflowLoad; // exported pollutant mass load (used in surfqual.c)
+#pragma omp threadprivate(OutflowLoad)
 
 //-----------------------------------------------------------------------------
 //  Imported variables
@@ -76,6 +83,12 @@ static void   runoff_initFile(void);
 static void   runoff_readFromFile(void);
 static void   runoff_saveToFile(float tStep);
 static void   runoff_getOutfallRunon(double tStep);
+static double runoff_getSubcatchRunoff(int j, double tStep,
+              DateTime currentDate, char canSweep);
+static void   runoff_getParallelRunoff(double tStep, DateTime currentDate,
+              char canSweep);
+static int    runoff_openWorkspace(void);
+static void   runoff_closeWorkspace(void);
 
 //=============================================================================
 
@@ -91,9 +104,6 @@ int runoff_open()
     HasSnow = FALSE;
     Nsteps = 0;
 
-    // --- open the Ordinary Differential Equation solver
-    if ( !odesolve_open(MAXODES) ) report_writeErrorMsg(ERR_ODE_SOLVER, "");
-
     // --- allocate memory for pollutant runoff loads
     OutflowLoad = NULL;
     if ( Nobjects[POLLUT] > 0 )
@@ -102,6 +112,10 @@ int runoff_open()
         if ( !OutflowLoad ) report_writeErrorMsg(ERR_MEMORY, "");
     }
 
+    // --- allocate logs for mass balance updates made by parallel threads
+    if ( NumThreads > 1 && !massbal_openLogs(NumThreads) )
+        report_writeErrorMsg(ERR_MEMORY, "");
+
     // --- see if a runoff interface file should be opened
     switch ( Frunoff.mode )
     {
@@ -128,11 +142,9 @@ void runoff_close()
 //  Purpose: closes the runoff analyzer.
 //
 {
-    // --- close the ODE solver
-    odesolve_close();
-
     // --- free memory for pollutant runoff loads
     FREE(OutflowLoad);
+    massbal_closeLogs();
 
     // --- close runoff interface file if in use
     if ( Frunoff.file )
@@ -254,30 +266,19 @@ void runoff_execute()
     HasSnow = FALSE;
     HasRunoff = FALSE;
     HasWetLids = FALSE;
-    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    if ( NumThreads > 1 )
+    {
+        runoff_getParallelRunoff(runoffStep, currentDate, canSweep);
+    }
+    else for (j = 0; j < Nobjects[SUBCATCH]; j++)
     {
-        // --- find total runoff rate (in ft/sec) over the subcatchment
-        //     (the amount that actually leaves the subcatchment (in cfs)
-        //     is also computed and is stored in Subcatch[j].newRunoff)
         if ( Subcatch[j].area == 0.0 ) continue;
-        runoff = subcatch_getRunoff(j, runoffStep);
+        runoff = runoff_getSubcatchRunoff(j, runoffStep, currentDate,
+                                          canSweep);
 
         // --- update state of study area surfaces
         if ( runoff > 0.0 ) HasRunoff = TRUE;
         if ( Subcatch[j].newSnowDepth > 0.0 ) HasSnow = TRUE;
-
-        // --- skip pollutant buildup/washoff if quality ignored
-        if ( IgnoreQuality ) continue;
-
-        // --- add to pollutant buildup if runoff is negligible
-        if ( runoff < MIN_RUNOFF ) surfqual_getBuildup(j, runoffStep); 
-
-        // --- reduce buildup by street sweeping
-        if ( canSweep && Subcatch[j].rainfall <= MIN_RUNOFF)
-            surfqual_sweepBuildup(j, currentDate);
-
-        // --- compute pollutant washoff 
-        surfqual_getWashoff(j, runoff, runoffStep);
     }
 
     // --- update tracking of system-wide max. runoff rate
@@ -296,6 +297,135 @@ void runoff_execute()
 
 //=============================================================================
 
+double runoff_getSubcatchRunoff(int j, double tStep, DateTime currentDate,
+                                char canSweep)
+//
+//  Input:   j = subcatchment index
+//           tStep = runoff time step (sec)
+//           currentDate = current date/time
+//           canSweep = TRUE if street sweeping can occur
+//  Output:  returns total runoff over the subcatchment (ft/sec)
+//  Purpose: computes runoff and pollutant buildup/washoff for a subcatchment.
+//
+{
+    // --- find total runoff rate (in ft/sec) over the subcatchment
+    //     (the amount that actually leaves the subcatchment (in cfs)
+    //     is also computed and is stored in Subcatch[j].newRunoff)
+    double runoff = subcatch_getRunoff(j, tStep);
+
+    // --- skip pollutant buildup/washoff if quality ignored
+    if ( IgnoreQuality ) return runoff;
+
+    // --- add to pollutant buildup if runoff is negligible
+    if ( runoff < MIN_RUNOFF ) surfqual_getBuildup(j, tStep);
+
+    // --- reduce buildup by street sweeping
+    if ( canSweep && Subcatch[j].rainfall <= MIN_RUNOFF)
+        surfqual_sweepBuildup(j, currentDate);
+
+    // --- compute pollutant washoff
+    surfqual_getWashoff(j, runoff, tStep);
+    return runoff;
+}
+
+//=============================================================================
+
+void runoff_getParallelRunoff(double tStep, DateTime currentDate,
+                              char canSweep)
+//
+//  Input:   tStep = runoff time step (sec)
+//           currentDate = current date/time
+//           canSweep = TRUE if street sweeping can occur
+//  Output:  none
+//  Purpose: computes runoff and pollutant buildup/washoff for all
+//           subcatchments using parallel threads.
+//
+//  Runon from other subcatchments is based on their runoff from the
+//  previous time step (see subcatch_getRunon) so the subcatchments can
+//  be analyzed in any order. Each thread is given a contiguous block of
+//  subcatchments and logs its updates to the system mass balance totals.
+//  The logs are then added in thread order so that the totals are the
+//  same as those of a serial run.
+//
+{
+    int    j;
+    int    hasRunoff = FALSE;
+    int    hasSnow = FALSE;
+    int    canRun = TRUE;
+    double runoff;
+
+#pragma omp parallel num_threads(NumThreads) private(runoff) \
+    reduction(|:hasRunoff, hasSnow)
+{
+    int thread = omp_get_thread_num();
+
+    // --- the master thread uses the workspace allocated in runoff_open
+    //     while other threads allocate their own
+    if ( thread > 0 && !runoff_openWorkspace() )
+    {
+        #pragma omp critical(runoff)
+        canRun = FALSE;
+    }
+    #pragma omp barrier
+
+    if ( canRun )
+    {
+        massbal_startLog(thread);
+        #pragma omp for schedule(static)
+        for (j = 0; j < Nobjects[SUBCATCH]; j++)
+        {
+            if ( Subcatch[j].area == 0.0 ) continue;
+            runoff = runoff_getSubcatchRunoff(j, tStep, currentDate,
+                                              canSweep);
+            if ( runoff > 0.0 ) hasRunoff = TRUE;
+            if ( Subcatch[j].newSnowDepth > 0.0 ) hasSnow = TRUE;
+        }
+        massbal_stopLog();
+    }
+    if ( thread > 0 ) runoff_closeWorkspace();
+}
+
+    // --- add logged mass balance updates to the system totals
+    if ( !massbal_commitLogs() || !canRun )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+    }
+    if ( hasRunoff ) HasRunoff = TRUE;
+    if ( hasSnow ) HasSnow = TRUE;
+}
+
+//=============================================================================
+
+int runoff_openWorkspace()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: allocates the calling thread's pollutant load array.
+//
+{
+    OutflowLoad = NULL;
+    if ( Nobjects[POLLUT] > 0 )
+    {
+        OutflowLoad = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        if ( !OutflowLoad ) return FALSE;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void runoff_closeWorkspace()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the calling thread's pollutant load array.
+//
+{
+    FREE(OutflowLoad);
+}
+
+//=============================================================================
+
 double runoff_getTimeStep(DateTime currentDate)
 //
 //  Input:   currentDate = current simulation date/time
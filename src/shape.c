@@ -33,7 +33,7 @@ static int normalizeShapeTables(TShape *shape);
 static int getNextInterval(TTable *curve, double y, double yLast, double wLast,
                            double *y1, double *y2, double *w1, double *w2,
                            double *wMax);
-static double getWidth(double y, double y1, double y2, double w1, double w2);
+static double getShapeWidth(double y, double y1, double y2, double w1, double w2);
 static double getArea(double y, double w, double y1, double w1);
 static double getPerim(double y, double w, double y1, double w1);
 
@@ -154,7 +154,7 @@ int computeShapeTables(TShape *shape, TTable *curve)
         }
 
         // --- get top width, area, & perimeter of current interval
-        w = getWidth(y, y1, y2, w1, w2);
+        w = getShapeWidth(y, y1, y2, w1, w2);
         Atotal += getArea(y, w, yLast, wLast);
         Ptotal += getPerim(y, w, yLast, wLast);
 
@@ -304,7 +304,7 @@ int getNextInterval(TTable *curve, double y, double yLast, double wLast,
 
 //=============================================================================
 
-double getWidth(double y, double y1, double y2, double w1, double w2)
+double getShapeWidth(double y, double y1, double y2, double w1, double w2)
 //
 //  Input:   y = height along a shape curve
 //           y1 = height at start of a shape curve interval
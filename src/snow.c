@@ -24,6 +24,7 @@
 #include <string.h>
 #include <math.h>
 #include "headers.h"
+#include "mempool.h"
 
 //-----------------------------------------------------------------------------
 // Constants 
@@ -132,7 +133,7 @@ int snow_createSnowpack(int j, int k)
 //
 {
     TSnowpack* snowpack;
-    snowpack = (TSnowpack *) malloc(sizeof(TSnowpack));
+    snowpack = AllocArray(TSnowpack, 1);
     if ( !snowpack ) return FALSE;
     Subcatch[j].snowpack = snowpack;
     snowpack->snowmeltIndex = k;
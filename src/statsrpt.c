@@ -131,6 +131,8 @@ void statsrpt_writeReport()
         /* START modification by Alejandro Figueroa | EAWAG */
         if ( TempModel.active == 1 && !IgnoreWTemperature) writeLinkLoadsT();       
         /* END modification by Alejandro Figueroa | EAWAG */
+        if ( TempModel.active == 1 && !IgnoreWTemperature)
+            temprout_writeSensReport();
     }
 }
 
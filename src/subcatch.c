@@ -71,11 +71,21 @@ double     VlidReturn;    // LID outflow returned to pervious area
 //-----------------------------------------------------------------------------
 // Locally shared variables   
 //-----------------------------------------------------------------------------
-static  TSubarea* theSubarea;     // subarea to which getDdDt() is applied
-static  double    Dstore;         // monthly adjusted depression storage (ft)
-static  double    Alpha;          // monthly adjusted runoff coeff.
 static  char *RunoffRoutingWords[] = { w_OUTLET,  w_IMPERV, w_PERV, NULL};
 
+// --- the water balance volumes are private to each thread so that
+//     subcatchments can be analyzed in parallel
+#pragma omp threadprivate(Vevap, Vpevap, Vinfil, Vinflow, Voutflow, VlidIn, \
+    VlidInfil, VlidOut, VlidDrain, VlidReturn)
+
+// --- subarea whose ponded depth is integrated by getDdDt()
+typedef struct
+{
+    TSubarea* subarea;        // subarea being analyzed
+    double    dStore;         // monthly adjusted depression storage (ft)
+    double    alpha;          // monthly adjusted runoff coeff.
+}   TPondedFlow;
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
 //-----------------------------------------------------------------------------
@@ -109,10 +119,13 @@ static double getSubareaRunoff(int subcatch, int subarea, double area,
               double rainfall, double evap, double tStep);
 static double getSubareaInfil(int j, TSubarea* subarea, double precip,
               double tStep);
-static double findSubareaRunoff(TSubarea* subarea, double tRunoff);
-static void   updatePondedDepth(TSubarea* subarea, double* tx);
-static void   getDdDt(double t, double* d, double* dddt);
-static void   adjustSubareaParams(int subareaType, int subcatch);
+static double findSubareaRunoff(TSubarea* subarea, double dStore,
+              double alpha, double tRunoff);
+static void   updatePondedDepth(TSubarea* subarea, double dStore,
+              double alpha, double* tx);
+static void   getDdDt(double t, double* d, double* dddt, void* data);
+static void   adjustSubareaParams(int subareaType, int subcatch,
+              double* dStore, double* alpha);
 
 //=============================================================================
 
@@ -407,11 +420,6 @@ void  subcatch_validate(int j)
                 sqrt(Subcatch[j].slope) / Subcatch[j].subArea[i].N;
         }
     }
-
-    // --- set isUsed property of subcatchment's rain gage
-    i = Subcatch[j].gage;
-    if (i >= 0) Gage[i].isUsed = TRUE;
-
 }
 
 //=============================================================================
@@ -923,6 +931,8 @@ double getSubareaRunoff(int j, int i, double area, double precip, double evap,
     double    surfEvap;                // evap. used for surface water (ft/sec)
     double    infil = 0.0;             // infiltration rate (ft/sec)
     double    runoff = 0.0;            // runoff rate (ft/sec)
+    double    dStore;                  // adjusted depression storage (ft)
+    double    alpha;                   // adjusted runoff coeff.
     TSubarea* subarea;                 // pointer to subarea being analyzed
 
     // --- no runoff if no area
@@ -951,10 +961,10 @@ double getSubareaRunoff(int j, int i, double area, double precip, double evap,
     if ( i == PERV ) Vpevap += Vevap;
     Vinfil += infil * area * tStep;
 
-    // --- assign adjusted runoff coeff. & storage to shared variables
-    Alpha = subarea->alpha;
-    Dstore = subarea->dStore;
-    adjustSubareaParams(i, j); 
+    // --- find adjusted runoff coeff. & storage
+    alpha = subarea->alpha;
+    dStore = subarea->dStore;
+    adjustSubareaParams(i, j, &dStore, &alpha);
 
     // --- if losses exceed available moisture then no ponded water remains
     if ( surfEvap + infil >= surfMoisture )
@@ -967,11 +977,11 @@ double getSubareaRunoff(int j, int i, double area, double precip, double evap,
     else
     {
         subarea->inflow -= surfEvap + infil;
-        updatePondedDepth(subarea, &tRunoff);
+        updatePondedDepth(subarea, dStore, alpha, &tRunoff);
     }
 
     // --- compute runoff based on updated ponded depth
-    runoff = findSubareaRunoff(subarea, tRunoff);
+    runoff = findSubareaRunoff(subarea, dStore, alpha, tRunoff);
 
     // --- compute runoff volume leaving subcatchment for mass balance purposes
     //     (fOutlet is the fraction of this subarea's runoff that goes to the
@@ -1010,15 +1020,18 @@ double getSubareaInfil(int j, TSubarea* subarea, double precip, double tStep)
 
 //=============================================================================
 
-double findSubareaRunoff(TSubarea* subarea, double tRunoff)
+double findSubareaRunoff(TSubarea* subarea, double dStore, double alpha,
+                         double tRunoff)
 //
 //  Purpose: computes runoff (ft/s) from subarea after current time step.
 //  Input:   subarea = ptr. to a subarea
+//           dStore = adjusted depression storage (ft)
+//           alpha = adjusted runoff coeff.
 //           tRunoff = time step over which runoff occurs (sec)
 //  Output:  returns runoff rate (ft/s)
 //
 {
-    double xDepth = subarea->depth - Dstore;
+    double xDepth = subarea->depth - dStore;
     double runoff = 0.0;
 
     if ( xDepth > ZERO )
@@ -1026,14 +1039,14 @@ double findSubareaRunoff(TSubarea* subarea, double tRunoff)
         // --- case where nonlinear routing is used
         if ( subarea->N > 0.0 )
         {
-            runoff = Alpha * pow(xDepth, MEXP);
+            runoff = alpha * pow(xDepth, MEXP);
         }
 
         // --- case where no routing is used (Mannings N = 0)
         else
         {
             runoff = xDepth / tRunoff;
-            subarea->depth = Dstore;
+            subarea->depth = dStore;
         }
     }
     else
@@ -1045,9 +1058,12 @@ double findSubareaRunoff(TSubarea* subarea, double tRunoff)
 
 //=============================================================================
 
-void updatePondedDepth(TSubarea* subarea, double* dt)
+void updatePondedDepth(TSubarea* subarea, double dStore, double alpha,
+                       double* dt)
 //
 //  Input:   subarea = ptr. to a subarea,
+//           dStore = adjusted depression storage (ft)
+//           alpha = adjusted runoff coeff.
 //           dt = time step (sec)
 //  Output:  dt = time ponded depth is above depression storage (sec)
 //  Purpose: computes new ponded depth over subarea after current time step.
@@ -1056,9 +1072,10 @@ void updatePondedDepth(TSubarea* subarea, double* dt)
     double ix = subarea->inflow;       // excess inflow to subarea (ft/sec)
     double dx;                         // depth above depression storage (ft)
     double tx = *dt;                   // time over which dx > 0 (sec)
+    TPondedFlow flow;                  // subarea state used by getDdDt
     
     // --- see if not enough inflow to fill depression storage (dStore)
-    if ( subarea->depth + ix*tx <= Dstore )
+    if ( subarea->depth + ix*tx <= dStore )
     {
         subarea->depth += ix * tx;
     }
@@ -1066,20 +1083,22 @@ void updatePondedDepth(TSubarea* subarea, double* dt)
     // --- otherwise use the ODE solver to integrate flow depth
     else
     {
-        // --- if depth < Dstore then fill up Dstore & reduce time step
-        dx = Dstore - subarea->depth;
+        // --- if depth < dStore then fill up dStore & reduce time step
+        dx = dStore - subarea->depth;
         if ( dx > 0.0 && ix > 0.0 )
         {
             tx -= dx / ix;
-            subarea->depth = Dstore;
+            subarea->depth = dStore;
         }
 
         // --- now integrate depth over remaining time step tx
-        if ( Alpha > 0.0 && tx > 0.0 )
+        if ( alpha > 0.0 && tx > 0.0 )
         {
-            theSubarea = subarea;
+            flow.subarea = subarea;
+            flow.dStore = dStore;
+            flow.alpha = alpha;
             odesolve_integrate(&(subarea->depth), 1, 0, tx, ODETOL, tx,
-                               getDdDt);
+                               getDdDt, &flow);
         }
         else
         {
@@ -1098,35 +1117,39 @@ void updatePondedDepth(TSubarea* subarea, double* dt)
 
 //=============================================================================
 
-void  getDdDt(double t, double* d, double* dddt)
+void  getDdDt(double t, double* d, double* dddt, void* data)
 //
 //  Input:   t = current time (not used)
 //           d = stored depth (ft)
+//           data = ptr. to the TPondedFlow of the subarea being analyzed
 //  Output   dddt = derivative of d with respect to time
 //  Purpose: evaluates derivative of stored depth w.r.t. time
 //           for the subarea whose runoff is being computed.
 //
 {
-    double ix = theSubarea->inflow;
-    double rx = *d - Dstore;
+    TPondedFlow* flow = (TPondedFlow *)data;
+    double ix = flow->subarea->inflow;
+    double rx = *d - flow->dStore;
     if ( rx < 0.0 )
     {
         rx = 0.0;
     }
     else
     {
-        rx = Alpha * pow(rx, MEXP);
+        rx = flow->alpha * pow(rx, MEXP);
     }
     *dddt = ix - rx;
 }
 
 //=============================================================================
 
-void adjustSubareaParams(int i, int j)
+void adjustSubareaParams(int i, int j, double* dStore, double* alpha)
 //
 //  Input:   i = type of subarea being analyzed
 //           j = index of current subcatchment being analyzed
-//  Output   adjusted values of module-level variables Dstore & Alpha
+//           dStore = subarea's depression storage (ft)
+//           alpha = subarea's runoff coeff.
+//  Output   adjusted values of dStore & alpha
 //  Purpose: adjusts a pervious subarea's depression storage and its
 //           runoff coeff. by month of the year.
 //
@@ -1143,7 +1166,7 @@ void adjustSubareaParams(int i, int j)
         {
             m = datetime_monthOfYear(getDateTime(OldRunoffTime)) - 1;
             f = Pattern[p].factor[m];
-            if (f >= 0.0) Dstore *= f;
+            if (f >= 0.0) *dStore *= f;
         }
 
         // --- roughness adjustment to runoff coeff.
@@ -1152,8 +1175,8 @@ void adjustSubareaParams(int i, int j)
         {
             m = datetime_monthOfYear(getDateTime(OldRunoffTime)) - 1;
             f = Pattern[p].factor[m];
-            if (f <= 0.0) Alpha = 0.0;
-            else          Alpha /= f;
+            if (f <= 0.0) *alpha = 0.0;
+            else          *alpha /= f;
         }
     }
 }
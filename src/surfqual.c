@@ -43,6 +43,8 @@ extern double      VlidInfil;     // infiltration from LID units
 extern double      VlidOut;       // surface outflow from LID units
 extern double      VlidDrain;     // drain outflow from LID units
 extern double      VlidReturn;    // LID outflow returned to pervious area
+#pragma omp threadprivate(OutflowLoad, Vinfil, Vinflow, Voutflow, VlidIn, \
+    VlidInfil, VlidOut, VlidDrain, VlidReturn)
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
@@ -69,6 +69,8 @@
   #include <errno.h>
 #else
   #include <unistd.h>
+  #include <sys/stat.h>
+  #include <errno.h>
 #endif
 #ifdef EXH
   #include <excpt.h>
@@ -253,6 +255,41 @@ int DLLEXPORT  swmm_run(const char *f1, const char *f2, const char *f3)
 
 //=============================================================================
 
+int DLLEXPORT  swmm_convertRainfall(const char *f1, const char *f2,
+                                    const char *f3)
+//
+//  Input:   f1 = name of input file
+//           f2 = name of report file
+//           f3 = name of rainfall interface file to create
+//  Output:  returns error code
+//  Purpose: saves the data read from a project's rainfall data files to
+//           a binary rainfall interface file without running a simulation.
+//
+//  The interface file can then be used by other runs of the project
+//  (with USE RAINFALL in its [FILES] section) so that they don't have
+//  to read the data files again.
+//
+{
+    char fname[MAXFNAME+1];
+
+    // --- open the project
+    ErrorCode = 0;
+    writecon("\n o  Retrieving project data");
+    swmm_open(f1, f2, "");
+
+    // --- write rainfall interface file
+    if ( !ErrorCode )
+    {
+        writecon("\n o  Saving rainfall interface file");
+        sstrncpy(fname, f3, MAXFNAME);
+        rain_convert(fname);
+    }
+    swmm_close();
+    return ErrorCode;
+}
+
+//=============================================================================
+
 int DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3)
 //
 //  Input:   f1 = name of input file
@@ -1543,9 +1580,26 @@ char* getTempFileName(char* fname)
 // For non-Windows systems:
 #else
 
-    // --- use system function mkstemp() to create a temporary file name
-    sstrncpy(fname, "swmmXXXXXX", MAXFNAME);
-    mkstemp(fname);
+    char* dir = NULL;
+    int   fd;
+
+    // --- set dir to user's choice of a temporary directory or else to
+    //     the system's (as _tempnam does on Windows)
+    if (strlen(TempDir) > 0)
+    {
+        if (mkdir(TempDir, 0777) == 0 || errno == EEXIST)
+            dir = TempDir;
+    }
+    if (dir == NULL) dir = getenv("TMPDIR");
+    if (dir == NULL || strlen(dir) == 0) dir = P_tmpdir;
+    if (strlen(dir) + 11 > MAXFNAME) return NULL;
+
+    // --- use system function mkstemp() to create a unique file in dir
+    //     (closing the descriptor it opens, since callers use fopen)
+    snprintf(fname, MAXFNAME+1, "%s/swmmXXXXXX", dir);
+    fd = mkstemp(fname);
+    if (fd < 0) return NULL;
+    close(fd);
     return fname;
 
 #endif
@@ -131,6 +131,8 @@ typedef enum {
 } swmm_FlowUnitsProperty;
 
 int    DLLEXPORT swmm_run(const char *f1, const char *f2, const char *f3);
+int    DLLEXPORT swmm_convertRainfall(const char *f1, const char *f2,
+                 const char *f3);
 int    DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3);
 int    DLLEXPORT swmm_start(int saveFlag);
 int    DLLEXPORT swmm_step(double *elapsedTime);
@@ -14,6 +14,11 @@
 //   The table_getFirstEntry and table_getNextEntry functions, as well as the
 //   Time Series functions that use them, are not thread safe.
 //
+//   A table's x/y entries are stored in a contiguous array. The data for a
+//   Time Series that comes from an external file are parsed just once, when
+//   the series is validated, and saved to a binary scratch file that is then
+//   read a block of entries at a time.
+//
 //   Update History
 //   ==============
 //   Build 5.1.008:
@@ -38,10 +43,16 @@
 #include <string.h>
 #include "headers.h"
 
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+static const int FILEBLOCK = 4096;     // entries read at a time from file
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 int    table_getNextFileEntry(TTable* table, double* x, double* y);
+int    table_convertFile(TTable* table);
 int    table_parseFileLine(char* line, TTable* table, double* x, double* y);
 double table_interpolate(double x, double x1, double y1, double x2, double y2);
 
@@ -214,15 +225,25 @@ int table_addEntry(TTable* table, double x, double y)
 //  Purpose: adds a new x/y entry to a table.
 //
 {
-    TTableEntry *entry;
-    entry = (TTableEntry *) malloc(sizeof(TTableEntry));
-    if ( !entry ) return FALSE;
-    entry->x = x;
-    entry->y = y;
-    entry->next = NULL;
-    if ( table->firstEntry == NULL )  table->firstEntry = entry;
-    else table->lastEntry->next = entry;
-    table->lastEntry = entry;
+    int n = table->nEntries;
+    TTableEntry* entries;
+
+    // --- grow the table's array of entries if it's full
+    //     (copying any entries that reside in a shared input cache)
+    if ( n >= table->maxEntries )
+    {
+        entries = (TTableEntry *) realloc(
+                  table->maxEntries > 0 ? table->entries : NULL,
+                  2 * (size_t)MAX(n, 4) * sizeof(TTableEntry));
+        if ( !entries ) return FALSE;
+        if ( table->maxEntries == 0 && n > 0 )
+            memcpy(entries, table->entries, n * sizeof(TTableEntry));
+        table->entries = entries;
+        table->maxEntries = 2 * MAX(n, 4);
+    }
+    table->entries[n].x = x;
+    table->entries[n].y = y;
+    table->nEntries++;
     return TRUE;
 }
 
@@ -235,24 +256,23 @@ void   table_deleteEntries(TTable *table)
 //  Purpose: deletes all x/y entries in a table.
 //
 {
-    TTableEntry *entry;
-    TTableEntry *nextEntry;
-    entry = table->firstEntry;
-    while (entry)
-    {
-        nextEntry = entry->next;
-        free(entry);
-        entry = nextEntry;
-    }
-    table->firstEntry = NULL;
-    table->lastEntry  = NULL;
-    table->thisEntry  = NULL;
+    // --- entries read from a shared input cache are not owned by the table
+    if ( table->maxEntries > 0 ) free(table->entries);
+    table->entries = NULL;
+    table->nEntries = 0;
+    table->maxEntries = 0;
+    table->thisEntry = 0;
 
     if (table->file.file)
     { 
         fclose(table->file.file);
         table->file.file = NULL;
     }
+    if ( table->file.mode == SCRATCH_FILE )
+    {
+        remove(table->scratchName);
+        table->file.mode = NO_FILE;
+    }
 }
 
 //=============================================================================
@@ -266,9 +286,10 @@ void   table_init(TTable *table)
 {
     table->ID = NULL;
     table->refersTo = -1;
-    table->firstEntry = NULL;
-    table->lastEntry = NULL;
-    table->thisEntry = table->firstEntry;
+    table->entries = NULL;
+    table->nEntries = 0;
+    table->maxEntries = 0;
+    table->thisEntry = 0;
     table->lastDate = 0.0;
     table->x1 = 0.0;
     table->x2 = 0.0;
@@ -277,6 +298,9 @@ void   table_init(TTable *table)
     table->dxMin = 0.0;
     table->file.mode = NO_FILE;
     table->file.file = NULL;
+    table->scratchName[0] = '\0';
+    table->fileStart = 0;
+    table->fileEnd = 0;
     table->curveType = -1;
 }
 
@@ -289,40 +313,37 @@ int   table_validate(TTable *table)
 //  Purpose: checks that table's x-values are in ascending order.
 //
 {
-    int    result;
-    double x1, x2, y1, y2;
+    int    i;
     double dx, dxMin = BIG;
+    TTableEntry* entries;
 
-    // --- open external file if used as the table's data source
-    if ( table->file.mode == USE_FILE )
-    {
-        table->file.file = fopen(table->file.name, "rt");
-        if ( table->file.file == NULL ) return ERR_TABLE_FILE_OPEN;
-    }
-
-    // --- retrieve the first data entry in the table
-    result = table_getFirstEntry(table, &x1, &y1);
-
-    // --- return error condition if external file has no valid data
-    if ( !result && table->file.mode == USE_FILE ) return ERR_TABLE_FILE_READ;
+    // --- convert external file used as the table's data source
+    if ( table->file.mode == USE_FILE ) return table_convertFile(table);
 
-    // --- retrieve successive table entries and check for non-increasing x-values
-    while ( table_getNextEntry(table, &x2, &y2) )
+    // --- check for non-increasing x-values
+    for (i = 1; i < table->nEntries; i++)
     {
-        dx = x2 - x1;
+        dx = table->entries[i].x - table->entries[i-1].x;
         if ( dx <= 0.0 )
         {
-            table->x2 = x2;
+            table->x2 = table->entries[i].x;
             return ERR_CURVE_SEQUENCE;
         }
         dxMin = MIN(dxMin, dx);
-        x1 = x2;
     }
     table->dxMin = dxMin;
 
-    // --- return error if external file could not be read completely
-    if ( table->file.mode == USE_FILE && !feof(table->file.file) )
-        return ERR_TABLE_FILE_READ;
+    // --- release any unused space in the entries array
+    if ( table->nEntries > 0 && table->nEntries < table->maxEntries )
+    {
+        entries = (TTableEntry *) realloc(table->entries,
+                  table->nEntries * sizeof(TTableEntry));
+        if ( entries )
+        {
+            table->entries = entries;
+            table->maxEntries = table->nEntries;
+        }
+    }
     return 0;
 }
 
@@ -336,26 +357,27 @@ int table_getFirstEntry(TTable *table, double *x, double *y)
 //           returns TRUE if successful, FALSE if not
 //  Purpose: retrieves the first x/y entry in a table.
 //
-//  NOTE: also moves the current position pointer (thisEntry) to the 1st entry.
+//  NOTE: also moves the current position (thisEntry) to the 1st entry.
 //
 {
-    TTableEntry *entry;
     *x = 0;
     *y = 0.0;
 
-    if ( table->file.mode == USE_FILE )
+    if ( table->file.mode == SCRATCH_FILE )
     {
         if ( table->file.file == NULL ) return FALSE;
         rewind(table->file.file);
+        table->fileStart = 0;
+        table->nEntries = 0;
+        table->thisEntry = 0;
         return table_getNextFileEntry(table, x, y);
     }
 
-    entry = table->firstEntry;
-    if ( entry )
+    if ( table->nEntries > 0 )
     {
-        *x = entry->x;
-        *y = entry->y;
-        table->thisEntry = entry;
+        *x = table->entries[0].x;
+        *y = table->entries[0].y;
+        table->thisEntry = 0;
         return TRUE;
     }
     else return FALSE;
@@ -371,20 +393,20 @@ int table_getNextEntry(TTable *table, double *x, double *y)
 //           returns TRUE if successful, FALSE if not
 //  Purpose: retrieves the next x/y entry in a table.
 //
-//  NOTE: also updates the current position pointer (thisEntry).
+//  NOTE: also updates the current position (thisEntry).
 //
 {
-    TTableEntry *entry;
+    int i;
 
-    if ( table->file.mode == USE_FILE )
+    if ( table->file.mode == SCRATCH_FILE )
         return table_getNextFileEntry(table, x, y);
-    
-    entry = table->thisEntry->next;
-    if ( entry )
+
+    i = table->thisEntry + 1;
+    if ( i < table->nEntries )
     {
-        *x = entry->x;
-        *y = entry->y;
-        table->thisEntry = entry;
+        *x = table->entries[i].x;
+        *y = table->entries[i].y;
+        table->thisEntry = i;
         return TRUE;
     }
     else return FALSE;
@@ -406,18 +428,17 @@ double table_lookup(TTable *table, double x)
 //
 {
     double x1,y1,x2,y2;
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
-    entry = table->firstEntry;
-    if ( entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
+    if ( n == 0 ) return 0.0;
+    x1 = entry[0].x;
+    y1 = entry[0].y;
     if ( x <= x1 ) return y1;
-    while ( entry->next )
+    for (i = 1; i < n; i++)
     {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
+        x2 = entry[i].x;
+        y2 = entry[i].y;
         if ( x <= x2 ) return table_interpolate(x, x1, y1, x2, y2);
         x1 = x2;
         y1 = y2;
@@ -437,19 +458,18 @@ double table_getSlope(TTable *table, double x)
 {
     double x1,y1,x2,y2;
     double dx;
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
-    entry = table->firstEntry;
-    if ( entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
+    if ( n == 0 ) return 0.0;
+    x1 = entry[0].x;
+    y1 = entry[0].y;
     x2 = x1;
     y2 = y1;
-    while ( entry->next )
+    for (i = 1; i < n; i++)
     {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
+        x2 = entry[i].x;
+        y2 = entry[i].y;
         if ( x <= x2 ) break;
         x1 = x2;
         y1 = y2;
@@ -473,22 +493,21 @@ double table_lookupEx(TTable *table, double x)
 {
     double x1,y1,x2,y2;
     double s = 0.0;
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
-    entry = table->firstEntry;
-    if (entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
+    if ( n == 0 ) return 0.0;
+    x1 = entry[0].x;
+    y1 = entry[0].y;
     if ( x <= x1 )
     {
         if (x1 > 0.0 ) return x/x1*y1;
         else return y1;
     }
-    while ( entry->next )
+    for (i = 1; i < n; i++)
     {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
+        x2 = entry[i].x;
+        y2 = entry[i].y;
         if ( x2 != x1 ) s = (y2 - y1) / (x2 - x1);
         if ( x <= x2 ) return table_interpolate(x, x1, y1, x2, y2);
         x1 = x2;
@@ -509,17 +528,15 @@ double table_intervalLookup(TTable *table, double x)
 //           whose x-value is > x.
 //
 {
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
-    entry = table->firstEntry;
-    if (entry == NULL ) return 0.0;
-    if ( x < entry->x ) return entry->y;
-    while ( entry->next )
+    if ( n == 0 ) return 0.0;
+    for (i = 0; i < n - 1; i++)
     {
-        entry = entry->next;
-        if ( x < entry->x ) return entry->y;
+        if ( x < entry[i].x ) return entry[i].y;
     }
-    return entry->y;
+    return entry[n-1].y;
 }
 
 //=============================================================================
@@ -538,18 +555,17 @@ double table_inverseLookup(TTable *table, double y)
 //
 {
     double x1,y1,x2,y2;
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
-    entry = table->firstEntry;
-    if (entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
+    if ( n == 0 ) return 0.0;
+    x1 = entry[0].x;
+    y1 = entry[0].y;
     if ( y <= y1 ) return x1;
-    while ( entry->next )
+    for (i = 1; i < n; i++)
     {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
+        x2 = entry[i].x;
+        y2 = entry[i].y;
         if ( y <= y2 ) return table_interpolate(y, y1, x1, y2, x2);
         x1 = x2;
         y1 = y2;
@@ -569,15 +585,15 @@ double  table_getMaxY(TTable *table, double x)
 //
 {
     double ymax;
-    TTableEntry* entry;
+    int    i = 0, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
-    entry = table->firstEntry;
-    ymax = entry->y;
-    while ( x > entry->x && entry->next )
+    ymax = entry[0].y;
+    while ( x > entry[i].x && i + 1 < n )
     {
-        entry = entry->next;
-        if ( entry->y < ymax ) return ymax;
-        ymax = entry->y;
+        i++;
+        if ( entry[i].y < ymax ) return ymax;
+        ymax = entry[i].y;
     }
     return 0.0;
 }
@@ -593,14 +609,14 @@ double table_getStorageVolume(TTable *table, double x)
 //
 {
     double a, a1, x1, v, dx = 0.0, dy = 0.0, s;
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
     // --- get first entry in table
     v = 0.0;
-    entry = table->firstEntry;
-    if (entry == NULL) return 0.0;
-    x1 = entry->x;
-    a1 = entry->y;
+    if (n == 0) return 0.0;
+    x1 = entry[0].x;
+    a1 = entry[0].y;
 
     // --- target depth is below first tabulated depth
     if (x <= x1)
@@ -610,23 +626,22 @@ double table_getStorageVolume(TTable *table, double x)
     }
 
     // --- otherwise traverse table entries until target depth is bracketed
-    while (entry->next)
+    for (i = 1; i < n; i++)
     {
-        entry = entry->next;
         // --- target is bracketed - apply end area method to interpolated area
-        if (entry->x >= x)
+        if (entry[i].x >= x)
         {
-            a = table_interpolate(x, x1, a1, entry->x, entry->y);
+            a = table_interpolate(x, x1, a1, entry[i].x, entry[i].y);
             return v + (a1 + a) / 2.0 * (x - x1);
         }
         // --- target not yet bracketed so update volume using end area method
         else
         {
-            dx = entry->x - x1;
-            dy = entry->y - a1;
-            v = v + (a1 + entry->y) / 2.0 * dx;
-            x1 = entry->x;
-            a1 = entry->y;
+            dx = entry[i].x - x1;
+            dy = entry[i].y - a1;
+            v = v + (a1 + entry[i].y) / 2.0 * dx;
+            x1 = entry[i].x;
+            a1 = entry[i].y;
         }
     }
 
@@ -657,14 +672,14 @@ double table_getStorageDepth(TTable *table, double v)
 //
 {
     double a1, a2, d1, d2, dd = 0.0, da = 0.0, v1, v2, s;
-    TTableEntry* entry;
+    int    i, n = table->nEntries;
+    TTableEntry* entry = table->entries;
 
     // --- see if target volume is below that of 1st table entry
     if (v == 0.0) return 0.0;
-    entry = table->firstEntry;
-    if (entry == NULL) return 0.0;
-    d1 = entry->x;
-    a1 = entry->y;
+    if (n == 0) return 0.0;
+    d1 = entry[0].x;
+    a1 = entry[0].y;
     v1 = a1 * d1 / 2.0;
     if (v <= v1)
     {
@@ -673,11 +688,10 @@ double table_getStorageDepth(TTable *table, double v)
     }
 
     // --- add next table entry to volume until target volume is bracketed
-    while (entry->next)
+    for (i = 1; i < n; i++)
     {
-        entry = entry->next;
-        d2 = entry->x;
-        a2 = entry->y;
+        d2 = entry[i].x;
+        a2 = entry[i].y;
         dd = d2 - d1;
         da = a2 - a1;
         v2 = v1 + (a1 + a2) / 2.0 * dd;
@@ -763,7 +777,8 @@ double table_tseriesLookup(TTable *table, double x, char extend)
     return table_interpolate(x, table->x1, table->y1, table->x2, table->y2);
     
     // --- end of external time series file has been reached
-    if ( table->file.mode == USE_FILE && feof(table->file.file) )
+    if ( table->file.mode == SCRATCH_FILE &&
+         table->fileStart + table->thisEntry >= table->fileEnd )
     {
         if (extend == TRUE) return table->y1;
         else return 0;
@@ -815,17 +830,126 @@ int  table_getNextFileEntry(TTable* table, double* x, double* y)
 //  Purpose: retrieves the next date and value for a time series
 //           table stored in an external file.
 //
+//  NOTE: the file's data are read from its binary scratch copy a block of
+//        entries at a time.
+//
 {
-    char line[MAXLINE+1];
-    int  code;
+    int i = table->thisEntry + 1;
+
     if ( table->file.file == NULL ) return FALSE;
-    while ( !feof(table->file.file) && fgets(line, MAXLINE, table->file.file) != NULL )
+    if ( i >= table->nEntries )
+    {
+        table->fileStart += table->nEntries;
+        table->nEntries = (int)fread(table->entries, sizeof(TTableEntry),
+                          table->maxEntries, table->file.file);
+        table->thisEntry = 0;
+        if ( table->nEntries == 0 ) return FALSE;
+        i = 0;
+    }
+    *x = table->entries[i].x;
+    *y = table->entries[i].y;
+    table->thisEntry = i;
+    return TRUE;
+}
+
+//=============================================================================
+
+int  table_convertFile(TTable* table)
+//
+//  Input:   table = pointer to a TTable structure
+//  Output:  returns error code
+//  Purpose: checks the data in a time series' external file and saves them
+//           to a binary scratch file that replaces it as the data source.
+//
+//  NOTE: fileEnd records the entry whose line reached the end of the
+//        external file (or the number of entries if the end was reached
+//        after the last one) so that lookups behave as if the file itself
+//        were still being read.
+//
+{
+    char   line[MAXLINE+1];
+    char*  fname = table->scratchName;
+    int    code, n = 0, errcode = 0;
+    double x, y, x1 = 0.0, dx, dxMin = BIG;
+    FILE*  f;
+    FILE*  scratch = NULL;
+
+    // --- open the external file and its scratch copy
+    f = fopen(table->file.name, "rt");
+    if ( f == NULL ) return ERR_TABLE_FILE_OPEN;
+    #pragma omp critical(tempFile)
+    {
+        if ( getTempFileName(fname) ) scratch = fopen(fname, "w+b");
+    }
+    if ( scratch == NULL )
     {
-        code = table_parseFileLine(line, table, x, y);
+        fclose(f);
+        return ERR_TABLE_FILE_OPEN;
+    }
+    table->entries = (TTableEntry *) malloc(FILEBLOCK * sizeof(TTableEntry));
+    if ( table->entries == NULL ) errcode = ERR_MEMORY;
+    table->maxEntries = FILEBLOCK;
+    table->nEntries = 0;
+    table->fileEnd = -1;
+
+    // --- parse each line of the file, checking for non-increasing dates
+    //     and saving entries to the scratch file a block at a time
+    while ( !errcode && !feof(f) && fgets(line, MAXLINE, f) != NULL )
+    {
+        code = table_parseFileLine(line, table, &x, &y);
         if ( code < 0 ) continue;      //skip blank & comment lines
-        return code;
+        if ( code == FALSE ) break;
+        if ( n > 0 )
+        {
+            dx = x - x1;
+            if ( dx <= 0.0 )
+            {
+                table->x2 = x;
+                errcode = ERR_CURVE_SEQUENCE;
+                break;
+            }
+            dxMin = MIN(dxMin, dx);
+        }
+        x1 = x;
+        table->entries[table->nEntries].x = x;
+        table->entries[table->nEntries].y = y;
+        table->nEntries++;
+        n++;
+        if ( feof(f) ) table->fileEnd = n - 1;
+        if ( table->nEntries == table->maxEntries )
+        {
+            if ( fwrite(table->entries, sizeof(TTableEntry), table->nEntries,
+                 scratch) < (size_t)table->nEntries )
+                errcode = ERR_TABLE_FILE_OPEN;
+            table->nEntries = 0;
+        }
+    }
+    if ( table->fileEnd < 0 ) table->fileEnd = n;
+
+    // --- return error if file had no valid data or was not read completely
+    if ( !errcode && (n == 0 || !feof(f)) ) errcode = ERR_TABLE_FILE_READ;
+    fclose(f);
+    if ( !errcode && fwrite(table->entries, sizeof(TTableEntry),
+         table->nEntries, scratch) < (size_t)table->nEntries )
+        errcode = ERR_TABLE_FILE_OPEN;
+    if ( errcode )
+    {
+        fclose(scratch);
+        remove(fname);
+        FREE(table->entries);
+        table->maxEntries = 0;
+        table->nEntries = 0;
+        return errcode;
     }
-    return FALSE;
+
+    // --- replace the external file with the scratch file
+    table->dxMin = dxMin;
+    table->file.file = scratch;
+    table->file.mode = SCRATCH_FILE;
+    table->nEntries = 0;
+    table->thisEntry = 0;
+    table->fileStart = 0;
+    return 0;
 }
 
 //=============================================================================
@@ -856,8 +980,9 @@ int  table_parseFileLine(char* line, TTable* table, double* x, double* y)
     n = sscanf(line, "%s %s %s", s1, s2, s3);
 
     // --- return if line is blank or is a comment
-    tStr = strtok(line, SEPSTR);
-    if ( tStr == NULL || *tStr == ';' ) return -1;
+    //     (strtok isn't used since files are checked in parallel)
+    tStr = line + strspn(line, SEPSTR);
+    if ( *tStr == '\0' || *tStr == ';' ) return -1;
 
     // --- line only has a time and a value
     if ( n == 2 )
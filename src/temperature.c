@@ -28,16 +28,58 @@
 #include <string.h>
 #include "headers.h"
 
+#define WRITE(x) (report_writeLine((x)))
+
 //-----------------------------------------------------------------------------
 //  Constants
 //-----------------------------------------------------------------------------
 
 static const double ZeroVolume = 0.0353147; // 1 liter in ft3
+
+//-----------------------------------------------------------------------------
+//  Heat exchanger sensitivity (tangent-linear) data
+//-----------------------------------------------------------------------------
+//  Derivatives of each node and link temperature with respect to the
+//  thermalEnergy of every candidate conduit listed in [HEAT_SENSITIVITY]
+//  are carried along with the primal solution. Arrays are stored by object
+//  with the candidate index varying fastest.
+typedef struct
+{
+    double  oldTemp;          // d(old temp.)/dE
+    double  newTemp;          // d(new temp.)/dE or d(heat inflow)/dE
+}  TNodeSens;
+
+typedef struct
+{
+    double  oldTemp;          // d(old temp.)/dE
+    double  newTemp;          // d(new temp.)/dE
+    double  oldTemp1;         // d(upstream end temp.)/dE
+    double  oldTemp2;         // d(downstream end temp.)/dE
+}  TLinkSens;
+
+typedef struct
+{
+    double  sum;              // time integral of dT/dE (C-sec/E)
+    double  time;             // time node carried water (sec)
+    double  maxAbs;           // largest |dT/dE| (C/E)
+}  TSensStats;
+
+static int         NumSens;     // number of candidate conduits
+static int*        SensLink;    // link index of each candidate conduit
+static int*        SensNode;    // node index of each report node
+static TNodeSens*  NodeSens;    // node sensitivities
+static TLinkSens*  LinkSens;    // link sensitivities
+static TSensStats* SensStats;   // sensitivity statistics at report nodes
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
 //  temprout_init            (called by swmm_start)
 //  Temprout_execute         (called by routing_execute)
+//  temprout_readSensParams  (called by parseLine in input.c)
+//  temprout_open            (called by routing_open)
+//  temprout_close           (called by routing_close)
+//  temprout_writeSensReport (called by statsrpt_writeReport)
 
 //-----------------------------------------------------------------------------
 //  Function declarations
@@ -52,11 +94,23 @@ static void  findStorageTemps(int j, double tStep, double airt, double soilt);
 static void  updateHRTT(int j, double v, double q, double tStep);
 static double getMixedTemp(double c, double v1, double wIn, double qIn,
 	double tStep);
-static double getReactedTemp(double oldTemp, int i, double tStep, int month, int day, int hour);
-static double getReactedTemps(double oldTemp, int i, double tStep, double airt, double soilt);
-static double getReactedTempStNode(double oldTemp, int j, double tStep, int month, int day, int hour);
-static double getReactedTempStNodes(double oldTemp, int j, double tStep, double airt, double soilt);
+static double getReactedTemp(double oldTemp, int i, double tStep, int month, int day, int hour,
+	double* dOld, double* dExt);
+static double getReactedTemps(double oldTemp, int i, double tStep, double airt, double soilt,
+	double* dOld, double* dExt);
+static double getReactedTempStNode(double oldTemp, int j, double tStep, int month, int day, int hour,
+	double* dOld, double* dW);
+static double getReactedTempStNodes(double oldTemp, int j, double tStep, double airt, double soilt,
+	double* dOld, double* dW);
 static double getWettedArea(TTable* table, double d);
+static double getThermalExtDeriv(double tStep, double denom);
+static void   getMixedTempCoeffs(double c, double v1, double wIn, double qIn,
+	double tStep, double* a, double* b);
+static void   initSensStep(void);
+static void   updateNodeSens(int j, double cOld, double cW);
+static void   updateLinkSens(int i, int j, double cOld, double cNode, double cExt);
+static void   updateLinkEndSens(int i);
+static void   updateSensStats(double tStep);
 //=============================================================================
 
 void    temprout_init()
@@ -131,6 +185,9 @@ void temprout_execute(double tStep)
 		);
 	}
 
+	// --- advance sensitivity state to the new time step
+	if (NumSens > 0) initSensStep();
+
 	// --- find mass flow each link contributes to its downstream node
 	for (i = 0; i < Nobjects[LINK]; i++) findLinkMassFlowT(i, tStep);
 
@@ -165,6 +222,9 @@ void temprout_execute(double tStep)
 		for (i = 0; i < Nobjects[LINK]; i++) findLinkTemp(i, tStep, month, day, hour);
 	else if (TempModel.GTPattern == 1)
 		for (i = 0; i < Nobjects[LINK]; i++) findLinkTemps(i, tStep, airt, soilt);
+
+	// --- update sensitivity statistics at report nodes
+	if (NumSens > 0) updateSensStats(tStep);
 }
 
 //=============================================================================
@@ -263,6 +323,20 @@ void findLinkMassFlowT(int i, double tStep)
 				Node[j].newTemp = 0.0;
 			}
 			if (!isnan(w)) {Node[j].newTemp += w;}
+
+			// --- accumulate heat inflow sensitivity at downstream node
+			if (NumSens > 0 && !isnan(w))
+			{
+				int p;
+				TNodeSens* ns = &NodeSens[j * NumSens];
+				TLinkSens* ls = &LinkSens[i * NumSens];
+				for (p = 0; p < NumSens; p++)
+				{
+					if (Link[i].type != CONDUIT)  ns[p].newTemp += qLink * ls[p].oldTemp;
+					else if (j == Link[i].node2) ns[p].newTemp += qLink * ls[p].oldTemp2;
+					else                          ns[p].newTemp += qLink * ls[p].oldTemp1;
+				}
+			}
 		}
 	else
 		{
@@ -282,11 +356,13 @@ void findNodeTemp(int j)
 //
 {
 	double qNode;
+	double cOld = 0.0, cW = 0.0;   // sensitivity coeffs. for old temp. & heat inflow
 
 	// --- if there is flow into node then temperature = mass inflow / node flow
 	qNode = Node[j].inflow;
 	if (qNode > ZERO)
 	{
+		cW = isnan(Node[j].newTemp) ? 0.0 : 1.0 / qNode;
 		if (isnan(Node[j].newTemp))
 			// Cold-start: water flows in but no upstream temperature source yet.
 			Node[j].newTemp = WTemperature.initTemp;
@@ -305,7 +381,9 @@ void findNodeTemp(int j)
 			Node[j].newTemp = Node[j].oldTemp;  // water present: keep last temperature
 		else
 			Node[j].newTemp = NAN;              // node is dry: no temperature
+		cOld = 1.0;
 	}
+	if (NumSens > 0) updateNodeSens(j, cOld, cW);
 
 }
 
@@ -332,6 +410,9 @@ void findLinkTemp(int i, double tStep, int month, int day, int hour)
 		vLosses,          // evap. + seepage volume loss (ft3)
 		fEvap,            // evaporation concentration factor
 		barrels;          // number of barrels in conduit
+	double cOld, cNode,   // sensitivity coeffs. for old link & upstream node temp.
+		cExt,             // sensitivity coeff. for the conduit's thermal energy
+		a, b;             // mixing coeffs. for reactor & inflow temp.
 
  // --- identify index of upstream node
 	j = Link[i].node1;
@@ -343,6 +424,7 @@ void findLinkTemp(int i, double tStep, int month, int day, int hour)
 	    (Link[i].newFlow != 0.0 && Link[i].newVolume / fabs(Link[i].newFlow) < 10.0))
 	{
 		Link[i].newTemp = Node[j].newTemp;
+		if (NumSens > 0) updateLinkSens(i, j, 0.0, 1.0, 0.0);
 		return;
 	}
 
@@ -381,6 +463,7 @@ void findLinkTemp(int i, double tStep, int month, int day, int hour)
 
 		// --- start with temperature at start of time step
 	c1 = Link[i].oldTemp;
+	cOld = cNode = cExt = 0.0;
 	if (!isnan(c1)) {
 		// --- update mass balance accounting for seepage loss
 		massbal_addSeepageLossT(qSeep * c1);
@@ -388,16 +471,22 @@ void findLinkTemp(int i, double tStep, int month, int day, int hour)
 		// --- increase concen. by evaporation factor
 		c1 *= fEvap;
 			// --- adjust temperature by heat exchange processes
-		c2 = getReactedTemp(c1, i, tStep, month, day, hour);
+		c2 = getReactedTemp(c1, i, tStep, month, day, hour, &cOld, &cExt);
+		cOld *= fEvap;
 		// --- mix resulting contents with inflow from upstream node
 		if (!isnan(Node[j].newTemp)) { // do not consider NaN values
 			wIn = Node[j].newTemp * qIn;
+			getMixedTempCoeffs(c2, v1, wIn, qIn, tStep, &a, &b);
 			c2 = getMixedTemp(c2, v1, wIn, qIn, tStep);
+			cOld *= a;
+			cExt *= a;
+			cNode = b * qIn;
 		}
 	}
 	else{
 		if (!isnan(Node[j].newTemp)) {
 			c2 = Node[j].newTemp;
+			cNode = 1.0;
 		}
 		else c2 = NAN;
     }
@@ -408,6 +497,7 @@ void findLinkTemp(int i, double tStep, int month, int day, int hour)
 
 			// set temperature to NaN, because 0 is a valid temperatur value
 				c2 =- NAN;
+				cOld = cNode = cExt = 0.0;
 		}
 
 				// --- assign new temperature to link
@@ -427,6 +517,13 @@ void findLinkTemp(int i, double tStep, int month, int day, int hour)
 				Link[i].oldTemp1 = c2;  // Downstream end in reverse flow
 				Link[i].oldTemp2 = Node[Link[i].node2].newTemp;  // Upstream end in reverse
 			}
+
+		// --- carry sensitivities along with the new link temperature
+		if (NumSens > 0)
+		{
+			updateLinkSens(i, j, cOld, cNode, cExt);
+			updateLinkEndSens(i);
+		}
 	//}
 }
 
@@ -453,6 +550,9 @@ void findLinkTemps(int i, double tStep, double airt, double soilt)
 		vLosses,          // evap. + seepage volume loss (ft3)
 		fEvap,            // evaporation concentration factor
 		barrels;          // number of barrels in conduit
+	double cOld, cNode,   // sensitivity coeffs. for old link & upstream node temp.
+		cExt,             // sensitivity coeff. for the conduit's thermal energy
+		a, b;             // mixing coeffs. for reactor & inflow temp.
 
  // --- identify index of upstream node
 	j = Link[i].node1;
@@ -464,6 +564,7 @@ void findLinkTemps(int i, double tStep, double airt, double soilt)
 	    (Link[i].newFlow != 0.0 && Link[i].newVolume / fabs(Link[i].newFlow) < 10.0))
 	{
 		Link[i].newTemp = Node[j].newTemp;
+		if (NumSens > 0) updateLinkSens(i, j, 0.0, 1.0, 0.0);
 		return;
 	}
 	// --- get flow rates and evaporation loss
@@ -502,6 +603,7 @@ void findLinkTemps(int i, double tStep, double airt, double soilt)
 	//{
 		// --- start with concen. at start of time step
 	c1 = Link[i].oldTemp;
+	cOld = cNode = cExt = 0.0;
 	if(!isnan(c1)) {
 	// --- update mass balance accounting for seepage loss
 	massbal_addSeepageLossT(qSeep * c1);
@@ -510,16 +612,22 @@ void findLinkTemps(int i, double tStep, double airt, double soilt)
 	c1 *= fEvap;
 			// --- adjust temperature by heat exchange processes
 			//fprintf(stdout, "inside\n");
-			c2 = getReactedTemps(c1, i, tStep, airt, soilt);
+			c2 = getReactedTemps(c1, i, tStep, airt, soilt, &cOld, &cExt);
+			cOld *= fEvap;
 			// --- mix resulting contents with inflow from upstream node
 			if (!isnan(Node[j].newTemp)) { // do not consider NaN values
 				wIn = Node[j].newTemp * qIn;
+				getMixedTempCoeffs(c2, v1, wIn, qIn, tStep, &a, &b);
 				c2 = getMixedTemp(c2, v1, wIn, qIn, tStep);
+				cOld *= a;
+				cExt *= a;
+				cNode = b * qIn;
 			}
 	}
 	else{
 		if (!isnan(Node[j].newTemp)) {
 			c2 = Node[j].newTemp;
+			cNode = 1.0;
 		}
 		else c2 = NAN;
 	}
@@ -531,6 +639,7 @@ void findLinkTemps(int i, double tStep, double airt, double soilt)
 		massbal_addToFinalStorageT(c2 * v2);
 		// set temperature to NaN, because 0 is a valid temperatur value
 		c2 =- NAN;
+		cOld = cNode = cExt = 0.0;
 	}
 	// --- assign new concen. to link
 	Link[i].newTemp = c2;
@@ -546,6 +655,13 @@ void findLinkTemps(int i, double tStep, double airt, double soilt)
 			Link[i].oldTemp1 = c2;  // Downstream end in reverse flow
 			Link[i].oldTemp2 = Node[Link[i].node2].newTemp;  // Upstream end in reverse
 		}
+
+	// --- carry sensitivities along with the new link temperature
+	if (NumSens > 0)
+	{
+		updateLinkSens(i, j, cOld, cNode, cExt);
+		updateLinkEndSens(i);
+	}
 	//}
 }
 
@@ -576,6 +692,7 @@ void  findSFLinkTemp(int i, double qSeep, double fEvap, double tStep)
 		// --- increase concen. by evaporation factor
 		c1 *= fEvap;
 		Link[i].newTemp = c1;
+		if (NumSens > 0) updateLinkSens(i, j, 0.0, isnan(c1) ? 0.0 : fEvap, 0.0);
 	//}
 }
 
@@ -598,6 +715,9 @@ void  findStorageTemp(int j, double tStep, int month, int day, int hour)
 		qExfil = 0.0,     // exfiltration rate from storage unit (cfs)
 		vEvap = 0.0,      // evaporation loss from storage unit (ft3)
 		fEvap = 1.0;      // evaporation concentration factor
+	double cOld = 1.0,    // sensitivity coeff. for old node temp.
+		cW = 0.0,         // sensitivity coeff. for heat inflow
+		a, b;             // mixing coeffs. for reactor & inflow temp.
 
  // --- get inflow rate & initial volume
 	qIn = Node[j].inflow;
@@ -626,28 +746,37 @@ void  findStorageTemp(int j, double tStep, int month, int day, int hour)
 		// --- increase concen. by evaporation factor
 		c1 *= fEvap;
 		if (c1 != 0.0 && !isnan(c1))
-			c1 = getReactedTempStNode(c1, j, tStep, month, day, hour);
+			c1 = getReactedTempStNode(c1, j, tStep, month, day, hour, &cOld, &cW);
+		cOld *= fEvap;
 
 		// --- mix resulting contents with inflow from all sources
 		//     (temporarily accumulated in Node[j].newTemp)
 		wIn = Node[j].newTemp;
+		getMixedTempCoeffs(c1, v1, wIn, qIn, tStep, &a, &b);
 		c2 = getMixedTemp(c1, v1, wIn, qIn, tStep);
+		cOld *= a;
+		cW = a * cW + b;
 
 		// Cold-start fallback: storage is wet but has no temperature source yet.
 		// Zero-area storage nodes always have newVolume==0 even when carrying flow,
 		// so also check depth to catch that case.
 		if (isnan(c2) && (Node[j].newVolume > ZeroVolume || Node[j].newDepth > FUDGE))
+		{
 			c2 = WTemperature.initTemp;
+			cOld = cW = 0.0;
+		}
 
 		// --- set concen. to zero if remaining volume & inflow is negligible
 		if (Node[j].newVolume <= ZeroVolume && Node[j].newDepth <= FUDGE && qIn <= FLOW_TOL)
 		{
 			massbal_addToFinalStorageT(c2 * Node[j].newVolume);
 			c2 = NAN;
+			cOld = cW = 0.0;
 		}
 
 		// --- assign new concen. to node
 		Node[j].newTemp = c2;
+		if (NumSens > 0) updateNodeSens(j, cOld, cW);
 }
 
 //=============================================================================
@@ -669,6 +798,9 @@ void  findStorageTemps(int j, double tStep, double airt, double soilt)
 		qExfil = 0.0,     // exfiltration rate from storage unit (cfs)
 		vEvap = 0.0,      // evaporation loss from storage unit (ft3)
 		fEvap = 1.0;      // evaporation concentration factor
+	double cOld = 1.0,    // sensitivity coeff. for old node temp.
+		cW = 0.0,         // sensitivity coeff. for heat inflow
+		a, b;             // mixing coeffs. for reactor & inflow temp.
 
  // --- get inflow rate & initial volume
 	qIn = Node[j].inflow;
@@ -697,26 +829,35 @@ void  findStorageTemps(int j, double tStep, double airt, double soilt)
 	// --- increase concen. by evaporation factor
 	c1 *= fEvap;
 	if (c1 != 0.0 && !isnan(c1))
-		c1 = getReactedTempStNodes(c1, j, tStep, airt, soilt);
+		c1 = getReactedTempStNodes(c1, j, tStep, airt, soilt, &cOld, &cW);
+	cOld *= fEvap;
 	// --- mix resulting contents with inflow from all sources
 	//     (temporarily accumulated in Node[j].newTemp)
 	wIn = Node[j].newTemp;
+	getMixedTempCoeffs(c1, v1, wIn, qIn, tStep, &a, &b);
 	c2 = getMixedTemp(c1, v1, wIn, qIn, tStep);
+	cOld *= a;
+	cW = a * cW + b;
 
 	// Cold-start fallback: storage is wet but has no temperature source yet.
 	// Zero-area storage nodes always have newVolume==0 even when carrying flow,
 	// so also check depth to catch that case.
 	if (isnan(c2) && (Node[j].newVolume > ZeroVolume || Node[j].newDepth > FUDGE))
+	{
 		c2 = WTemperature.initTemp;
+		cOld = cW = 0.0;
+	}
 
 	// --- set concen. to zero if remaining volume & inflow is negligible
 	if (Node[j].newVolume <= ZeroVolume && Node[j].newDepth <= FUDGE && qIn <= FLOW_TOL)
 	{
 		massbal_addToFinalStorageT(c2 * Node[j].newVolume);
 		c2 = NAN;
+		cOld = cW = 0.0;
 	}
 	// --- assign new concen. to node
 	Node[j].newTemp = c2;
+	if (NumSens > 0) updateNodeSens(j, cOld, cW);
 }
 
 //=============================================================================
@@ -741,12 +882,15 @@ void updateHRTT(int j, double v, double q, double tStep)
 
 //=============================================================================
 
-double getReactedTemp(double oldTemp, int i, double tStep, int month, int day, int hour)
+double getReactedTemp(double oldTemp, int i, double tStep, int month, int day, int hour,
+	double* dOld, double* dExt)
 //
 //  Input:   oldTemp = temperature of the previous timestep (C)
 //           i = index of the current conduit
 //           tStep = time step (sec)
-//  Output:  none
+//  Output:  dOld = derivative of new temperature w.r.t. oldTemp
+//           dExt = derivative of new temperature w.r.t. thermal energy
+//           returns the new temperature (C)
 //  Purpose: calculate the heat exchange by soil and air of the conduit
 //
 {
@@ -762,6 +906,7 @@ double getReactedTemp(double oldTemp, int i, double tStep, int month, int day, i
 	double length2 = UCF(LENGTH) * UCF(LENGTH);
 	double soilTemp, airTemp;
 	double thermalExt;
+	double tk, dEwa, dEws;
 	// transform from FT to M
 	thickness = Conduit[k].thickness;
 	width = Conduit[k].oldwidth;
@@ -832,18 +977,37 @@ double getReactedTemp(double oldTemp, int i, double tStep, int month, int day, i
 		thermalExt = (Conduit[k].thermalEnergy * 1000 * tStep / denom);
 	else if (TempModel.extUnit == 'T')
 		thermalExt = Conduit[k].thermalEnergy;
+
+	// --- sensitivity of the new temperature to the old one and to the
+	//     conduit's thermal energy (only needed for sensitivity analysis)
+	*dOld = 1.0;
+	*dExt = 0.0;
+	if (NumSens > 0)
+	{
+		tk = oldTemp + 273.15;
+		dEwa = 0.0;
+		if (deltaV > 0.001)
+			dEwa = -widthLength * deltaV * (5.85 + 8.75 * ps0 * ts0 * exp(-ts0 / tk) / (tk * tk));
+		dEws = -wetp * length * UCF(LENGTH) / (radius * (log(radThick / radius) / kp +
+			log(penThick / radThick) / ks));
+		*dOld += (dEwa + dEws) * tStep / denom;
+		*dExt = getThermalExtDeriv(tStep, denom);
+	}
 	oldTemp += deltaT + thermalExt;
 	return oldTemp;
 }
 
 //=============================================================================
 
-double getReactedTemps(double oldTemp, int i, double tStep, double airt, double soilt)
+double getReactedTemps(double oldTemp, int i, double tStep, double airt, double soilt,
+	double* dOld, double* dExt)
 //
 //  Input:   oldTemp = temperature of the previous timestep (C)
 //           i = index of the current conduit
 //           tStep = time step (sec)
-//  Output:  none
+//  Output:  dOld = derivative of new temperature w.r.t. oldTemp
+//           dExt = derivative of new temperature w.r.t. thermal energy
+//           returns the new temperature (C)
 //  Purpose: calculate the heat exchange by soil and air of the conduit
 //
 {
@@ -859,6 +1023,7 @@ double getReactedTemps(double oldTemp, int i, double tStep, double airt, double
 	double length2 = UCF(LENGTH) * UCF(LENGTH);
 	double soilTemp, airTemp;
 	double thermalExt;
+	double tk, dEwa, dEws;
 	// transform from FT to M
 	thickness = Conduit[k].thickness;
 	width = Conduit[k].oldwidth;
@@ -928,18 +1093,38 @@ double getReactedTemps(double oldTemp, int i, double tStep, double airt, double
 		thermalExt = (Conduit[k].thermalEnergy * 1000 * tStep/ denom);
 	else if (TempModel.extUnit == 'T')
 		thermalExt = Conduit[k].thermalEnergy;
+
+	// --- sensitivity of the new temperature to the old one and to the
+	//     conduit's thermal energy (only needed for sensitivity analysis)
+	*dOld = 1.0;
+	*dExt = 0.0;
+	if (NumSens > 0)
+	{
+		tk = oldTemp + 273.15;
+		dEwa = 0.0;
+		if (deltaV > 0.001)
+			dEwa = -widthLength * deltaV * (5.85 + 8.75 * ps0 * ts0 * exp(-ts0 / tk) / (tk * tk));
+		dEws = -wetp * length * UCF(LENGTH) / (radius * (log(radThick / radius) / kp +
+			log(penThick / radThick) / ks));
+		*dOld += (dEwa + dEws) * tStep / denom;
+		*dExt = getThermalExtDeriv(tStep, denom);
+	}
 	oldTemp += deltaT + thermalExt;
 	return oldTemp;
 }
 
 //=============================================================================
 
-double getReactedTempStNode(double oldTemp, int j, double tStep, int month, int day, int hour)
+double getReactedTempStNode(double oldTemp, int j, double tStep, int month, int day, int hour,
+	double* dOld, double* dW)
 //
 //  Input:   oldTemp = temperature of the previous timestep (C)
 //           i = index of the current conduit
 //           tStep = time step (sec)
-//  Output:  none
+//  Output:  dOld = derivative of new temperature w.r.t. oldTemp
+//           dW = derivative of new temperature w.r.t. the node's
+//                accumulated heat inflow
+//           returns the new temperature (C)
 //  Purpose: calculate the heat exchange by soil and air of the storage unit
 //
 {
@@ -1014,6 +1199,18 @@ double getReactedTempStNode(double oldTemp, int j, double tStep, int month, int
 	//deltaT += (Ewa + Ews) * tStep / (TempModel.density* TempModel.specHC * (volume + Qout * tStep));
 	deltaT += (Ews)*tStep / (TempModel.density * TempModel.specHC * (volume + Qout * tStep));
 
+	// --- sensitivity of the new temperature to the old one and to the
+	//     heat inflow (only needed for sensitivity analysis)
+	*dOld = 1.0;
+	*dW = 0.0;
+	if (NumSens > 0)
+	{
+		*dOld = volume / (volume + Qin * tStep) - wetA / Rws * tStep /
+			(TempModel.density * TempModel.specHC * (volume + Qout * tStep));
+		if (Node[j].inflow > ZERO)
+			*dW = Qin * tStep / (volume + Qin * tStep) / Node[j].inflow;
+	}
+
 	oldTemp = deltaT;// - 273.15;
 
 	return oldTemp;
@@ -1021,12 +1218,16 @@ double getReactedTempStNode(double oldTemp, int j, double tStep, int month, int
 
 //=============================================================================
 
-double getReactedTempStNodes(double oldTemp, int j, double tStep, double airt, double soilt)
+double getReactedTempStNodes(double oldTemp, int j, double tStep, double airt, double soilt,
+	double* dOld, double* dW)
 //
 //  Input:   oldTemp = temperature of the previous timestep (C)
 //           i = index of the current conduit
 //           tStep = time step (sec)
-//  Output:  none
+//  Output:  dOld = derivative of new temperature w.r.t. oldTemp
+//           dW = derivative of new temperature w.r.t. the node's
+//                accumulated heat inflow
+//           returns the new temperature (C)
 //  Purpose: calculate the heat exchange by soil and air of the storage unit
 //
 {
@@ -1100,6 +1301,18 @@ double getReactedTempStNodes(double oldTemp, int j, double tStep, double airt, d
 	//deltaT += (Ewa + Ews) * tStep / (TempModel.density* TempModel.specHC * (volume + Qout * tStep));
 	deltaT += (Ews)*tStep / (TempModel.density * TempModel.specHC * (volume + Qout * tStep));
 
+	// --- sensitivity of the new temperature to the old one and to the
+	//     heat inflow (only needed for sensitivity analysis)
+	*dOld = 1.0;
+	*dW = 0.0;
+	if (NumSens > 0)
+	{
+		*dOld = volume / (volume + Qin * tStep) - wetA / Rws * tStep /
+			(TempModel.density * TempModel.specHC * (volume + Qout * tStep));
+		if (Node[j].inflow > ZERO)
+			*dW = Qin * tStep / (volume + Qin * tStep) / Node[j].inflow;
+	}
+
 	oldTemp = deltaT;// - 273.15;
 
 	return oldTemp;
@@ -1118,12 +1331,12 @@ double getWettedArea(TTable* table, double x)
 	double x1, y1, x2, y2;
 	double s = 0.0;
 	double area = 0.0;
-	TTableEntry* entry;
+	int i, n = table->nEntries;
+	TTableEntry* entry = table->entries;
 
-	entry = table->firstEntry;
-	if (entry == NULL) return 0.0;
-	x1 = entry->x;
-	y1 = entry->y;
+	if (n == 0) return 0.0;
+	x1 = entry[0].x;
+	y1 = entry[0].y;
 
 	// get base area
 	area = y1;
@@ -1132,11 +1345,10 @@ double getWettedArea(TTable* table, double x)
 		return area;
 
 	// calculate the lateral surface
-	while (entry->next)
+	for (i = 1; i < n; i++)
 	{
-		entry = entry->next;
-		x2 = entry->x;
-		y2 = entry->y;
+		x2 = entry[i].x;
+		y2 = entry[i].y;
 		if (x <= x2) {
 			y2 = y1 + (y2 - y1) / (x2 - x1) * (x - x1);
 			x2 = x;
@@ -1150,4 +1362,372 @@ double getWettedArea(TTable* table, double x)
 	}
 
 	return area;
-}
\ No newline at end of file
+}
+//=============================================================================
+//                   HEAT EXCHANGER SENSITIVITY ANALYSIS
+//=============================================================================
+
+int temprout_readSensParams(char* tok[], int ntoks)
+//
+//  Input:   tok[] = array of string tokens
+//           ntoks = number of tokens
+//  Output:  returns an error code
+//  Purpose: reads a candidate conduit or a report node for the heat
+//           exchanger sensitivity analysis from a line of input.
+//
+//  Data format is:
+//    CONDUIT  linkID   (conduit whose thermalEnergy is a parameter)
+//    NODE     nodeID   (node where sensitivities are reported)
+//
+{
+    int j;
+
+    if ( ntoks < 2 ) return error_setInpError(ERR_ITEMS, "");
+    if ( match(tok[0], w_CONDUIT) )
+    {
+        j = project_findObject(LINK, tok[1]);
+        if ( j < 0 ) return error_setInpError(ERR_NAME, tok[1]);
+        if ( Link[j].sensIndex < 0 )
+            Link[j].sensIndex = TempModel.nSensLinks++;
+    }
+    else if ( match(tok[0], w_NODE) )
+    {
+        j = project_findObject(NODE, tok[1]);
+        if ( j < 0 ) return error_setInpError(ERR_NAME, tok[1]);
+        if ( Node[j].sensIndex < 0 )
+            Node[j].sensIndex = TempModel.nSensNodes++;
+    }
+    else return error_setInpError(ERR_KEYWORD, tok[0]);
+    return 0;
+}
+
+//=============================================================================
+
+int temprout_open()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: allocates the tangent-linear state used to compute the
+//           sensitivity of water temperature to the thermal energy of
+//           candidate heat exchanger conduits.
+//
+//  Note:    if no report nodes were listed then sensitivities are
+//           reported at every outfall.
+//
+{
+    int i, j, nNodes;
+
+    NumSens = 0;
+    SensLink = NULL;
+    SensNode = NULL;
+    NodeSens = NULL;
+    LinkSens = NULL;
+    SensStats = NULL;
+    if ( TempModel.nSensLinks == 0 || IgnoreWTemperature ) return TRUE;
+
+    // --- check that all candidate links are conduits
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        if ( Link[i].sensIndex >= 0 && Link[i].type != CONDUIT )
+        {
+            report_writeErrorMsg(ERR_HEAT_SENS_LINK, Link[i].ID);
+            return FALSE;
+        }
+    }
+
+    // --- default report nodes are the system's outfalls
+    nNodes = TempModel.nSensNodes;
+    if ( nNodes == 0 )
+    {
+        for (j = 0; j < Nobjects[NODE]; j++)
+        {
+            if ( Node[j].type == OUTFALL ) Node[j].sensIndex = nNodes++;
+        }
+    }
+
+    // --- allocate sensitivity arrays
+    NumSens   = TempModel.nSensLinks;
+    SensLink  = (int *) calloc(NumSens, sizeof(int));
+    SensNode  = (int *) calloc(nNodes + 1, sizeof(int));
+    NodeSens  = (TNodeSens *) calloc((size_t)Nobjects[NODE] * NumSens,
+                                     sizeof(TNodeSens));
+    LinkSens  = (TLinkSens *) calloc((size_t)Nobjects[LINK] * NumSens,
+                                     sizeof(TLinkSens));
+    SensStats = (TSensStats *) calloc((size_t)(nNodes + 1) * NumSens,
+                                      sizeof(TSensStats));
+    if ( !SensLink || !SensNode || !NodeSens || !LinkSens || !SensStats )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return FALSE;
+    }
+
+    // --- map parameter and report indexes to their objects
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        if ( Link[i].sensIndex >= 0 ) SensLink[Link[i].sensIndex] = i;
+    }
+    for (j = 0; j < Nobjects[NODE]; j++)
+    {
+        if ( Node[j].sensIndex >= 0 ) SensNode[Node[j].sensIndex] = j;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void temprout_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory used by the sensitivity analysis.
+//
+{
+    FREE(SensLink);
+    FREE(SensNode);
+    FREE(NodeSens);
+    FREE(LinkSens);
+    FREE(SensStats);
+    NumSens = 0;
+}
+
+//=============================================================================
+
+void temprout_writeSensReport()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes the heat exchanger sensitivity summary to the report file.
+//
+{
+    int    j, k, n, p;
+    double mean;
+    char*  units = (TempModel.extUnit == 'P') ? "C/kW" : "C/C";
+    TSensStats* stats;
+
+    if ( NumSens == 0 || Frpt.file == NULL ) return;
+    WRITE("");
+    WRITE("**********************************");
+    WRITE("Heat Exchanger Sensitivity Summary");
+    WRITE("**********************************");
+    WRITE("");
+    fprintf(Frpt.file,
+"\n  ----------------------------------------------------------------------"
+"\n                                              Mean dT/dE   Max |dT/dE|"
+"\n  Node                 Conduit                %10s    %10s"
+"\n  ----------------------------------------------------------------------",
+        units, units);
+
+    for (j = 0; j < Nobjects[NODE]; j++)
+    {
+        n = Node[j].sensIndex;
+        if ( n < 0 ) continue;
+        for (p = 0; p < NumSens; p++)
+        {
+            k = SensLink[p];
+            stats = &SensStats[n * NumSens + p];
+            mean = 0.0;
+            if ( stats->time > 0.0 ) mean = stats->sum / stats->time;
+            fprintf(Frpt.file, "\n  %-20s %-20s %12.4e  %12.4e",
+                Node[j].ID, Link[k].ID, mean, stats->maxAbs);
+        }
+    }
+    WRITE("");
+}
+
+//=============================================================================
+
+double getThermalExtDeriv(double tStep, double denom)
+//
+//  Input:   tStep = time step (sec)
+//           denom = heat capacity of the water in the conduit (J/C)
+//  Output:  returns derivative of the temperature change produced by a
+//           heat exchanger w.r.t. its thermal energy (C/kW or C/C)
+//  Purpose: differentiates the heat exchanger term of getReactedTemp.
+//
+{
+    if ( TempModel.extUnit == 'P' ) return 1000.0 * tStep / denom;
+    if ( TempModel.extUnit == 'T' ) return 1.0;
+    return 0.0;
+}
+
+//=============================================================================
+
+void getMixedTempCoeffs(double c, double v1, double wIn, double qIn,
+	double tStep, double* a, double* b)
+//
+//  Input:   c = temperature in reactor at start of time step
+//           v1 = volume in reactor at start of time step (ft3)
+//           wIn = heat inflow rate (C-cfs)
+//           qIn = flow inflow rate (cfs)
+//           tStep = time step (sec)
+//  Output:  a = derivative of mixed temperature w.r.t. c
+//           b = derivative of mixed temperature w.r.t. wIn
+//  Purpose: differentiates getMixedTemp, following the same branches.
+//
+{
+	double vIn, cIn, cMix;
+
+	*a = 1.0;
+	*b = 0.0;
+	if (qIn <= ZERO || isnan(wIn)) return;
+	vIn = qIn * tStep;
+	cIn = wIn * tStep / vIn;
+
+	// --- empty reactor takes on the inflow temperature
+	if (isnan(c) || v1 <= ZeroVolume)
+	{
+		*a = 0.0;
+		if (cIn > 0.0) *b = 1.0 / qIn;
+		return;
+	}
+
+	// --- mixture is limited by the larger of the two temperatures
+	cMix = (c * v1 + wIn * tStep) / (v1 + vIn);
+	if (cMix > MAX(c, cIn))
+	{
+		if (c >= cIn) return;
+		*a = 0.0;
+		*b = 1.0 / qIn;
+	}
+	else if (cMix < 0.0) *a = 0.0;
+	else
+	{
+		*a = v1 / (v1 + vIn);
+		*b = tStep / (v1 + vIn);
+	}
+}
+
+//=============================================================================
+
+void initSensStep()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: replaces old sensitivity states with new ones and clears the
+//           nodal heat inflow sensitivity accumulators.
+//
+{
+	int i, n = Nobjects[NODE] * NumSens;
+
+	for (i = 0; i < n; i++)
+	{
+		NodeSens[i].oldTemp = NodeSens[i].newTemp;
+		NodeSens[i].newTemp = 0.0;
+	}
+	n = Nobjects[LINK] * NumSens;
+	for (i = 0; i < n; i++) LinkSens[i].oldTemp = LinkSens[i].newTemp;
+}
+
+//=============================================================================
+
+void updateNodeSens(int j, double cOld, double cW)
+//
+//  Input:   j = node index
+//           cOld = derivative of new temperature w.r.t. old temperature
+//           cW = derivative of new temperature w.r.t. heat inflow
+//  Output:  none
+//  Purpose: finds the new temperature sensitivities at a node once its
+//           new temperature has been computed.
+//
+{
+	int p;
+	double x;
+	TNodeSens* ns = &NodeSens[j * NumSens];
+
+	for (p = 0; p < NumSens; p++)
+	{
+		x = 0.0;
+		if (!isnan(Node[j].newTemp)) x = cOld * ns[p].oldTemp + cW * ns[p].newTemp;
+		ns[p].newTemp = isfinite(x) ? x : 0.0;
+	}
+}
+
+//=============================================================================
+
+void updateLinkSens(int i, int j, double cOld, double cNode, double cExt)
+//
+//  Input:   i = link index
+//           j = index of link's upstream node
+//           cOld = derivative of new temperature w.r.t. old link temperature
+//           cNode = derivative of new temperature w.r.t. node j temperature
+//           cExt = derivative of new temperature w.r.t. link's thermal energy
+//  Output:  none
+//  Purpose: finds the new temperature sensitivities in a link once its
+//           new temperature has been computed.
+//
+{
+	int p;
+	double x;
+	TLinkSens* ls = &LinkSens[i * NumSens];
+	TNodeSens* ns = &NodeSens[j * NumSens];
+
+	for (p = 0; p < NumSens; p++)
+	{
+		x = 0.0;
+		if (!isnan(Link[i].newTemp))
+		{
+			x = cOld * ls[p].oldTemp + cNode * ns[p].newTemp;
+			if (p == Link[i].sensIndex) x += cExt;
+		}
+		ls[p].newTemp = isfinite(x) ? x : 0.0;
+	}
+}
+
+//=============================================================================
+
+void updateLinkEndSens(int i)
+//
+//  Input:   i = link index
+//  Output:  none
+//  Purpose: updates the sensitivities of the temperatures held at each end
+//           of a conduit, mirroring the update of oldTemp1 & oldTemp2.
+//
+{
+	int p;
+	int n1 = Link[i].node1;
+	int n2 = Link[i].node2;
+	TLinkSens* ls = &LinkSens[i * NumSens];
+
+	for (p = 0; p < NumSens; p++)
+	{
+		if (Link[i].newFlow >= 0.0)
+		{
+			ls[p].oldTemp1 = NodeSens[n1 * NumSens + p].newTemp;
+			ls[p].oldTemp2 = ls[p].newTemp;
+		}
+		else
+		{
+			ls[p].oldTemp1 = ls[p].newTemp;
+			ls[p].oldTemp2 = NodeSens[n2 * NumSens + p].newTemp;
+		}
+	}
+}
+
+//=============================================================================
+
+void updateSensStats(double tStep)
+//
+//  Input:   tStep = routing time step (sec)
+//  Output:  none
+//  Purpose: updates the time-averaged and peak temperature sensitivities
+//           at the report nodes.
+//
+{
+	int j, n, p;
+	double x;
+	TSensStats* stats;
+
+	for (j = 0; j < Nobjects[NODE]; j++)
+	{
+		n = Node[j].sensIndex;
+		if (n < 0 || isnan(Node[j].newTemp)) continue;
+		stats = &SensStats[n * NumSens];
+		for (p = 0; p < NumSens; p++)
+		{
+			x = NodeSens[j * NumSens + p].newTemp;
+			stats[p].sum += x * tStep;
+			stats[p].time += tStep;
+			stats[p].maxAbs = MAX(stats[p].maxAbs, fabs(x));
+		}
+	}
+}
@@ -107,6 +107,11 @@
 #define  w_MIN_ROUTE_STEP    "MINIMUM_STEP"
 #define  w_NUM_THREADS       "THREADS"
 #define  w_SURCHARGE_METHOD  "SURCHARGE_METHOD"
+#define  w_XSECT_TABLES      "XSECT_TABLES"
+#define  w_SOLVER_METHOD     "SOLVER_METHOD"
+#define  w_RATE_LEVELS      "MULTIRATE_LEVELS"
+#define  w_FRIC_TOL          "FRICTION_TOLERANCE"
+#define  w_INPUT_CACHE       "INPUT_CACHE"
 /* START modification by Peter Schlagbauer | TUGraz */
 #define  w_TEMP_MODEL        "TEMP_MODEL"
 #define  w_DENSITY			 "DENSITY" 
@@ -140,6 +145,10 @@
 #define  w_EXTRAN            "EXTRAN"
 #define  w_SLOT              "SLOT"
 
+// Dynamic Wave Solver Methods
+#define  w_PICARD            "PICARD"
+#define  w_NEWTON            "NEWTON"
+
 // Infiltration Methods
 #define  w_HORTON            "HORTON"
 #define  w_MOD_HORTON        "MODIFIED_HORTON"
@@ -479,5 +488,6 @@
 #define  ws_STREET           "[STREET"
 #define  ws_INLET            "[INLET"
 #define  ws_INLET_USAGE      "[INLET_USAGE"
+#define  ws_HEAT_SENS        "[HEAT_SENSITIVITY"
 
 #endif //TEXT_H
@@ -13,11 +13,6 @@
 #include <stdlib.h>
 #include "headers.h"
 
-//-----------------------------------------------------------------------------
-//  Constants
-//-----------------------------------------------------------------------------
-enum AdjListType {UNDIRECTED, DIRECTED};    // type of nodal adjacency list
-
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
@@ -28,29 +23,24 @@ static int* Stack;                     // array of nodes "reached" during sortin
 static int  First;                     // position of first node in stack
 static int  Last;                      // position of last node added to stack
 
-static char* Examined;                 // TRUE if node included in spanning tree
-static char* InTree;                   // state of each link in spanning tree:
-                                       // 0 = unexamined,
-                                       // 1 = in spanning tree,
-                                       // 2 = chord of spanning tree
-static int*  LoopLinks;                // list of links which forms a loop
-static int   LoopLinksLast;            // number of links in a loop
-
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
 //-----------------------------------------------------------------------------
 //  toposort_sortLinks (called by routing_open)
+//  toposort_sortLinksByLocality (called by dynwave_init)
+//  toposort_getLevels (called by createWavefronts in flowrout.c)
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
-static void createAdjList(int listType);
+static void createAdjList(void);
 static void adjustAdjList(void);
 static int  topoSort(int sortedLinks[]);
 static void findCycles(void);
-static void findSpanningTree(int startNode);
-static void evalLoop(int startLink);
-static int  traceLoop(int i1, int i2, int k);
+static void findComponents(int comp[], int index[], int low[],
+            int stack[], int path[]);
+static int  findCycle(int startNode, int comp[], int pos[], int path[]);
+static void writeCycle(int path[], int n);
 static void checkDummyLinks(void);
 //=============================================================================
 
@@ -107,7 +97,7 @@ void toposort_sortLinks(int sortedLinks[])
     else
     {
         // --- create a directed adjacency list of links leaving each node
-        createAdjList(DIRECTED);
+        createAdjList();
 
         // --- adjust adjacency list for DIVIDER nodes
         adjustAdjList();
@@ -121,6 +111,13 @@ void toposort_sortLinks(int sortedLinks[])
 
         // --- topo sort the links
         n = topoSort(sortedLinks);
+
+        // --- check that all links are included in SortedLinks
+        if ( n != Nobjects[LINK] )
+        {
+            report_writeErrorMsg(ERR_LOOP, "");
+            findCycles();
+        }
     }   
 
     // --- free allocated memory
@@ -128,34 +125,149 @@ void toposort_sortLinks(int sortedLinks[])
     FREE(StartPos);
     FREE(AdjList);
     FREE(Stack);
+}
+
+//=============================================================================
+
+int toposort_getLevels(int sortedLinks[], int level[])
+//
+//  Input:   sortedLinks = array of link indexes in topo-sorted order
+//  Output:  level = dependency level of each node;
+//           returns number of levels
+//  Purpose: assigns each node to a level of the sorted network.
+//
+//  A node's level is one more than the highest level of the nodes that
+//  send flow to it, so nodes on the same level don't depend on each other
+//  and can be processed in parallel once all earlier levels are done.
+//
+{
+    int  i, k, n1, n2;
+    int  nLevels = 0;
+
+    for (i = 0; i < Nobjects[NODE]; i++) level[i] = 0;
+    for (k = 0; k < Nobjects[LINK]; k++)
+    {
+        n1 = Link[sortedLinks[k]].node1;
+        n2 = Link[sortedLinks[k]].node2;
+        level[n2] = MAX(level[n2], level[n1] + 1);
+        nLevels = MAX(nLevels, level[n2] + 1);
+    }
+    if ( Nobjects[NODE] > 0 ) nLevels = MAX(nLevels, 1);
+    return nLevels;
+}
 
-    // --- check that all links are included in SortedLinks
-    if ( !ErrorCode &&  n != Nobjects[LINK] )
+//=============================================================================
+
+int toposort_sortLinksByLocality(int sortedLinks[])
+//
+//  Input:   none
+//  Output:  sortedLinks = array of link indexes in breadth-first order;
+//           returns FALSE if memory could not be allocated, TRUE otherwise
+//  Purpose: orders links so that links sharing a node are listed close
+//           to one another.
+//
+//  Links are listed in the order they are reached by a breadth-first
+//  search of the undirected network, started from each outfall and then
+//  from any node not yet reached. Loops over links in this order keep
+//  revisiting the same few nodes, which stay in cache.
+//
+{
+    int  i, j, k, m, n, seed;
+    int  nNodes = Nobjects[NODE];
+    int  nLinks = Nobjects[LINK];
+    int  first, last;
+    int* start;                        // start of node's links in adjList
+    int* adjList;                      // links incident on each node
+    int* queue;                        // nodes in breadth-first order
+    char* reached;                     // TRUE if node reached by search
+    char* listed;                      // TRUE if link added to sortedLinks
+
+    // --- default to original link order
+    for (j = 0; j < nLinks; j++) sortedLinks[j] = j;
+    if ( nLinks == 0 ) return TRUE;
+
+    // --- allocate work arrays
+    start = (int *) calloc(nNodes+1, sizeof(int));
+    adjList = (int *) calloc(2*(size_t)nLinks, sizeof(int));
+    queue = (int *) calloc(nNodes, sizeof(int));
+    reached = (char *) calloc(nNodes, sizeof(char));
+    listed = (char *) calloc(nLinks, sizeof(char));
+    if ( start && adjList && queue && reached && listed )
     {
-        report_writeErrorMsg(ERR_LOOP, "");
-        findCycles();
+        // --- build an undirected adjacency list
+        //     (Node[].degree is left untouched since routing uses it)
+        for (j = 0; j < nLinks; j++)
+        {
+            start[Link[j].node1+1]++;
+            start[Link[j].node2+1]++;
+        }
+        for (i = 0; i < nNodes; i++) start[i+1] += start[i];
+        for (j = 0; j < nLinks; j++)
+        {
+            adjList[start[Link[j].node1]++] = j;
+            adjList[start[Link[j].node2]++] = j;
+        }
+        for (i = nNodes; i > 0; i--) start[i] = start[i-1];
+        start[0] = 0;
+
+        // --- search from outfalls first, then from any unreached node
+        m = 0;
+        first = 0;
+        last = -1;
+        for (seed = 0; seed < 2*nNodes; seed++)
+        {
+            i = seed % nNodes;
+            if ( reached[i] ) continue;
+            if ( seed < nNodes && Node[i].type != OUTFALL ) continue;
+            reached[i] = TRUE;
+            queue[++last] = i;
+            while ( first <= last )
+            {
+                i = queue[first++];
+                for (k = start[i]; k < start[i+1]; k++)
+                {
+                    j = adjList[k];
+                    if ( listed[j] ) continue;
+                    listed[j] = TRUE;
+                    sortedLinks[m++] = j;
+                    n = Link[j].node1;
+                    if ( n == i ) n = Link[j].node2;
+                    if ( !reached[n] )
+                    {
+                        reached[n] = TRUE;
+                        queue[++last] = n;
+                    }
+                }
+            }
+        }
     }
+    else m = -1;
+
+    // --- free work arrays
+    FREE(start);
+    FREE(adjList);
+    FREE(queue);
+    FREE(reached);
+    FREE(listed);
+    return ( m >= 0 );
 }
 
 //=============================================================================
 
-void createAdjList(int listType)
+void createAdjList()
 //
-//  Input:   lsitType = DIRECTED or UNDIRECTED
+//  Input:   none
 //  Output:  none
-//  Purpose: creates listing of links incident on each node.
+//  Purpose: creates listing of links leaving each node.
 //
 {
     int i, j, k;
 
-    // --- determine degree of each node
-    //     (for DIRECTED list only count link at its upstream node;
-    //      for UNDIRECTED list count link at both end nodes)
+    // --- determine number of links leaving each node
     for (i = 0; i < Nobjects[NODE]; i++) Node[i].degree = 0;
     for (j = 0; j < Nobjects[LINK]; j++)
     {
         Node[ Link[j].node1 ].degree++;
-        if ( listType == UNDIRECTED ) Node[ Link[j].node2 ].degree++;
     }
 
     // --- determine start position of each node in the adjacency list
@@ -178,13 +290,6 @@ void createAdjList(int listType)
         k = StartPos[i] + Node[i].degree;
         AdjList[k] = j;
         Node[i].degree++;
-        if ( listType == UNDIRECTED )
-        {
-            i = Link[j].node2;
-            k = StartPos[i] + Node[i].degree;
-            AdjList[k] = j;
-            Node[i].degree++;
-        }
     }
 }
 
@@ -285,196 +390,206 @@ void  findCycles()
 //
 //  Input:   none
 //  Output:  none
-//  Purpose: finds all cycles in the drainage network (i.e., closed loops that
-//           start and end at the same node).
+//  Purpose: writes a closed cycle of links found in each group of nodes
+//           that prevents the network from being topologically sorted.
+//
+//  The network's strongly connected components (groups of nodes that can
+//  each reach one another along the direction of their links) are found
+//  first. A cycle is then traced through each component that contains a
+//  link, which takes time proportional to the number of nodes and links.
 //
 {
-    int i;
+    int   i;
+    int   n;
+    int   nNodes = Nobjects[NODE];
+    int*  comp;                        // component each node belongs to
+    int*  index;                       // work arrays
+    int*  low;
+    int*  path;
+    char* hasCycle;                    // TRUE if component has a cycle
 
     // --- allocate arrays
-    AdjList  = (int *) calloc(2*(size_t)Nobjects[LINK], sizeof(int));
-    StartPos = (int *) calloc(Nobjects[NODE], sizeof(int));
-    Stack    = (int *) calloc(Nobjects[NODE], sizeof(int));
-    Examined = (char *) calloc(Nobjects[NODE], sizeof(char));
-    InTree   = (char *) calloc(Nobjects[LINK], sizeof(char));
-    LoopLinks = (int *) calloc(Nobjects[LINK], sizeof(int));
-    if ( StartPos && AdjList && Stack && Examined && InTree && LoopLinks )
+    comp  = (int *) calloc(nNodes, sizeof(int));
+    index = (int *) calloc(nNodes, sizeof(int));
+    low   = (int *) calloc(nNodes, sizeof(int));
+    path  = (int *) calloc(nNodes + 1, sizeof(int));
+    hasCycle = (char *) calloc(nNodes, sizeof(char));
+    if ( comp && index && low && path && hasCycle )
     {
-        // --- create an undirected adjacency list for the nodes
-        createAdjList(UNDIRECTED);
+        // --- find each node's strongly connected component
+        findComponents(comp, index, low, Stack, path);
 
-        // --- set to empty the list of nodes examined and the list
-        //     of links in the spanning tree
-        for ( i=0; i<Nobjects[NODE]; i++) Examined[i] = 0;
-        for ( i=0; i<Nobjects[LINK]; i++) InTree[i] = 0;
+        // --- a component has a cycle if one of its links joins two of
+        //     its nodes (including a link that starts & ends at one node)
+        for (i = 0; i < Nobjects[LINK]; i++)
+        {
+            if ( comp[Link[i].node1] == comp[Link[i].node2] )
+                hasCycle[comp[Link[i].node1]] = TRUE;
+        }
 
-        // --- find a spanning tree for each unexamined node
-        //     (cycles are identified as tree is constructed)
-        for ( i=0; i<Nobjects[NODE]; i++)
+        // --- write a cycle for each such component, starting from
+        //     its lowest numbered node
+        for (i = 0; i < nNodes; i++) index[i] = -1;
+        for (i = 0; i < nNodes; i++)
         {
-            if ( Examined[i] ) continue;
-            Last = -1;
-            findSpanningTree(i);
+            if ( !hasCycle[comp[i]] ) continue;
+            hasCycle[comp[i]] = FALSE;
+            n = findCycle(i, comp, index, path);
+            writeCycle(path, n);
         }
     }
-    FREE(StartPos);
-    FREE(AdjList);
-    FREE(Stack);
-    FREE(Examined);
-    FREE(InTree);
-    FREE(LoopLinks);
+    FREE(comp);
+    FREE(index);
+    FREE(low);
+    FREE(path);
+    FREE(hasCycle);
 }
 
 //=============================================================================
 
-void  findSpanningTree(int startNode)
+void  findComponents(int comp[], int index[], int low[], int stack[],
+                     int path[])
 //
-//  Input:   i = index of starting node of tree
-//  Output:  none
-//  Purpose: finds continuation of network's spanning tree of links.
+//  Input:   stack, path = work arrays sized to the number of nodes
+//  Output:  comp = index of the component each node belongs to
+//           index, low = visit order & lowest reachable visit order
+//  Purpose: finds the strongly connected components of the directed
+//           network using an iterative form of Tarjan's algorithm.
+//
+//  The nodes on the current search path are kept in path[] (instead of
+//  on the call stack of a recursive search) and each node's next outlink
+//  to examine is kept in comp[] until its component is known.
 //
 {
-    int nextNode, j, k, m;
-
-    // --- examine each link connected to node i
-    for ( m = StartPos[startNode];
-          m < StartPos[startNode]+Node[startNode].degree; m++ )
+    int i, j, m, n, u, v, w;
+    int count = 0;                     // number of nodes visited
+    int top = -1;                      // top of stack of unassigned nodes
+    int depth;                         // number of nodes in path
+    int nNodes = Nobjects[NODE];
+
+    for (i = 0; i < nNodes; i++) index[i] = -1;
+    for (i = 0; i < nNodes; i++)
     {
-        // --- find which node (j) connects link k from start node
-        k = AdjList[m];
-        if ( Link[k].node1 == startNode ) j = Link[k].node2;
-        else j = Link[k].node1;
-
-        // --- if link k is not in the tree
-        if ( InTree[k] == 0 )
+        if ( index[i] >= 0 ) continue;
+
+        // --- start a search path at node i
+        index[i] = low[i] = count++;
+        stack[++top] = i;
+        comp[i] = StartPos[i];
+        path[0] = i;
+        depth = 1;
+        while ( depth > 0 )
         {
-            // --- if connecting node already examined,
-            //     then link k forms a loop; mark it as a chord
-            //     and check if loop forms a cycle
-            if ( Examined[j] )
+            v = path[depth-1];
+
+            // --- extend the path along the node's next outlink
+            m = comp[v];
+            if ( m < StartPos[v] + Node[v].degree )
             {
-                InTree[k] = 2;
-                evalLoop(k);
+                comp[v] = m + 1;
+                j = AdjList[m];
+                w = Link[j].node2;
+                if ( index[w] < 0 )
+                {
+                    index[w] = low[w] = count++;
+                    stack[++top] = w;
+                    comp[w] = StartPos[w];
+                    path[depth++] = w;
+                }
+
+                // --- node w is unassigned if its low value has not yet
+                //     been set to the number of nodes
+                else if ( low[w] < nNodes ) low[v] = MIN(low[v], index[w]);
+                continue;
             }
 
-            // --- otherwise mark connected node as being examined,
-            //     add it to the node stack, and mark the connecting
-            //     link as being in the spanning tree
-            else
+            // --- all outlinks examined; back up along the path
+            depth--;
+            if ( depth > 0 )
             {
-                Examined[j] = 1;
-                Last++;
-                Stack[Last] = j;
-                InTree[k] = 1;
+                u = path[depth-1];
+                low[u] = MIN(low[u], low[v]);
             }
-        }
-    }
 
-    // --- continue to grow the spanning tree from
-    //     the last node added to the stack
-    if ( Last >= 0 )
-    {
-        nextNode = Stack[Last];
-        Last--;
-        findSpanningTree(nextNode);
+            // --- if v is the root of a component then assign it and
+            //     the nodes above it on the stack to the component
+            if ( low[v] == index[v] )
+            {
+                do
+                {
+                    n = stack[top--];
+                    comp[n] = v;
+                    low[n] = nNodes;
+                } while ( n != v );
+            }
+        }
     }
 }
 
 //=============================================================================
 
-void evalLoop(int startLink)
+int  findCycle(int startNode, int comp[], int pos[], int path[])
 //
-//  Input:   startLink = index of starting link of a loop
-//  Output:  none
-//  Purpose: checks if loop starting with a given link forms a closed cycle.
+//  Input:   startNode = node in a component that contains a cycle
+//           comp = component each node belongs to
+//           pos = position of each node on a path (-1 if not visited)
+//  Output:  path = links that form a cycle;
+//           returns number of links in the cycle (0 if none found)
+//  Purpose: traces a cycle of links through a strongly connected component.
+//
+//  Every node of such a component has an outlink to another of its nodes,
+//  so following them must eventually return to a node already visited.
 //
 {
-    int i;                             // loop list index
-    int i1, i2;                        // start & end node indexes
-    int j;                             // index of link in loop
-    int kount;                         // items per line counter
-    int isCycle;                       // TRUE if loop forms a cycle
-
-    // --- make startLink the first link in the loop
-    LoopLinksLast = 0;
-    LoopLinks[0] = startLink;
-
-    // --- trace a path on the spanning tree that starts at the
-    //     tail node of startLink and ends at its head node
-    i1 = Link[startLink].node1;
-    i2 = Link[startLink].node2;
-    if ( !traceLoop(i1, i2, startLink) ) return;
-
-    // --- check if all links on the path are oriented head-to-tail
-    isCycle = TRUE;
-    j = LoopLinks[0];
-    i2 = Link[j].node2;
-    for (i=1; i<=LoopLinksLast; i++)
-    {
-        j = LoopLinks[i];
-        i1 = Link[j].node1;
-        if ( i1 == i2 ) i2 = Link[j].node2;
-        else
-        {
-            isCycle = FALSE;
-            break;
-        }
-    }
+    int j, m, n = 0;
+    int i = startNode;
+    int c = comp[startNode];
 
-    // --- print cycle to report file
-    if ( isCycle )
+    while ( pos[i] < 0 )
     {
-        kount = 0;
-        for (i = 0; i <= LoopLinksLast; i++)
+        pos[i] = n;
+        j = -1;
+        for (m = StartPos[i]; m < StartPos[i] + Node[i].degree; m++)
         {
-            if ( kount % 5 == 0 ) fprintf(Frpt.file, "\n");
-            kount++;
-            fprintf(Frpt.file, "  %s", Link[LoopLinks[i]].ID);
-            if ( i < LoopLinksLast ) fprintf(Frpt.file, "  -->");
+            if ( comp[Link[AdjList[m]].node2] == c )
+            {
+                j = AdjList[m];
+                break;
+            }
         }
+
+        // --- stop if no outlink stays within the component
+        //     (can only occur if the components were mis-assigned)
+        if ( j < 0 ) return 0;
+        path[n++] = j;
+        i = Link[j].node2;
     }
+
+    // --- drop links that lead up to the cycle
+    m = pos[i];
+    for (j = m; j < n; j++) path[j-m] = path[j];
+    return n - m;
 }
 
 //=============================================================================
 
-int traceLoop(int i1, int i2, int k1)
+void writeCycle(int path[], int n)
 //
-//  Input:   i1 = index of current node reached while tracing a loop
-//           i2 = index of final node on the loop
-//           k1 = index of link which extends loop to node i1
-//  Output:  returns TRUE if loop can be extended through node i1
-//  Purpose: tries to extend closed loop through current node.
+//  Input:   path = links that form a cycle
+//           n = number of links in the cycle
+//  Output:  none
+//  Purpose: writes a cycle of links to the report file.
 //
 {
-    int j, k, m;
-
-    // --- if current node equals final node then return with loop found
-    if ( i1 == i2 ) return TRUE;
+    int i;
 
-    // --- examine each link connected to current node
-    for (m = StartPos[i1]; m < StartPos[i1] + Node[i1].degree; m++)
+    if ( Frpt.file == NULL ) return;
+    for (i = 0; i < n; i++)
     {
-        // --- ignore link if it comes from predecessor node or if
-        //     it is not on the spanning tree
-        k = AdjList[m];
-        if ( k == k1 || InTree[k] != 1 ) continue;
-
-        // --- identify other node that link is connected to
-        if ( Link[k].node1 == i1 ) j = Link[k].node2;
-        else                       j = Link[k].node1;
-
-        // --- try to continue tracing the loop from this node;
-        //     if successful, then add link to loop and return
-        if ( traceLoop(j, i2, k) )
-        {
-            LoopLinksLast++;
-            LoopLinks[LoopLinksLast] = k;
-            return TRUE;
-        }
+        if ( i % 5 == 0 ) fprintf(Frpt.file, "\n");
+        fprintf(Frpt.file, "  %s", Link[path[i]].ID);
+        if ( i < n - 1 ) fprintf(Frpt.file, "  -->");
     }
-
-    // --- return false if loop cannot be continued from current node
-    return FALSE;
 }
 
 //=============================================================================
@@ -34,16 +34,29 @@
 //   - Support added for Street cross sections.
 //   Build 5.2.2:
 //   - Feasibility check added to Mod. Baskethandle & Rect.-Round shapes.
+//
+//   Optional geometry lookup tables (XSECT_TABLES option) replace the
+//   shape computations for analytic (non-tabular) shapes with linear
+//   interpolation in uniformly spaced tables. Since the tables are
+//   normalized, all sections of the same shape whose parameters have the
+//   same ratios to their full depth share one set of tables, found through
+//   a hash table keyed on the shape and these ratios.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <math.h>
+#include <stdlib.h>
 #include "headers.h"
 #include "findroot.h"
+#include "hash.h"
 
 #define  RECT_ALFMAX        0.97
 #define  RECT_TRIANG_ALFMAX 0.98
 #define  RECT_ROUND_ALFMAX  0.98
+#define  N_GEOM_TBL         401      // number of entries in a lookup table
+#define  GEOM_TBL_XMIN      0.02     // range of normalized area or depth
+#define  GEOM_TBL_XMAX      0.96     //   where lookup tables are used
+#define  GEOM_KEY_LEN       256      // length of a lookup table's hash key
 
 #include "xsect.dat"    // File containing geometry tables for rounded shapes
 
@@ -90,6 +103,24 @@ typedef struct
     TXsect* xsect;            // pointer to a cross section object
 } TXsectStar;
 
+enum GeomTableTypes {
+    Y_OF_A,                   // depth v. area
+    R_OF_A,                   // hyd. radius v. area
+    S_OF_A,                   // section factor v. area
+    A_OF_S,                   // area v. section factor
+    A_OF_Y,                   // area v. depth
+    W_OF_Y,                   // top width v. depth
+    N_GEOM_TBLS};
+
+typedef struct
+{
+    TXsect  xsect;                         // cross section tabulated
+    double  tbl[N_GEOM_TBLS][N_GEOM_TBL];  // normalized values at normalized
+} TGeomTable;                              // arguments 0, dx, ..., 1
+
+static TGeomTable* GeomTables;     // geometry lookup tables
+static int         NumGeomTables;  // number of lookup tables
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -99,6 +130,8 @@ typedef struct
 //  xsect_setStreetXsectParams
 //  xsect_setCustomXsectParams
 //  xsect_getAmax
+//  xsect_createTables
+//  xsect_deleteTables
 //  xsect_getSofA
 //  xsect_getYofA
 //  xsect_getRofA
@@ -113,6 +146,11 @@ typedef struct
 //  Local functions
 //-----------------------------------------------------------------------------
 static void   getTransectParams(TXsect *xsect, TTransect *transect);
+static int    hasGeomTable(TXsect *xsect);
+static void   getGeomTableKey(TXsect *xsect, char *key);
+static void   setGeomTable(TGeomTable *table);
+static int    getGeomTableValue(TXsect *xsect, int k, double x, double *y,
+                                double *dydx);
 
 static double generic_getAofS(TXsect* xsect, double s);
 static void   evalSofA(double a, double* f, double* df, void* p);
@@ -711,6 +749,92 @@ double xsect_getAmax(TXsect* xsect)
 
 //=============================================================================
 
+int xsect_createTables()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: builds geometry lookup tables for the cross sections of all
+//           links, with one set of tables shared by similar sections.
+//
+{
+    int      i, j, result = TRUE;
+    char     (*keys)[GEOM_KEY_LEN];
+    HTtable* keyTable;
+    TXsect*  xsect;
+
+    xsect_deleteTables();
+    if ( Nobjects[LINK] == 0 ) return TRUE;
+
+    // --- the hash table holds pointers to the keys so they are
+    //     kept in an array that lasts until the tables are built
+    keys = calloc(Nobjects[LINK], GEOM_KEY_LEN);
+    keyTable = HTcreate();
+    if ( keys == NULL || keyTable == NULL )
+    {
+        FREE(keys);
+        if ( keyTable ) HTfree(keyTable);
+        return FALSE;
+    }
+
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        xsect = &Link[j].xsect;
+        xsect->geomTable = -1;
+        if ( !hasGeomTable(xsect) ) continue;
+
+        // --- use an existing table if one was built for a similar section
+        getGeomTableKey(xsect, keys[j]);
+        i = HTfind(keyTable, keys[j]);
+
+        // --- otherwise build a new table
+        if ( i == NOTFOUND )
+        {
+            i = NumGeomTables;
+            if ( NumGeomTables % 64 == 0 )
+            {
+                GeomTables = (TGeomTable *) realloc(GeomTables,
+                    (NumGeomTables + 64) * sizeof(TGeomTable));
+                if ( GeomTables == NULL )
+                {
+                    NumGeomTables = 0;
+                    result = FALSE;
+                    break;
+                }
+            }
+            if ( !HTinsert(keyTable, keys[j], i) )
+            {
+                result = FALSE;
+                break;
+            }
+            GeomTables[i].xsect = *xsect;
+            setGeomTable(&GeomTables[i]);
+            NumGeomTables++;
+        }
+        xsect->geomTable = i;
+    }
+    HTfree(keyTable);
+    FREE(keys);
+    if ( !result ) xsect_deleteTables();
+    return result;
+}
+
+//=============================================================================
+
+void xsect_deleteTables()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees memory used by cross section geometry lookup tables.
+//
+{
+    int j;
+    for (j = 0; j < Nobjects[LINK]; j++) Link[j].xsect.geomTable = -1;
+    FREE(GeomTables);
+    NumGeomTables = 0;
+}
+
+//=============================================================================
+
 double xsect_getSofA(TXsect *xsect, double a)
 //
 //  Input:   xsect = ptr. to a cross section data structure
@@ -721,6 +845,8 @@ double xsect_getSofA(TXsect *xsect, double a)
 {
     double alpha = a / xsect->aFull;
     double r;
+    if ( getGeomTableValue(xsect, S_OF_A, alpha, &r, NULL) )
+        return xsect->sFull * r;
     switch ( xsect->type )
     {
       case FORCE_MAIN:
@@ -779,6 +905,9 @@ double xsect_getYofA(TXsect *xsect, double a)
 //
 {
     double alpha = a / xsect->aFull;
+    double y;
+    if ( getGeomTableValue(xsect, Y_OF_A, alpha, &y, NULL) )
+        return xsect->yFull * y;
     switch ( xsect->type )
     {
       case FORCE_MAIN:
@@ -863,7 +992,10 @@ double xsect_getAofY(TXsect *xsect, double y)
 //
 {
     double yNorm = y / xsect->yFull;
+    double a;
     if ( y <= 0.0 ) return 0.0;
+    if ( getGeomTableValue(xsect, A_OF_Y, yNorm, &a, NULL) )
+        return xsect->aFull * a;
     switch ( xsect->type )
     {
       case FORCE_MAIN:
@@ -949,6 +1081,9 @@ double xsect_getWofY(TXsect *xsect, double y)
 //
 {
     double yNorm = y / xsect->yFull;
+    double w;
+    if ( getGeomTableValue(xsect, W_OF_Y, yNorm, &w, NULL) )
+        return xsect->wMax * w;
     switch ( xsect->type )
     {
       case FORCE_MAIN:
@@ -1097,6 +1232,45 @@ double xsect_getRofY(TXsect *xsect, double y)
 
 //=============================================================================
 
+double xsect_getCircAofY(TXsect *xsect, double y)
+//
+//  Input:   xsect = ptr. to a circular cross section data structure
+//           y = depth (ft)
+//  Output:  returns area (ft2)
+//  Purpose: computes a circular xsection's area at a given depth.
+//
+{
+    return xsect->aFull * lookup(y / xsect->yFull, A_Circ, N_A_Circ);
+}
+
+//=============================================================================
+
+double xsect_getCircWofY(TXsect *xsect, double y)
+//
+//  Input:   xsect = ptr. to a circular cross section data structure
+//           y = depth (ft)
+//  Output:  returns top width (ft)
+//  Purpose: computes a circular xsection's top width at a given depth.
+//
+{
+    return xsect->wMax * lookup(y / xsect->yFull, W_Circ, N_W_Circ);
+}
+
+//=============================================================================
+
+double xsect_getCircRofY(TXsect *xsect, double y)
+//
+//  Input:   xsect = ptr. to a circular cross section data structure
+//           y = depth (ft)
+//  Output:  returns hydraulic radius (ft)
+//  Purpose: computes a circular xsection's hydraulic radius at a given depth.
+//
+{
+    return xsect->rFull * lookup(y / xsect->yFull, R_Circ, N_R_Circ);
+}
+
+//=============================================================================
+
 double xsect_getRofA(TXsect *xsect, double a)
 //
 //  Input:   xsect = ptr. to a cross section data structure
@@ -1107,6 +1281,8 @@ double xsect_getRofA(TXsect *xsect, double a)
 {
     double cathy;
     if ( a <= 0.0 ) return 0.0;
+    if ( getGeomTableValue(xsect, R_OF_A, a / xsect->aFull, &cathy, NULL) )
+        return xsect->rFull * cathy;
     switch ( xsect->type )
     {
       case HORIZ_ELLIPSE:
@@ -1155,7 +1331,10 @@ double xsect_getAofS(TXsect* xsect, double s)
 //
 {
     double psi = s / xsect->sFull;
+    double a;
     if ( s <= 0.0 ) return 0.0;
+    if ( getGeomTableValue(xsect, A_OF_S, psi, &a, NULL) )
+        return xsect->aFull * a;
     if ( s > xsect->sMax ) s = xsect->sMax;
     switch ( xsect->type )
     {
@@ -1200,6 +1379,9 @@ double xsect_getdSdA(TXsect* xsect, double a)
 //           respect to area at a given area.
 //
 {
+    double s, dSdA;
+    if ( getGeomTableValue(xsect, S_OF_A, a / xsect->aFull, &s, &dSdA) )
+        return dSdA * xsect->sFull / xsect->aFull;
     switch ( xsect->type )
     {
       case FORCE_MAIN:
@@ -1356,6 +1538,150 @@ void getTransectParams(TXsect *xsect, TTransect *transect)
 
 //=============================================================================
 
+int hasGeomTable(TXsect *xsect)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//  Output:  returns TRUE if lookup tables can be used for the cross section
+//  Purpose: determines if a cross section's geometry is computed
+//           analytically (rather than from a geometry table) so that
+//           lookup tables can replace these computations.
+//
+{
+    switch ( xsect->type )
+    {
+      case CIRCULAR:
+      case FORCE_MAIN:
+      case FILLED_CIRCULAR:
+      case RECT_TRIANG:
+      case RECT_ROUND:
+      case MOD_BASKET:
+      case TRAPEZOIDAL:
+      case TRIANGULAR:
+      case PARABOLIC:
+      case POWERFUNC:
+        break;
+      default: return FALSE;
+    }
+    return xsect->yFull > 0.0 && xsect->wMax > 0.0 && xsect->aFull > 0.0 &&
+           xsect->rFull > 0.0 && xsect->sFull > 0.0;
+}
+
+//=============================================================================
+
+void getGeomTableKey(TXsect *xsect, char *key)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//  Output:  key = hash key of the section's lookup tables
+//  Purpose: forms a key from a cross section's shape and its parameters
+//           scaled by its full depth, which is the same for all sections
+//           that can share the same normalized lookup tables.
+//
+{
+    double y = xsect->yFull;
+    double yBot = xsect->yBot / y;
+    double aBot = xsect->aBot / y / y;
+    double sBot = xsect->sBot;
+    double rBot = xsect->rBot;
+
+    // --- scale the shape parameters that have units of length
+    //     (the others are slopes, angles or exponents)
+    switch ( xsect->type )
+    {
+      case FILLED_CIRCULAR:
+        sBot /= y;
+        rBot /= y;
+        break;
+      case RECT_ROUND:
+        sBot /= pow(y, 8./3.);
+        rBot /= y;
+        break;
+      case MOD_BASKET:
+        rBot /= y;
+        break;
+      case PARABOLIC:
+        rBot /= sqrt(y);
+        break;
+      case POWERFUNC:
+        rBot /= pow(y, 1.0 - sBot);
+        break;
+    }
+
+    // --- section factor is scaled by yFull^(8/3) so that shapes whose
+    //     normalized tables change with size (e.g. force mains) get
+    //     a different key for each size
+    snprintf(key, GEOM_KEY_LEN,
+        "%d %.10g %.10g %.10g %.10g %.10g %.10g %.10g %.10g %.10g %.10g",
+        xsect->type, xsect->wMax / y, xsect->ywMax / y,
+        xsect->aFull / y / y, xsect->rFull / y,
+        xsect->sFull / pow(y, 8./3.), xsect->sMax / xsect->sFull,
+        yBot, aBot, sBot, rBot);
+}
+
+//=============================================================================
+
+void setGeomTable(TGeomTable *table)
+//
+//  Input:   table = ptr. to a set of geometry lookup tables
+//  Output:  none
+//  Purpose: fills in the normalized lookup tables for a cross section.
+//
+{
+    int     i;
+    double  x;
+    TXsect  xsect = table->xsect;      // copy of section without tables
+    TXsect* xs = &xsect;
+
+    xsect.geomTable = -1;
+    for (i = 0; i < N_GEOM_TBL; i++)
+    {
+        // --- normalized area or depth
+        x = (double)i / (double)(N_GEOM_TBL - 1);
+        table->tbl[Y_OF_A][i] = xsect_getYofA(xs, x * xs->aFull) / xs->yFull;
+        table->tbl[R_OF_A][i] = xsect_getRofA(xs, x * xs->aFull) / xs->rFull;
+        table->tbl[S_OF_A][i] = xsect_getSofA(xs, x * xs->aFull) / xs->sFull;
+        table->tbl[A_OF_Y][i] = xsect_getAofY(xs, x * xs->yFull) / xs->aFull;
+        table->tbl[W_OF_Y][i] = xsect_getWofY(xs, x * xs->yFull) / xs->wMax;
+
+        // --- normalized section factor
+        table->tbl[A_OF_S][i] = xsect_getAofS(xs, x * xs->sFull) / xs->aFull;
+    }
+}
+
+//=============================================================================
+
+int getGeomTableValue(TXsect *xsect, int k, double x, double *y,
+                      double *dydx)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           k = type of lookup table
+//           x = normalized table argument
+//  Output:  y = normalized value from table;
+//           dydx = slope of table at x (if not NULL);
+//           returns TRUE if a value was found, FALSE if not
+//  Purpose: interpolates a value from one of a cross section's
+//           geometry lookup tables.
+//
+//  Note: the ends of a table are left to the exact shape functions
+//        since most shapes have an infinite slope at zero depth and
+//        closed shapes switch to special formulas near full depth.
+//
+{
+    int     i;
+    double  u;
+    double* tbl;
+
+    if ( xsect->geomTable < 0 ) return FALSE;
+    if ( x < GEOM_TBL_XMIN || x >= GEOM_TBL_XMAX ) return FALSE;
+    u = x * (N_GEOM_TBL - 1);
+    i = (int)u;
+    tbl = GeomTables[xsect->geomTable].tbl[k];
+    *y = tbl[i] + (u - i) * (tbl[i+1] - tbl[i]);
+    if ( dydx ) *dydx = (tbl[i+1] - tbl[i]) * (N_GEOM_TBL - 1);
+    return TRUE;
+}
+
+//=============================================================================
+
 double generic_getAofS(TXsect* xsect, double s)
 //
 //  Input:   xsect = ptr. to a cross section data structure
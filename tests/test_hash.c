@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+//   test_hash.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks the ID hash table of hash.c as it grows from its initial size
+//   to hold many thousands of keys: every key inserted must still be found
+//   with its own data after each doubling of the table, look-ups must
+//   ignore case, keys never inserted must not be found and re-inserting a
+//   key must replace its data rather than add a second entry.
+//
+//   Command line is: test_hash
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "hash.h"
+
+#define NKEYS   20000                  // number of keys inserted
+#define KEYLEN  16                     // max. length of a key
+
+static char Keys[NKEYS][KEYLEN];       // keys stored in the table
+
+static int    checkKeys(HTtable* ht, int n);
+
+//=============================================================================
+
+int  main(void)
+{
+    int      i, nFailed = 0;
+    unsigned int size;
+    char     key[KEYLEN];
+    HTtable* ht = HTcreate();
+
+    if ( ht == NULL ) return 1;
+
+    // --- insert keys, checking all of them each time the table grows
+    size = ht->size;
+    for (i = 0; i < NKEYS; i++)
+    {
+        sprintf(Keys[i], "%s%d", i % 2 ? "J" : "Node_", i);
+        if ( !HTinsert(ht, Keys[i], i) )
+        {
+            printf("Could not insert key %s\n", Keys[i]);
+            HTfree(ht);
+            return 1;
+        }
+        if ( ht->size != size )
+        {
+            nFailed += checkKeys(ht, i + 1);
+            size = ht->size;
+        }
+    }
+    nFailed += checkKeys(ht, NKEYS);
+    if ( ht->count != NKEYS || 2 * ht->count > ht->size )
+    {
+        printf("Table holds %u keys in %u slots\n", ht->count, ht->size);
+        nFailed++;
+    }
+
+    // --- look-ups ignore case
+    if ( HTfind(ht, "node_10") != 10 || HTfind(ht, "j11") != 11 )
+    {
+        printf("Look-up is not case insensitive\n");
+        nFailed++;
+    }
+
+    // --- keys that were never inserted are not found
+    for (i = 0; i < NKEYS; i++)
+    {
+        sprintf(key, "%s%d", i % 2 ? "Node_" : "J", i);
+        if ( HTfind(ht, key) != NOTFOUND || HTfindKey(ht, key) != NULL )
+        {
+            printf("Key %s was found but never inserted\n", key);
+            nFailed++;
+            break;
+        }
+    }
+
+    // --- re-inserting a key replaces its data
+    HTinsert(ht, Keys[5], -5);
+    if ( HTfind(ht, Keys[5]) != -5 || ht->count != NKEYS )
+    {
+        printf("Re-inserting key %s added a new entry\n", Keys[5]);
+        nFailed++;
+    }
+    HTfree(ht);
+    if ( nFailed ) return 1;
+    printf("Hash table finds all keys as it grows.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int checkKeys(HTtable* ht, int n)
+//
+//  Input:   ht = hash table
+//           n = number of keys inserted so far
+//  Output:  returns 1 if some key is not found with its data, 0 if not
+//  Purpose: looks up every key inserted into the table so far.
+//
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        if ( HTfind(ht, Keys[i]) != i || HTfindKey(ht, Keys[i]) != Keys[i] )
+        {
+            printf("Key %s not found after %d insertions (%u slots)\n",
+                   Keys[i], n, ht->size);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+//-----------------------------------------------------------------------------
+//   test_heatsens.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks the mean heat exchanger sensitivities (dT/dE) that SWMM-HEAT
+//   writes to its status report against central finite differences of the
+//   mean node temperatures saved by runs whose conduit thermal energies
+//   are perturbed.
+//
+//   The routing and reporting time steps are equal, so the mean of the
+//   temperatures saved for each reporting period is the mean over the
+//   routing steps that the reported sensitivities are averaged over. One
+//   report node lies upstream of the second candidate conduit, so its
+//   sensitivity to that conduit must be zero.
+//
+//   Command line is: test_heatsens
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "swmm5.h"
+
+#define NSENS  2                       // number of candidate conduits
+#define NRPT   3                       // number of report nodes
+#define DE     0.5                     // thermal energy perturbation (kW)
+#define TOL    1.0e-3                  // relative tolerance on dT/dE
+
+static const char* InpFile = "test_heatsens.inp";
+static const char* RptFile = "test_heatsens.rpt";
+static const char* OutFile = "test_heatsens.out";
+
+// --- thermal energy (kW) of each candidate conduit in the base run
+static const double Energy[NSENS] = {5.0, -3.0};
+
+// --- candidate conduits, report nodes & the nodes' output file indexes
+static const char* SensLink[NSENS] = {"C1", "C3"};
+static const char* RptNode[NRPT] = {"J2", "J4", "O1"};
+static const int   NodeIndex[NRPT] = {1, 3, 4};
+
+static int    runModel(const double* energy);
+static int    readSens(double sens[NRPT][NSENS]);
+static int    readMeanTemps(double meanTemp[NRPT]);
+static void   writeInpFile(const double* energy);
+
+//=============================================================================
+
+int  main(void)
+{
+    int    i, k, p, nFailed = 0;
+    double energy[NSENS];
+    double sens[NRPT][NSENS];
+    double tPlus[NRPT], tMinus[NRPT], fd;
+
+    // --- base run gives the reported sensitivities
+    if ( !runModel(Energy) || !readSens(sens) ) return 1;
+
+    // --- perturb each conduit's thermal energy up and down
+    for (p = 0; p < NSENS; p++)
+    {
+        for (k = 0; k < NSENS; k++) energy[k] = Energy[k];
+        energy[p] = Energy[p] + DE;
+        if ( !runModel(energy) || !readMeanTemps(tPlus) ) return 1;
+        energy[p] = Energy[p] - DE;
+        if ( !runModel(energy) || !readMeanTemps(tMinus) ) return 1;
+        for (i = 0; i < NRPT; i++)
+        {
+            fd = (tPlus[i] - tMinus[i]) / (2.0 * DE);
+            if ( fabs(fd - sens[i][p]) > TOL * fabs(fd) + 1.0e-7 )
+            {
+                printf("Node %s, conduit %s: dT/dE = %.4e, finite "
+                       "difference = %.4e\n", RptNode[i], SensLink[p],
+                       sens[i][p], fd);
+                nFailed++;
+            }
+        }
+    }
+    if ( sens[0][1] != 0.0 )
+    {
+        printf("Node J2 is upstream of conduit C3 but dT/dE = %.4e\n",
+               sens[0][1]);
+        nFailed++;
+    }
+    if ( nFailed ) return 1;
+    printf("Heat exchanger sensitivities match finite differences.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int runModel(const double* energy)
+//
+//  Input:   energy = thermal energy (kW) of each candidate conduit
+//  Output:  returns TRUE if the run was successful, FALSE if not
+//
+{
+    int    err;
+    double elapsedTime = 0.0;
+
+    writeInpFile(energy);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(1);
+        if ( !err ) while ( swmm_step(&elapsedTime) == 0 &&
+                            elapsedTime > 0.0 );
+        if ( !err ) err = swmm_end();
+        if ( !err ) err = swmm_report();
+    }
+    swmm_close();
+    if ( err )
+    {
+        printf("SWMM error %d - see %s\n", err, RptFile);
+        return 0;
+    }
+    return 1;
+}
+
+//=============================================================================
+
+int readSens(double sens[NRPT][NSENS])
+//
+//  Output:  sens = mean dT/dE of each report node for each candidate
+//           returns TRUE if all values were found, FALSE if not
+//  Purpose: reads the Heat Exchanger Sensitivity Summary of the report.
+//
+{
+    char   line[256], node[32], link[32];
+    double mean, maxAbs;
+    int    i, k, n = 0, found = 0;
+    FILE*  f = fopen(RptFile, "rt");
+
+    if ( f == NULL ) return 0;
+    while ( fgets(line, sizeof(line), f) != NULL )
+    {
+        if ( strstr(line, "Heat Exchanger Sensitivity Summary") ) found = 1;
+        if ( !found ) continue;
+        if ( sscanf(line, "%31s %31s %lf %lf", node, link, &mean,
+                    &maxAbs) != 4 ) continue;
+        for (i = 0; i < NRPT; i++)
+        {
+            if ( strcmp(node, RptNode[i]) != 0 ) continue;
+            for (k = 0; k < NSENS; k++)
+            {
+                if ( strcmp(link, SensLink[k]) != 0 ) continue;
+                sens[i][k] = mean;
+                n++;
+            }
+        }
+    }
+    fclose(f);
+    if ( n < NRPT * NSENS )
+    {
+        printf("Sensitivity summary not found in %s\n", RptFile);
+        return 0;
+    }
+    return 1;
+}
+
+//=============================================================================
+
+int readMeanTemps(double meanTemp[NRPT])
+//
+//  Output:  meanTemp = mean temperature of each report node over all
+//           reporting periods
+//           returns TRUE if successful, FALSE if not
+//  Purpose: reads the node temperatures saved in the binary output file.
+//
+//  Temperature is the last node variable saved for each period.
+//
+{
+    int    i, n, nSubcatch, nNodes, nLinks, nPeriods;
+    int    header[8], closing[6], counts[4];
+    long   bytesPerPeriod, offset;
+    float  t;
+    FILE*  f = fopen(OutFile, "rb");
+
+    if ( f == NULL ) return 0;
+    if ( fread(header, sizeof(int), 8, f) < 8 ) return 0;
+    nSubcatch = header[3];
+    nNodes = header[4];
+    nLinks = header[5];
+    fseek(f, -6 * (long)sizeof(int), SEEK_END);
+    if ( fread(closing, sizeof(int), 6, f) < 6 ) return 0;
+    nPeriods = closing[3];
+
+    // --- skip the saved input data of each object type to reach the
+    //     number of result variables of each type
+    fseek(f, closing[1], SEEK_SET);
+    for (i = 0; i < 3; i++)
+    {
+        if ( fread(&n, sizeof(int), 1, f) < 1 ) return 0;
+        offset = n * (1 + (i == 0 ? nSubcatch : i == 1 ? nNodes : nLinks));
+        fseek(f, offset * (long)sizeof(int), SEEK_CUR);
+    }
+    for (i = 0; i < 4; i++)
+    {
+        if ( fread(&counts[i], sizeof(int), 1, f) < 1 ) return 0;
+        fseek(f, counts[i] * (long)sizeof(int), SEEK_CUR);
+    }
+    bytesPerPeriod = sizeof(double) + sizeof(float) *
+        ((long)nSubcatch * counts[0] + (long)nNodes * counts[1] +
+         (long)nLinks * counts[2] + counts[3]);
+
+    // --- average each report node's temperature over all periods
+    for (i = 0; i < NRPT; i++)
+    {
+        meanTemp[i] = 0.0;
+        for (n = 0; n < nPeriods; n++)
+        {
+            offset = closing[2] + n * bytesPerPeriod + sizeof(double) +
+                sizeof(float) * ((long)nSubcatch * counts[0] +
+                (long)NodeIndex[i] * counts[1] + counts[1] - 1);
+            fseek(f, offset, SEEK_SET);
+            if ( fread(&t, sizeof(float), 1, f) < 1 ) return 0;
+            meanTemp[i] += t;
+        }
+        meanTemp[i] /= nPeriods;
+    }
+    fclose(f);
+    return 1;
+}
+
+//=============================================================================
+
+void writeInpFile(const double* energy)
+//
+//  Input:   energy = thermal energy (kW) of each candidate conduit
+//  Purpose: writes the model used for the test.
+//
+{
+    int    j;
+    double e[4] = {0.0, 0.0, 0.0, 0.0};
+    const char* node1[4] = {"J1", "J2", "J3", "J4"};
+    const char* node2[4] = {"J2", "J3", "J4", "O1"};
+    FILE*  f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    e[0] = energy[0];
+    e[2] = energy[1];
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS LPS\nFLOW_ROUTING DYNWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/02/2020\nEND_TIME 00:00:00\n"
+               "REPORT_STEP 00:01:00\nROUTING_STEP 60\n"
+               "TEMP_MODEL 1\nDENSITY 1000\nSPEC_HEAT_CAPACITY 4180\n"
+               "HUMIDITY 0.8\nEXT_UNIT P\nGLOBTPAT 0\n\n");
+    fprintf(f, "[WTEMPERATURE]\nWTEMPERATURE CELSIUS 10 12 12 0 18 15\n\n");
+    fprintf(f, "[JUNCTIONS]\nJ1 100 3 0 0 0\nJ2 99 3 0 0 0\n"
+               "J3 98 3 0 0 0\nJ4 97 3 0 0 0\n\n");
+    fprintf(f, "[OUTFALLS]\nO1 96 FREE NO\n\n");
+    fprintf(f, "[CONDUITS]\n");
+    for (j = 0; j < 4; j++)
+    {
+        fprintf(f, "C%d %s %s 200 0.013 0 0 0 0 0.05 1.5 1.2 900 1800 "
+                   "AirP SoilP %.2f\n", j + 1, node1[j], node2[j], e[j]);
+    }
+    fprintf(f, "\n[XSECTIONS]\nC1 CIRCULAR 0.6 0 0 0 1\n"
+               "C2 CIRCULAR 0.6 0 0 0 1\nC3 CIRCULAR 0.8 0 0 0 1\n"
+               "C4 CIRCULAR 0.8 0 0 0 1\n\n");
+    fprintf(f, "[DWF]\nJ1 FLOW 20 Hpat\nJ1 WTEMPERATURE 18\n"
+               "J3 FLOW 10 Hpat\nJ3 WTEMPERATURE 16\n\n");
+    fprintf(f, "[PATTERNS]\n"
+               "AirP MONTHLY 12 12 12 12 12 12 12 12 12 12 12 12\n"
+               "SoilP MONTHLY 10 10 10 10 10 10 10 10 10 10 10 10\n"
+               "Hpat HOURLY 0.5 0.5 0.5 0.6 0.8 1.0 1.3 1.5 1.4 1.3 1.2 1.1\n"
+               "Hpat 1.0 1.0 1.0 1.1 1.2 1.3 1.3 1.2 1.0 0.8 0.6 0.5\n\n");
+    fprintf(f, "[REPORT]\nNODES ALL\n\n");
+    fprintf(f, "[HEAT_SENSITIVITY]\nCONDUIT C1\nCONDUIT C3\n"
+               "NODE J2\nNODE J4\nNODE O1\n");
+    fclose(f);
+}
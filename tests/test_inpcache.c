@@ -0,0 +1,204 @@
+//-----------------------------------------------------------------------------
+//   test_inpcache.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that a model whose storage, pump, rating curves and inflow time
+//   series are loaded from an INPUT_CACHE file gives the same saved results
+//   as when they are read from the input file, both on the run that writes
+//   the cache and on the run that loads it.
+//
+//   To show that the last run really used the cache, the final value of the
+//   inflow time series (the last 8 bytes of the cache file) is then changed
+//   in the cache and the results must change with it.
+//
+//   Command line is: test_inpcache
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include "swmm5.h"
+
+#define NRUNS    4                     // number of runs
+#define MAXPER   100                   // max. number of reporting periods
+#define MAXOBJ   20                    // max. number of nodes or links
+
+static const char* InpFile   = "test_inpcache.inp";
+static const char* RptFile   = "test_inpcache.rpt";
+static const char* OutFile   = "test_inpcache.out";
+static const char* CacheFile = "test_inpcache.inp.cache";
+
+static float  Depth[NRUNS][MAXPER][MAXOBJ]; // saved node depths (ft)
+static float  Flow[NRUNS][MAXPER][MAXOBJ];  // saved link flows (cfs)
+static int    Nperiods[NRUNS];              // number of reporting periods
+static int    Nnodes, Nlinks;               // number of nodes & links
+
+static int    runModel(int m, int useCache);
+static int    countDiffs(int m);
+static int    changeCache(void);
+static void   writeInpFile(int useCache);
+
+//=============================================================================
+
+int  main(void)
+{
+    int   nFailed = 0;
+    FILE* f;
+
+    // --- run without the cache, then write the cache & load it
+    remove(CacheFile);
+    if ( !runModel(0, 0) || !runModel(1, 1) ) return 1;
+    f = fopen(CacheFile, "rb");
+    if ( f == NULL )
+    {
+        printf("Cache file %s was not written\n", CacheFile);
+        return 1;
+    }
+    fclose(f);
+    if ( !runModel(2, 1) ) return 1;
+    if ( countDiffs(1) > 0 || countDiffs(2) > 0 ) nFailed++;
+
+    // --- a change made to the cache must show up in the results
+    if ( !changeCache() || !runModel(3, 1) ) return 1;
+    if ( countDiffs(3) == 0 )
+    {
+        printf("Results did not change with the cache file\n");
+        nFailed++;
+    }
+    remove(CacheFile);
+    if ( nFailed ) return 1;
+    printf("Results are the same with and without the input cache.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int countDiffs(int m)
+//
+//  Input:   m = index of run
+//  Output:  returns the number of results that differ from the first run
+//  Purpose: compares a run's results with those of the run made without
+//           the cache.
+//
+{
+    int i, j, p, n = 0;
+
+    if ( Nperiods[m] != Nperiods[0] ) return 1;
+    for (p = 0; p < Nperiods[0]; p++)
+    {
+        for (i = 0; i < Nnodes; i++)
+            if ( Depth[m][p][i] != Depth[0][p][i] ) n++;
+        for (j = 0; j < Nlinks; j++)
+            if ( Flow[m][p][j] != Flow[0][p][j] ) n++;
+    }
+    if ( n > 0 && m < 3 )
+        printf("Run %d: %d results differ from the uncached run\n", m + 1, n);
+    return n;
+}
+
+//=============================================================================
+
+int changeCache()
+//
+//  Output:  returns TRUE if the cache file was changed, FALSE if not
+//  Purpose: raises the final value of the inflow time series, which is
+//           the last entry of the last table in the cache file.
+//
+{
+    double y;
+    FILE*  f = fopen(CacheFile, "r+b");
+
+    if ( f == NULL ) return 0;
+    if ( fseek(f, -(long)sizeof(double), SEEK_END) != 0 ||
+         fread(&y, sizeof(double), 1, f) != 1 )
+    {
+        fclose(f);
+        return 0;
+    }
+    y += 20.0;
+    fseek(f, -(long)sizeof(double), SEEK_END);
+    fwrite(&y, sizeof(double), 1, f);
+    fclose(f);
+    return 1;
+}
+
+//=============================================================================
+
+int runModel(int m, int useCache)
+//
+//  Input:   m = index of run
+//           useCache = TRUE if the INPUT_CACHE option is set
+//  Output:  returns TRUE if the run was successful, FALSE if not
+//  Purpose: runs the test model and saves its node depths and link flows.
+//
+{
+    int    err, i, j, p, n;
+    double elapsedTime = 0.0;
+
+    writeInpFile(useCache);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(1);
+        if ( !err ) while ( swmm_step(&elapsedTime) == 0 &&
+                            elapsedTime > 0.0 );
+        if ( !err ) err = swmm_end();
+    }
+    if ( err )
+    {
+        printf("SWMM error %d on run %d - see %s\n", err, m + 1, RptFile);
+        swmm_close();
+        return 0;
+    }
+
+    Nnodes = swmm_getCount(swmm_NODE);
+    Nlinks = swmm_getCount(swmm_LINK);
+    n = (int)swmm_getValue(swmm_TOTALSTEPS, 0);
+    if ( n > MAXPER ) n = MAXPER;
+    Nperiods[m] = n;
+    for (p = 0; p < n; p++)
+    {
+        for (i = 0; i < Nnodes; i++) Depth[m][p][i] =
+            (float)swmm_getSavedValue(swmm_NODE_DEPTH, i, p + 1);
+        for (j = 0; j < Nlinks; j++) Flow[m][p][j] =
+            (float)swmm_getSavedValue(swmm_LINK_FLOW, j, p + 1);
+    }
+    swmm_close();
+    return 1;
+}
+
+//=============================================================================
+
+void writeInpFile(int useCache)
+//
+//  Input:   useCache = TRUE if the INPUT_CACHE option is set
+//  Purpose: writes the model used for the test.
+//
+{
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 06:00:00\n"
+               "REPORT_STEP 00:05:00\nROUTING_STEP 10\n"
+               "INPUT_CACHE %s\n\n", useCache ? "YES" : "NO");
+    fprintf(f, "[JUNCTIONS]\nJ1 104 6 0 0 0\nJ2 100 6 0 0 0\n"
+               "J3 96 6 0 0 0\n\n");
+    fprintf(f, "[STORAGE]\nSU1 98 10 0 TABULAR SC1 0 0\n\n");
+    fprintf(f, "[OUTFALLS]\nO1 90 FREE NO\n\n");
+    fprintf(f, "[CONDUITS]\nC1 J1 SU1 400 0.013 0 0 0 0\n"
+               "C2 J2 J3 400 0.013 0 0 0 0\nC3 J3 O1 400 0.013 0 0 0 0\n\n");
+    fprintf(f, "[PUMPS]\nP1 SU1 J2 PC1 ON 0 0\n\n");
+    fprintf(f, "[OUTLETS]\nOL1 SU1 J3 2 TABULAR/DEPTH RC1 NO\n\n");
+    fprintf(f, "[XSECTIONS]\nC1 CIRCULAR 2 0 0 0 1\n"
+               "C2 CIRCULAR 2 0 0 0 1\nC3 CIRCULAR 3 0 0 0 1\n\n");
+    fprintf(f, "[CURVES]\nSC1 STORAGE 0 200\nSC1 4 400\nSC1 10 900\n"
+               "PC1 PUMP2 1 0.5\nPC1 3 3\nPC1 10 6\n"
+               "RC1 RATING 0 0\nRC1 2 1\nRC1 8 12\n\n");
+    fprintf(f, "[INFLOWS]\nJ1 FLOW HYD FLOW 1.0 1.0 0.0\n\n");
+    fprintf(f, "[TIMESERIES]\nHYD 0:00 0\nHYD 1:00 4\nHYD 2:00 15\n"
+               "HYD 3:00 8\nHYD 5:00 2\nHYD 6:00 2\n\n");
+    fprintf(f, "[REPORT]\nNODES ALL\nLINKS ALL\n");
+    fclose(f);
+}
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+//   test_loops.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that a Kinematic Wave model whose conveyance network holds two
+//   separate cyclic loops is rejected with error 131 and that the status
+//   report lists each loop as a closed cycle of links.
+//
+//   One loop is 200,000 links long, which overflows the default stack of
+//   a search that recurses once per node.
+//
+//   Each loop also has a conduit leading into it, which must not be listed
+//   as part of the loop.
+//
+//   Command line is: test_loops
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "swmm5.h"
+
+#define NLONG    200000                // number of links in long loop
+#define NSHORT   3                     // number of links in short loop
+#define ERR_LOOP 131                   // SWMM's cyclic loop error code
+
+static const char* InpFile = "test_loops.inp";
+static const char* RptFile = "test_loops.rpt";
+static const char* OutFile = "test_loops.out";
+
+static char   Listed[NLONG + 1];       // TRUE if long loop link was listed
+
+static int    checkReport(void);
+static void   writeInpFile(void);
+
+//=============================================================================
+
+int  main(void)
+{
+    int err;
+
+    writeInpFile();
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err ) err = swmm_start(0);
+    swmm_close();
+    if ( err != ERR_LOOP )
+    {
+        printf("SWMM error %d, expected %d - see %s\n", err, ERR_LOOP,
+               RptFile);
+        return 1;
+    }
+    if ( !checkReport() ) return 1;
+    printf("Both cyclic loops were reported.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int checkReport()
+//
+//  Output:  returns TRUE if both loops were listed in full, FALSE if not
+//  Purpose: reads the cycles of links listed after the loop error message.
+//
+//  Each cycle is listed as link IDs separated by "-->", with no arrow
+//  after its last link. All of the model's link IDs begin with L or C,
+//  so the list ends at the first other word.
+//
+{
+    char  token[64];
+    int   k, found = 0, nLong = 0, nShort = 0, nCycles = 0, ok = 1;
+    FILE* f = fopen(RptFile, "rt");
+
+    if ( f == NULL ) return 0;
+    while ( fscanf(f, "%63s", token) == 1 )
+    {
+        // --- skip to the line after the error message
+        if ( !found )
+        {
+            found = strcmp(token, "131:") == 0;
+            if ( found ) while ( (k = fgetc(f)) != '\n' && k != EOF );
+            continue;
+        }
+        if ( strcmp(token, "-->") == 0 ) continue;
+        if ( token[0] != 'L' && token[0] != 'C' ) break;
+
+        // --- a link ID in the long or short loop
+        if ( sscanf(token, "LA%d", &k) == 1 && k >= 1 && k <= NLONG &&
+             !Listed[k] )
+        {
+            Listed[k] = 1;
+            nLong++;
+        }
+        else if ( sscanf(token, "LB%d", &k) == 1 ) nShort++;
+        else
+        {
+            printf("Link %s was listed in a loop\n", token);
+            ok = 0;
+        }
+
+        // --- see if the ID is the last one in its cycle
+        k = fgetc(f);
+        while ( k == ' ' ) k = fgetc(f);
+        if ( k != '-' ) nCycles++;
+        ungetc(k, f);
+    }
+    fclose(f);
+    if ( !found )
+    {
+        printf("No loop error found in %s\n", RptFile);
+        return 0;
+    }
+    if ( nCycles != 2 || nLong != NLONG || nShort != NSHORT )
+    {
+        printf("Report lists %d cycles with %d long loop links and %d short "
+               "loop links\n", nCycles, nLong, nShort);
+        ok = 0;
+    }
+    return ok;
+}
+
+//=============================================================================
+
+void writeInpFile()
+//
+//  Purpose: writes the model used for the test.
+//
+{
+    int   k;
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING KINWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 01:00:00\n"
+               "REPORT_STEP 00:15:00\nROUTING_STEP 20\n\n");
+
+    // --- junctions of the two loops, a junction feeding each loop and a
+    //     junction draining to an outfall (the loops' conduits fall by
+    //     their inlet offsets)
+    fprintf(f, "[JUNCTIONS]\n");
+    for (k = 1; k <= NLONG; k++) fprintf(f, "A%d 10 6 0 0 0\n", k);
+    for (k = 1; k <= NSHORT; k++) fprintf(f, "B%d 10 6 0 0 0\n", k);
+    fprintf(f, "FA 12 6 0 0 0\nFB 12 6 0 0 0\nJ0 5 6 0 0 0\n\n");
+    fprintf(f, "[OUTFALLS]\nO1 0 FREE NO\n\n");
+    fprintf(f, "[CONDUITS]\n");
+    for (k = 1; k <= NLONG; k++)
+        fprintf(f, "LA%d A%d A%d 100 0.013 0.1 0 0 0\n", k, k,
+                k % NLONG + 1);
+    for (k = 1; k <= NSHORT; k++)
+        fprintf(f, "LB%d B%d B%d 100 0.013 0.1 0 0 0\n", k, k,
+                k % NSHORT + 1);
+    fprintf(f, "CA FA A1 100 0.013 0 0 0 0\nCB FB B2 100 0.013 0 0 0 0\n"
+               "C0 J0 O1 100 0.013 0 0 0 0\n\n");
+    fprintf(f, "[XSECTIONS]\n");
+    for (k = 1; k <= NLONG; k++)
+        fprintf(f, "LA%d CIRCULAR 1 0 0 0 1\n", k);
+    for (k = 1; k <= NSHORT; k++)
+        fprintf(f, "LB%d CIRCULAR 1 0 0 0 1\n", k);
+    fprintf(f, "CA CIRCULAR 1 0 0 0 1\nCB CIRCULAR 1 0 0 0 1\n"
+               "C0 CIRCULAR 1 0 0 0 1\n");
+    fclose(f);
+}
@@ -0,0 +1,219 @@
+//-----------------------------------------------------------------------------
+//   test_multirate.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that dynamic wave routing with MULTIRATE_LEVELS set tracks the
+//   single-rate solution on a pipe chain where a few short conduits limit
+//   the variable time step, so that sub-stepping takes over and the
+//   network step becomes several times longer.
+//
+//   The saved node depths and link flows must stay close to those of the
+//   single-rate run and the flow routing continuity error must not grow.
+//
+//   Command line is: test_multirate
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <math.h>
+#include "swmm5.h"
+
+#define NCONDUITS 8                    // number of conduits in the chain
+#define NNODES   (NCONDUITS + 1)       // number of nodes
+#define NRUNS    3                     // number of runs
+#define MAXPER   200                   // max. number of reporting periods
+#define DEPTHTOL 0.05                  // max. node depth difference (ft)
+#define FLOWTOL  0.02                  // max. link flow difference
+                                       //   (fraction of link's peak flow)
+#define ERRTOL   0.1                   // max. increase in continuity error (%)
+
+static const char* InpFile = "test_multirate.inp";
+static const char* RptFile = "test_multirate.rpt";
+static const char* OutFile = "test_multirate.out";
+
+// --- number of rate levels used by each run (the first is single-rate)
+static const int Levels[NRUNS] = {0, 2, 3};
+
+// --- conduit lengths (ft)
+static const int Length[NCONDUITS] = {1500, 60, 1200, 80, 40, 1000, 100, 800};
+
+static double Depth[NRUNS][MAXPER][NNODES];    // saved node depths (ft)
+static double Flow[NRUNS][MAXPER][NCONDUITS];  // saved link flows (cfs)
+static int    Nperiods[NRUNS];                 // number of reporting periods
+static float  FlowErr[NRUNS];                  // flow continuity error (%)
+
+static int    runModel(int m);
+static int    compareRuns(int m);
+static void   writeInpFile(int m);
+
+//=============================================================================
+
+int  main(void)
+{
+    int m, nFailed = 0;
+
+    for (m = 0; m < NRUNS; m++) if ( !runModel(m) ) return 1;
+    for (m = 1; m < NRUNS; m++) nFailed += compareRuns(m);
+    if ( nFailed ) return 1;
+    printf("Multirate results track single-rate results.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int compareRuns(int m)
+//
+//  Input:   m = index of a multirate run
+//  Output:  returns the number of objects whose results differ too much
+//  Purpose: compares a multirate run's results with the single-rate run.
+//
+{
+    int    i, j, p, nFailed = 0;
+    double peak, diff;
+
+    if ( Nperiods[m] != Nperiods[0] )
+    {
+        printf("Runs have %d and %d reporting periods\n", Nperiods[0],
+               Nperiods[m]);
+        return 1;
+    }
+
+    // --- compare node depths
+    for (i = 0; i < NNODES; i++)
+    {
+        for (p = 0; p < Nperiods[0]; p++)
+        {
+            diff = fabs(Depth[m][p][i] - Depth[0][p][i]);
+            if ( diff > DEPTHTOL )
+            {
+                printf("Levels %d, node %d, period %d: depth = %.4f ft, "
+                       "single-rate depth = %.4f ft\n", Levels[m], i, p + 1,
+                       Depth[m][p][i], Depth[0][p][i]);
+                nFailed++;
+                break;
+            }
+        }
+    }
+
+    // --- compare link flows relative to each link's peak flow
+    for (j = 0; j < NCONDUITS; j++)
+    {
+        peak = 0.0;
+        for (p = 0; p < Nperiods[0]; p++)
+            peak = fmax(peak, fabs(Flow[0][p][j]));
+        for (p = 0; p < Nperiods[0]; p++)
+        {
+            diff = fabs(Flow[m][p][j] - Flow[0][p][j]);
+            if ( diff > FLOWTOL * peak )
+            {
+                printf("Levels %d, link %d, period %d: flow = %.4f cfs, "
+                       "single-rate flow = %.4f cfs\n", Levels[m], j, p + 1,
+                       Flow[m][p][j], Flow[0][p][j]);
+                nFailed++;
+                break;
+            }
+        }
+    }
+
+    // --- compare flow routing continuity errors
+    if ( fabs(FlowErr[m]) > fabs(FlowErr[0]) + ERRTOL )
+    {
+        printf("Levels %d: continuity error = %.3f %%, single-rate "
+               "error = %.3f %%\n", Levels[m], FlowErr[m], FlowErr[0]);
+        nFailed++;
+    }
+    return nFailed;
+}
+
+//=============================================================================
+
+int runModel(int m)
+//
+//  Input:   m = index of run
+//  Output:  returns TRUE if the run was successful, FALSE if not
+//  Purpose: runs the test model and saves its node depths, link flows
+//           and flow continuity error.
+//
+{
+    int    err, i, j, p, n;
+    float  runoffErr, qualErr, tempErr;
+    double elapsedTime = 0.0;
+
+    writeInpFile(m);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(1);
+        if ( !err ) while ( swmm_step(&elapsedTime) == 0 &&
+                            elapsedTime > 0.0 );
+        if ( !err ) err = swmm_end();
+    }
+    if ( err )
+    {
+        printf("SWMM error %d using %d rate levels - see %s\n", err,
+               Levels[m], RptFile);
+        swmm_close();
+        return 0;
+    }
+    swmm_getMassBalErr(&runoffErr, &FlowErr[m], &qualErr, &tempErr);
+
+    n = (int)swmm_getValue(swmm_TOTALSTEPS, 0);
+    if ( n > MAXPER ) n = MAXPER;
+    Nperiods[m] = n;
+    for (p = 0; p < n; p++)
+    {
+        for (i = 0; i < NNODES; i++)
+            Depth[m][p][i] = swmm_getSavedValue(swmm_NODE_DEPTH, i, p + 1);
+        for (j = 0; j < NCONDUITS; j++)
+            Flow[m][p][j] = swmm_getSavedValue(swmm_LINK_FLOW, j, p + 1);
+    }
+    swmm_close();
+    return 1;
+}
+
+//=============================================================================
+
+void writeInpFile(int m)
+//
+//  Input:   m = index of run
+//  Purpose: writes the model used for the test.
+//
+{
+    int    j;
+    double invert = 100.0;
+    FILE*  f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 12:00:00\n"
+               "REPORT_STEP 00:05:00\nROUTING_STEP 30\nVARIABLE_STEP 0.75\n"
+               "MULTIRATE_LEVELS %d\n\n", Levels[m]);
+
+    // --- junctions on a constant 0.4% slope, draining to an outfall
+    fprintf(f, "[JUNCTIONS]\n");
+    for (j = 0; j < NCONDUITS; j++)
+    {
+        fprintf(f, "J%d %.2f 6 0 0 0\n", j + 1, invert);
+        invert -= 0.004 * Length[j];
+    }
+    fprintf(f, "\n[OUTFALLS]\nO1 %.2f FREE NO\n\n", invert);
+    fprintf(f, "[CONDUITS]\n");
+    for (j = 0; j < NCONDUITS - 1; j++)
+        fprintf(f, "C%d J%d J%d %d 0.013 0 0 0 0\n", j + 1, j + 1, j + 2,
+                Length[j]);
+    fprintf(f, "C%d J%d O1 %d 0.013 0 0 0 0\n\n", NCONDUITS, NCONDUITS,
+            Length[NCONDUITS - 1]);
+    fprintf(f, "[XSECTIONS]\n");
+    for (j = 0; j < NCONDUITS; j++)
+        fprintf(f, "C%d CIRCULAR 2 0 0 0 1\n", j + 1);
+
+    // --- inflows stay below full pipe flow
+    fprintf(f, "\n[INFLOWS]\nJ1 FLOW HYD FLOW 1.0 1.0 1.0\n"
+               "J4 FLOW HYD FLOW 1.0 0.5 0.0\n\n");
+    fprintf(f, "[TIMESERIES]\nHYD 0:00 1\nHYD 1:00 3\nHYD 2:00 6\n"
+               "HYD 3:00 8\nHYD 4:00 5\nHYD 6:00 3\nHYD 12:00 1\n\n");
+    fprintf(f, "[REPORT]\nNODES ALL\nLINKS ALL\n");
+    fclose(f);
+}
@@ -0,0 +1,178 @@
+//-----------------------------------------------------------------------------
+//   test_newton.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that dynamic wave routing with SOLVER_METHOD NEWTON tracks the
+//   default PICARD solution on a network where a storage unit empties
+//   through a pump and a weir and a junction overflows through a side
+//   orifice, so that the Newton solver's Jacobian couples node heads
+//   through all three kinds of non-conduit links.
+//
+//   Both solvers stop iterating once node heads change by less than the
+//   head tolerance, so their saved node depths and link flows must agree
+//   to within a small multiple of it.
+//
+//   Command line is: test_newton
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <math.h>
+#include "swmm5.h"
+
+#define NNODES   7                     // number of nodes
+#define NLINKS   8                     // number of links
+#define MAXPER   200                   // max. number of reporting periods
+#define DEPTHTOL 0.02                  // max. node depth difference (ft)
+#define FLOWTOL  0.01                  // max. link flow difference
+                                       //   (fraction of link's peak flow)
+
+static const char* InpFile = "test_newton.inp";
+static const char* RptFile = "test_newton.rpt";
+static const char* OutFile = "test_newton.out";
+static const char* Method[2] = {"PICARD", "NEWTON"};
+
+static double Depth[2][MAXPER][NNODES];     // saved node depths (ft)
+static double Flow[2][MAXPER][NLINKS];      // saved link flows (cfs)
+static int    Nperiods[2];                  // number of reporting periods
+
+static int    runModel(int m);
+static void   writeInpFile(int m);
+
+//=============================================================================
+
+int  main(void)
+{
+    int    i, j, p, nFailed = 0;
+    double peak, diff;
+
+    if ( !runModel(0) || !runModel(1) ) return 1;
+    if ( Nperiods[0] != Nperiods[1] )
+    {
+        printf("Runs have %d and %d reporting periods\n", Nperiods[0],
+               Nperiods[1]);
+        return 1;
+    }
+
+    // --- compare node depths
+    for (i = 0; i < NNODES; i++)
+    {
+        for (p = 0; p < Nperiods[0]; p++)
+        {
+            diff = fabs(Depth[1][p][i] - Depth[0][p][i]);
+            if ( diff > DEPTHTOL )
+            {
+                printf("Node %d, period %d: depth = %.4f ft, PICARD "
+                       "depth = %.4f ft\n", i, p + 1, Depth[1][p][i],
+                       Depth[0][p][i]);
+                nFailed++;
+                break;
+            }
+        }
+    }
+
+    // --- compare link flows relative to each link's peak flow
+    for (j = 0; j < NLINKS; j++)
+    {
+        peak = 0.0;
+        for (p = 0; p < Nperiods[0]; p++)
+            peak = fmax(peak, fabs(Flow[0][p][j]));
+        for (p = 0; p < Nperiods[0]; p++)
+        {
+            diff = fabs(Flow[1][p][j] - Flow[0][p][j]);
+            if ( diff > FLOWTOL * peak )
+            {
+                printf("Link %d, period %d: flow = %.4f cfs, PICARD "
+                       "flow = %.4f cfs\n", j, p + 1, Flow[1][p][j],
+                       Flow[0][p][j]);
+                nFailed++;
+                break;
+            }
+        }
+    }
+    if ( nFailed ) return 1;
+    printf("NEWTON results track PICARD results.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int runModel(int m)
+//
+//  Input:   m = 0 for the PICARD solver, 1 for NEWTON
+//  Output:  returns TRUE if the run was successful, FALSE if not
+//  Purpose: runs the test model and saves its node depths and link flows.
+//
+{
+    int    err, i, j, p, n;
+    double elapsedTime = 0.0;
+
+    writeInpFile(m);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(1);
+        if ( !err ) while ( swmm_step(&elapsedTime) == 0 &&
+                            elapsedTime > 0.0 );
+        if ( !err ) err = swmm_end();
+    }
+    if ( err )
+    {
+        printf("SWMM error %d using %s - see %s\n", err, Method[m],
+               RptFile);
+        swmm_close();
+        return 0;
+    }
+
+    n = (int)swmm_getValue(swmm_TOTALSTEPS, 0);
+    if ( n > MAXPER ) n = MAXPER;
+    Nperiods[m] = n;
+    for (p = 0; p < n; p++)
+    {
+        for (i = 0; i < NNODES; i++)
+            Depth[m][p][i] = swmm_getSavedValue(swmm_NODE_DEPTH, i, p + 1);
+        for (j = 0; j < NLINKS; j++)
+            Flow[m][p][j] = swmm_getSavedValue(swmm_LINK_FLOW, j, p + 1);
+    }
+    swmm_close();
+    return 1;
+}
+
+//=============================================================================
+
+void writeInpFile(int m)
+//
+//  Input:   m = 0 for the PICARD solver, 1 for NEWTON
+//  Purpose: writes the model used for the test.
+//
+{
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 12:00:00\n"
+               "REPORT_STEP 00:05:00\nROUTING_STEP 5\nVARIABLE_STEP 0.75\n"
+               "SOLVER_METHOD %s\n\n", Method[m]);
+    fprintf(f, "[JUNCTIONS]\nJ1 100 8 0 0 0\nJ2 98 8 0 0 0\n"
+               "J3 99 6 0 0 0\nJ4 94 6 0 0 0\nJ5 92 8 0 0 0\n\n");
+    fprintf(f, "[STORAGE]\nSU1 94 12 2 FUNCTIONAL 0 0 500\n\n");
+    fprintf(f, "[OUTFALLS]\nO1 90 FREE NO\n\n");
+    fprintf(f, "[CONDUITS]\nC1 J1 J2 400 0.013 0 0 0 0\n"
+               "C2 J2 SU1 400 0.013 0 0 0 0\nC3 J3 J5 400 0.013 0 0 0 0\n"
+               "C4 J4 J5 300 0.013 0 0 0 0\nC5 J5 O1 300 0.013 0 0 0 0\n\n");
+    fprintf(f, "[PUMPS]\nP1 SU1 J3 PC1 ON 0 0\n\n");
+    fprintf(f, "[WEIRS]\nW1 SU1 J4 TRANSVERSE 5 3.3 NO 0 0\n\n");
+    fprintf(f, "[ORIFICES]\nOR1 J2 J4 SIDE 2 0.65 NO 0\n\n");
+    fprintf(f, "[XSECTIONS]\nC1 CIRCULAR 2.5 0 0 0 1\n"
+               "C2 CIRCULAR 2.5 0 0 0 1\nC3 CIRCULAR 1.5 0 0 0 1\n"
+               "C4 CIRCULAR 2.5 0 0 0 1\nC5 CIRCULAR 3 0 0 0 1\n"
+               "W1 RECT_OPEN 2 6 0 0\nOR1 RECT_CLOSED 1 1 0 0\n\n");
+    fprintf(f, "[CURVES]\nPC1 PUMP3 2 6\nPC1 4 4\nPC1 8 1\n\n");
+    fprintf(f, "[INFLOWS]\nJ1 FLOW HYD FLOW 1.0 1.0 1.0\n\n");
+    fprintf(f, "[TIMESERIES]\nHYD 0:00 1\nHYD 1:00 3\nHYD 2:00 25\n"
+               "HYD 3:00 40\nHYD 4:00 15\nHYD 6:00 5\nHYD 12:00 1\n\n");
+    fprintf(f, "[REPORT]\nNODES ALL\nLINKS ALL\n");
+    fclose(f);
+}
@@ -0,0 +1,179 @@
+//-----------------------------------------------------------------------------
+//   test_rainfile.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks the rainfall that a rain gage reads from a rain data file, both
+//   directly and through a rainfall interface file made by
+//   swmm_convertRainfall, against the values written to the data file.
+//
+//   The hourly record has dry spells (hours with no entry in the file)
+//   and the runs start before it, inside it and on its last day (running
+//   past its end), so that the gage has to search the interface file's
+//   date column for its first period.
+//
+//   Command line is: test_rainfile
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <math.h>
+#include "swmm5.h"
+
+#define NDAYS  20                      // length of rainfall record (days)
+#define NRUNS  3                       // number of simulation windows
+#define RUNLEN 3                       // length of each simulation (days)
+
+static const char* RainFile = "test_rainfile.dat";
+static const char* RffFile  = "test_rainfile.rff";
+static const char* InpFile  = "test_rainfile.inp";
+static const char* RptFile  = "test_rainfile.rpt";
+static const char* OutFile  = "test_rainfile.out";
+
+// --- day of the record (starting from 0) on which each simulation starts
+static const int StartDay[NRUNS] = {-1, 9, NDAYS - 1};
+
+static double getRain(int h);
+static void   writeRainFile(void);
+static void   writeInpFile(int startDay, int useRff);
+static int    checkRun(int startDay, int useRff);
+
+//=============================================================================
+
+int  main(void)
+{
+    int err, i, nFailed = 0;
+
+    // --- convert the rain data file to an interface file
+    writeRainFile();
+    writeInpFile(0, 0);
+    err = swmm_convertRainfall(InpFile, RptFile, RffFile);
+    if ( err )
+    {
+        printf("SWMM error %d converting %s - see %s\n", err, RainFile,
+               RptFile);
+        return 1;
+    }
+
+    // --- compare rainfall read from each file with the recorded values
+    for (i = 0; i < NRUNS; i++)
+    {
+        nFailed += checkRun(StartDay[i], 0);
+        nFailed += checkRun(StartDay[i], 1);
+    }
+    if ( nFailed ) return 1;
+    printf("Rain gage rainfall matches the rain data file.\n");
+    return 0;
+}
+
+//=============================================================================
+
+double getRain(int h)
+//
+//  Input:   h = hour of rainfall record (starting from 0)
+//  Output:  returns rainfall intensity (in/hr) recorded for the hour
+//
+{
+    if ( h < 0 || h >= NDAYS * 24 ) return 0.0;
+    if ( (h / 24) % 4 == 2 || h % 7 == 0 ) return 0.0;
+    return (double)((h * 37) % 23 + 1) / 100.0;
+}
+
+//=============================================================================
+
+int checkRun(int startDay, int useRff)
+//
+//  Input:   startDay = day of rainfall record that the simulation starts on
+//           useRff = TRUE if the run uses the rainfall interface file
+//  Output:  returns the number of reporting periods with wrong rainfall
+//  Purpose: runs a simulation and compares the rainfall saved for its
+//           subcatchment with the recorded rainfall.
+//
+{
+    int    err, p, h, nFailed = 0;
+    double recordStart, date, rain;
+
+    writeInpFile(startDay, useRff);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(1);
+        if ( !err ) while ( swmm_step(&date) == 0 && date > 0.0 );
+        if ( !err ) err = swmm_end();
+    }
+    if ( err )
+    {
+        printf("SWMM error %d - see %s\n", err, RptFile);
+        swmm_close();
+        return 1;
+    }
+
+    // --- the reported rainfall is that of the hour starting at the
+    //     reporting time
+    recordStart = swmm_getValue(swmm_STARTDATE, 0) - startDay;
+    for (p = 1; p <= RUNLEN * 24; p++)
+    {
+        date = swmm_getSavedValue(swmm_CURRENTDATE, 0, p);
+        h = (int)floor((date - recordStart) * 24.0 + 0.5);
+        rain = swmm_getSavedValue(swmm_SUBCATCH_RAINFALL, 0, p);
+        if ( fabs(rain - getRain(h)) > 1.0e-5 )
+        {
+            printf("%s, start day %d, hour %d: rainfall = %.4f, "
+                   "expected %.4f\n", useRff ? "interface file" : "data file",
+                   startDay, h, rain, getRain(h));
+            nFailed++;
+        }
+    }
+    swmm_close();
+    return nFailed;
+}
+
+//=============================================================================
+
+void writeRainFile()
+//
+//  Purpose: writes the rainfall record in SWMM's standard format,
+//           omitting dry hours.
+//
+{
+    int   h;
+    FILE* f = fopen(RainFile, "wt");
+
+    if ( f == NULL ) return;
+    for (h = 0; h < NDAYS * 24; h++)
+    {
+        if ( getRain(h) == 0.0 ) continue;
+        fprintf(f, "STA1 2020 1 %d %d 0 %.2f\n", 2 + h / 24, h % 24,
+                getRain(h));
+    }
+    fclose(f);
+}
+
+//=============================================================================
+
+void writeInpFile(int startDay, int useRff)
+//
+//  Input:   startDay = day of rainfall record that the simulation starts on
+//           useRff = TRUE if the rainfall interface file is used
+//  Purpose: writes the model used for the test.
+//
+{
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    if ( useRff ) fprintf(f, "[FILES]\nUSE RAINFALL \"%s\"\n\n", RffFile);
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nIGNORE_ROUTING YES\n"
+               "START_DATE 01/%02d/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/%02d/2020\nEND_TIME 00:00:00\n"
+               "WET_STEP 00:15:00\nDRY_STEP 01:00:00\n"
+               "REPORT_STEP 01:00:00\n\n",
+               2 + startDay, 2 + startDay + RUNLEN);
+    fprintf(f, "[RAINGAGES]\nG1 INTENSITY 1:00 1.0 FILE \"%s\" STA1 IN\n\n",
+            RainFile);
+    fprintf(f, "[SUBCATCHMENTS]\nS1 G1 O1 10 50 500 0.5 0\n\n");
+    fprintf(f, "[SUBAREAS]\nS1 0.01 0.1 0.05 0.05 25 OUTLET\n\n");
+    fprintf(f, "[INFILTRATION]\nS1 3.0 0.5 4 7 0\n\n");
+    fprintf(f, "[OUTFALLS]\nO1 0 FREE\n\n");
+    fprintf(f, "[REPORT]\nSUBCATCHMENTS ALL\n");
+    fclose(f);
+}
@@ -0,0 +1,226 @@
+//-----------------------------------------------------------------------------
+//   test_rdii.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks the RDII flows that SWMM saves to an RDII interface file against
+//   a direct convolution of each node's unit hydrographs with past rainfall.
+//
+//   Two UH groups are used: one whose times to peak are shorter than the
+//   gage's recording interval (so its rainfall is processed over shorter
+//   intervals) and one whose times to peak are at least as long as it.
+//   The rainfall record runs long enough for the UHs' arrays of past
+//   rainfall to wrap around several times and has dry spells that start
+//   new RDII events.
+//
+//   Command line is: test_rdii
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <math.h>
+#include "swmm5.h"
+
+#define NRAIN  40                      // number of hourly rainfall values
+#define NHOURS 60                      // length of simulation (hours)
+#define DT     3600                    // rainfall interval (sec)
+
+static const char* InpFile  = "test_rdii.inp";
+static const char* RptFile  = "test_rdii.rpt";
+static const char* RdiiFile = "test_rdii.rdi";
+
+// --- hourly rainfall depths (in)
+static const double Rain[NRAIN] =
+    {0.10, 0.50, 0.00, 0.30, 0.20, 0.00, 0.00, 0.40, 0.05, 0.25,
+     0.00, 0.00, 0.00, 0.00, 0.00, 0.00, 0.60, 0.10, 0.00, 0.35,
+     0.15, 0.45, 0.20, 0.00, 0.00, 0.05, 0.00, 0.00, 0.00, 0.00,
+     0.00, 0.00, 0.00, 0.00, 0.00, 0.00, 0.00, 0.70, 0.30, 0.10};
+
+// --- R, T (hr) & K of the short, medium & long term UH of each group
+static const double UH[2][3][3] =
+    {{{0.10, 0.25, 11.0}, {0.05, 0.40, 4.0}, {0.02, 0.10, 30.0}},
+     {{0.10, 1.00,  2.0}, {0.05, 2.50, 1.5}, {0.03, 4.00,  2.0}}};
+
+// --- sewered area (acres) of the node served by each group
+static const double Area[2] = {100.0, 50.0};
+
+static void   writeInpFile(void);
+static double getRdii(int g, int s);
+static double getUnitHydOrd(const double* uh, double t);
+
+//=============================================================================
+
+int  main(void)
+{
+    FILE*  f;
+    char   stamp[10];
+    int    err, rdiiStep, nNodes, i, s, n, nFailed = 0;
+    int    node[2];
+    float  q[2];
+    double startDate = 0.0, date, qExpect;
+    double qSaved[NHOURS+1][2] = {{0.0}};
+
+    // --- run the model up to where its RDII file has been written
+    writeInpFile();
+    err = swmm_open(InpFile, RptFile, "");
+    if ( !err )
+    {
+        startDate = swmm_getValue(swmm_STARTDATE, 0);
+        err = swmm_start(0);
+        if ( !err ) err = swmm_end();
+    }
+    swmm_close();
+    if ( err )
+    {
+        printf("SWMM error %d - see %s\n", err, RptFile);
+        return 1;
+    }
+
+    // --- read the RDII flows saved to the file
+    f = fopen(RdiiFile, "rb");
+    if ( f == NULL ||
+         fread(stamp, 1, 10, f) < 10 ||
+         fread(&rdiiStep, sizeof(int), 1, f) < 1 ||
+         fread(&nNodes, sizeof(int), 1, f) < 1 ||
+         rdiiStep != DT || nNodes != 2 ||
+         fread(node, sizeof(int), 2, f) < 2 )
+    {
+        printf("cannot read %s\n", RdiiFile);
+        return 1;
+    }
+    while ( fread(&date, sizeof(double), 1, f) == 1 &&
+            fread(q, sizeof(float), 2, f) == 2 )
+    {
+        s = (int)floor((date - startDate) * 24.0 + 0.5);
+        if ( s < 0 || s > NHOURS ) continue;
+        for (i = 0; i < 2; i++) qSaved[s][node[i]] = q[i];
+    }
+    fclose(f);
+
+    // --- compare them to the flows found by direct convolution
+    for (s = 0; s <= NHOURS; s++)
+    {
+        for (n = 0; n < 2; n++)
+        {
+            // --- convert in/hr over acres to cfs as SWMM does
+            qExpect = getRdii(n, s) * Area[n] / 2.2956e-5 / 43200.0;
+            if ( qExpect < 0.0001 ) qExpect = 0.0;
+            if ( fabs(qSaved[s][n] - qExpect) > 1.0e-5 + 1.0e-5 * qExpect )
+            {
+                printf("node J%d hour %d: RDII = %.6f, expected %.6f\n",
+                       n + 1, s, qSaved[s][n], qExpect);
+                nFailed++;
+            }
+        }
+    }
+    if ( nFailed ) return 1;
+    printf("RDII flows match direct convolution.\n");
+    return 0;
+}
+
+//=============================================================================
+
+double getRdii(int g, int s)
+//
+//  Input:   g = UH group index
+//           s = hour of simulation
+//  Output:  returns RDII (in/hr) of UH group at the start of hour s
+//  Purpose: convolutes the group's UHs with the rainfall of prior hours.
+//
+//  As in SWMM, rainfall is processed over an interval no longer than the
+//  shortest limb of the group's UHs, each UH is evaluated at the mid-point
+//  of these intervals and only the first tBase/interval of them are used.
+//
+{
+    int    k, p, pMax, q, n;
+    int    ri = DT;                    // rainfall processing interval (sec)
+    long   t1, tBase;
+    double rdii = 0.0;
+
+    for (k = 0; k < 3; k++)
+    {
+        t1 = (long)(UH[g][k][1] * 3600.0);
+        tBase = (long)(UH[g][k][1] * (1.0 + UH[g][k][2]) * 3600.0);
+        if ( t1 < ri ) ri = (int)t1;
+        if ( tBase - t1 < ri ) ri = (int)(tBase - t1);
+    }
+
+    // --- n = number of processing intervals that begin before hour s
+    n = (s * DT + ri - 1) / ri;
+    for (k = 0; k < 3; k++)
+    {
+        tBase = (long)(UH[g][k][1] * (1.0 + UH[g][k][2]) * 3600.0);
+        pMax = (int)(tBase / ri) + 1;
+        for (p = 1; p < pMax && p <= n; p++)
+        {
+            q = (n - p) * ri / DT;
+            if ( q >= NRAIN ) continue;
+            rdii += UH[g][k][0] * Rain[q] * ri / DT *
+                    getUnitHydOrd(UH[g][k], ((double)p - 0.5) * ri);
+        }
+    }
+    return rdii;
+}
+
+//=============================================================================
+
+double getUnitHydOrd(const double* uh, double t)
+//
+//  Input:   uh = R, T & K of a triangular UH
+//           t = time (sec)
+//  Output:  returns UH ordinate (1/hr) at time t
+//
+{
+    double t1 = (double)(long)(uh[1] * 3600.0);
+    double tBase = (double)(long)(uh[1] * (1.0 + uh[2]) * 3600.0);
+    double f;
+
+    if ( t >= tBase ) return 0.0;
+    if ( t <= t1 ) f = t / t1;
+    else f = 1.0 - (t - t1) / (tBase - t1);
+    return f * 2.0 / tBase * 3600.0;
+}
+
+//=============================================================================
+
+void writeInpFile()
+//
+//  Purpose: writes the model used for the test.
+//
+{
+    int   g, k, i;
+    char* term[] = {"SHORT", "MEDIUM", "LONG"};
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[FILES]\nSAVE RDII \"%s\"\n\n", RdiiFile);
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING STEADY\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/%02d/2020\nEND_TIME %02d:00:00\n"
+               "WET_STEP 01:00:00\nDRY_STEP 01:00:00\n"
+               "ROUTING_STEP 00:01:00\nREPORT_STEP 01:00:00\n\n",
+               1 + NHOURS / 24, NHOURS % 24);
+    fprintf(f, "[RAINGAGES]\nG1 VOLUME 1:00 1.0 TIMESERIES TS1\n\n");
+    fprintf(f, "[JUNCTIONS]\nJ1 10 5\nJ2 10 5\n\n[OUTFALLS]\nO1 0 FREE\n\n");
+    fprintf(f, "[CONDUITS]\nC1 J1 O1 400 0.013 0 0\n"
+               "C2 J2 O1 400 0.013 0 0\n\n");
+    fprintf(f, "[XSECTIONS]\nC1 CIRCULAR 3 0 0 0\nC2 CIRCULAR 3 0 0 0\n\n");
+    fprintf(f, "[HYDROGRAPHS]\n");
+    for (g = 0; g < 2; g++)
+    {
+        fprintf(f, "UH%d G1\n", g + 1);
+        for (k = 0; k < 3; k++)
+        {
+            fprintf(f, "UH%d ALL %s %.2f %.2f %.2f\n", g + 1, term[k],
+                    UH[g][k][0], UH[g][k][1], UH[g][k][2]);
+        }
+    }
+    fprintf(f, "\n[RDII]\nJ1 UH1 %.1f\nJ2 UH2 %.1f\n\n", Area[0], Area[1]);
+    fprintf(f, "[TIMESERIES]\n");
+    for (i = 0; i < NRAIN; i++)
+    {
+        fprintf(f, "TS1 01/%02d/2020 %02d:00 %.2f\n", 1 + i / 24, i % 24,
+                Rain[i]);
+    }
+    fclose(f);
+}
@@ -0,0 +1,208 @@
+//-----------------------------------------------------------------------------
+//   test_tseries.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that only the time series that a model uses are read from its
+//   input file: bad data in a used series must still be reported with its
+//   line number and a used series' missing file must still be reported,
+//   while unused series with bad data or a missing file must not be
+//   reported or stop the model from running.
+//
+//   Command line is: test_tseries
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "swmm5.h"
+
+#define ERR_INPUT 200                  // SWMM's input file error code
+
+enum TestCases {GOOD, BAD_DATA, BAD_FILE};
+
+static const char* InpFile = "test_tseries.inp";
+static const char* RptFile = "test_tseries.rpt";
+static const char* OutFile = "test_tseries.out";
+
+static int    checkUsedErrors(void);
+static int    checkUnusedErrors(void);
+static int    runModel(void);
+static int    findLine(const char* file, const char* text);
+static void   writeInpFile(int testCase);
+
+//=============================================================================
+
+int  main(void)
+{
+    int nFailed = 0;
+
+    nFailed += checkUsedErrors();
+    nFailed += checkUnusedErrors();
+    if ( nFailed ) return 1;
+    printf("Errors are reported only for time series that are used.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int checkUsedErrors()
+//
+//  Output:  returns the number of failed checks
+//  Purpose: checks that errors in used time series are reported (with the
+//           line they occur on) and that those in unused series are not.
+//
+{
+    int  nFailed = 0;
+    char msg[80];
+
+    // --- the used series' bad value is reported on its own line
+    writeInpFile(BAD_DATA);
+    if ( runModel() != ERR_INPUT )
+    {
+        printf("Bad data in a used series was not an input error\n");
+        nFailed++;
+    }
+    sprintf(msg, "invalid number xx at line %d of [TIMESERIES]",
+            findLine(InpFile, " xx"));
+    if ( findLine(RptFile, msg) == 0 )
+    {
+        printf("Report does not include \"%s\"\n", msg);
+        nFailed++;
+    }
+    if ( findLine(RptFile, " yy") || findLine(RptFile, "UNUSED") )
+    {
+        printf("Bad data in an unused series was reported\n");
+        nFailed++;
+    }
+
+    // --- the used series' missing file is reported, the unused one isn't
+    writeInpFile(BAD_FILE);
+    if ( runModel() == 0 || findLine(RptFile, "Time Series RAIN") == 0 )
+    {
+        printf("Missing file of a used series was not reported\n");
+        nFailed++;
+    }
+    if ( findLine(RptFile, "Time Series UNUSED") )
+    {
+        printf("Missing file of an unused series was reported\n");
+        nFailed++;
+    }
+    return nFailed;
+}
+
+//=============================================================================
+
+int checkUnusedErrors()
+//
+//  Output:  returns the number of failed checks
+//  Purpose: checks that a model whose only bad time series are unused
+//           can be run.
+//
+{
+    int err;
+
+    writeInpFile(GOOD);
+    err = runModel();
+    if ( err )
+    {
+        printf("SWMM error %d with bad unused series - see %s\n", err,
+               RptFile);
+        return 1;
+    }
+    return 0;
+}
+
+//=============================================================================
+
+int runModel()
+//
+//  Output:  returns the SWMM error code of the run
+//  Purpose: runs the test model.
+//
+{
+    int    err;
+    double elapsedTime = 0.0;
+
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(0);
+        if ( !err ) while ( swmm_step(&elapsedTime) == 0 &&
+                            elapsedTime > 0.0 );
+        if ( !err ) err = swmm_end();
+    }
+    swmm_close();
+    return err;
+}
+
+//=============================================================================
+
+int findLine(const char* file, const char* text)
+//
+//  Input:   file = name of a text file
+//           text = text to search for
+//  Output:  returns the number of the first line of the file that contains
+//           the text (starting from 1) or 0 if no line does
+//
+{
+    char  line[256];
+    int   n = 0;
+    FILE* f = fopen(file, "rt");
+
+    if ( f == NULL ) return 0;
+    while ( fgets(line, sizeof(line), f) != NULL )
+    {
+        n++;
+        if ( strstr(line, text) )
+        {
+            fclose(f);
+            return n;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+//=============================================================================
+
+void writeInpFile(int testCase)
+//
+//  Input:   testCase = GOOD, BAD_DATA or BAD_FILE for the used series
+//  Purpose: writes the model used for the test.
+//
+//  The rain gage uses series RAIN and the junction's inflow uses HYD; the
+//  series named UNUSED are referred to by nothing.
+//
+{
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING KINWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 06:00:00\n"
+               "REPORT_STEP 00:15:00\nWET_STEP 00:05:00\n"
+               "ROUTING_STEP 30\n\n");
+    fprintf(f, "[RAINGAGES]\nG1 INTENSITY 0:15 1.0 TIMESERIES RAIN\n\n");
+    fprintf(f, "[SUBCATCHMENTS]\nS1 G1 J1 10 50 500 0.5 0\n\n");
+    fprintf(f, "[SUBAREAS]\nS1 0.01 0.1 0.05 0.05 25 OUTLET\n\n");
+    fprintf(f, "[INFILTRATION]\nS1 3.0 0.5 4 7 0\n\n");
+    fprintf(f, "[JUNCTIONS]\nJ1 10 6 0 0 0\n\n");
+    fprintf(f, "[OUTFALLS]\nO1 0 FREE NO\n\n");
+    fprintf(f, "[CONDUITS]\nC1 J1 O1 400 0.013 0 0 0 0\n\n");
+    fprintf(f, "[XSECTIONS]\nC1 CIRCULAR 2 0 0 0 1\n\n");
+    fprintf(f, "[INFLOWS]\nJ1 FLOW HYD FLOW 1.0 1.0 0.0\n\n");
+    fprintf(f, "[TIMESERIES]\nUNUSED1 0:00 1\nUNUSED1 1:00 yy\n"
+               "UNUSED2 FILE unused.dat\n");
+    if ( testCase == BAD_DATA )
+        fprintf(f, "HYD 0:00 1\nHYD 1:00 xx\n");
+    else
+        fprintf(f, "HYD 0:00 1\nHYD 1:00 4\n");
+    if ( testCase == BAD_FILE )
+        fprintf(f, "RAIN FILE used.dat\n");
+    else
+        fprintf(f, "RAIN 0:00 0.5\nRAIN 1:00 0\n");
+    fprintf(f, "UNUSED3 0:00 1\nUNUSED3 1:00 yy\n\n");
+    fprintf(f, "[REPORT]\nSUBCATCHMENTS ALL\nNODES ALL\nLINKS ALL\n");
+    fclose(f);
+}
@@ -0,0 +1,166 @@
+//-----------------------------------------------------------------------------
+//   test_validate.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that when curves, time series, nodes and links are validated in
+//   parallel the error and warning messages written to the status report
+//   are the same, and in the same order, as when they are validated by a
+//   single thread.
+//
+//   The model has bad data scattered over many curves, time series,
+//   junctions and conduits, so that with four threads each thread finds
+//   several of the problems.
+//
+//   The test is registered with OMP_NUM_THREADS set to 4 so that the
+//   parallel run uses four threads on any machine.
+//
+//   Command line is: test_validate
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "swmm5.h"
+
+#define NCONDUITS 64                   // number of conduits in the chain
+#define NCURVES   12                   // number of curves & time series
+#define NMSG      40                   // number of messages expected
+#define MAXMSG    100                  // max. number of messages saved
+#define MSGLEN    128                  // max. length of a message
+
+static const char* InpFile = "test_validate.inp";
+static const char* RptFile = "test_validate.rpt";
+static const char* OutFile = "test_validate.out";
+
+static char   Msg[2][MAXMSG][MSGLEN];       // messages written to report
+static int    Nmsg[2];                      // number of messages
+
+static int    runModel(int m, int threads);
+static void   writeInpFile(int threads);
+
+//=============================================================================
+
+int  main(void)
+{
+    int i, nFailed = 0;
+
+    if ( !runModel(0, 1) || !runModel(1, 4) ) return 1;
+    if ( Nmsg[0] != NMSG )
+    {
+        printf("Serial run reported %d messages, expected %d\n", Nmsg[0],
+               NMSG);
+        nFailed++;
+    }
+    if ( Nmsg[1] != Nmsg[0] )
+    {
+        printf("Parallel run reported %d messages, serial run %d\n",
+               Nmsg[1], Nmsg[0]);
+        nFailed++;
+    }
+    for (i = 0; i < Nmsg[0] && i < Nmsg[1]; i++)
+    {
+        if ( strcmp(Msg[0][i], Msg[1][i]) != 0 )
+        {
+            printf("Message %d is\n%sbut serial run reported\n%s", i + 1,
+                   Msg[1][i], Msg[0][i]);
+            nFailed++;
+            break;
+        }
+    }
+    if ( nFailed ) return 1;
+    printf("Parallel validation reports the same messages as serial.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int runModel(int m, int threads)
+//
+//  Input:   m = index of run
+//           threads = number of threads to use
+//  Output:  returns TRUE if the model was rejected, FALSE if not
+//  Purpose: opens the test model and saves the error and warning messages
+//           written to its status report.
+//
+{
+    int   err;
+    char  line[MSGLEN];
+    FILE* f;
+
+    writeInpFile(threads);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    swmm_close();
+    if ( err == 0 )
+    {
+        printf("Model with %d threads had no errors\n", threads);
+        return 0;
+    }
+
+    f = fopen(RptFile, "rt");
+    if ( f == NULL ) return 0;
+    Nmsg[m] = 0;
+    while ( fgets(line, sizeof(line), f) != NULL && Nmsg[m] < MAXMSG )
+    {
+        if ( strstr(line, "ERROR") || strstr(line, "WARNING") )
+            strcpy(Msg[m][Nmsg[m]++], line);
+    }
+    fclose(f);
+    return 1;
+}
+
+//=============================================================================
+
+void writeInpFile(int threads)
+//
+//  Input:   threads = number of threads to use
+//  Purpose: writes the model used for the test.
+//
+{
+    int   j, k;
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 06:00:00\n"
+               "REPORT_STEP 00:15:00\nROUTING_STEP 30\nTHREADS %d\n\n",
+               threads);
+
+    // --- every 5th junction starts deeper than it is
+    fprintf(f, "[JUNCTIONS]\n");
+    for (j = 1; j <= NCONDUITS; j++)
+        fprintf(f, "J%d %d 8 %d 0 0\n", j, 200 - j, j % 5 ? 0 : 10);
+    fprintf(f, "\n[OUTFALLS]\nO1 %d FREE NO\n\n", 199 - NCONDUITS);
+
+    // --- every 9th conduit has no length, every 11th no roughness and
+    //     every 7th a negative offset
+    fprintf(f, "[CONDUITS]\n");
+    for (j = 1; j <= NCONDUITS; j++)
+    {
+        fprintf(f, "C%d J%d ", j, j);
+        if ( j < NCONDUITS ) fprintf(f, "J%d ", j + 1);
+        else                 fprintf(f, "O1 ");
+        fprintf(f, "%d %s %d 0 0 0\n", j % 9 ? 200 : 0,
+                j % 11 ? "0.013" : "0", j % 7 ? 0 : -1);
+    }
+    fprintf(f, "\n[XSECTIONS]\n");
+    for (j = 1; j <= NCONDUITS; j++)
+        fprintf(f, "C%d CIRCULAR 2 0 0 0 1\n", j);
+
+    // --- every 3rd curve & time series has out of sequence data (each
+    //     time series is an inflow so that it is in use)
+    fprintf(f, "\n[CURVES]\n");
+    for (k = 1; k <= NCURVES; k++)
+        fprintf(f, "SC%d STORAGE 0 100\nSC%d %d 200\nSC%d 4 300\n", k, k,
+                k % 3 ? 2 : 6, k);
+    fprintf(f, "\n[TIMESERIES]\n");
+    for (k = 1; k <= NCURVES; k++)
+        fprintf(f, "TS%d 0:00 1\nTS%d %d:00 2\nTS%d 4:00 3\n", k, k,
+                k % 3 ? 2 : 6, k);
+    fprintf(f, "\n[INFLOWS]\n");
+    for (k = 1; k <= NCURVES; k++)
+        fprintf(f, "J%d FLOW TS%d FLOW 1.0 1.0 0.0\n", k, k);
+    fprintf(f, "\n[REPORT]\nNODES ALL\nLINKS ALL\n");
+    fclose(f);
+}
@@ -0,0 +1,273 @@
+//-----------------------------------------------------------------------------
+//   test_wavefront.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//
+//   Checks that Kinematic Wave and Steady Flow routing give the same saved
+//   results with THREADS 1 as with THREADS 4, where the nodes of each
+//   wavefront are shared out among the threads.
+//
+//   The network has two branching trees of conduits, each draining into a
+//   storage unit that empties through a weir and an orifice, then through
+//   a flow divider to two outfalls, so that nodes with several inlets,
+//   multi-outlet storage units and dividers all appear in wavefronts that
+//   hold more than one node.
+//
+//   The test is registered with OMP_NUM_THREADS set to 4 so that the
+//   parallel run uses four threads on any machine.
+//
+//   Command line is: test_wavefront
+//   (files are written to the current directory)
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include "swmm5.h"
+
+#define NTREES   2                     // number of trees
+#define NLEVELS  3                     // number of branching levels per tree
+#define MAXPER   100                   // max. number of reporting periods
+#define MAXOBJ   100                   // max. number of nodes or links
+#define TREESIZE ((2 << NLEVELS) - 1)  // number of junctions per tree
+
+static const char* InpFile = "test_wavefront.inp";
+static const char* RptFile = "test_wavefront.rpt";
+static const char* OutFile = "test_wavefront.out";
+static const char* Routing[2] = {"KINWAVE", "STEADY"};
+
+static float  Depth[2][MAXPER][MAXOBJ];     // saved node depths (ft)
+static float  Flow[2][MAXPER][MAXOBJ];      // saved link flows (cfs)
+static int    Nperiods[2];                  // number of reporting periods
+static int    Nnodes, Nlinks;               // number of nodes & links
+
+// --- tree junctions (numbered from 1) & the junction each one drains to
+static int    NtreeNodes;
+static int    Elev[NTREES * TREESIZE + 1];
+static int    DrainsTo[NTREES * TREESIZE + 1];
+
+static int    runModel(int r, int threads);
+static int    compareRuns(int r);
+static void   writeInpFile(int r, int threads);
+static int    buildTree(int level, int elev);
+
+//=============================================================================
+
+int  main(void)
+{
+    int r, nFailed = 0;
+
+    for (r = 0; r < 2; r++)
+    {
+        if ( !runModel(r, 1) || !runModel(r, 4) ) return 1;
+        nFailed += compareRuns(r);
+    }
+    if ( nFailed ) return 1;
+    printf("Parallel wavefront routing matches serial routing.\n");
+    return 0;
+}
+
+//=============================================================================
+
+int compareRuns(int r)
+//
+//  Input:   r = routing method index
+//  Output:  returns the number of objects whose results differ
+//  Purpose: compares the results of the serial and parallel runs.
+//
+{
+    int i, j, p, nFailed = 0;
+
+    if ( Nperiods[0] != Nperiods[1] )
+    {
+        printf("%s runs have %d and %d reporting periods\n", Routing[r],
+               Nperiods[0], Nperiods[1]);
+        return 1;
+    }
+    for (i = 0; i < Nnodes; i++)
+    {
+        for (p = 0; p < Nperiods[0]; p++)
+        {
+            if ( Depth[1][p][i] != Depth[0][p][i] )
+            {
+                printf("%s, node %d, period %d: depth = %.6f ft, serial "
+                       "depth = %.6f ft\n", Routing[r], i, p + 1,
+                       Depth[1][p][i], Depth[0][p][i]);
+                nFailed++;
+                break;
+            }
+        }
+    }
+    for (j = 0; j < Nlinks; j++)
+    {
+        for (p = 0; p < Nperiods[0]; p++)
+        {
+            if ( Flow[1][p][j] != Flow[0][p][j] )
+            {
+                printf("%s, link %d, period %d: flow = %.6f cfs, serial "
+                       "flow = %.6f cfs\n", Routing[r], j, p + 1,
+                       Flow[1][p][j], Flow[0][p][j]);
+                nFailed++;
+                break;
+            }
+        }
+    }
+    return nFailed;
+}
+
+//=============================================================================
+
+int runModel(int r, int threads)
+//
+//  Input:   r = routing method index
+//           threads = number of threads to use
+//  Output:  returns TRUE if the run was successful, FALSE if not
+//  Purpose: runs the test model and saves its node depths and link flows.
+//
+{
+    int    err, i, j, p, n, m = (threads > 1);
+    double elapsedTime = 0.0;
+
+    writeInpFile(r, threads);
+    err = swmm_open(InpFile, RptFile, OutFile);
+    if ( !err )
+    {
+        err = swmm_start(1);
+        if ( !err ) while ( swmm_step(&elapsedTime) == 0 &&
+                            elapsedTime > 0.0 );
+        if ( !err ) err = swmm_end();
+    }
+    if ( err )
+    {
+        printf("SWMM error %d using %s with %d threads - see %s\n", err,
+               Routing[r], threads, RptFile);
+        swmm_close();
+        return 0;
+    }
+
+    Nnodes = swmm_getCount(swmm_NODE);
+    Nlinks = swmm_getCount(swmm_LINK);
+    n = (int)swmm_getValue(swmm_TOTALSTEPS, 0);
+    if ( n > MAXPER ) n = MAXPER;
+    Nperiods[m] = n;
+    for (p = 0; p < n; p++)
+    {
+        for (i = 0; i < Nnodes; i++) Depth[m][p][i] =
+            (float)swmm_getSavedValue(swmm_NODE_DEPTH, i, p + 1);
+        for (j = 0; j < Nlinks; j++) Flow[m][p][j] =
+            (float)swmm_getSavedValue(swmm_LINK_FLOW, j, p + 1);
+    }
+    swmm_close();
+    return 1;
+}
+
+//=============================================================================
+
+int buildTree(int level, int elev)
+//
+//  Input:   level = number of branching levels below the junction
+//           elev = junction's invert elevation (ft)
+//  Output:  returns the index of the tree's top junction
+//  Purpose: adds a binary tree of junctions to the network.
+//
+{
+    int k, child, n = ++NtreeNodes;
+
+    Elev[n] = elev;
+    DrainsTo[n] = 0;
+    if ( level == 0 ) return n;
+    for (k = 0; k < 2; k++)
+    {
+        child = buildTree(level - 1, elev + 2);
+        DrainsTo[child] = n;
+    }
+    return n;
+}
+
+//=============================================================================
+
+void writeInpFile(int r, int threads)
+//
+//  Input:   r = routing method index
+//           threads = number of threads to use
+//  Purpose: writes the model used for the test.
+//
+{
+    int   b, n, root[NTREES];
+    FILE* f = fopen(InpFile, "wt");
+
+    if ( f == NULL ) return;
+    NtreeNodes = 0;
+    for (b = 0; b < NTREES; b++) root[b] = buildTree(NLEVELS, 12);
+
+    fprintf(f, "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING %s\n"
+               "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+               "END_DATE 01/01/2020\nEND_TIME 12:00:00\n"
+               "REPORT_STEP 00:15:00\nROUTING_STEP 30\nTHREADS %d\n\n",
+               Routing[r], threads);
+    fprintf(f, "[JUNCTIONS]\n");
+    for (n = 1; n <= NtreeNodes; n++)
+        fprintf(f, "N%d %d 6 0 0 0\n", n, Elev[n]);
+    for (b = 0; b < NTREES; b++)
+        fprintf(f, "Q%d 5 10 0 0 0\nE%d 3 10 0 0 0\nF%d 3 10 0 0 0\n",
+                b, b, b);
+    fprintf(f, "\n[OUTFALLS]\n");
+    for (b = 0; b < NTREES; b++)
+        fprintf(f, "O%d 0 FREE NO\nOD%d 0 FREE NO\n", b, b);
+    fprintf(f, "\n[STORAGE]\n");
+    for (b = 0; b < NTREES; b++)
+        fprintf(f, "SU%d 10 15 0 FUNCTIONAL 2000 0 0 0 0\n", b);
+    fprintf(f, "\n[DIVIDERS]\nDV0 4 CD0 OVERFLOW 10 0 0 0\n"
+               "DV1 4 CD1 CUTOFF 5 10 0 0 0\n\n");
+
+    // --- each tree junction drains through its own conduit, the trees'
+    //     top junctions drain to storage units
+    fprintf(f, "[CONDUITS]\n");
+    for (n = 1; n <= NtreeNodes; n++)
+    {
+        if ( DrainsTo[n] ) fprintf(f, "C%d N%d N%d 400 0.013 0 0 0 0\n",
+                                   n, n, DrainsTo[n]);
+    }
+    for (b = 0; b < NTREES; b++)
+    {
+        fprintf(f, "C%d N%d SU%d 400 0.013 0 0 0 0\n", root[b], root[b], b);
+        fprintf(f, "CQ%d Q%d DV%d 400 0.013 0 0 0 0\n", b, b, b);
+        fprintf(f, "CM%d DV%d E%d 400 0.013 0 0 0 0\n", b, b, b);
+        fprintf(f, "CD%d DV%d F%d 400 0.013 0 0 0 0\n", b, b, b);
+        fprintf(f, "CO%d E%d O%d 400 0.013 0 0 0 0\n", b, b, b);
+        fprintf(f, "CP%d F%d OD%d 400 0.013 0 0 0 0\n", b, b, b);
+    }
+
+    // --- each storage unit empties through a weir and an orifice
+    fprintf(f, "\n[WEIRS]\n");
+    for (b = 0; b < NTREES; b++)
+        fprintf(f, "W%d SU%d Q%d TRANSVERSE 3 3.33 NO 0 0\n", b, b, b);
+    fprintf(f, "\n[ORIFICES]\n");
+    for (b = 0; b < NTREES; b++)
+        fprintf(f, "OR%d SU%d Q%d BOTTOM 0 0.65 NO 0\n", b, b, b);
+
+    fprintf(f, "\n[XSECTIONS]\n");
+    for (n = 1; n <= NtreeNodes; n++)
+    {
+        if ( n % 2 ) fprintf(f, "C%d CIRCULAR 1.5 0 0 0 1\n", n);
+        else         fprintf(f, "C%d TRAPEZOIDAL 2 3 1 1 1\n", n);
+    }
+    for (b = 0; b < NTREES; b++)
+    {
+        fprintf(f, "CQ%d CIRCULAR 3 0 0 0 1\nCM%d CIRCULAR 2 0 0 0 1\n"
+                   "CD%d CIRCULAR 1 0 0 0 1\nCO%d CIRCULAR 3 0 0 0 1\n"
+                   "CP%d CIRCULAR 2 0 0 0 1\n", b, b, b, b, b);
+        fprintf(f, "W%d RECT_OPEN 3 4 0 0\nOR%d CIRCULAR 1 0 0 0\n", b, b);
+    }
+
+    // --- inflow at each leaf junction
+    fprintf(f, "\n[INFLOWS]\n");
+    for (n = 1; n <= NtreeNodes; n++)
+    {
+        if ( Elev[n] == 12 + 2 * NLEVELS )
+            fprintf(f, "N%d FLOW HYD FLOW 1.0 %.2f 0.05\n", n,
+                    0.2 + 0.01 * (n % 17));
+    }
+    fprintf(f, "\n[TIMESERIES]\nHYD 0:00 0\nHYD 1:00 10\nHYD 3:00 25\n"
+               "HYD 6:00 5\nHYD 12:00 0\n\n");
+    fprintf(f, "[REPORT]\nNODES ALL\nLINKS ALL\n");
+    fclose(f);
+}